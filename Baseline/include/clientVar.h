@@ -71,6 +71,7 @@ class ClientVar {
         MessageQueue<Container_t>* _inputMQ;
         SendMsgBuffer_t _recvChunkBuf;
         Recipe_t _inRecipe;
+        uint8_t* _hashList; // the chunk hashes of the current batch
 
         // restore buffer parameters
         uint8_t* _readRecipeBuf;
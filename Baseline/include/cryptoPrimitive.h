@@ -15,6 +15,8 @@
 #include <openssl/crypto.h>
 #include "chunkStructure.h"
 #include "configure.h"
+// the SHA-NI kernel is shared with the enclave of the prototype
+#include "../../Prototype/src/Enclave/include/ecallSha256.h"
 
 using namespace std;
 
@@ -33,6 +35,9 @@ class CryptoPrimitive {
         // initialized vector
         uint8_t* iv_;
 
+        // whether SHA-256 uses the SHA extensions instead of EVP
+        bool shaNI_ = false;
+
     public:
         /**
          * @brief Construct a new Crypto Primitive object
@@ -58,6 +63,19 @@ class CryptoPrimitive {
          */
         void GenerateHash(EVP_MD_CTX* mdCtx, uint8_t* dataBuffer, const int dataSize, uint8_t* hash);
 
+        /**
+         * @brief Generate the hash of each chunk in a batch buffer, whose
+         * layout is (uint32_t chunk size, chunk data) per chunk
+         * 
+         * @param mdCtx hasher ctx
+         * @param batchBuffer the batch buffer
+         * @param chunkNum the number of chunks
+         * @param hashList the hash of chunk i is at hashList + i * hashStride
+         * @param hashStride the stride of the hashes
+         */
+        void GenerateHashBatch(EVP_MD_CTX* mdCtx, uint8_t* batchBuffer, size_t chunkNum,
+            uint8_t* hashList, size_t hashStride);
+
         /**
          * @brief Encrypt the data with the encryption key 
          * 
@@ -63,13 +63,16 @@ void PlainIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf, ClientVar* curCl
     tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
     bool status;
 
+    // compute the hash over the ciphertext chunks of the batch
+    uint8_t* hashList = curClient->_hashList;
+    cryptoObj_->GenerateHashBatch(mdCtx, recvChunkBuf->dataBuffer, chunkNum, hashList,
+        CHUNK_HASH_SIZE);
+
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the ciphertext chunk
         memcpy(&tmpChunkSize, recvChunkBuf->dataBuffer + currentOffset, sizeof(tmpChunkSize));
         currentOffset += sizeof(tmpChunkSize);
 
-        cryptoObj_->GenerateHash(mdCtx, recvChunkBuf->dataBuffer + currentOffset, 
-            tmpChunkSize, (uint8_t*)&tmpHashStr[0]);
+        memcpy(&tmpHashStr[0], hashList + i * CHUNK_HASH_SIZE, CHUNK_HASH_SIZE);
         status = this->ReadIndexStore(tmpHashStr, tmpChunkAddStr);
         if (status == false) {
             // this is unique chunk
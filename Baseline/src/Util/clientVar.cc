@@ -88,6 +88,9 @@ void ClientVar::InitUploadBuffer() {
         sizeof(RecipeEntry_t));
     _inRecipe.recipeNum = 0;
 
+    // init the hash buffer of a batch
+    _hashList = (uint8_t*) malloc(sendChunkBatchSize_ * CHUNK_HASH_SIZE);
+
     // prepare the input MQ
     _inputMQ = new MessageQueue<Container_t>(CONTAINER_QUEUE_SIZE);
 
@@ -130,6 +133,7 @@ void ClientVar::DestoryUploadBuffer() {
     }
     free(_recvChunkBuf.sendBuffer);
     free(_inRecipe.entryList);
+    free(_hashList);
     delete _inputMQ;
     EVP_MD_CTX_free(_mdCtx);
     EVP_CIPHER_CTX_free(_cipherCtx);
@@ -1,4 +1,5 @@
 #include "../../include/cryptoPrimitive.h"
+#include <cpuid.h>
 
 /**
  * @brief Construct a new Crypto Primitive object
@@ -15,6 +16,20 @@ CryptoPrimitive::CryptoPrimitive(int cipherType, int hashType) {
         exit(EXIT_FAILURE);
     }
     memset(iv_, 0, sizeof(uint8_t) * CRYPTO_BLOCK_SIZE);
+
+    // check the SHA extensions
+    if (hashType_ == SHA_256) {
+        uint32_t eax, ebx, ecx, edx;
+        uint32_t leaf1Ecx = 0;
+        uint32_t leaf7Ebx = 0;
+        if (__get_cpuid_count(1, 0, &eax, &ebx, &ecx, &edx)) {
+            leaf1Ecx = ecx;
+        }
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            leaf7Ebx = ebx;
+        }
+        shaNI_ = EcallSha256::CheckCPU(leaf1Ecx, leaf7Ebx);
+    }
 }
 
 /**
@@ -36,6 +51,11 @@ CryptoPrimitive::~CryptoPrimitive() {
  * @param hash output hash 
  */
 void CryptoPrimitive::GenerateHash(EVP_MD_CTX* mdCtx, uint8_t* dataBuffer, const int dataSize, uint8_t* hash) {
+    if (shaNI_) {
+        EcallSha256::Hash(dataBuffer, dataSize, hash);
+        return ;
+    }
+
     int expectedHashSize = 0;
     switch (hashType_) {
         case SHA_1:
@@ -79,6 +99,35 @@ void CryptoPrimitive::GenerateHash(EVP_MD_CTX* mdCtx, uint8_t* dataBuffer, const
     return ;
 }
 
+/**
+ * @brief Generate the hash of each chunk in a batch buffer, whose
+ * layout is (uint32_t chunk size, chunk data) per chunk
+ * 
+ * @param mdCtx hasher ctx
+ * @param batchBuffer the batch buffer
+ * @param chunkNum the number of chunks
+ * @param hashList the hash of chunk i is at hashList + i * hashStride
+ * @param hashStride the stride of the hashes
+ */
+void CryptoPrimitive::GenerateHashBatch(EVP_MD_CTX* mdCtx, uint8_t* batchBuffer, size_t chunkNum,
+    uint8_t* hashList, size_t hashStride) {
+    if (shaNI_) {
+        EcallSha256::HashBatch(batchBuffer, chunkNum, hashList, hashStride);
+        return ;
+    }
+
+    size_t currentOffset = 0;
+    uint32_t tmpChunkSize = 0;
+    for (size_t i = 0; i < chunkNum; i++) {
+        memcpy(&tmpChunkSize, batchBuffer + currentOffset, sizeof(uint32_t));
+        currentOffset += sizeof(uint32_t);
+        this->GenerateHash(mdCtx, batchBuffer + currentOffset, tmpChunkSize,
+            hashList + i * hashStride);
+        currentOffset += tmpChunkSize;
+    }
+    return ;
+}
+
 /**
  * @brief Encrypt the data with the encryption key 
  * 
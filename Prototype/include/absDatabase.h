@@ -15,6 +15,9 @@
 
 using namespace std;
 
+// the handler of a key in the key scan
+typedef function<void(const char* key, size_t keySize)> KeyHandler_t;
+
 class AbsDatabase {
     protected:
         // the name of the database
@@ -98,6 +101,58 @@ class AbsDatabase {
          */
         virtual bool QueryBuffer(const char* key, size_t keySize, std::string& value) = 0;
 
+        /**
+         * @brief query a batch of fixed-size keys, the value of a found key
+         * is copied to its value slot
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value slot
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the value slots
+         * @param itemNum the number of keys
+         * @param selectList the keys to query (NULL: all), the others are not found
+         * @param foundList the query result of each key
+         * @return size_t the number of found keys
+         */
+        virtual size_t MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+            bool* foundList) = 0;
+
+        /**
+         * @brief insert a batch of fixed-size (key, value) pairs in one write
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the values
+         * @param itemNum the number of pairs
+         * @param selectList the pairs to insert (NULL: all)
+         * @return true success
+         * @return false fail
+         */
+        virtual bool WriteBatchBuffer(const char* keyList, size_t keySize, const char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList) = 0;
+
+        /**
+         * @brief check whether the database has no key
+         * 
+         * @return true it is empty
+         * @return false it has keys
+         */
+        virtual bool IsEmpty() = 0;
+
+        /**
+         * @brief pass each key of the database to the handler once, the
+         * database must not be modified during the scan
+         * 
+         * @param keyHandler the key handler
+         * @return true success
+         * @return false fail
+         */
+        virtual bool ScanKey(KeyHandler_t keyHandler) = 0;
+
 
 };
 
@@ -25,9 +25,18 @@ typedef struct {
     uint64_t totalChunkNum;
 } FileRecipeHead_t;
 
+// the pooled read buffer of the client (defined in readBufferPool.h)
+struct ReadBuffer;
+
+typedef struct {
+    uint32_t chunkSize;
+    uint8_t* data; // the chunk content in the read buffer
+    struct ReadBuffer* readBuffer; // released once the chunk is copied out
+} ChunkDesc_t;
+
 typedef struct {
     union {
-        Chunk_t chunk;
+        ChunkDesc_t chunk;
         FileRecipeHead_t recipeHead;
     };
     int dataType;
@@ -55,8 +64,15 @@ typedef struct {
 
 typedef struct {
     uint64_t sendChunkBatchSize;
+    uint64_t maxChunkBatchSize; // the upload buffers hold the largest adaptive batch
     uint64_t sendRecipeBatchSize;
     uint64_t topKParam;
+    uint64_t topKEPCBudget; // the memory budget of the sketch and the top-k index (0: fixed k)
+    uint64_t sketchWidth;
+    uint64_t sketchDepth;
+    uint64_t freqPolicy; // the bits of FREQ_POLICY of the freq index
+    uint64_t enclaveWorkerNum; // the worker threads inside the enclave (0: no worker)
+    uint64_t outQueryPipeline; // pipeline the out-enclave query with the next batch (freq index)
 } EnclaveConfig_t;
 
 typedef struct {
@@ -90,6 +106,18 @@ typedef struct {
     uint8_t* dataBuffer;
 } SendMsgBuffer_t;
 
+typedef struct {
+    uint32_t streamNum; // the number of upload streams
+    uint32_t batchTuneWindow; // the chunk batches between two feedbacks (0: fixed batch size)
+    uint32_t maxChunkBatchSize; // the max chunk num in a batch
+} UploadLoginOpt_t;
+
+typedef struct {
+    uint32_t batchNum; // the chunk batches in the window
+    uint32_t chunkNum; // the chunks in the window
+    double enclaveTime; // the enclave process time of the window
+} BatchFeedback_t;
+
 typedef struct {
     uint32_t recipeNum;
     uint8_t* entryList;
@@ -166,6 +194,7 @@ typedef struct {
     SendMsgBuffer_t* sendChunkBuf;
     void* outClient; // the out-enclave client ptr
     void* sgxClient; // the sgx-client ptr
+    uint32_t transferMode; // the transfer mode of the restored chunks
 } ResOutSGX_t;
 
 typedef struct _ra_msg4_struct {
@@ -0,0 +1,112 @@
+/**
+ * @file chunkerPool.h
+ * @brief define the interface of the pool of chunkers for multi-file upload
+ * @version 0.1
+ * 
+ */
+
+#ifndef BASICDEDUP_CHUNKER_POOL_H
+#define BASICDEDUP_CHUNKER_POOL_H
+
+#include "chunker.h"
+#include <boost/atomic.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+using namespace std;
+
+extern Configure config;
+
+typedef struct {
+    Chunker* chunkerObj; // the chunker of the file in this slot
+    MessageQueue<Data_t>* outputMQ; // the chunks of the file in this slot
+    boost::atomic<uint64_t> readyFileID; // the file ready in this slot
+} ChunkerSlot_t;
+
+class ChunkerPool {
+    private:
+        string myName_ = "ChunkerPool";
+
+        // the files to upload in the session
+        vector<string> fileList_;
+
+        // worker i chunks the file i, i + workerNum_, ... in slot i
+        uint64_t workerNum_;
+        ChunkerSlot_t* slotList_;
+
+        // the number of files sent by the sender
+        boost::atomic<uint64_t> sentFileNum_;
+
+        // park the workers and the sender while waiting for each other
+        boost::mutex slotLck_;
+        boost::condition_variable slotCond_;
+
+        double totalTime_ = 0;
+
+        /**
+         * @brief chunk the files assigned to a worker
+         * 
+         * @param workerID the worker ID
+         */
+        void ChunkFiles(uint64_t workerID);
+
+    public:
+        // the total size of the chunked files
+        boost::atomic<uint64_t> _totalFileSize;
+        boost::atomic<uint64_t> _totalChunkNum;
+
+        /**
+         * @brief Construct a new ChunkerPool object
+         * 
+         * @param fileList the files to upload
+         */
+        ChunkerPool(vector<string>& fileList);
+
+        /**
+         * @brief Destroy the ChunkerPool object
+         * 
+         */
+        ~ChunkerPool();
+
+        /**
+         * @brief the main process, chunk the files with the workers
+         * 
+         */
+        void Run();
+
+        /**
+         * @brief Get the chunks of a file, wait until its chunker is ready
+         * 
+         * @param fileID the file ID
+         * @return MessageQueue<Data_t>* the MQ of the file chunks
+         */
+        MessageQueue<Data_t>* GetFileMQ(uint64_t fileID);
+
+        /**
+         * @brief notify that all chunks of a file are sent, such that its slot can
+         * be reused
+         * 
+         * @param fileID the file ID
+         */
+        void FinishFile(uint64_t fileID);
+
+        /**
+         * @brief Get the number of files
+         * 
+         * @return uint64_t the file number
+         */
+        uint64_t GetFileNum() {
+            return fileList_.size();
+        }
+
+        /**
+         * @brief Get the path of a file
+         * 
+         * @param fileID the file ID
+         * @return string& the file path
+         */
+        string& GetFilePath(uint64_t fileID) {
+            return fileList_[fileID];
+        }
+};
+
+#endif // BASICDEDUP_CHUNKER_POOL_H
@@ -22,11 +22,15 @@ using namespace std;
 
 extern Configure config;
 
+class UploadSession;
+class OutQueryWorker;
+
 class ClientVar {
     private:
         string myName_ = "ClientVar";
         int optType_; // the operation type (upload / download)
         uint64_t sendChunkBatchSize_;
+        uint64_t maxChunkBatchSize_; // the upload buffers hold the largest adaptive batch
         uint64_t sendRecipeBatchSize_;
         string recipePath_;
 
@@ -68,6 +72,8 @@ class ClientVar {
         // upload buffer parameters
         Container_t _curContainer; // current container buffer
         OutQuery_t _outQuery; // the buffer to store the encrypted chunk fp
+        bool* _outQueryFlagList; // the found / insert flag of each out-enclave query
+        bool* _outQueryProbeList; // the out-enclave queries that pass the index filter
         MessageQueue<Container_t>* _inputMQ;
         SendMsgBuffer_t _recvChunkBuf;
         Recipe_t _outRecipe; // the buffer to store ciphertext recipe
@@ -83,13 +89,25 @@ class ClientVar {
         // upload logical data size
         uint64_t _uploadDataSize = 0;
 
+        // the session of the parallel upload streams (NULL for a single stream)
+        UploadSession* _uploadSession = NULL;
+        uint32_t _streamID = 0;
+
+        // the helper thread of the pipelined out-enclave query (created by the
+        // first query of the freq index)
+        OutQueryWorker* _outQueryWorker = NULL;
+
+        // the batches between two feedbacks of the enclave time (0: no feedback)
+        uint32_t _batchTuneWindow = 0;
+
         /**
          * @brief Construct a new ClientVar object
          * 
          * @param clientID the client ID
          * @param clientSSL the client SSL
          * @param optType the operation type (upload / download)
-         * @param recipePath the file recipe path
+         * @param recipePath the file recipe path (empty for a secondary upload
+         * stream, which writes to the recipe of the primary stream)
          */
         ClientVar(uint32_t clientID, SSL* clientSSL, 
             int optType, string& recipePath);
@@ -99,6 +117,13 @@ class ClientVar {
          * 
          */
         ~ClientVar();
+
+        /**
+         * @brief open the recipe of the next uploaded file in this session
+         * 
+         * @param recipePath the file recipe path
+         */
+        void OpenRecipe(string& recipePath);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,336 @@
+/**
+ * @file compactDatabase.h
+ * @brief define a compact in-memory index of the fixed-size (fingerprint,
+ * address) pairs, the snapshot is mapped at startup and the delta log keeps
+ * the inserts after the snapshot. Like the default writes of LevelDB, the log
+ * is not synced per batch: a crash of the process keeps the inserts, a crash
+ * of the machine may lose the inserts after the last snapshot
+ * @version 0.1
+ * 
+ */
+
+#ifndef COMPACT_DATABASE_H
+#define COMPACT_DATABASE_H
+
+#include "absDatabase.h"
+#include "configure.h"
+#include "chunkStructure.h"
+
+class CompactDatabase : public AbsDatabase {
+    protected:
+        // the fixed pair size
+        static const size_t KEY_SIZE = CHUNK_HASH_SIZE;
+        static const size_t VALUE_SIZE = sizeof(RecipeEntry_t);
+        static const size_t SLOT_SIZE = KEY_SIZE + VALUE_SIZE;
+
+        // the snapshot header takes one page, the table is page-aligned in the file
+        static const size_t SNAPSHOT_HEAD_SIZE = 4096;
+        static const uint64_t INIT_SLOT_NUM = 1 << 16;
+        // the table grows when the items exceed 3/4 of the slots
+        static const uint64_t MAX_LOAD_NUM = 3;
+        static const uint64_t MAX_LOAD_DEN = 4;
+        // the distance of the prefetched slot in the batch query
+        static const size_t PREFETCH_DIST = 8;
+        // the log is merged into the snapshot when it holds 1/4 of the items
+        static const uint64_t MIN_SNAPSHOT_LOG_NUM = 1 << 20;
+        // the slots copied at a time by the snapshot thread
+        static const uint64_t SNAPSHOT_SLICE_SLOT_NUM = 1 << 16;
+
+        // the open-addressing table, the all-zero key marks the empty slot
+        uint8_t* table_ = NULL;
+        uint64_t slotNum_ = 0; // power of 2
+        uint64_t itemNum_ = 0;
+
+        // the all-zero key is kept aside
+        bool hasZeroKey_ = false;
+        uint8_t zeroValue_[VALUE_SIZE];
+
+        // the memory of the table, a private mapping of the snapshot or an
+        // anonymous mapping
+        uint8_t* mapAddr_ = NULL;
+        size_t mapSize_ = 0;
+
+        // the delta log
+        string logName_;
+        int logFd_ = -1;
+        uint64_t logItemNum_ = 0;
+        string logBuffer_; // the records of the current call
+        // the log before the running snapshot, removed when the snapshot is done
+        string oldLogName_;
+
+        // the snapshot thread copies the table slice by slice while the
+        // inserts go on, the inserts take the lock only against the copy
+        mutex tableLck_;
+        thread snapshotThread_;
+        atomic<bool> snapshotRunning_{false};
+        // a failed snapshot keeps the old log, the next one runs at exit
+        atomic<bool> snapshotFailed_{false};
+
+        /**
+         * @brief hash a key
+         * 
+         * @param key the key
+         * @return uint64_t the hash value
+         */
+        inline uint64_t HashKey(const char* key) {
+            uint64_t word0;
+            uint64_t word1;
+            memcpy(&word0, key, sizeof(uint64_t));
+            memcpy(&word1, key + sizeof(uint64_t), sizeof(uint64_t));
+            // the finalizer of murmurhash3, the keys may not be random
+            uint64_t hashVal = word0 ^ (word1 * 0x9e3779b97f4a7c15ULL);
+            hashVal ^= hashVal >> 33;
+            hashVal *= 0xff51afd7ed558ccdULL;
+            hashVal ^= hashVal >> 33;
+            hashVal *= 0xc4ceb9fe1a85ec53ULL;
+            hashVal ^= hashVal >> 33;
+            return hashVal;
+        }
+
+        /**
+         * @brief check whether a key is all zero
+         * 
+         * @param key the key
+         * @return true it is all zero
+         * @return false it is not all zero
+         */
+        inline bool IsZeroKey(const uint8_t* key) {
+            uint64_t orVal = 0;
+            for (size_t i = 0; i < KEY_SIZE; i += sizeof(uint64_t)) {
+                uint64_t word;
+                memcpy(&word, key + i, sizeof(uint64_t));
+                orVal |= word;
+            }
+            return orVal == 0;
+        }
+
+        /**
+         * @brief find the slot of a key
+         * 
+         * @param key the key (not all zero)
+         * @param hashVal the hash value of the key
+         * @return uint8_t* the slot of the key, or the empty slot to put it
+         */
+        uint8_t* FindSlot(const char* key, uint64_t hashVal);
+
+        /**
+         * @brief put a pair into the table without the log
+         * 
+         * @param key the key
+         * @param value the value
+         */
+        void PutItem(const char* key, const char* value);
+
+        /**
+         * @brief move the items to a new table
+         * 
+         * @param newSlotNum the number of slots of the new table
+         */
+        void Resize(uint64_t newSlotNum);
+
+        /**
+         * @brief allocate an empty table in an anonymous mapping
+         * 
+         * @param slotNum the number of slots
+         */
+        void AllocTable(uint64_t slotNum);
+
+        /**
+         * @brief release the mapping of the table
+         * 
+         */
+        void FreeTable();
+
+        /**
+         * @brief write the records of the current call to the log
+         * 
+         * @return true success
+         * @return false fail
+         */
+        bool FlushLog();
+
+        /**
+         * @brief map the snapshot file
+         * 
+         * @return true success
+         * @return false no valid snapshot
+         */
+        bool LoadSnapshot();
+
+        /**
+         * @brief insert the records of a log into the table
+         * 
+         * @param logFd the log file
+         * @return uint64_t the number of records
+         */
+        uint64_t ReplayLog(int logFd);
+
+        /**
+         * @brief write the table to a new snapshot, the inserts during the
+         * copy are also in the current log
+         * 
+         * @return true success
+         * @return false fail
+         */
+        bool WriteSnapshot();
+
+        /**
+         * @brief rotate the log and write the snapshot in the background,
+         * the caller holds tableLck_
+         * 
+         */
+        void StartSnapshot();
+
+        /**
+         * @brief the snapshot thread, remove the old log after the snapshot
+         * 
+         */
+        void RunSnapshot();
+
+        /**
+         * @brief merge the logs into the snapshot without the concurrent
+         * inserts (at startup and at exit)
+         * 
+         * @return true success
+         * @return false fail, the logs are kept
+         */
+        bool MergeLog();
+
+    public:
+        /**
+         * @brief Construct a new Compact Database object
+         * 
+         */
+        CompactDatabase() {};
+
+        /**
+         * @brief Construct a new Compact Database object
+         * 
+         * @param dbName the path of the snapshot file
+         */
+        CompactDatabase(std::string dbName);
+
+        /**
+         * @brief Destroy the Compact Database object
+         * 
+         */
+        virtual ~CompactDatabase();
+
+        /**
+         * @brief open a database
+         * 
+         * @param dbName the path of the snapshot file
+         * @return true success
+         * @return false fail
+         */
+        bool OpenDB(std::string dbName);
+
+        /**
+         * @brief execute query over database
+         * 
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Query(const std::string& key, std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Insert(const std::string& key, const std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key the key
+         * @param buffer the value
+         * @param bufferSize the value size
+         * @return true success
+         * @return false fail
+         */
+        bool InsertBuffer(const std::string& key, const char* buffer, size_t bufferSize);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key the key
+         * @param keySize the key size
+         * @param buffer the value
+         * @param bufferSize the value size
+         * @return true success
+         * @return false fail
+         */
+        bool InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+            size_t bufferSize);
+
+        /**
+         * @brief query the (key, value) pair
+         * 
+         * @param key the key
+         * @param keySize the key size
+         * @param value the value <return>
+         * @return true success
+         * @return false fail
+         */
+        bool QueryBuffer(const char* key, size_t keySize, std::string& value);
+
+        /**
+         * @brief query a batch of fixed-size keys, the value of a found key
+         * is copied to its value slot
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value slot
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the value slots
+         * @param itemNum the number of keys
+         * @param selectList the keys to query (NULL: all), the others are not found
+         * @param foundList the query result of each key
+         * @return size_t the number of found keys
+         */
+        size_t MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+            bool* foundList);
+
+        /**
+         * @brief insert a batch of fixed-size (key, value) pairs in one write
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the values
+         * @param itemNum the number of pairs
+         * @param selectList the pairs to insert (NULL: all)
+         * @return true success
+         * @return false fail
+         */
+        bool WriteBatchBuffer(const char* keyList, size_t keySize, const char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList);
+
+        /**
+         * @brief check whether the database has no key
+         * 
+         * @return true it is empty
+         * @return false it has keys
+         */
+        bool IsEmpty();
+
+        /**
+         * @brief pass each key of the database to the handler once, the
+         * database must not be modified during the scan
+         * 
+         * @param keyHandler the key handler
+         * @return true success
+         * @return false fail
+         */
+        bool ScanKey(KeyHandler_t keyHandler);
+};
+
+#endif
@@ -27,6 +27,8 @@ private:
     uint64_t minChunkSize_;
     uint64_t slidingWinSize_;
     uint64_t readSize_; //128MB per time 
+    uint64_t chunkingThreadNum_; // the number of FastCDC workers
+    uint64_t fileWorkerNum_; // the number of files chunked concurrently
     
     // deduplication setting 
     string recipeRootPath_;
@@ -34,7 +36,16 @@ private:
     string containerRootPath_;
     string containerSuffix_ = "-container";
     string fp2ChunkDBName_;
+    uint64_t fp2ChunkDBType_; // the backend of the out-enclave index
     uint64_t topKParam_;
+    uint64_t topKEPCBudget_; // the enclave memory of the sketch and the top-k index (0: fixed k)
+    uint64_t sketchWidth_;
+    uint64_t sketchDepth_;
+    uint64_t freqPolicy_; // the bits of FREQ_POLICY (0: the plain count)
+    uint64_t enclaveWorkerNum_; // the worker threads inside the enclave
+    uint64_t outQueryPipeline_; // overlap the out-enclave query of a batch with the next batch
+    uint64_t outIndexFilterSize_; // the capacity of the filter of the out-enclave index (0: no filter)
+    uint64_t outIndexShardNum_; // the fingerprint shards of the out-enclave index, each with its own lock
     
     // restore setting
     uint64_t readCacheSize_;
@@ -45,8 +56,13 @@ private:
 
     // client id
     uint32_t clientID_;
-    uint64_t sendChunkBatchSize_ = 0;
+    uint64_t sendChunkBatchSize_ = 0; // the initial batch size of an upload
+    uint64_t minChunkBatchSize_ = 0; // the bounds of the adaptive batch size
+    uint64_t maxChunkBatchSize_ = 0;
+    uint32_t batchTuneWindow_; // the batches between two server feedbacks (0: fixed batch size)
     uint64_t sendRecipeBatchSize_ = 0;
+    uint32_t transferMode_; // the transfer mode requested by the client
+    uint32_t uploadStreamNum_; // the number of parallel upload streams requested by the client
 
     // for RA
     string spid_;
@@ -104,6 +120,14 @@ public:
     inline uint64_t GetReadSize() {
         return readSize_;
     }
+
+    inline uint64_t GetChunkingThreadNum() {
+        return chunkingThreadNum_;
+    }
+
+    inline uint64_t GetFileWorkerNum() {
+        return fileWorkerNum_;
+    }
     
     inline string GetRecipeRootPath() {
         return recipeRootPath_;
@@ -129,6 +153,10 @@ public:
         return fp2ChunkDBName_;
     }
 
+    inline uint64_t GetFp2ChunkDBType() {
+        return fp2ChunkDBType_;
+    }
+
     inline uint64_t GetReadCacheSize() {
 #if (MULTI_CLIENT == 1)
         return 1;
@@ -153,10 +181,30 @@ public:
         return sendChunkBatchSize_;
     }
 
+    inline uint64_t GetMinChunkBatchSize() {
+        return minChunkBatchSize_;
+    }
+
+    inline uint64_t GetMaxChunkBatchSize() {
+        return maxChunkBatchSize_;
+    }
+
+    inline uint32_t GetBatchTuneWindow() {
+        return batchTuneWindow_;
+    }
+
     inline uint64_t GetSendRecipeBatchSize() {
         return sendRecipeBatchSize_;
     }
 
+    inline uint32_t GetTransferMode() {
+        return transferMode_;
+    }
+
+    inline uint32_t GetUploadStreamNum() {
+        return uploadStreamNum_;
+    }
+
     inline string GetSPID() {
         return spid_;
     }
@@ -184,6 +232,38 @@ public:
     inline uint64_t GetTopKParam() {
         return (topKParam_ * 1024);
     }
+
+    inline uint64_t GetTopKEPCBudget() {
+        return (topKEPCBudget_ * 1024 * 1024);
+    }
+
+    inline uint64_t GetSketchWidth() {
+        return (sketchWidth_ * 1024);
+    }
+
+    inline uint64_t GetSketchDepth() {
+        return sketchDepth_;
+    }
+
+    inline uint64_t GetFreqPolicy() {
+        return freqPolicy_;
+    }
+
+    inline uint64_t GetEnclaveWorkerNum() {
+        return enclaveWorkerNum_;
+    }
+
+    inline uint64_t GetOutQueryPipeline() {
+        return outQueryPipeline_;
+    }
+
+    inline uint64_t GetOutIndexFilterSize() {
+        return outIndexFilterSize_;
+    }
+
+    inline uint64_t GetOutIndexShardNum() {
+        return outIndexShardNum_;
+    }
 };
 
 #endif
\ No newline at end of file
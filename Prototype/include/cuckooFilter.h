@@ -0,0 +1,207 @@
+/**
+ * @file cuckooFilter.h
+ * @brief define the cuckoo filter in front of the out-enclave index, it
+ * answers "definitely unique" for most new chunks without the index query
+ * @version 0.1
+ * 
+ */
+
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include "define.h"
+#include <atomic>
+
+using namespace std;
+
+class CuckooFilter {
+    private:
+        string myName_ = "CuckooFilter";
+
+        // the number of tags in a bucket
+        static const size_t SLOT_PER_BUCKET = 4;
+        // the max number of relocations of an insert
+        static const size_t MAX_KICK_NUM = 500;
+        // the load factor of the table for the capacity
+        static constexpr double MAX_LOAD_FACTOR = 0.95;
+
+        // the tag table, 0 for the empty slot
+        uint16_t* table_ = NULL;
+        uint64_t bucketNum_ = 0; // power of 2
+        uint64_t itemNum_ = 0;
+
+        // the tag that cannot be relocated in the last insert
+        bool hasVictim_ = false;
+        uint64_t victimIdx_ = 0;
+        uint16_t victimTag_ = 0;
+
+        // the filter misses the keys of a failed insert, it answers "maybe" afterwards
+        bool overflow_ = false;
+
+        // the state of the relocation
+        uint64_t kickSeed_ = 88172645463325252ULL;
+
+        // the statistic, the queries under the shared filter lock update it
+        atomic<uint64_t> hitNum_;
+        atomic<uint64_t> missNum_;
+        atomic<uint64_t> falsePositiveNum_;
+
+        /**
+         * @brief get the bucket index and the tag of a key, the key is the
+         * encrypted fingerprint, whose bytes are uniformly distributed
+         * 
+         * @param key the key (at least 10 bytes)
+         * @param idx the bucket index <return>
+         * @param tag the tag <return>
+         */
+        inline void GetIndexTag(const char* key, uint64_t* idx, uint16_t* tag) {
+            uint64_t hashVal;
+            memcpy(&hashVal, key, sizeof(uint64_t));
+            memcpy(tag, key + sizeof(uint64_t), sizeof(uint16_t));
+            if (*tag == 0) {
+                *tag = 1;
+            }
+            *idx = hashVal & (bucketNum_ - 1);
+            return ;
+        }
+
+        /**
+         * @brief get the other bucket of a tag
+         * 
+         * @param idx the bucket index
+         * @param tag the tag
+         * @return uint64_t the other bucket index
+         */
+        inline uint64_t GetAltIndex(uint64_t idx, uint16_t tag) {
+            // the tag is mixed to spread the nearby buckets
+            return (idx ^ (tag * 0x5bd1e995ULL)) & (bucketNum_ - 1);
+        }
+
+        /**
+         * @brief put a tag into an empty slot of the bucket
+         * 
+         * @param idx the bucket index
+         * @param tag the tag
+         * @return true success
+         * @return false the bucket is full
+         */
+        bool InsertTagToBucket(uint64_t idx, uint16_t tag);
+
+        /**
+         * @brief check whether the bucket has the tag
+         * 
+         * @param idx the bucket index
+         * @param tag the tag
+         * @return true it has the tag
+         * @return false it does not have the tag
+         */
+        bool FindTagInBucket(uint64_t idx, uint16_t tag);
+
+        /**
+         * @brief remove one copy of a tag from the bucket
+         * 
+         * @param idx the bucket index
+         * @param tag the tag
+         * @return true success
+         * @return false the bucket does not have the tag
+         */
+        bool DeleteTagFromBucket(uint64_t idx, uint16_t tag);
+
+        /**
+         * @brief put a tag into one of its buckets, relocate the tags if both are full
+         * 
+         * @param idx the bucket index
+         * @param tag the tag
+         */
+        void InsertTag(uint64_t idx, uint16_t tag);
+
+    public:
+        /**
+         * @brief Construct a new Cuckoo Filter object
+         * 
+         * @param capacity the max number of keys
+         */
+        CuckooFilter(uint64_t capacity);
+
+        /**
+         * @brief Destroy the Cuckoo Filter object
+         * 
+         */
+        ~CuckooFilter();
+
+        /**
+         * @brief insert a key
+         * 
+         * @param key the key (at least 10 bytes)
+         * @return true success
+         * @return false the filter is full, it answers "maybe" afterwards
+         */
+        bool Insert(const char* key);
+
+        /**
+         * @brief check whether a key may be in the index
+         * 
+         * @param key the key (at least 10 bytes)
+         * @return true it may be in the index
+         * @return false it is definitely not in the index
+         */
+        bool Contain(const char* key);
+
+        /**
+         * @brief delete a key inserted before, for the garbage collection
+         * 
+         * @param key the key (at least 10 bytes)
+         * @return true success
+         * @return false the filter does not have the key
+         */
+        bool Delete(const char* key);
+
+        /**
+         * @brief count the keys that pass the filter but miss the index
+         * 
+         * @param num the number of keys
+         */
+        inline void AddFalsePositive(uint64_t num) {
+            falsePositiveNum_.fetch_add(num, memory_order_relaxed);
+            return ;
+        }
+
+        /**
+         * @brief persist the filter to a file
+         * 
+         * @param filePath the file path
+         * @return true success
+         * @return false fail, the file is not written
+         */
+        bool Persist(string filePath);
+
+        /**
+         * @brief load the filter from a file
+         * 
+         * @param filePath the file path
+         * @return true success
+         * @return false fail, the filter is unchanged
+         */
+        bool Load(string filePath);
+
+        /**
+         * @brief check whether the filter misses some keys
+         * 
+         * @return true it answers "maybe" for all keys
+         * @return false it is in sync with the index
+         */
+        inline bool IsOverflow() {
+            return overflow_;
+        }
+
+        /**
+         * @brief Get the number of keys in the filter
+         * 
+         * @return uint64_t the number of keys
+         */
+        inline uint64_t GetItemNum() {
+            return itemNum_;
+        }
+};
+
+#endif
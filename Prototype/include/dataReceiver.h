@@ -14,6 +14,7 @@
 
 #include "configure.h"
 #include "clientVar.h"
+#include "uploadSession.h"
 #include "sslConnection.h"
 #include "absIndex.h"
 #include "../build/src/Enclave/storeEnclave_u.h"
@@ -28,6 +29,10 @@ class DataReceiver {
 
         uint64_t batchNum_ = 0;
         uint64_t recipeEndNum_ = 0;
+        uint64_t newFileNum_ = 0;
+        uint64_t compressedBatchNum_ = 0;
+        uint64_t streamSyncNum_ = 0;
+        uint64_t feedbackNum_ = 0;
 
         // to pass the data to the index thread
         AbsIndex* absIndexObj_;
@@ -35,6 +40,15 @@ class DataReceiver {
         // pass the storage core obj
         StorageCore* storageCoreObj_;
 
+        /**
+         * @brief send the enclave time of a batch window to the client, which
+         * tunes the batch size by the feedback
+         * 
+         * @param clientSSL the client connection
+         * @param feedback the feedback of the window
+         */
+        void SendBatchFeedback(SSL* clientSSL, BatchFeedback_t& feedback);
+
     public:
         /**
          * @brief Construct a new DataReceiver object
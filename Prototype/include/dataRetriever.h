@@ -18,6 +18,7 @@
 #include "sslConnection.h"
 #include "cryptoPrimitive.h"
 #include "restoreWriter.h"
+#include <lz4.h>
 
 class DataRetriever {
     private:
@@ -40,6 +41,7 @@ class DataRetriever {
         SendMsgBuffer_t recvChunkBuf_;
         MessageQueue<Chunk_t>* outputMQ_;
         FileRecipeHead_t fileRecipeHead_;
+        uint32_t transferMode_ = PLAIN_TRANSFER;
 
         double totalTime_ = 0;
 
@@ -53,6 +55,7 @@ class DataRetriever {
         // for statistics: the received chunk number  
         uint64_t _totalRecvChunkNum = 0;
         uint64_t _totalRecvDataSize = 0;
+        uint64_t _totalTransferDataSize = 0; // the chunk size on the wire
 
         /**
          * @brief Construct a new Data Retriever object
@@ -16,9 +16,19 @@
 #include "sslConnection.h"
 #include "messageQueue.h"
 #include "cryptoPrimitive.h"
+#include "readBufferPool.h"
+#include "chunkerPool.h"
+#include <lz4.h>
+#include <atomic>
 
 extern Configure config;
 
+typedef struct {
+    SendMsgBuffer_t plainBuf; // the batch filled by the chunks
+    SendMsgBuffer_t encBuf; // the batch encrypted with the session key
+    bool lastBatch; // whether this is the last batch of the session
+} SendBatch_t;
+
 class DataSender {
     private:
         string myName_ = "DataSender";
@@ -29,6 +39,25 @@ class DataSender {
         uint64_t sendChunkBatchSize_ = 0;
         uint32_t clientID_;
 
+        // the adaptive batch size, the filling stage reads it and the sending
+        // stage tunes it by the enclave time reported by the server
+        std::atomic<uint64_t> curChunkBatchSize_;
+        uint64_t minChunkBatchSize_ = 0;
+        uint64_t maxChunkBatchSize_ = 0;
+        uint32_t batchTuneWindow_ = 0;
+        uint64_t primaryBatchNum_ = 0; // the chunk batches sent by the primary connection
+        uint64_t windowChunkNum_ = 0;
+        struct timeval windowStartTime_;
+        list<pair<double, uint64_t>> tuneWindowList_; // <client time, chunk num>
+        uint8_t feedbackBuffer_[sizeof(NetworkHead_t) + sizeof(BatchFeedback_t)];
+        int tuneDirection_ = 1;
+        double lastChunkCost_ = 0;
+        uint32_t holdWindowNum_ = 0;
+        uint32_t skipWindowNum_ = 0;
+        uint64_t feedbackNum_ = 0;
+        uint64_t growNum_ = 0;
+        uint64_t shrinkNum_ = 0;
+
         // for security channel encryption
         CryptoPrimitive* cryptoObj_;
         uint8_t sessionKey_[CHUNK_HASH_SIZE];
@@ -36,14 +65,49 @@ class DataSender {
         EVP_MD_CTX* mdCtx_;
 
         uint64_t batchNum_ = 0;
+        uint64_t fileNum_ = 0;
+
+        // for the compressed transfer mode (the encryption stage)
+        uint32_t transferMode_ = PLAIN_TRANSFER;
+        uint8_t* compressBuffer_;
+        uint64_t compressedBatchNum_ = 0;
+        uint64_t rawBatchSize_ = 0;
+        uint64_t transferBatchSize_ = 0;
         
-        // the sender buffer 
-        SendMsgBuffer_t sendChunkBuf_;
-        SendMsgBuffer_t sendEncBuffer_;
+        // the batch pipeline: filling -> encryption -> sending
+        uint32_t batchBufferNum_;
+        SendBatch_t* batchList_;
+        SendBatch_t* curBatch_; // the batch being filled
+        MessageQueue<SendBatch_t*>* freeBatchMQ_;
+        MessageQueue<SendBatch_t*>* encBatchMQ_;
+        MessageQueue<SendBatch_t*>* sendBatchMQ_;
         MessageQueue<Data_t>* inputMQ_;
 
+        // the parallel upload streams, the chunk batch i is sent by the stream
+        // i % streamNum_, the stream 0 is the primary connection
+        uint32_t streamNum_ = 1;
+        uint64_t chunkBatchSeq_ = 0;
+        vector<pair<int, SSL*>> streamRecordList_;
+        vector<MessageQueue<SendBatch_t*>*> streamMQList_;
+        vector<uint64_t> streamBatchNumList_;
+        boost::mutex freeBatchLck_; // the streams return the sent batches concurrently
+
+        // the chunkers of the files uploaded in this session
+        ChunkerPool* chunkerPoolObj_;
+
         double totalTime_ = 0;
 
+        // the stage occupancy: the busy time and the time waiting for the input
+        // (stall) of each stage
+        double inputStallTime_ = 0;
+        double fillStallTime_ = 0;
+        double encTime_ = 0;
+        double encStallTime_ = 0;
+        double sendTime_ = 0;
+        double sendStallTime_ = 0;
+        uint64_t inputFullStallNum_ = 0;
+        uint64_t inputEmptyStallNum_ = 0;
+
         /**
          * @brief insert a chunk to the sending buffer
          * 
@@ -70,22 +134,87 @@ class DataSender {
          * @brief process the recipe end
          * 
          * @param recipeHead the pointer to the recipe end
+         * @param lastFile whether this is the last file of the session
          */
-        void ProcessRecipeEnd(FileRecipeHead_t& recipeHead);
+        void ProcessRecipeEnd(FileRecipeHead_t& recipeHead, bool lastFile);
+
+        /**
+         * @brief notify the server of the next file in this session
+         * 
+         * @param filePath the path of the next file
+         */
+        void ProcessNewFile(string& filePath);
 
         /**
          * @brief process a chunk
          * 
-         * @param inputChunk the input chunk
+         * @param inputChunk the input chunk descriptor
+         */
+        void ProcessChunk(ChunkDesc_t& inputChunk);
+
+        /**
+         * @brief submit the current batch to the encryption stage, and take a
+         * free batch for filling
+         * 
+         */
+        void SubmitBatch();
+
+        /**
+         * @brief the encryption stage of the batch pipeline
+         * 
+         */
+        void EncryptBatches();
+
+        /**
+         * @brief the sending stage of the batch pipeline
+         * 
+         */
+        void SendBatches();
+
+        /**
+         * @brief the sending stage of a secondary upload stream
+         * 
+         * @param streamID the stream ID
+         */
+        void SendStreamBatches(uint32_t streamID);
+
+        /**
+         * @brief return a sent batch to the filling stage
+         * 
+         * @param batch the sent batch
+         */
+        void ReleaseBatch(SendBatch_t* batch);
+
+        /**
+         * @brief open the secondary upload streams of the session
+         * 
+         * @param masterKey the client master key
+         */
+        void OpenStreams(uint8_t* masterKey);
+
+        /**
+         * @brief close the current batch window, and tune the batch size by
+         * the feedback of the previous window
+         * 
+         */
+        void CloseTuneWindow();
+
+        /**
+         * @brief receive the feedback of a batch window from the server
+         * 
+         * @param feedback the feedback of the window
          */
-        void ProcessChunk(Chunk_t& inputChunk);
+        void RecvBatchFeedback(BatchFeedback_t& feedback);
 
         /**
-         * @brief send a batch of chunks
+         * @brief tune the batch size to reduce the time per chunk
          * 
-         * @param chunkBuffer the chunk buffer
+         * @param feedback the feedback of the window
+         * @param clientTime the sending time of the window in the client
+         * @param chunkNum the chunks sent in the window
          */
-        void SendChunks();
+        void TuneBatchSize(BatchFeedback_t& feedback, double clientTime,
+            uint64_t chunkNum);
     public:
         /**
          * @brief Construct a new DataSender object
@@ -134,12 +263,12 @@ class DataSender {
         }
 
         /**
-         * @brief Set the InputMQ object
+         * @brief Set the ChunkerPool object
          * 
-         * @param inputMQ the input MQ
+         * @param chunkerPoolObj the chunkers of the uploaded files
          */
-        void SetInputMQ(MessageQueue<Data_t>* inputMQ) {
-            inputMQ_ = inputMQ;
+        void SetChunkerPool(ChunkerPool* chunkerPoolObj) {
+            chunkerPoolObj_ = chunkerPoolObj;
             return ;
         }
 };
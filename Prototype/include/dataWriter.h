@@ -33,6 +33,10 @@ class DataWriter {
         // the num of the written containers 
         uint64_t containerNum_ = 0;
 
+        // the stalls of the container queue
+        uint64_t fullStallNum_ = 0;
+        uint64_t emptyStallNum_ = 0;
+
 #if (DATAWRITER_BREAKDOWN == 1)
         // the time of writing container
         double writeTime_ = 0;
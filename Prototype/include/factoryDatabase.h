@@ -15,10 +15,14 @@
 #include "absDatabase.h"
 #include "leveldbDatabase.h"
 #include "inMemoryDatabase.h"
+#include "compactDatabase.h"
+#include "ssdLogDatabase.h"
 
 #define LEVEL_DB 1
 #define ROCKS_DB 2
 #define IN_MEMORY 3
+#define COMPACT_MEMORY 4
+#define SSD_LOG 5
 
 
 
@@ -14,6 +14,7 @@
 #include "absDatabase.h"
 #include <leveldb/db.h>
 #include <leveldb/cache.h>
+#include <leveldb/write_batch.h>
 #include "configure.h"
 #include <bits/stdc++.h>
 
@@ -104,6 +105,58 @@ class LeveldbDatabase : public AbsDatabase {
          * @return false 
          */
         bool QueryBuffer(const char* key, size_t keySize, std::string& value);
+
+        /**
+         * @brief query a batch of fixed-size keys, the value of a found key
+         * is copied to its value slot
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value slot
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the value slots
+         * @param itemNum the number of keys
+         * @param selectList the keys to query (NULL: all), the others are not found
+         * @param foundList the query result of each key
+         * @return size_t the number of found keys
+         */
+        size_t MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+            bool* foundList);
+
+        /**
+         * @brief insert a batch of fixed-size (key, value) pairs in one write
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the values
+         * @param itemNum the number of pairs
+         * @param selectList the pairs to insert (NULL: all)
+         * @return true success
+         * @return false fail
+         */
+        bool WriteBatchBuffer(const char* keyList, size_t keySize, const char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList);
+
+        /**
+         * @brief check whether the database has no key
+         * 
+         * @return true it is empty
+         * @return false it has keys
+         */
+        bool IsEmpty();
+
+        /**
+         * @brief pass each key of the database to the handler once, the
+         * database must not be modified during the scan
+         * 
+         * @param keyHandler the key handler
+         * @return true success
+         * @return false fail
+         */
+        bool ScanKey(KeyHandler_t keyHandler);
 };
 
 
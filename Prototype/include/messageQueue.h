@@ -19,6 +19,7 @@
 #include <boost/lockfree/queue.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 
 template <class T>
@@ -30,6 +31,59 @@ class MessageQueue {
         // moodycamel::ConcurrentQueue<T>* lockFreeQueue_;
         moodycamel::ReaderWriterQueue<T>* lockFreeQueue_;
 
+        // the blocked side spins for MQ_SPIN_ROUND tries, and then parks until
+        // it is notified by the other side (or MQ_PARK_TIMEOUT)
+        boost::mutex parkLck_;
+        boost::condition_variable notEmptyCond_;
+        boost::condition_variable notFullCond_;
+        boost::atomic<uint32_t> parkedPopNum_;
+        boost::atomic<uint32_t> parkedPushNum_;
+
+        // the number of push on a full queue and blocking pop on an empty queue
+        uint64_t fullStallNum_ = 0;
+        uint64_t emptyStallNum_ = 0;
+        // the producer and the consumer park under parkLck_, GetParkNum reads
+        // it without the lock
+        boost::atomic<uint64_t> parkNum_;
+
+        /**
+         * @brief wake up the parked thread after an item is pushed or popped
+         * 
+         * @param parkedNum the number of parked threads
+         * @param cond the condition variable they wait for
+         */
+        void Wake(boost::atomic<uint32_t>& parkedNum, boost::condition_variable& cond) {
+            // pairs with the fence in Park, either the parked thread sees the
+            // update, or the waker sees the parked thread
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (parkedNum.load(boost::memory_order_relaxed) != 0) {
+                boost::unique_lock<boost::mutex> lck(parkLck_);
+                cond.notify_all();
+            }
+            return ;
+        }
+
+        /**
+         * @brief park the thread until the queue state may change
+         * 
+         * @param parkedNum the number of parked threads
+         * @param cond the condition variable to wait for
+         * @param ready check whether the thread can continue
+         */
+        template <class Ready>
+        void Park(boost::atomic<uint32_t>& parkedNum, boost::condition_variable& cond,
+            Ready ready) {
+            boost::unique_lock<boost::mutex> lck(parkLck_);
+            parkedNum.fetch_add(1, boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (!ready()) {
+                parkNum_.fetch_add(1, boost::memory_order_relaxed);
+                cond.timed_wait(lck, boost::posix_time::microseconds(MQ_PARK_TIMEOUT));
+            }
+            parkedNum.fetch_sub(1, boost::memory_order_relaxed);
+            return ;
+        }
+
     public:
         // to show whether the whole process is done
         boost::atomic<bool> done_;
@@ -43,6 +97,9 @@ class MessageQueue {
             // lockFreeQueue_ = new moodycamel::ConcurrentQueue<T>(QUEUE_SIZE);
             lockFreeQueue_ = new moodycamel::ReaderWriterQueue<T>(maxQueueSize);
             done_ = false;
+            parkedPopNum_ = 0;
+            parkedPushNum_ = 0;
+            parkNum_ = 0;
         }
 
         /**
@@ -61,7 +118,7 @@ class MessageQueue {
         }
 
         /**
-         * @brief push data to the queue
+         * @brief push data to the queue, block while the queue is full
          * 
          * @param data the original data
          * @return true success
@@ -69,9 +126,21 @@ class MessageQueue {
          */
         bool Push(T& data) {
             // while (!lockFreeQueue_.push(data)) {
-            while (!lockFreeQueue_->try_enqueue(data)) {
-                ;
+            if (!lockFreeQueue_->try_enqueue(data)) {
+                fullStallNum_++;
+                uint32_t spinRound = 0;
+                while (!lockFreeQueue_->try_enqueue(data)) {
+                    if (spinRound < MQ_SPIN_ROUND) {
+                        spinRound++;
+                        continue;
+                    }
+                    this->Park(parkedPushNum_, notFullCond_, [this]() {
+                        return lockFreeQueue_->size_approx() <
+                            lockFreeQueue_->max_capacity();
+                    });
+                }
             }
+            this->Wake(parkedPopNum_, notEmptyCond_);
             return true;
         }
 
@@ -84,7 +153,103 @@ class MessageQueue {
          */
         bool Pop(T& data) {
             // return lockFreeQueue_.pop(data);
-            return lockFreeQueue_->try_dequeue(data);
+            if (lockFreeQueue_->try_dequeue(data)) {
+                this->Wake(parkedPushNum_, notFullCond_);
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief pop data from the queue, wait until the data arrives or the
+         * timeout
+         * 
+         * @param data the original data
+         * @param timeout the timeout (us)
+         * @return true success
+         * @return false the queue is still empty after the timeout, or the
+         * whole process is done
+         */
+        bool Pop(T& data, uint64_t timeout) {
+            if (this->Pop(data)) {
+                return true;
+            }
+            emptyStallNum_++;
+            struct timeval sWaitTime;
+            struct timeval eWaitTime;
+            gettimeofday(&sWaitTime, NULL);
+            uint32_t spinRound = 0;
+            while (true) {
+                // check done_ before the queue, the data pushed before done_ is
+                // visible to the last pop
+                bool done = done_.load(boost::memory_order_acquire);
+                if (this->Pop(data)) {
+                    return true;
+                }
+                if (done) {
+                    return false;
+                }
+                if (spinRound < MQ_SPIN_ROUND) {
+                    spinRound++;
+                    continue;
+                }
+                gettimeofday(&eWaitTime, NULL);
+                if (tool::GetTimeDiff(sWaitTime, eWaitTime) * 1000000 >= timeout) {
+                    return false;
+                }
+                this->Park(parkedPopNum_, notEmptyCond_, [this]() {
+                    return lockFreeQueue_->size_approx() != 0 ||
+                        done_.load(boost::memory_order_acquire);
+                });
+            }
+        }
+
+        /**
+         * @brief pop data from the queue, wait until the data arrives
+         * 
+         * @param data the original data
+         * @return true success
+         * @return false the queue is empty and the whole process is done
+         */
+        bool BlockingPop(T& data) {
+            return this->Pop(data, UINT64_MAX);
+        }
+
+        /**
+         * @brief set the whole process is done, and wake up the parked consumer
+         * 
+         */
+        void SetDone() {
+            done_.store(true, boost::memory_order_release);
+            this->Wake(parkedPopNum_, notEmptyCond_);
+            return ;
+        }
+
+        /**
+         * @brief Get the number of push on a full queue
+         * 
+         * @return uint64_t the full stall number
+         */
+        uint64_t GetFullStallNum() {
+            return fullStallNum_;
+        }
+
+        /**
+         * @brief Get the number of blocking pop on an empty queue
+         * 
+         * @return uint64_t the empty stall number
+         */
+        uint64_t GetEmptyStallNum() {
+            return emptyStallNum_;
+        }
+
+        /**
+         * @brief Get the number of times the threads are parked
+         * 
+         * @return uint64_t the park number
+         */
+        uint64_t GetParkNum() {
+            return parkNum_.load(boost::memory_order_relaxed);
         }
 
         /**
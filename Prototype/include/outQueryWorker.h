@@ -0,0 +1,66 @@
+/**
+ * @file outQueryWorker.h
+ * @brief define the helper thread of a client that runs the out-enclave
+ * index query of a batch while the enclave processes the next batch
+ * @version 0.1
+ * 
+ */
+
+#ifndef OUT_QUERY_WORKER_H
+#define OUT_QUERY_WORKER_H
+
+#include "define.h"
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/function.hpp>
+
+using namespace std;
+
+class OutQueryWorker {
+    private:
+        string myName_ = "OutQueryWorker";
+
+        boost::thread* workerTh_;
+        boost::mutex workerLck_;
+        boost::condition_variable workerCond_;
+
+        // the submitted task, at most one task is in flight
+        boost::function<void()> task_;
+        bool busyFlag_ = false;
+        bool exitFlag_ = false;
+
+        /**
+         * @brief the main loop of the helper thread
+         * 
+         */
+        void Run();
+
+    public:
+        /**
+         * @brief Construct a new OutQueryWorker object
+         * 
+         */
+        OutQueryWorker();
+
+        /**
+         * @brief Destroy the OutQueryWorker object, wait for the task in flight
+         * 
+         */
+        ~OutQueryWorker();
+
+        /**
+         * @brief submit a task, wait for the previous one if it is in flight
+         * 
+         * @param task the task
+         */
+        void Submit(boost::function<void()> task);
+
+        /**
+         * @brief wait until the submitted task finishes
+         * 
+         */
+        void Wait();
+};
+
+#endif
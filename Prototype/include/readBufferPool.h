@@ -0,0 +1,99 @@
+/**
+ * @file readBufferPool.h
+ * @brief define the interface of the pool of client read buffers
+ * @version 0.1
+ * 
+ */
+
+#ifndef BASICDEDUP_READ_BUFFER_POOL_H
+#define BASICDEDUP_READ_BUFFER_POOL_H
+
+#include "define.h"
+#include "chunkStructure.h"
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+using namespace std;
+
+typedef struct ReadBuffer {
+    uint8_t* buffer; // the headroom for the carried tail and the read data
+    uint64_t dataSize; // the size of the read data after the headroom
+    bool end; // whether this is the last read of the input
+    boost::atomic<uint64_t> refCnt; // the holder and the chunks not yet copied out
+    // the pool parks on the buffer until the last reference is released
+    boost::mutex parkLck;
+    boost::condition_variable freeCond;
+    boost::atomic<uint32_t> parkedNum;
+} ReadBuffer_t;
+
+class ReadBufferPool {
+    private:
+        string myName_ = "ReadBufferPool";
+
+        // the buffers are reused in round-robin order
+        ReadBuffer_t* bufferList_;
+        uint32_t bufferNum_;
+        uint64_t headroomSize_;
+        uint64_t dataSize_;
+        uint32_t nextIndex_ = 0;
+
+        // for statistics
+        uint64_t acquireNum_ = 0;
+        uint64_t parkNum_ = 0;
+        double acquireWaitTime_ = 0;
+
+    public:
+        /**
+         * @brief Construct a new ReadBufferPool object
+         * 
+         * @param bufferNum the number of buffers
+         * @param headroomSize the size of the headroom before the data of each buffer
+         * @param dataSize the data size of each buffer
+         */
+        ReadBufferPool(uint32_t bufferNum, uint64_t headroomSize, uint64_t dataSize);
+
+        /**
+         * @brief Destroy the ReadBufferPool object
+         * 
+         */
+        ~ReadBufferPool();
+
+        /**
+         * @brief acquire the next buffer, wait until all its chunks are copied out
+         * 
+         * @return ReadBuffer_t* the buffer held by the caller (refCnt = 1)
+         */
+        ReadBuffer_t* Acquire();
+
+        /**
+         * @brief add a reference of a chunk in the buffer
+         * 
+         * @param readBuffer the buffer
+         */
+        static void Ref(ReadBuffer_t* readBuffer) {
+            readBuffer->refCnt.fetch_add(1, boost::memory_order_relaxed);
+            return ;
+        }
+
+        /**
+         * @brief release a reference to the buffer
+         * 
+         * @param readBuffer the buffer
+         */
+        static void Release(ReadBuffer_t* readBuffer) {
+            if (readBuffer->refCnt.fetch_sub(1, boost::memory_order_release) != 1) {
+                return ;
+            }
+            // pairs with the fence in Acquire, either the pool sees the free
+            // buffer, or the last holder sees the parked pool
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (readBuffer->parkedNum.load(boost::memory_order_relaxed) != 0) {
+                boost::unique_lock<boost::mutex> lck(readBuffer->parkLck);
+                readBuffer->freeCond.notify_all();
+            }
+            return ;
+        }
+};
+
+#endif // BASICDEDUP_READ_BUFFER_POOL_H
@@ -15,6 +15,7 @@
 // for upload 
 #include "dataWriter.h"
 #include "dataReceiver.h"
+#include "uploadSession.h"
 #include "absIndex.h"
 #include "enclaveIndex.h"
 
@@ -63,6 +64,10 @@ class ServerOptThread {
         // store the client information 
         unordered_map<int, boost::mutex*> clientLockIndex_;
 
+        // the upload sessions with parallel streams, the secondary streams join
+        // the session of the primary stream by the client ID
+        unordered_map<uint32_t, UploadSession*> uploadSessionIndex_;
+
         // for log file
         ofstream logFile_;
 
@@ -78,6 +83,14 @@ class ServerOptThread {
          */
         bool CheckFileStatus(string& fullRecipePath, int optType);
 
+        /**
+         * @brief the process of a secondary stream of an upload session
+         * 
+         * @param clientSSL the client ssl
+         * @param recvBuf the buffer of the stream login
+         */
+        void RunStream(SSL* clientSSL, SendMsgBuffer_t& recvBuf);
+
     public:
         /**
          * @brief Construct a new Server Opt Thread object
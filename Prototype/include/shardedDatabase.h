@@ -0,0 +1,216 @@
+/**
+ * @file shardedDatabase.h
+ * @brief define the concurrent out-enclave index, the keys are sharded by the
+ * fingerprint over the backends and each shard has its own rw lock, so that
+ * the queries and the inserts of different clients run concurrently
+ * @version 0.1
+ * 
+ */
+
+#ifndef SHARDED_DATABASE_H
+#define SHARDED_DATABASE_H
+
+#include "absDatabase.h"
+#include "configure.h"
+
+class ShardedDatabase : public AbsDatabase {
+    private:
+        // the backend type of the shards
+        int dbType_ = 0;
+        uint32_t shardNum_ = 1;
+        vector<AbsDatabase*> shardList_;
+
+        // the queries share the lock of a shard, the inserts hold it
+        pthread_rwlock_t* shardLckList_ = NULL;
+        // the backend is thread-safe by itself, no shard and no lock
+        bool isThreadSafe_ = false;
+
+        /**
+         * @brief get the shard of a key
+         * 
+         * @param key the key
+         * @param keySize the key size
+         * @return uint32_t the shard ID
+         */
+        inline uint32_t GetShardId(const char* key, size_t keySize) {
+            // the last bytes of the fingerprint, the backends and the filter
+            // hash the first bytes
+            uint64_t hashVal = 0xcbf29ce484222325ULL;
+            for (size_t i = (keySize > sizeof(uint64_t)) ? keySize - sizeof(uint64_t) : 0;
+                i < keySize; i++) {
+                hashVal ^= (uint8_t)key[i];
+                hashVal *= 0x100000001b3ULL;
+            }
+            return hashVal % shardNum_;
+        }
+
+        /**
+         * @brief lock a shard
+         * 
+         * @param shardId the shard ID
+         * @param isWrite true: for the insert, false: for the query
+         */
+        inline void LockShard(uint32_t shardId, bool isWrite) {
+            if (isThreadSafe_) {
+                return ;
+            }
+            if (isWrite) {
+                pthread_rwlock_wrlock(&shardLckList_[shardId]);
+            } else {
+                pthread_rwlock_rdlock(&shardLckList_[shardId]);
+            }
+            return ;
+        }
+
+        /**
+         * @brief unlock a shard
+         * 
+         * @param shardId the shard ID
+         */
+        inline void UnlockShard(uint32_t shardId) {
+            if (!isThreadSafe_) {
+                pthread_rwlock_unlock(&shardLckList_[shardId]);
+            }
+            return ;
+        }
+
+        /**
+         * @brief check the shard num of an existing index
+         * 
+         */
+        void CheckShardNum();
+
+    public:
+        /**
+         * @brief Construct a new Sharded Database object
+         * 
+         * @param dbType the backend type of the shards
+         * @param dbName the db path
+         * @param shardNum the number of shards
+         */
+        ShardedDatabase(int dbType, std::string dbName, uint32_t shardNum);
+
+        /**
+         * @brief Destroy the Sharded Database object
+         * 
+         */
+        virtual ~ShardedDatabase();
+
+        /**
+         * @brief open a database
+         * 
+         * @param dbName the db path, the shards are in dbName-shard<ID>
+         * @return true success
+         * @return false fail
+         */
+        bool OpenDB(std::string dbName);
+
+        /**
+         * @brief execute query over database
+         * 
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Query(const std::string& key, std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Insert(const std::string& key, const std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key the key
+         * @param buffer the value
+         * @param bufferSize the value size
+         * @return true success
+         * @return false fail
+         */
+        bool InsertBuffer(const std::string& key, const char* buffer, size_t bufferSize);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key the key
+         * @param keySize the key size
+         * @param buffer the value
+         * @param bufferSize the value size
+         * @return true success
+         * @return false fail
+         */
+        bool InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+            size_t bufferSize);
+
+        /**
+         * @brief query the (key, value) pair
+         * 
+         * @param key the key
+         * @param keySize the key size
+         * @param value the value <return>
+         * @return true success
+         * @return false fail
+         */
+        bool QueryBuffer(const char* key, size_t keySize, std::string& value);
+
+        /**
+         * @brief query a batch of fixed-size keys, the value of a found key
+         * is copied to its value slot
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value slot
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the value slots
+         * @param itemNum the number of keys
+         * @param selectList the keys to query (NULL: all), the others are not found
+         * @param foundList the query result of each key
+         * @return size_t the number of found keys
+         */
+        size_t MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+            bool* foundList);
+
+        /**
+         * @brief insert a batch of fixed-size (key, value) pairs in one write
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the values
+         * @param itemNum the number of pairs
+         * @param selectList the pairs to insert (NULL: all)
+         * @return true success
+         * @return false fail
+         */
+        bool WriteBatchBuffer(const char* keyList, size_t keySize, const char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList);
+
+        /**
+         * @brief check whether the database has no key
+         * 
+         * @return true it is empty
+         * @return false it has keys
+         */
+        bool IsEmpty();
+
+        /**
+         * @brief pass each key of the database to the handler once, the
+         * database must not be modified during the scan
+         * 
+         * @param keyHandler the key handler
+         * @return true success
+         * @return false fail
+         */
+        bool ScanKey(KeyHandler_t keyHandler);
+};
+
+#endif
@@ -0,0 +1,362 @@
+/**
+ * @file ssdLogDatabase.h
+ * @brief define an SSD-resident index of the fixed-size (fingerprint, address)
+ * pairs for the index larger than the memory, a bucket directory in memory
+ * points each fingerprint prefix to one 4 KiB page on SSD, so that a query
+ * reads at most one page
+ * @version 0.1
+ * 
+ */
+
+#ifndef SSD_LOG_DATABASE_H
+#define SSD_LOG_DATABASE_H
+
+#include "absDatabase.h"
+#include "configure.h"
+#include "chunkStructure.h"
+#include <atomic>
+
+// the bucket of the directory
+typedef struct {
+    uint32_t pageId; // the page of the bucket on SSD
+    uint32_t prefix; // the low localDepth bits of the hash of its keys
+    uint16_t localDepth;
+    uint16_t itemNum;
+} SsdBucket_t;
+
+class SsdLogDatabase : public AbsDatabase {
+    protected:
+        // the fixed pair size
+        static const size_t KEY_SIZE = CHUNK_HASH_SIZE;
+        static const size_t VALUE_SIZE = sizeof(RecipeEntry_t);
+        static const size_t ENTRY_SIZE = KEY_SIZE + VALUE_SIZE;
+
+        // a page holds the pairs of one bucket after a small header
+        static const size_t PAGE_SIZE = 4096;
+        static const size_t PAGE_HEAD_SIZE = 8;
+        static const size_t PAGE_ITEM_NUM = (PAGE_SIZE - PAGE_HEAD_SIZE) / ENTRY_SIZE;
+        static const uint32_t INVALID_PAGE = UINT32_MAX;
+        static const uint32_t MAX_GLOBAL_DEPTH = 32;
+
+        // the inserts are kept in memory and written to the pages in a batch
+        static const size_t WRITE_BUFFER_ITEM_NUM = 1 << 18;
+        // the journal is merged into the snapshot when it holds 1M records
+        static const uint64_t MAX_JOURNAL_RECORD_NUM = 1 << 20;
+
+        // the bucket directory, indexed by the low globalDepth_ bits of the hash
+        vector<uint32_t> directory_;
+        vector<SsdBucket_t> bucketList_;
+        uint32_t globalDepth_ = 0;
+        uint64_t itemNum_ = 0;
+
+        // the page file
+        int pageFd_ = -1;
+        uint64_t pageNum_ = 0;
+        // the free pages in the ascending order, reused by the next flush
+        vector<uint32_t> freePageList_;
+        uint8_t* readPage_ = NULL; // for the flush, a query reads to its own page
+
+        // the write buffer, and its log for a crash
+        string bufferEntryList_;
+        unordered_map<string, uint32_t> bufferIndex_;
+        string walName_;
+        int walFd_ = -1;
+        string walBuffer_; // the records of the current call
+
+        // the pages and the bucket updates of the current flush
+        string flushPageList_;
+        vector<uint32_t> flushBucketList_;
+
+        // the bucket journal after the snapshot
+        string snapshotName_;
+        string journalName_;
+        int journalFd_ = -1;
+        uint64_t journalRecordNum_ = 0;
+
+        // the statistic, the queries may run concurrently
+        atomic<uint64_t> queryNum_;
+        atomic<uint64_t> readPageNum_;
+        uint64_t writePageNum_ = 0;
+        uint64_t flushNum_ = 0;
+
+        /**
+         * @brief hash a key
+         * 
+         * @param key the key
+         * @return uint64_t the hash value
+         */
+        inline uint64_t HashKey(const char* key) {
+            uint64_t word0;
+            uint64_t word1;
+            memcpy(&word0, key, sizeof(uint64_t));
+            memcpy(&word1, key + sizeof(uint64_t), sizeof(uint64_t));
+            // the finalizer of murmurhash3, the keys may not be random
+            uint64_t hashVal = word0 ^ (word1 * 0x9e3779b97f4a7c15ULL);
+            hashVal ^= hashVal >> 33;
+            hashVal *= 0xff51afd7ed558ccdULL;
+            hashVal ^= hashVal >> 33;
+            hashVal *= 0xc4ceb9fe1a85ec53ULL;
+            hashVal ^= hashVal >> 33;
+            return hashVal;
+        }
+
+        /**
+         * @brief get the bucket of a hash value
+         * 
+         * @param hashVal the hash value
+         * @return uint32_t the bucket ID
+         */
+        inline uint32_t GetBucketId(uint64_t hashVal) {
+            return directory_[hashVal & ((1ULL << globalDepth_) - 1)];
+        }
+
+        /**
+         * @brief read the page of a bucket
+         * 
+         * @param pageId the page ID
+         * @param pageBuffer the page <return>
+         */
+        void ReadPage(uint32_t pageId, uint8_t* pageBuffer);
+
+        /**
+         * @brief find a key in a page
+         * 
+         * @param pageBuffer the page
+         * @param key the key
+         * @return const uint8_t* the value of the key, NULL if not found
+         */
+        const uint8_t* FindInPage(const uint8_t* pageBuffer, const char* key);
+
+        /**
+         * @brief put a pair into the write buffer without the log
+         * 
+         * @param key the key
+         * @param value the value
+         */
+        void PutItem(const char* key, const char* value);
+
+        /**
+         * @brief write the records of the current call to the log, flush the
+         * buffer if it is full
+         * 
+         * @return true success
+         * @return false fail
+         */
+        bool FlushLog();
+
+        /**
+         * @brief write the pairs of a bucket to new pages, split the bucket
+         * if its pairs exceed a page
+         * 
+         * @param bucketId the bucket ID
+         * @param entryList the pairs of the bucket
+         */
+        void BuildBucketPage(uint32_t bucketId, const string& entryList);
+
+        /**
+         * @brief split a bucket by the next bit of the hash
+         * 
+         * @param bucketId the bucket ID
+         * @return uint32_t the new bucket ID
+         */
+        uint32_t SplitBucket(uint32_t bucketId);
+
+        /**
+         * @brief merge the write buffer into the pages of its buckets
+         * 
+         * @return true success
+         * @return false fail
+         */
+        bool FlushBuffer();
+
+        /**
+         * @brief write the new pages in the ascending page order
+         * 
+         * @param pageIdList the page ID of each new page
+         * @return true success
+         * @return false fail
+         */
+        bool WritePages(const vector<uint32_t>& pageIdList);
+
+        /**
+         * @brief append the bucket updates of a flush to the journal
+         * 
+         * @return true success
+         * @return false fail
+         */
+        bool WriteJournal();
+
+        /**
+         * @brief write the bucket list to a new snapshot, then clear the journal
+         * 
+         * @return true success
+         * @return false fail
+         */
+        bool WriteSnapshot();
+
+        /**
+         * @brief load the snapshot and replay the journal
+         * 
+         */
+        void LoadBucketList();
+
+        /**
+         * @brief rebuild the directory and the free pages from the bucket list
+         * 
+         */
+        void RebuildDirectory();
+
+        /**
+         * @brief insert the records of the log into the write buffer
+         * 
+         */
+        void ReplayLog();
+
+    public:
+        /**
+         * @brief Construct a new Ssd Log Database object
+         * 
+         */
+        SsdLogDatabase() : queryNum_(0), readPageNum_(0) {};
+
+        /**
+         * @brief Construct a new Ssd Log Database object
+         * 
+         * @param dbName the path of the page file
+         */
+        SsdLogDatabase(std::string dbName);
+
+        /**
+         * @brief Destroy the Ssd Log Database object
+         * 
+         */
+        virtual ~SsdLogDatabase();
+
+        /**
+         * @brief open a database
+         * 
+         * @param dbName the path of the page file
+         * @return true success
+         * @return false fail
+         */
+        bool OpenDB(std::string dbName);
+
+        /**
+         * @brief execute query over database
+         * 
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Query(const std::string& key, std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Insert(const std::string& key, const std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key the key
+         * @param buffer the value
+         * @param bufferSize the value size
+         * @return true success
+         * @return false fail
+         */
+        bool InsertBuffer(const std::string& key, const char* buffer, size_t bufferSize);
+
+        /**
+         * @brief insert the (key, value) pair
+         * 
+         * @param key the key
+         * @param keySize the key size
+         * @param buffer the value
+         * @param bufferSize the value size
+         * @return true success
+         * @return false fail
+         */
+        bool InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+            size_t bufferSize);
+
+        /**
+         * @brief query the (key, value) pair
+         * 
+         * @param key the key
+         * @param keySize the key size
+         * @param value the value <return>
+         * @return true success
+         * @return false fail
+         */
+        bool QueryBuffer(const char* key, size_t keySize, std::string& value);
+
+        /**
+         * @brief query a batch of fixed-size keys, the value of a found key
+         * is copied to its value slot
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value slot
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the value slots
+         * @param itemNum the number of keys
+         * @param selectList the keys to query (NULL: all), the others are not found
+         * @param foundList the query result of each key
+         * @return size_t the number of found keys
+         */
+        size_t MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+            bool* foundList);
+
+        /**
+         * @brief insert a batch of fixed-size (key, value) pairs in one write
+         * 
+         * @param keyList the first key
+         * @param keySize the key size
+         * @param valueList the first value
+         * @param valueSize the value size
+         * @param itemStride the stride of the keys and the values
+         * @param itemNum the number of pairs
+         * @param selectList the pairs to insert (NULL: all)
+         * @return true success
+         * @return false fail
+         */
+        bool WriteBatchBuffer(const char* keyList, size_t keySize, const char* valueList,
+            size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList);
+
+        /**
+         * @brief check whether the database has no key
+         * 
+         * @return true it is empty
+         * @return false it has keys
+         */
+        bool IsEmpty();
+
+        /**
+         * @brief pass each key of the database to the handler once, the
+         * database must not be modified during the scan
+         * 
+         * @param keyHandler the key handler
+         * @return true success
+         * @return false fail
+         */
+        bool ScanKey(KeyHandler_t keyHandler);
+
+        /**
+         * @brief Get the number of page reads per query
+         * 
+         * @return double the number of page reads per query
+         */
+        inline double GetReadPerQuery() {
+            uint64_t queryNum = queryNum_.load();
+            return queryNum == 0 ? 0 : (double)readPageNum_.load() / queryNum;
+        }
+};
+
+#endif
@@ -37,6 +37,14 @@ class StorageCore {
          */
         void UpdateRecipeToFile(const uint8_t* recipeBuffer, size_t recipeEntryNum, ofstream& fileRecipeHandler);
 
+        /**
+         * @brief Get the recipe path of a file
+         * 
+         * @param fileNameHash the hash of the file name
+         * @return string the recipe path
+         */
+        string GetRecipePath(const uint8_t* fileNameHash);
+
         /**
          * @brief Construct a new Storage Core object
          * 
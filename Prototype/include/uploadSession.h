@@ -0,0 +1,130 @@
+/**
+ * @file uploadSession.h
+ * @brief define the interface of the upload session with parallel streams
+ * @version 0.1
+ *
+ */
+
+#ifndef UPLOAD_SESSION_H
+#define UPLOAD_SESSION_H
+
+#include "define.h"
+#include "clientVar.h"
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+using namespace std;
+
+class UploadSession {
+    private:
+        string myName_ = "UploadSession";
+
+        // the primary stream aborts the session at the recipe end if the
+        // secondary streams have not all joined within this time (second)
+        static const uint32_t STREAM_JOIN_TIMEOUT = 60;
+
+        // the primary stream owns the file recipe of the session
+        ClientVar* primaryClient_;
+        uint32_t streamNum_;
+
+        // the secondary streams in the session
+        uint32_t joinStreamNum_ = 0;
+        uint32_t syncStreamNum_ = 0;
+        uint32_t exitStreamNum_ = 0;
+
+        // increase when the primary stream starts the next file
+        uint64_t fileEpoch_ = 0;
+        bool closed_ = false;
+        // a secondary stream is rejected, the current file cannot be completed
+        bool aborted_ = false;
+
+        boost::mutex sessionLck_;
+        boost::condition_variable sessionCond_;
+
+    public:
+        /**
+         * @brief Construct a new UploadSession object
+         *
+         * @param primaryClient the out-enclave client of the primary stream
+         * @param streamNum the number of streams in the session
+         */
+        UploadSession(ClientVar* primaryClient, uint32_t streamNum);
+
+        /**
+         * @brief Destroy the UploadSession object
+         *
+         */
+        ~UploadSession();
+
+        /**
+         * @brief join a secondary stream to the session
+         *
+         * @param streamID the stream ID
+         * @return true success
+         * @return false the stream ID is wrong or the session is closed
+         */
+        bool JoinStream(uint32_t streamID);
+
+        /**
+         * @brief a secondary stream has processed all its batches of the
+         * current file, wait until the primary stream starts the next file
+         *
+         */
+        void SyncStream();
+
+        /**
+         * @brief wait until all secondary streams process their batches of the
+         * current file, called by the primary stream at the recipe end
+         *
+         * @return true success
+         * @return false the session is aborted, or a secondary stream does
+         * not join in time
+         */
+        bool WaitStreamSync();
+
+        /**
+         * @brief the primary stream starts the next file, release the
+         * secondary streams
+         *
+         */
+        void NextFile();
+
+        /**
+         * @brief exit a secondary stream
+         *
+         */
+        void ExitStream();
+
+        /**
+         * @brief abort the session after a secondary stream is rejected, the
+         * primary stream stops waiting for the streams
+         *
+         */
+        void Abort();
+
+        /**
+         * @brief close the session, wait until all secondary streams exit
+         *
+         */
+        void Close();
+
+        /**
+         * @brief Get the out-enclave client of the primary stream
+         *
+         * @return ClientVar* the primary client
+         */
+        ClientVar* GetPrimaryClient() {
+            return primaryClient_;
+        }
+
+        /**
+         * @brief Get the number of streams
+         *
+         * @return uint32_t the stream num
+         */
+        uint32_t GetStreamNum() {
+            return streamNum_;
+        }
+};
+
+#endif
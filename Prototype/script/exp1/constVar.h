@@ -49,6 +49,9 @@ static const uint32_t PATTERN = 1;
 // the type of chunker
 enum CHUNKER_TYPE {FIXED_SIZE_CHUNKING = 0, FAST_CDC, FSL_TRACE, UBC_TRACE};
 
+// the kernel of the gear hash in FastCDC
+enum GEAR_KERNEL_TYPE {GEAR_SCALAR = 0, GEAR_AVX2, GEAR_AVX512};
+
 // the setting of the container
 static const uint32_t MAX_CONTAINER_SIZE = 1 << 22; // container size: 4MB
 static const uint32_t CONTAINER_ID_LENGTH = 8;
@@ -65,6 +68,21 @@ static const uint32_t SPARSE_MANIFIEST_CAP_NUM = 10;
 enum INDEX_TYPE_SET {OUT_ENCLAVE = 0, IN_ENCLAVE, EXTREME_BIN, SPARSE_INDEX, 
     FREQ_INDEX};
 
+// the update of the count-min sketch in the freq index, the conservative update
+// only raises the counters below the new estimate (less over-estimation)
+enum SKETCH_UPDATE_TYPE {STANDARD_UPDATE = 0, CONSERVATIVE_UPDATE};
+static const uint32_t SKETCH_UPDATE = STANDARD_UPDATE;
+
+// the policies of the frequency index (the bits of freqPolicy): FREQ_AGING halves
+// the sketch and the top-k freqs every FREQ_AGING_FACTOR * k chunks, FREQ_DOORKEEPER
+// keeps the first occurrence of a chunk in a doorkeeper (cleared every period) and
+// only admits a chunk above the top-k min (TinyLFU), FREQ_BYTE_WEIGHT counts a
+// chunk by its size in FREQ_WEIGHT_UNIT
+enum FREQ_POLICY {FREQ_AGING = 0x1, FREQ_DOORKEEPER = 0x2, FREQ_BYTE_WEIGHT = 0x4};
+static const uint32_t FREQ_AGING_FACTOR = 10;
+static const uint32_t DOORKEEPER_BITS_PER_CHUNK = 8;
+static const uint32_t FREQ_WEIGHT_UNIT = MIN_CHUNK_SIZE;
+
 enum SSL_CONNECTION_TYPE {IN_SERVERSIDE = 0, IN_CLIENTSIDE};
 
 // for SSL connection 
@@ -80,13 +98,46 @@ enum PROTCOL_CODE_SET {CLIENT_UPLOAD_CHUNK = 0, CLIENT_UPLOAD_RECIPE_END,
     SERVER_RESTORE_CHUNK, SERVER_RESTORE_FINAL, 
     SERVER_LOGIN_RESPONSE, SERVER_FILE_NON_EXIST, SGX_RA_MSG01, SGX_RA_MSG2,
     SGX_RA_MSG3, SGX_RA_MSG4, SGX_RA_NEED, SGX_RA_NOT_NEED, SGX_RA_NOT_SUPPORT, 
-    SESSION_KEY_INIT, SESSION_KEY_REPLY};
+    SESSION_KEY_INIT, SESSION_KEY_REPLY, CLIENT_UPLOAD_NEW_FILE,
+    CLIENT_UPLOAD_COMPRESSED_CHUNK, CLIENT_LOGIN_UPLOAD_STREAM,
+    CLIENT_UPLOAD_STREAM_SYNC, SERVER_BATCH_FEEDBACK};
+
+// the chunk batches in the compressed transfer mode are LZ4-compressed before
+// the session encryption (upload), or carry the stored compressed chunks (restore)
+enum TRANSFER_MODE {PLAIN_TRANSFER = 0, COMPRESSED_TRANSFER = 1};
+// in the compressed transfer mode, the size of a restored chunk carries this flag
+// if the chunk is LZ4-compressed (the chunk size is below MAX_CHUNK_SIZE)
+static const uint32_t COMPRESSED_CHUNK_FLAG = 0x80000000;
+
+// an upload session stripes its chunk batches over at most MAX_UPLOAD_STREAM_NUM
+// connections (batch i goes to stream i % streamNum)
+static const uint32_t MAX_UPLOAD_STREAM_NUM = 8;
+
+// the adaptive chunk batch size: a cost change within BATCH_TUNE_TOLERANCE keeps
+// the batch size, which is probed again after BATCH_TUNE_HOLD_WINDOW windows
+static const double BATCH_TUNE_TOLERANCE = 0.05;
+static const uint32_t BATCH_TUNE_HOLD_WINDOW = 8;
 
 static const uint32_t CHUNK_QUEUE_SIZE = 8192;
 static const uint32_t CONTAINER_QUEUE_SIZE = 32;
 static const uint32_t CONTAINER_CAPPING_VALUE = 16;
 
+// the blocked side of a message queue spins for MQ_SPIN_ROUND tries before
+// parking, a parked thread rechecks the queue every MQ_PARK_TIMEOUT (us)
+static const uint32_t MQ_SPIN_ROUND = 1024;
+static const uint32_t MQ_PARK_TIMEOUT = 1000;
+
 static const uint32_t SGX_PERSISTENCE_BUFFER_SIZE = 2 * 1024 * 1024;
+// the adaptive top-k index: its size is checked every TOP_K_ADAPT_WINDOW batches,
+// a growth gaining less than TOP_K_MIN_GAIN hit ratio is reverted and the size
+// is held for TOP_K_HOLD_WINDOW windows
+static const uint32_t TOP_K_ADAPT_WINDOW = 64;
+static const double TOP_K_MIN_GAIN = 0.01;
+static const uint32_t TOP_K_HOLD_WINDOW = 8;
+static const uint64_t TOP_K_MIN_CAPACITY = 1024;
+// the unique chunks of a batch compressed and encrypted together by the
+// enclave workers, each takes a MAX_CHUNK_SIZE buffer of the client
+static const uint32_t ENCLAVE_ENCODE_WINDOW = 32;
 
 enum TWO_PATH_STATUS {UNIQUE = 0, TMP_UNIQUE = 1, DUPLICATE = 2, TMP_DUPLICATE = 3};
 
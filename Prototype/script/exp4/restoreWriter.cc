@@ -39,6 +39,8 @@ RestoreWriter::~RestoreWriter() {
 #endif 
     fprintf(stderr, "write chunk num: %lu\n", totalRecvNum_);
     fprintf(stderr, "write data size: %lu\n", totalWrittenSize_);
+    fprintf(stderr, "chunk queue: full stall num: %lu, empty stall num: %lu\n",
+        inputMQ_->GetFullStallNum(), inputMQ_->GetEmptyStallNum());
     fprintf(stderr, "==================================\n");
 }
 
@@ -50,32 +52,21 @@ void RestoreWriter::Run() {
     tool::Logging(myName_.c_str(),"the main thread is running.\n");
     gettimeofday(&sTotalTime_, NULL);
     Chunk_t newData;
-    bool jobDoneFlag = false;
 
-    while (true) {
-        // the main loop
-        if (inputMQ_->done_ && inputMQ_->IsEmpty()) {
-            tool::Logging(myName_.c_str(), "no chunk in the message queue, all jobs are done.\n");
-            jobDoneFlag = true;
-        }
-
-        if (inputMQ_->Pop(newData)) {
+    // the main loop, park the thread until a chunk arrives
+    while (inputMQ_->BlockingPop(newData)) {
 #if (RESTORE_WRITER_BREAKDOWN == 1)
-            gettimeofday(&sRestoreTime_, NULL);
+        gettimeofday(&sRestoreTime_, NULL);
 #endif 
-            fwrite((char*)newData.data, newData.chunkSize, 1, outputFile_);
-            totalRecvNum_++;
-            totalWrittenSize_ += newData.chunkSize;
+        fwrite((char*)newData.data, newData.chunkSize, 1, outputFile_);
+        totalRecvNum_++;
+        totalWrittenSize_ += newData.chunkSize;
 #if (RESTORE_WRITER_BREAKDOWN == 1)
-            gettimeofday(&eRestoreTime_, NULL);
-            restoreWriteTime_ += tool::GetTimeDiff(sRestoreTime, eRestoreTime);
+        gettimeofday(&eRestoreTime_, NULL);
+        restoreWriteTime_ += tool::GetTimeDiff(sRestoreTime, eRestoreTime);
 #endif
-        } 
-
-        if (jobDoneFlag) {
-            break;
-        }  
     }
+    tool::Logging(myName_.c_str(), "no chunk in the message queue, all jobs are done.\n");
 
     // ensure to write the data to the disk
     fsync(fileno(outputFile_));
@@ -34,6 +34,8 @@ DataWriter::~DataWriter() {
     fprintf(stderr, "write container time: %lf\n", writeTime_);
 #endif
     fprintf(stderr, "writer container num: %lu\n", containerNum_);
+    fprintf(stderr, "container queue: full stall num: %lu, empty stall num: %lu\n",
+        fullStallNum_, emptyStallNum_);
     fprintf(stderr, "===============================\n");
 }
 
@@ -43,37 +45,26 @@ DataWriter::~DataWriter() {
  * @param inputMQ the input MQ
  */
 void DataWriter::Run(MessageQueue<Container_t>* inputMQ) {
-    bool jobDoneFlag = false;
-
     // store the container extract from the MQ
     Container_t tmpContainer;
 
     tool::Logging(myName_.c_str(), "the main thread is running.\n");
     gettimeofday(&sTotalTime, NULL);
-    while (true) {
-        // the main loop        
-        if (inputMQ->done_ && inputMQ->IsEmpty()) {
-            jobDoneFlag = true;
-        }
-
-        if (inputMQ->Pop(tmpContainer)) {
-            // write this container to the disk.
+    // the main loop, park the thread until a container arrives
+    while (inputMQ->BlockingPop(tmpContainer)) {
+        // write this container to the disk.
 #if (DATAWRITER_BREAKDOWN == 1)
-            gettimeofday(&sTimeDataWrite, NULL);
+        gettimeofday(&sTimeDataWrite, NULL);
 #endif
-            // SaveToFile(tmpContainer);
+        // SaveToFile(tmpContainer);
 #if (DATAWRITER_BREAKDOWN == 1)
-            gettimeofday(&eTimeDataWrite, NULL);
-            writeTime_ += tool::GetTimeDiff(sTimeDataWrite, eTimeDataWrite);
+        gettimeofday(&eTimeDataWrite, NULL);
+        writeTime_ += tool::GetTimeDiff(sTimeDataWrite, eTimeDataWrite);
 #endif
-            containerNum_++;
-        }
-
-        if (jobDoneFlag) {
-            break;
-        }
-        
+        containerNum_++;
     }
+    fullStallNum_ += inputMQ->GetFullStallNum();
+    emptyStallNum_ += inputMQ->GetEmptyStallNum();
 
     gettimeofday(&eTotalTime, NULL);
     totalTime_ += tool::GetTimeDiff(sTotalTime, eTotalTime);
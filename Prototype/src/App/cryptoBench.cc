@@ -0,0 +1,294 @@
+/**
+ * @file cryptoBench.cc
+ * @brief compare the per-chunk crypto of a batch: the per-call EVP cipher (AES-CMC
+ * fingerprint, AES-CBC address enc/dec, and AES-GCM chunk with the full init) vs.
+ * the batch AES-NI kernel with the expanded key schedule and the keyed GCM ctx
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/define.h"
+#include "../../include/constVar.h"
+#include "../../include/chunkStructure.h"
+#include "../Enclave/include/ecallAes.h"
+
+#include <cpuid.h>
+#include <openssl/evp.h>
+
+using namespace std;
+
+struct timeval sTime;
+struct timeval eTime;
+
+static const unsigned char gcmAad[] = {
+    0x4d, 0x23, 0xc3, 0xce, 0xc3, 0x34, 0xb4, 0x9b, 0xdb, 0x37, 0x0c, 0x43,
+    0x7f, 0xec, 0x78, 0xde
+};
+
+static uint8_t zeroIV[CRYPTO_BLOCK_SIZE] = {0};
+
+void Usage() {
+    fprintf(stderr, "./cryptoBench -n [chunk num per batch] -b [batch num] -r [round]\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief encrypt with AES-256-CBC, same as EcallCrypto::AESCBCEnc
+ * 
+ * @param ctx cipher ctx
+ * @param dataBuffer the input
+ * @param dataSize the input size
+ * @param key the key
+ * @param ciphertext the output
+ */
+void CBCEncWithEVP(EVP_CIPHER_CTX* ctx, const uint8_t* dataBuffer, int dataSize,
+    const uint8_t* key, uint8_t* ciphertext) {
+    int cipherLen = 0;
+    int len = 0;
+    EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, zeroIV);
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    EVP_EncryptUpdate(ctx, ciphertext, &cipherLen, dataBuffer, dataSize);
+    EVP_EncryptFinal_ex(ctx, ciphertext + cipherLen, &len);
+    EVP_CIPHER_CTX_reset(ctx);
+    return ;
+}
+
+/**
+ * @brief decrypt with AES-256-CBC, same as EcallCrypto::AESCBCDec
+ * 
+ * @param ctx cipher ctx
+ * @param ciphertext the input
+ * @param dataSize the input size
+ * @param key the key
+ * @param dataBuffer the output
+ */
+void CBCDecWithEVP(EVP_CIPHER_CTX* ctx, const uint8_t* ciphertext, int dataSize,
+    const uint8_t* key, uint8_t* dataBuffer) {
+    int plainLen = 0;
+    int len = 0;
+    EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, zeroIV);
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    EVP_DecryptUpdate(ctx, dataBuffer, &plainLen, ciphertext, dataSize);
+    EVP_DecryptFinal_ex(ctx, dataBuffer + plainLen, &len);
+    EVP_CIPHER_CTX_reset(ctx);
+    return ;
+}
+
+/**
+ * @brief encrypt with AES-CMC, same as EcallCrypto::IndexAESCMCEnc
+ * 
+ * @param ctx cipher ctx
+ * @param dataBuffer the input
+ * @param dataSize the input size
+ * @param key the key
+ * @param ciphertext the output
+ */
+void CMCEncWithEVP(EVP_CIPHER_CTX* ctx, const uint8_t* dataBuffer, int dataSize,
+    const uint8_t* key, uint8_t* ciphertext) {
+    uint8_t tmpBuffer[EcallAes::MAX_CMC_ITEM_SIZE];
+    CBCEncWithEVP(ctx, dataBuffer, dataSize, key, tmpBuffer);
+    reverse(tmpBuffer, tmpBuffer + dataSize);
+    CBCEncWithEVP(ctx, tmpBuffer, dataSize, key, ciphertext);
+    return ;
+}
+
+/**
+ * @brief encrypt the chunk with AES-256-GCM
+ * 
+ * @param ctx cipher ctx
+ * @param fullInit true: init the cipher and the key per chunk (EncryptWithKeyIV),
+ * false: only reset the iv of the keyed ctx (EncryptWithKeyCtx)
+ * @param dataBuffer the chunk
+ * @param dataSize the chunk size
+ * @param key the data key
+ * @param iv the iv
+ * @param ciphertext the output
+ */
+void GCMEnc(EVP_CIPHER_CTX* ctx, bool fullInit, const uint8_t* dataBuffer, int dataSize,
+    const uint8_t* key, const uint8_t* iv, uint8_t* ciphertext) {
+    int cipherLen = 0;
+    int len = 0;
+    if (fullInit || EVP_CIPHER_CTX_cipher(ctx) == NULL) {
+        EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, NULL, NULL);
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, CRYPTO_BLOCK_SIZE, NULL);
+        EVP_EncryptInit_ex(ctx, NULL, NULL, key, NULL);
+    }
+    EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, iv);
+    EVP_EncryptUpdate(ctx, NULL, &cipherLen, gcmAad, sizeof(gcmAad));
+    EVP_EncryptUpdate(ctx, ciphertext, &cipherLen, dataBuffer, dataSize);
+    EVP_EncryptFinal_ex(ctx, ciphertext + cipherLen, &len);
+    if (fullInit) {
+        EVP_CIPHER_CTX_reset(ctx);
+    }
+    return ;
+}
+
+int main(int argc, char* argv[]) {
+    const char optString[] = "n:b:r:";
+    int option;
+    uint32_t chunkNum = 256;
+    uint32_t batchNum = 64;
+    uint32_t roundNum = 3;
+    while ((option = getopt(argc, argv, optString)) != -1) {
+        switch (option) {
+            case 'n': {
+                chunkNum = atoi(optarg);
+                break;
+            }
+            case 'b': {
+                batchNum = atoi(optarg);
+                break;
+            }
+            case 'r': {
+                roundNum = atoi(optarg);
+                break;
+            }
+            default: {
+                Usage();
+            }
+        }
+    }
+
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t leaf1Ecx = 0;
+    if (__get_cpuid_count(1, 0, &eax, &ebx, &ecx, &edx)) {
+        leaf1Ecx = ecx;
+    }
+    if (!EcallAes::CheckCPU(leaf1Ecx)) {
+        fprintf(stderr, "the CPU does not support AES-NI, the enclave uses the EVP cipher.\n");
+        return 0;
+    }
+
+    // prepare the fingerprints, the addresses, and the chunks of the batches
+    mt19937_64 generator(0);
+    uniform_int_distribution<uint32_t> sizeDist(MIN_CHUNK_SIZE, MAX_CHUNK_SIZE);
+    size_t itemNum = static_cast<size_t>(batchNum) * chunkNum;
+    vector<uint8_t> hashList(itemNum * CHUNK_HASH_SIZE);
+    vector<RecipeEntry_t> addrList(itemNum);
+    vector<uint32_t> chunkSizeList(itemNum);
+    vector<vector<uint8_t>> chunkList(itemNum);
+    vector<uint8_t> ivList(itemNum * CRYPTO_BLOCK_SIZE);
+    uint8_t dataKey[CHUNK_HASH_SIZE];
+    uint8_t indexKey[CHUNK_HASH_SIZE];
+    for (size_t i = 0; i < CHUNK_HASH_SIZE; i++) {
+        dataKey[i] = static_cast<uint8_t>(generator());
+        indexKey[i] = static_cast<uint8_t>(generator());
+    }
+    for (auto& byte : hashList) {
+        byte = static_cast<uint8_t>(generator());
+    }
+    for (auto& byte : ivList) {
+        byte = static_cast<uint8_t>(generator());
+    }
+    uint64_t totalDataSize = 0;
+    for (size_t i = 0; i < itemNum; i++) {
+        uint8_t* addr = (uint8_t*)&addrList[i];
+        for (size_t j = 0; j < sizeof(RecipeEntry_t); j++) {
+            addr[j] = static_cast<uint8_t>(generator());
+        }
+        chunkSizeList[i] = sizeDist(generator);
+        chunkList[i].resize(chunkSizeList[i]);
+        for (auto& byte : chunkList[i]) {
+            byte = static_cast<uint8_t>(generator());
+        }
+        totalDataSize += chunkSizeList[i];
+    }
+    fprintf(stderr, "chunk num per batch: %u, batch num: %u, data size (MiB): %lf\n",
+        chunkNum, batchNum, totalDataSize / 1024.0 / 1024.0);
+
+    EVP_CIPHER_CTX* cipherCtx = EVP_CIPHER_CTX_new();
+    EVP_CIPHER_CTX* chunkCipherCtx = EVP_CIPHER_CTX_new();
+    AesKeySchedule_t indexKeySchedule;
+    EcallAes::ExpandKey(indexKey, &indexKeySchedule);
+
+    vector<uint8_t> evpCipherHash(itemNum * CHUNK_HASH_SIZE);
+    vector<RecipeEntry_t> evpCipherAddr(itemNum);
+    vector<RecipeEntry_t> evpPlainAddr(itemNum);
+    vector<uint8_t> evpCipherChunk(itemNum * MAX_CHUNK_SIZE);
+    vector<uint8_t> batchCipherHash(itemNum * CHUNK_HASH_SIZE);
+    vector<RecipeEntry_t> batchCipherAddr(itemNum);
+    vector<RecipeEntry_t> batchPlainAddr(itemNum);
+    vector<uint8_t> batchCipherChunk(itemNum * MAX_CHUNK_SIZE);
+
+    double indexEVPTime = 0;
+    double indexBatchTime = 0;
+    double chunkEVPTime = 0;
+    double chunkBatchTime = 0;
+    for (uint32_t round = 0; round < roundNum; round++) {
+        // the index key and the address of each chunk
+        gettimeofday(&sTime, NULL);
+        for (size_t i = 0; i < itemNum; i++) {
+            CMCEncWithEVP(cipherCtx, &hashList[i * CHUNK_HASH_SIZE], CHUNK_HASH_SIZE,
+                indexKey, &evpCipherHash[i * CHUNK_HASH_SIZE]);
+            CBCEncWithEVP(cipherCtx, (uint8_t*)&addrList[i], sizeof(RecipeEntry_t),
+                indexKey, (uint8_t*)&evpCipherAddr[i]);
+            CBCDecWithEVP(cipherCtx, (uint8_t*)&evpCipherAddr[i], sizeof(RecipeEntry_t),
+                indexKey, (uint8_t*)&evpPlainAddr[i]);
+        }
+        gettimeofday(&eTime, NULL);
+        double roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < indexEVPTime) {
+            indexEVPTime = roundTime;
+        }
+
+        gettimeofday(&sTime, NULL);
+        for (size_t i = 0; i < batchNum; i++) {
+            size_t base = i * chunkNum;
+            EcallAes::CMCEncBatch(&indexKeySchedule, &hashList[base * CHUNK_HASH_SIZE],
+                CHUNK_HASH_SIZE, chunkNum, CHUNK_HASH_SIZE,
+                &batchCipherHash[base * CHUNK_HASH_SIZE], CHUNK_HASH_SIZE);
+            EcallAes::CBCEncBatch(&indexKeySchedule, (uint8_t*)&addrList[base],
+                sizeof(RecipeEntry_t), chunkNum, sizeof(RecipeEntry_t),
+                (uint8_t*)&batchCipherAddr[base], sizeof(RecipeEntry_t));
+            EcallAes::CBCDecBatch(&indexKeySchedule, (uint8_t*)&batchCipherAddr[base],
+                sizeof(RecipeEntry_t), chunkNum, sizeof(RecipeEntry_t),
+                (uint8_t*)&batchPlainAddr[base], sizeof(RecipeEntry_t));
+        }
+        gettimeofday(&eTime, NULL);
+        roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < indexBatchTime) {
+            indexBatchTime = roundTime;
+        }
+
+        // the chunk encryption
+        gettimeofday(&sTime, NULL);
+        for (size_t i = 0; i < itemNum; i++) {
+            GCMEnc(cipherCtx, true, &chunkList[i][0], chunkSizeList[i], dataKey,
+                &ivList[i * CRYPTO_BLOCK_SIZE], &evpCipherChunk[i * MAX_CHUNK_SIZE]);
+        }
+        gettimeofday(&eTime, NULL);
+        roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < chunkEVPTime) {
+            chunkEVPTime = roundTime;
+        }
+
+        gettimeofday(&sTime, NULL);
+        for (size_t i = 0; i < itemNum; i++) {
+            GCMEnc(chunkCipherCtx, false, &chunkList[i][0], chunkSizeList[i], dataKey,
+                &ivList[i * CRYPTO_BLOCK_SIZE], &batchCipherChunk[i * MAX_CHUNK_SIZE]);
+        }
+        gettimeofday(&eTime, NULL);
+        roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < chunkBatchTime) {
+            chunkBatchTime = roundTime;
+        }
+    }
+    EVP_CIPHER_CTX_free(cipherCtx);
+    EVP_CIPHER_CTX_free(chunkCipherCtx);
+
+    bool sameCipher = (evpCipherHash == batchCipherHash) &&
+        (memcmp(&evpCipherAddr[0], &batchCipherAddr[0], itemNum * sizeof(RecipeEntry_t)) == 0) &&
+        (memcmp(&batchPlainAddr[0], &addrList[0], itemNum * sizeof(RecipeEntry_t)) == 0) &&
+        (evpCipherChunk == batchCipherChunk);
+    double toNs = 1000.0 * 1000.0 * 1000.0 / itemNum;
+    fprintf(stderr, "index key + address (ns/chunk): per-call EVP: %lf, batch AES-NI: %lf, "
+        "speedup: %lf\n", indexEVPTime * toNs, indexBatchTime * toNs,
+        indexEVPTime / indexBatchTime);
+    fprintf(stderr, "chunk AES-GCM (ns/chunk): full init: %lf, keyed ctx: %lf, "
+        "speedup: %lf\n", chunkEVPTime * toNs, chunkBatchTime * toNs,
+        chunkEVPTime / chunkBatchTime);
+    fprintf(stderr, "total (ns/chunk): before: %lf, after: %lf, same ciphertext: %s\n",
+        (indexEVPTime + chunkEVPTime) * toNs, (indexBatchTime + chunkBatchTime) * toNs,
+        sameCipher ? "yes" : "no");
+    return 0;
+}
@@ -13,7 +13,7 @@
 #include "../../include/sessionKeyExchange.h"
 
 // for upload operation
-#include "../../include/chunker.h"
+#include "../../include/chunkerPool.h"
 #include "../../include/dataSender.h"
 
 // for remote attestation operation
@@ -24,6 +24,7 @@
 #include "../../include/restoreWriter.h"
 
 #include <boost/thread/thread.hpp>
+#include <filesystem>
 
 using namespace std;
 
@@ -37,11 +38,15 @@ string logFileName = "client-log";
 ofstream logFile;
 
 void Usage() {
-    fprintf(stderr, "./DEBEClient -t [u/d/a] -i [inputFile path].\n"
+    fprintf(stderr, "./DEBEClient -t [u/d/a] -i [inputFile path] -n [backup name].\n"
     "-t: operation ([u/d/a]):\n"
     "\tu: upload\n"
     "\td: download\n"
-    "\ta: remote attestation\n");
+    "\ta: remote attestation\n"
+    "-i: input file path (\"-\" for stdin in upload, "
+    "a directory uploads all its files in one session)\n"
+    "-n: backup name of the stdin upload (required with -i -), "
+    "it is restored by -t d -i [backup name]\n");
     return ;
 }
 
@@ -68,7 +73,8 @@ int main(int argc, char* argv[]) {
 
     // for upload operation
     DataSender* dataSenderObj;
-    Chunker* chunkerObj;
+    ChunkerPool* chunkerPoolObj;
+    vector<string> fileList;
     CryptoPrimitive* cryptoObj;
 
     // for restore operation 
@@ -77,10 +83,11 @@ int main(int argc, char* argv[]) {
 
     // ------ main process ------
 
-    const char optString[] = "t:i:";
+    const char optString[] = "t:i:n:";
     int option;
 
-    if (argc < sizeof(optString)) {
+    // -n is only required by the stdin upload
+    if (argc < 5) {
         tool::Logging(myName.c_str(), "wrong argc: %d\n", argc);
         Usage();
         exit(EXIT_FAILURE);
@@ -88,6 +95,7 @@ int main(int argc, char* argv[]) {
 
     uint32_t optType;
     string inputFile;
+    string backupName;
     while ((option = getopt(argc, argv, optString)) != -1) {
         switch (option) {
             case 't':
@@ -108,6 +116,9 @@ int main(int argc, char* argv[]) {
             case 'i':
                 inputFile.assign(optarg);
                 break;
+            case 'n':
+                backupName.assign(optarg);
+                break;
             case '?':
                 tool::Logging(myName.c_str(), "error optopt: %c\n", optopt);
                 tool::Logging(myName.c_str(), "error opterr: %d\n", opterr);
@@ -116,6 +127,13 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (optType == UPLOAD_OPT && inputFile == "-" && backupName.empty()) {
+        // the stdin backups of a client would share one recipe name
+        tool::Logging(myName.c_str(), "the stdin upload needs a backup name (-n).\n");
+        Usage();
+        exit(EXIT_FAILURE);
+    }
+
     boost::thread* thTmp;
     boost::thread::attributes attrs;
     attrs.set_stack_size(THREAD_STACK_SIZE);
@@ -135,8 +153,9 @@ int main(int argc, char* argv[]) {
     NetworkHead_t raDecision;
     raDecision.clientID = clientID;
 
-    // compute the file name hash
-    string fullName = inputFile + to_string(clientID);
+    // compute the file name hash, the stdin upload is named by its backup name
+    string fullName = ((inputFile == "-") ? backupName : inputFile) +
+        to_string(clientID);
     uint8_t fileNameHash[CHUNK_HASH_SIZE] = {0};
     cryptoObj->GenerateHash(mdCtx, (uint8_t*)&fullName[0],
         fullName.size(), fileNameHash);
@@ -154,19 +173,37 @@ int main(int argc, char* argv[]) {
 
             tool::Logging(myName.c_str(), "upload input file name: %s\n", 
                 inputFile.c_str());
-            chunkerObj = new Chunker(inputFile);
+            if (inputFile != "-" && std::filesystem::is_directory(inputFile)) {
+                // upload all regular files in the directory, each file is
+                // restored by its own path
+                for (auto& entry : std::filesystem::recursive_directory_iterator(
+                    inputFile)) {
+                    if (entry.is_regular_file()) {
+                        fileList.push_back(entry.path().string());
+                    }
+                }
+                sort(fileList.begin(), fileList.end());
+                if (fileList.size() == 0) {
+                    tool::Logging(myName.c_str(), "no file in the directory: %s\n",
+                        inputFile.c_str());
+                    exit(EXIT_FAILURE);
+                }
+                // the upload login carries the name of the first file
+                fullName = fileList[0] + to_string(clientID);
+                cryptoObj->GenerateHash(mdCtx, (uint8_t*)&fullName[0],
+                    fullName.size(), fileNameHash);
+            } else {
+                fileList.push_back(inputFile);
+            }
+            chunkerPoolObj = new ChunkerPool(fileList);
             dataSenderObj = new DataSender(dataSecureChannel); 
             dataSenderObj->SetConnectionRecord(serverConnectionRecord);
             dataSenderObj->SetSessionKey(sessionKey, CHUNK_HASH_SIZE);
-
-            // prepare the MQ
-            MessageQueue<Data_t>* chunker2SenderMQ = new MessageQueue<Data_t>(CHUNK_QUEUE_SIZE);
-            chunkerObj->SetOutputMQ(chunker2SenderMQ);
-            dataSenderObj->SetInputMQ(chunker2SenderMQ);
+            dataSenderObj->SetChunkerPool(chunkerPoolObj);
 
             dataSenderObj->UploadLogin(config.GetLocalSecret(), fileNameHash);
 
-            thTmp = new boost::thread(attrs, boost::bind(&Chunker::Chunking, chunkerObj));
+            thTmp = new boost::thread(attrs, boost::bind(&ChunkerPool::Run, chunkerPoolObj));
             thList.push_back(thTmp);
             thTmp = new boost::thread(attrs, boost::bind(&DataSender::Run, dataSenderObj));
             thList.push_back(thTmp);
@@ -184,16 +221,15 @@ int main(int argc, char* argv[]) {
             }
 
             // update the log
-            double speed = static_cast<double>(chunkerObj->_recipe.recipeHead.fileSize) / 
+            double speed = static_cast<double>(chunkerPoolObj->_totalFileSize) / 
                 1024.0 / 1024.0 / totalTime;
             logFile << inputFile << ", upload, "
-                << chunkerObj->_recipe.recipeHead.fileSize << ", "
-                << chunkerObj->_recipe.recipeHead.totalChunkNum << ", "
+                << chunkerPoolObj->_totalFileSize << ", "
+                << chunkerPoolObj->_totalChunkNum << ", "
                 << to_string(totalTime) << ", "
                 << to_string(speed) << endl;
-            delete chunkerObj;
+            delete chunkerPoolObj;
             delete dataSenderObj;
-            delete chunker2SenderMQ;
             thList.clear();
             break;
         }
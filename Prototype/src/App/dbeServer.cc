@@ -11,7 +11,7 @@
 // for basic build block
 #include "../../include/configure.h"
 #include "../../include/clientVar.h"
-#include "../../include/factoryDatabase.h"
+#include "../../include/shardedDatabase.h"
 #include "../../include/absDatabase.h"
 
 // for main server thread
@@ -38,9 +38,14 @@ Configure config("config.json");
 string myName = "DEBEServer";
 
 SSLConnection* dataSecurityChannelObj;
-DatabaseFactory dbFactory;
 AbsDatabase* fp2ChunkDB;
 vector<boost::thread*> thList;
+vector<boost::thread*> workerThList; // the worker threads inside the enclave
+atomic<uint32_t> failedWorkerNum(0); // the workers that cannot enter the enclave
+
+// the TCS can be held for a moment by another thread, retry the entry
+static const uint32_t TCS_RETRY_NUM = 100;
+static const uint32_t TCS_RETRY_INTERVAL = 10000; // us
 
 ServerOptThread* serverThreadObj;
 
@@ -55,6 +60,59 @@ void Usage() {
     return ;
 }
 
+/**
+ * @brief run a worker thread inside the enclave
+ * 
+ * @param workerID the worker ID
+ */
+void RunEnclaveWorker(uint32_t workerID) {
+    sgx_status_t status = Ecall_Worker_Run(eidSGX, workerID);
+    for (uint32_t i = 1; i < TCS_RETRY_NUM && status == SGX_ERROR_OUT_OF_TCS; i++) {
+        usleep(TCS_RETRY_INTERVAL);
+        status = Ecall_Worker_Run(eidSGX, workerID);
+    }
+    if (status != SGX_SUCCESS) {
+        // each worker takes a TCS of the enclave (TCSNum in storeEnclave.config.xml)
+        tool::Logging(myName.c_str(), "enclave worker %u cannot enter the enclave, "
+            "status: %x\n", workerID, status);
+        failedWorkerNum++;
+    }
+    return ;
+}
+
+/**
+ * @brief wait for the enclave workers to enter the enclave, and check that
+ * a TCS is left for the clients, exit if not
+ * 
+ * @param workerNum the number of the enclave workers
+ */
+void CheckEnclaveWorkers(uint32_t workerNum) {
+    uint32_t runningNum = 0;
+    for (uint32_t i = 0; i < 2 * TCS_RETRY_NUM; i++) {
+        if (failedWorkerNum != 0) {
+            break;
+        }
+        sgx_status_t status = Ecall_Worker_Running_Num(eidSGX, &runningNum);
+        if (status == SGX_SUCCESS && runningNum == workerNum) {
+            tool::Logging(myName.c_str(), "%u enclave workers are running.\n",
+                runningNum);
+            return ;
+        }
+        if (status != SGX_SUCCESS && status != SGX_ERROR_OUT_OF_TCS) {
+            tool::Logging(myName.c_str(), "cannot check the enclave workers, "
+                "status: %x\n", status);
+            exit(EXIT_FAILURE);
+        }
+        usleep(TCS_RETRY_INTERVAL);
+    }
+    // the workers hold all TCS, or some of them cannot get one
+    tool::Logging(myName.c_str(), "the enclave has not enough TCS for %u enclave "
+        "workers and the clients, set TCSNum, TCSMaxNum and TCSMinPool in "
+        "storeEnclave.config.xml to at least enclaveWorkerNum_ plus the number of "
+        "concurrent clients.\n", workerNum);
+    exit(EXIT_FAILURE);
+}
+
 void CTRLC(int s) {
     tool::Logging(myName.c_str(), "terminate the server with ctrl+c interrupt\n");
     // ------ clean up ------
@@ -69,8 +127,12 @@ void CTRLC(int s) {
     delete serverThreadObj;
     tool::Logging(myName.c_str(), "clear all server thread the object.\n");
 
-    // destroy the sgx here
+    // destroy the sgx here, the enclave workers return
     Ecall_Enclave_Destroy(eidSGX); 
+    for (auto it : workerThList) {
+        it->join();
+        delete it;
+    }
 
     delete fp2ChunkDB;
     delete dataSecurityChannelObj;
@@ -119,11 +181,23 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // the compact and SSD-resident indexes only hold the (fingerprint, address) pairs,
+    // the similarity-based and locality-based indexes store the bins and manifests
+    int dbType = config.GetFp2ChunkDBType();
+    if ((dbType == COMPACT_MEMORY || dbType == SSD_LOG) &&
+        (indexType == EXTREME_BIN || indexType == SPARSE_INDEX)) {
+        tool::Logging(myName.c_str(), "fp2ChunkDBType_ %d does not support the index type %d, "
+            "use LevelDB (%d) or In-Memory (%d).\n", dbType, indexType, LEVEL_DB, IN_MEMORY);
+        exit(EXIT_FAILURE);
+    }
+
     boost::thread* thTmp;
     boost::thread_attributes attrs;
     attrs.set_stack_size(THREAD_STACK_SIZE);
     
-    fp2ChunkDB = dbFactory.CreateDatabase(IN_MEMORY, config.GetFp2ChunkDBName());
+    // the clients access the shards of the index concurrently
+    fp2ChunkDB = new ShardedDatabase(config.GetFp2ChunkDBType(),
+        config.GetFp2ChunkDBName(), config.GetOutIndexShardNum());
     dataSecurityChannelObj = new SSLConnection(config.GetStorageServerIP(), 
         config.GetStoragePort(), IN_SERVERSIDE);
 
@@ -150,9 +224,22 @@ int main(int argc, char* argv[]) {
     // config the enclave
     EnclaveConfig_t enclaveConfig;
     enclaveConfig.sendChunkBatchSize = config.GetSendChunkBatchSize();
+    enclaveConfig.maxChunkBatchSize = config.GetMaxChunkBatchSize();
     enclaveConfig.sendRecipeBatchSize = config.GetSendRecipeBatchSize();
     enclaveConfig.topKParam = config.GetTopKParam();
+    enclaveConfig.topKEPCBudget = config.GetTopKEPCBudget();
+    enclaveConfig.sketchWidth = config.GetSketchWidth();
+    enclaveConfig.sketchDepth = config.GetSketchDepth();
+    enclaveConfig.freqPolicy = config.GetFreqPolicy();
+    enclaveConfig.enclaveWorkerNum = config.GetEnclaveWorkerNum();
+    enclaveConfig.outQueryPipeline = config.GetOutQueryPipeline();
     Ecall_Enclave_Init(eidSGX, &enclaveConfig);
+    for (uint32_t i = 0; i < enclaveConfig.enclaveWorkerNum; i++) {
+        workerThList.push_back(new boost::thread(attrs, boost::bind(&RunEnclaveWorker, i)));
+    }
+    if (enclaveConfig.enclaveWorkerNum != 0) {
+        CheckEnclaveWorkers(enclaveConfig.enclaveWorkerNum);
+    }
 
     // init 
     serverThreadObj = new ServerOptThread(dataSecurityChannelObj, fp2ChunkDB,
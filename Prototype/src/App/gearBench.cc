@@ -0,0 +1,144 @@
+/**
+ * @file gearBench.cc
+ * @brief compare the throughput of the gear hash kernels in FastCDC
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/define.h"
+#include "../../include/constVar.h"
+#include "../../include/gearHash.h"
+
+using namespace std;
+
+struct timeval sTime;
+struct timeval eTime;
+
+void Usage() {
+    fprintf(stderr, "./gearBench -s [data size (MiB)] -i [input file (optional)] -r [round]\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief the cut point of FastCDC, same as Chunker::CutPoint
+ * 
+ * @param gearHashObj the gear hash kernel
+ * @param src the input buffer
+ * @param len the length of the buffer
+ * @param normalSize the normal chunk size
+ * @param maskS the small mask
+ * @param maskL the large mask
+ * @return uint32_t length of this chunk
+ */
+uint32_t CutPoint(GearHash* gearHashObj, const uint8_t* src, uint32_t len,
+    uint32_t normalSize, uint32_t maskS, uint32_t maskL) {
+    uint32_t fp = 0;
+    uint32_t i = std::min(len, MIN_CHUNK_SIZE);
+    uint32_t n = std::min(normalSize, len);
+    if (i < n) {
+        i = gearHashObj->Scan(src, i, n, maskS, fp);
+        if (i < n) {
+            return (i + 1);
+        }
+    }
+    n = std::min(MAX_CHUNK_SIZE, len);
+    if (i < n) {
+        i = gearHashObj->Scan(src, i, n, maskL, fp);
+        if (i < n) {
+            return (i + 1);
+        }
+    }
+    return i;
+}
+
+int main(int argc, char* argv[]) {
+    const char optString[] = "s:i:r:";
+    int option;
+    uint64_t dataSizeMiB = 256;
+    uint32_t roundNum = 3;
+    string inputFileName;
+    while ((option = getopt(argc, argv, optString)) != -1) {
+        switch (option) {
+            case 's': {
+                dataSizeMiB = atol(optarg);
+                break;
+            }
+            case 'i': {
+                inputFileName.assign(optarg);
+                break;
+            }
+            case 'r': {
+                roundNum = atoi(optarg);
+                break;
+            }
+            default: {
+                Usage();
+            }
+        }
+    }
+
+    // prepare the data
+    uint64_t dataSize = dataSizeMiB * MiB_2_B;
+    uint8_t* dataBuffer = (uint8_t*) malloc(dataSize);
+    if (inputFileName.empty()) {
+        mt19937_64 generator(0);
+        for (uint64_t i = 0; i < dataSize; i++) {
+            dataBuffer[i] = static_cast<uint8_t>(generator());
+        }
+    } else {
+        ifstream inputFile(inputFileName, ios_base::in | ios_base::binary);
+        inputFile.read((char*)dataBuffer, dataSize);
+        dataSize = inputFile.gcount();
+        inputFile.close();
+    }
+    fprintf(stderr, "data size (MiB): %lf\n", dataSize / 1024.0 / 1024.0);
+
+    // the same FastCDC setting as the chunker
+    uint32_t off = MIN_CHUNK_SIZE + tool::DivCeil(MIN_CHUNK_SIZE, 2);
+    uint32_t normalSize = (off > AVG_CHUNK_SIZE) ? 0 : (AVG_CHUNK_SIZE - off);
+    uint32_t bits = (uint32_t) round(log2(static_cast<double>(AVG_CHUNK_SIZE)));
+    uint32_t maskS = (1 << tool::CompareLimit(bits + 1, 1, 31)) - 1;
+    uint32_t maskL = (1 << tool::CompareLimit(bits - 1, 1, 31)) - 1;
+
+    vector<uint32_t> scalarCut;
+    double scalarSpeed = 0;
+    for (int kernelType : {GEAR_SCALAR, GEAR_AVX2, GEAR_AVX512}) {
+        if (!GearHash::IsSupported(kernelType)) {
+            fprintf(stderr, "%s: not supported\n", GearHash::GetKernelName(kernelType));
+            continue;
+        }
+        GearHash gearHashObj(kernelType);
+        vector<uint32_t> cutList;
+        double bestTime = 0;
+        for (uint32_t round = 0; round < roundNum; round++) {
+            cutList.clear();
+            gettimeofday(&sTime, NULL);
+            uint64_t offset = 0;
+            while (offset < dataSize) {
+                uint32_t len = std::min(dataSize - offset, static_cast<uint64_t>(MiB_2_B));
+                uint32_t cp = CutPoint(&gearHashObj, dataBuffer + offset, len,
+                    normalSize, maskS, maskL);
+                cutList.push_back(cp);
+                offset += cp;
+            }
+            gettimeofday(&eTime, NULL);
+            double roundTime = tool::GetTimeDiff(sTime, eTime);
+            if (round == 0 || roundTime < bestTime) {
+                bestTime = roundTime;
+            }
+        }
+
+        double speed = dataSize / 1024.0 / 1024.0 / bestTime;
+        if (kernelType == GEAR_SCALAR) {
+            scalarCut = cutList;
+            scalarSpeed = speed;
+        }
+        fprintf(stderr, "%s: chunk num: %lu, speed (MiB/s): %lf, speedup: %lf, "
+            "same cut points: %s\n", GearHash::GetKernelName(kernelType),
+            cutList.size(), speed, speed / scalarSpeed,
+            (cutList == scalarCut) ? "yes" : "no");
+    }
+
+    free(dataBuffer);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file hashBench.cc
+ * @brief compare the chunk fingerprinting of a batch: the per-chunk EVP digest
+ * vs. the batch SHA-256 kernel with the SHA extensions
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/define.h"
+#include "../../include/constVar.h"
+#include "../Enclave/include/ecallSha256.h"
+
+#include <cpuid.h>
+#include <openssl/evp.h>
+
+using namespace std;
+
+struct timeval sTime;
+struct timeval eTime;
+
+void Usage() {
+    fprintf(stderr, "./hashBench -n [chunk num per batch] -b [batch num] -r [round]\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief hash each chunk of the batch with EVP, same as EcallCrypto::GenerateHash
+ * 
+ * @param mdCtx hasher ctx
+ * @param batchBuffer the batch buffer
+ * @param chunkNum the number of chunks
+ * @param hashList the hash list
+ */
+void HashWithEVP(EVP_MD_CTX* mdCtx, const uint8_t* batchBuffer, size_t chunkNum,
+    uint8_t* hashList) {
+    size_t currentOffset = 0;
+    uint32_t tmpChunkSize = 0;
+    uint32_t hashSize = 0;
+    for (size_t i = 0; i < chunkNum; i++) {
+        memcpy(&tmpChunkSize, batchBuffer + currentOffset, sizeof(uint32_t));
+        currentOffset += sizeof(uint32_t);
+        EVP_DigestInit_ex(mdCtx, EVP_sha256(), NULL);
+        EVP_DigestUpdate(mdCtx, batchBuffer + currentOffset, tmpChunkSize);
+        EVP_DigestFinal_ex(mdCtx, hashList + i * CHUNK_HASH_SIZE, &hashSize);
+        EVP_MD_CTX_reset(mdCtx);
+        currentOffset += tmpChunkSize;
+    }
+    return ;
+}
+
+int main(int argc, char* argv[]) {
+    const char optString[] = "n:b:r:";
+    int option;
+    uint32_t chunkNum = 256;
+    uint32_t batchNum = 64;
+    uint32_t roundNum = 3;
+    while ((option = getopt(argc, argv, optString)) != -1) {
+        switch (option) {
+            case 'n': {
+                chunkNum = atoi(optarg);
+                break;
+            }
+            case 'b': {
+                batchNum = atoi(optarg);
+                break;
+            }
+            case 'r': {
+                roundNum = atoi(optarg);
+                break;
+            }
+            default: {
+                Usage();
+            }
+        }
+    }
+
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t leaf1Ecx = 0;
+    uint32_t leaf7Ebx = 0;
+    if (__get_cpuid_count(1, 0, &eax, &ebx, &ecx, &edx)) {
+        leaf1Ecx = ecx;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        leaf7Ebx = ebx;
+    }
+    if (!EcallSha256::CheckCPU(leaf1Ecx, leaf7Ebx)) {
+        fprintf(stderr, "the CPU does not support the SHA extensions, "
+            "the enclave uses the EVP digest.\n");
+        return 0;
+    }
+
+    // prepare the batches in the layout of the recv buffer: (chunk size, chunk data)
+    mt19937_64 generator(0);
+    uniform_int_distribution<uint32_t> sizeDist(MIN_CHUNK_SIZE, MAX_CHUNK_SIZE);
+    vector<vector<uint8_t>> batchList(batchNum);
+    uint64_t totalDataSize = 0;
+    for (auto& batch : batchList) {
+        for (uint32_t i = 0; i < chunkNum; i++) {
+            uint32_t chunkSize = sizeDist(generator);
+            size_t offset = batch.size();
+            batch.resize(offset + sizeof(uint32_t) + chunkSize);
+            memcpy(&batch[offset], &chunkSize, sizeof(uint32_t));
+            for (size_t j = 0; j < chunkSize; j++) {
+                batch[offset + sizeof(uint32_t) + j] = static_cast<uint8_t>(generator());
+            }
+            totalDataSize += chunkSize;
+        }
+    }
+    fprintf(stderr, "chunk num per batch: %u, batch num: %u, data size (MiB): %lf\n",
+        chunkNum, batchNum, totalDataSize / 1024.0 / 1024.0);
+
+    EVP_MD_CTX* mdCtx = EVP_MD_CTX_new();
+    vector<uint8_t> evpHashList(batchNum * chunkNum * CHUNK_HASH_SIZE);
+    vector<uint8_t> batchHashList(batchNum * chunkNum * CHUNK_HASH_SIZE);
+    double evpTime = 0;
+    double batchTime = 0;
+    for (uint32_t round = 0; round < roundNum; round++) {
+        gettimeofday(&sTime, NULL);
+        for (uint32_t i = 0; i < batchNum; i++) {
+            HashWithEVP(mdCtx, &batchList[i][0], chunkNum,
+                &evpHashList[i * chunkNum * CHUNK_HASH_SIZE]);
+        }
+        gettimeofday(&eTime, NULL);
+        double roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < evpTime) {
+            evpTime = roundTime;
+        }
+
+        gettimeofday(&sTime, NULL);
+        for (uint32_t i = 0; i < batchNum; i++) {
+            EcallSha256::HashBatch(&batchList[i][0], chunkNum,
+                &batchHashList[i * chunkNum * CHUNK_HASH_SIZE], CHUNK_HASH_SIZE);
+        }
+        gettimeofday(&eTime, NULL);
+        roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < batchTime) {
+            batchTime = roundTime;
+        }
+    }
+    EVP_MD_CTX_free(mdCtx);
+
+    double evpSpeed = totalDataSize / 1024.0 / 1024.0 / evpTime;
+    double batchSpeed = totalDataSize / 1024.0 / 1024.0 / batchTime;
+    bool sameDigest = (evpHashList == batchHashList);
+    fprintf(stderr, "per-chunk EVP (MiB/s): %lf, batch SHA-NI (MiB/s): %lf, speedup: %lf, "
+        "same digests: %s\n", evpSpeed, batchSpeed, batchSpeed / evpSpeed,
+        sameDigest ? "yes" : "no");
+    return 0;
+}
@@ -0,0 +1,258 @@
+/**
+ * @file indexBench.cc
+ * @brief compare the SSD-resident index with LevelDB under the batch pattern of
+ * the out-enclave index: each batch of new fingerprints is queried and then
+ * inserted, then the batches of old and new fingerprints are queried
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/define.h"
+#include "../../include/constVar.h"
+#include "../../include/chunkStructure.h"
+#include "../../include/leveldbDatabase.h"
+#include "../../include/ssdLogDatabase.h"
+
+using namespace std;
+
+struct timeval sTime;
+struct timeval eTime;
+
+void Usage() {
+    fprintf(stderr, "./indexBench -n [entry num (M)] -q [query num (M)] -b [batch size] "
+        "-p [db path prefix] -c (drop the page cache before the query, root only)\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief mix a 64-bit value (splitmix64)
+ * 
+ * @param x the input
+ * @return uint64_t the mixed value
+ */
+uint64_t Mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief generate the fingerprint and the address of an entry, the
+ * fingerprints are generated on the fly to support 1B entries
+ * 
+ * @param entryId the entry ID
+ * @param entry the query entry <return>
+ */
+void GenerateEntry(uint64_t entryId, OutQueryEntry_t* entry) {
+    for (size_t i = 0; i < CHUNK_HASH_SIZE / sizeof(uint64_t); i++) {
+        uint64_t tmpVal = Mix64(entryId * (CHUNK_HASH_SIZE / sizeof(uint64_t)) + i);
+        memcpy(entry->chunkHash + i * sizeof(uint64_t), &tmpVal, sizeof(uint64_t));
+    }
+    memset(&entry->chunkAddr, 0, sizeof(RecipeEntry_t));
+    entry->chunkAddr.offset = static_cast<uint32_t>(entryId);
+    entry->chunkAddr.length = static_cast<uint32_t>(entryId >> 32);
+    return ;
+}
+
+/**
+ * @brief write the dirty pages and drop the page cache
+ * 
+ */
+void DropPageCache() {
+    sync();
+    ofstream dropFile("/proc/sys/vm/drop_caches");
+    if (!dropFile.is_open()) {
+        fprintf(stderr, "cannot drop the page cache, the query may hit the memory.\n");
+        return ;
+    }
+    dropFile << "3" << endl;
+    dropFile.close();
+    return ;
+}
+
+/**
+ * @brief insert the entries batch by batch, each batch is queried first
+ * 
+ * @param dbObj the index
+ * @param entryNum the number of entries
+ * @param batchSize the batch size
+ * @return double the insert time (second)
+ */
+double LoadIndex(AbsDatabase* dbObj, uint64_t entryNum, uint32_t batchSize) {
+    vector<OutQueryEntry_t> batchList(batchSize);
+    bool* foundList = (bool*) malloc(batchSize * sizeof(bool));
+    uint64_t reportStep = max(entryNum / 10, (uint64_t)1);
+    uint64_t nextReport = reportStep;
+    double totalTime = 0;
+    for (uint64_t start = 0; start < entryNum; start += batchSize) {
+        size_t curSize = std::min(static_cast<uint64_t>(batchSize), entryNum - start);
+        for (size_t i = 0; i < curSize; i++) {
+            GenerateEntry(start + i, &batchList[i]);
+        }
+
+        gettimeofday(&sTime, NULL);
+        dbObj->MultiQueryBuffer((char*)batchList[0].chunkHash, CHUNK_HASH_SIZE,
+            (char*)&batchList[0].chunkAddr, sizeof(RecipeEntry_t), sizeof(OutQueryEntry_t),
+            curSize, NULL, foundList);
+        dbObj->WriteBatchBuffer((char*)batchList[0].chunkHash, CHUNK_HASH_SIZE,
+            (char*)&batchList[0].chunkAddr, sizeof(RecipeEntry_t), sizeof(OutQueryEntry_t),
+            curSize, NULL);
+        gettimeofday(&eTime, NULL);
+        totalTime += tool::GetTimeDiff(sTime, eTime);
+
+        if (start + curSize >= nextReport) {
+            fprintf(stderr, "loaded entry num: %lu, speed (Kops/s): %lf\n", start + curSize,
+                (start + curSize) / totalTime / 1000.0);
+            nextReport += reportStep;
+        }
+    }
+    free(foundList);
+    return totalTime;
+}
+
+/**
+ * @brief query the batches of old and new entries
+ * 
+ * @param dbObj the index
+ * @param entryNum the number of inserted entries
+ * @param queryNum the number of queries
+ * @param batchSize the batch size
+ * @param batchTimeList the time of each batch (second) <return>
+ * @return bool whether the results are correct
+ */
+bool QueryIndex(AbsDatabase* dbObj, uint64_t entryNum, uint64_t queryNum,
+    uint32_t batchSize, vector<double>& batchTimeList) {
+    mt19937_64 generator(0);
+    uniform_int_distribution<uint64_t> oldDist(0, entryNum - 1);
+    vector<OutQueryEntry_t> batchList(batchSize);
+    vector<uint64_t> idList(batchSize);
+    bool* foundList = (bool*) malloc(batchSize * sizeof(bool));
+    OutQueryEntry_t expectEntry;
+    bool isCorrect = true;
+    batchTimeList.clear();
+    for (uint64_t start = 0; start < queryNum; start += batchSize) {
+        size_t curSize = std::min(static_cast<uint64_t>(batchSize), queryNum - start);
+        for (size_t i = 0; i < curSize; i++) {
+            // half of the queries are the old entries
+            idList[i] = (generator() & 1) ? oldDist(generator) : entryNum + start + i;
+            GenerateEntry(idList[i], &batchList[i]);
+            memset(&batchList[i].chunkAddr, 0, sizeof(RecipeEntry_t));
+        }
+
+        gettimeofday(&sTime, NULL);
+        dbObj->MultiQueryBuffer((char*)batchList[0].chunkHash, CHUNK_HASH_SIZE,
+            (char*)&batchList[0].chunkAddr, sizeof(RecipeEntry_t), sizeof(OutQueryEntry_t),
+            curSize, NULL, foundList);
+        gettimeofday(&eTime, NULL);
+        batchTimeList.push_back(tool::GetTimeDiff(sTime, eTime));
+
+        for (size_t i = 0; i < curSize; i++) {
+            GenerateEntry(idList[i], &expectEntry);
+            if (foundList[i] != (idList[i] < entryNum) || (foundList[i] &&
+                memcmp(&batchList[i].chunkAddr, &expectEntry.chunkAddr,
+                sizeof(RecipeEntry_t)) != 0)) {
+                isCorrect = false;
+            }
+        }
+    }
+    free(foundList);
+    return isCorrect;
+}
+
+/**
+ * @brief run the load and the query phase on an index
+ * 
+ * @param indexName the index name
+ * @param dbObj the index
+ * @param entryNum the number of entries
+ * @param queryNum the number of queries
+ * @param batchSize the batch size
+ * @param dropCache whether to drop the page cache before the query phase
+ */
+void RunBench(const char* indexName, AbsDatabase* dbObj, uint64_t entryNum,
+    uint64_t queryNum, uint32_t batchSize, bool dropCache) {
+    double loadTime = LoadIndex(dbObj, entryNum, batchSize);
+    if (dropCache) {
+        DropPageCache();
+    }
+    vector<double> batchTimeList;
+    bool isCorrect = QueryIndex(dbObj, entryNum, queryNum, batchSize, batchTimeList);
+    double queryTime = 0;
+    for (auto batchTime : batchTimeList) {
+        queryTime += batchTime;
+    }
+    sort(batchTimeList.begin(), batchTimeList.end());
+    double p99Time = batchTimeList[batchTimeList.size() * 99 / 100];
+    fprintf(stderr, "%s: load (Kops/s): %lf, query (Kops/s): %lf, "
+        "batch latency avg (ms): %lf, p99 (ms): %lf, memory (MiB): %lu, correct: %s\n",
+        indexName, entryNum / loadTime / 1000.0, queryNum / queryTime / 1000.0,
+        queryTime / batchTimeList.size() * 1000.0, p99Time * 1000.0,
+        tool::ProcessMemUsage() / 1024, isCorrect ? "yes" : "no");
+    return ;
+}
+
+int main(int argc, char* argv[]) {
+    const char optString[] = "n:q:b:p:c";
+    int option;
+    uint64_t entryNumM = 10;
+    uint64_t queryNumM = 1;
+    uint32_t batchSize = 128;
+    string pathPrefix = "./indexBench";
+    bool dropCache = false;
+    while ((option = getopt(argc, argv, optString)) != -1) {
+        switch (option) {
+            case 'n': {
+                entryNumM = atol(optarg);
+                break;
+            }
+            case 'q': {
+                queryNumM = atol(optarg);
+                break;
+            }
+            case 'b': {
+                batchSize = atoi(optarg);
+                break;
+            }
+            case 'p': {
+                pathPrefix = optarg;
+                break;
+            }
+            case 'c': {
+                dropCache = true;
+                break;
+            }
+            default: {
+                Usage();
+            }
+        }
+    }
+    uint64_t entryNum = entryNumM * 1000 * 1000;
+    uint64_t queryNum = queryNumM * 1000 * 1000;
+    if (entryNum == 0 || queryNum == 0 || batchSize == 0) {
+        Usage();
+    }
+    fprintf(stderr, "entry num: %lu, query num: %lu, batch size: %u\n", entryNum,
+        queryNum, batchSize);
+
+    // start from the empty indexes
+    string levelDBName = pathPrefix + "-leveldb";
+    string ssdDBName = pathPrefix + "-ssd";
+    leveldb::DestroyDB(levelDBName, leveldb::Options());
+    const char* ssdSuffixList[] = {"", "-wal", "-dir", "-journal"};
+    for (auto ssdSuffix : ssdSuffixList) {
+        remove((ssdDBName + ssdSuffix).c_str());
+    }
+
+    // the memory of each run is reported by the RSS, the SSD index runs first
+    AbsDatabase* dbObj = new SsdLogDatabase(ssdDBName);
+    RunBench("SSD index", dbObj, entryNum, queryNum, batchSize, dropCache);
+    fprintf(stderr, "SSD index: page read per query: %lf\n",
+        ((SsdLogDatabase*)dbObj)->GetReadPerQuery());
+    delete dbObj;
+
+    dbObj = new LeveldbDatabase(levelDBName);
+    RunBench("LevelDB", dbObj, entryNum, queryNum, batchSize, dropCache);
+    delete dbObj;
+    return 0;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file topKBench.cc
+ * @brief compare the flat top-k table with the heap index (unordered_map +
+ * iterator heap) under the update and probing pattern of the freq index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/define.h"
+#include "../../include/constVar.h"
+#include "../Enclave/include/ecallEntryHeap.h"
+#include "../Enclave/include/ecallTopKTable.h"
+
+using namespace std;
+
+struct timeval sTime;
+struct timeval eTime;
+
+// the batch size of the probing, same as the default chunk batch
+const uint32_t PROBE_BATCH_SIZE = 128;
+
+void Usage() {
+    fprintf(stderr, "./topKBench -k [top-k] -u [chunk num] -n [op num (M)] -r [round]\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief mix a 64-bit value (splitmix64)
+ * 
+ * @param x the input
+ * @return uint64_t the mixed value
+ */
+uint64_t Mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief generate the skewed chunk stream, a few chunks are highly
+ * duplicate (log-uniform chunk ID)
+ * 
+ * @param generator the random generator
+ * @param chunkNum the number of distinct chunks
+ * @param opNum the stream length
+ * @param idList the chunk ID list
+ */
+void GenerateStream(mt19937_64& generator, uint64_t chunkNum, uint64_t opNum,
+    vector<uint32_t>& idList) {
+    uniform_real_distribution<double> dist(0, log(static_cast<double>(chunkNum)));
+    idList.resize(opNum);
+    for (uint64_t i = 0; i < opNum; i++) {
+        idList[i] = static_cast<uint32_t>(exp(dist(generator))) - 1;
+    }
+    return ;
+}
+
+/**
+ * @brief the update of the heap index, same as EcallFreqIndex
+ * 
+ * @param heapObj the heap index
+ * @param topK the top-k
+ * @param fpList the chunk fp list
+ * @param idList the chunk ID stream
+ * @param freqList the chunk freq
+ */
+void UpdateHeap(EcallEntryHeap* heapObj, uint64_t topK, uint8_t* fpList,
+    vector<uint32_t>& idList, vector<uint32_t>& freqList) {
+    string tmpHashStr;
+    tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
+    HeapItem_t tmpItem;
+    memset(&tmpItem, 0, sizeof(HeapItem_t));
+    for (auto id : idList) {
+        uint32_t chunkFreq = ++freqList[id];
+        if (heapObj->Size() == topK && chunkFreq < heapObj->TopEntry()) {
+            continue;
+        }
+        tmpHashStr.assign((char*)fpList + id * CHUNK_HASH_SIZE, CHUNK_HASH_SIZE);
+        if (heapObj->Contains(tmpHashStr)) {
+            heapObj->Update(tmpHashStr, chunkFreq);
+        } else {
+            if (heapObj->Size() == topK) {
+                heapObj->Pop();
+            }
+            tmpItem.chunkFreq = chunkFreq;
+            memcpy(&tmpItem.address, &id, sizeof(uint32_t));
+            heapObj->Add(tmpHashStr, tmpItem);
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief the update of the flat top-k table, same as EcallFreqIndex
+ * 
+ * @param tableObj the flat top-k table
+ * @param topK the top-k
+ * @param fpList the chunk fp list
+ * @param idList the chunk ID stream
+ * @param freqList the chunk freq
+ */
+void UpdateTable(EcallTopKTable* tableObj, uint64_t topK, uint8_t* fpList,
+    vector<uint32_t>& idList, vector<uint32_t>& freqList) {
+    HeapItem_t tmpItem;
+    memset(&tmpItem, 0, sizeof(HeapItem_t));
+    uint64_t opNum = idList.size();
+    for (uint64_t i = 0; i < opNum; i++) {
+        if (i + EcallTopKTable::PREFETCH_DIST < opNum) {
+            tableObj->Prefetch(fpList +
+                idList[i + EcallTopKTable::PREFETCH_DIST] * CHUNK_HASH_SIZE);
+        }
+        uint32_t id = idList[i];
+        uint32_t chunkFreq = ++freqList[id];
+        if (tableObj->Size() == topK && chunkFreq < tableObj->TopEntry()) {
+            continue;
+        }
+        uint8_t* chunkFp = fpList + id * CHUNK_HASH_SIZE;
+        HeapItem_t* heapItem = tableObj->Find(chunkFp);
+        if (heapItem != NULL) {
+            tableObj->Update(heapItem, chunkFreq);
+        } else {
+            if (tableObj->Size() == topK) {
+                tableObj->Pop();
+            }
+            tmpItem.chunkFreq = chunkFreq;
+            memcpy(&tmpItem.address, &id, sizeof(uint32_t));
+            tableObj->Add(chunkFp, tmpItem);
+        }
+    }
+    return ;
+}
+
+int main(int argc, char* argv[]) {
+    const char optString[] = "k:u:n:r:";
+    int option;
+    uint64_t topK = 512 * 1024;
+    uint64_t chunkNum = 0;
+    uint64_t opNumM = 16;
+    uint32_t roundNum = 3;
+    while ((option = getopt(argc, argv, optString)) != -1) {
+        switch (option) {
+            case 'k': {
+                topK = atol(optarg);
+                break;
+            }
+            case 'u': {
+                chunkNum = atol(optarg);
+                break;
+            }
+            case 'n': {
+                opNumM = atol(optarg);
+                break;
+            }
+            case 'r': {
+                roundNum = atoi(optarg);
+                break;
+            }
+            default: {
+                Usage();
+            }
+        }
+    }
+    if (chunkNum == 0) {
+        chunkNum = 8 * topK;
+    }
+    uint64_t opNum = opNumM * 1000 * 1000;
+
+    // prepare the chunk fp and the streams
+    uint8_t* fpList = (uint8_t*) malloc(chunkNum * CHUNK_HASH_SIZE);
+    for (uint64_t i = 0; i < chunkNum * CHUNK_HASH_SIZE / sizeof(uint64_t); i++) {
+        uint64_t tmpVal = Mix64(i);
+        memcpy(fpList + i * sizeof(uint64_t), &tmpVal, sizeof(uint64_t));
+    }
+    mt19937_64 generator(0);
+    vector<uint32_t> updateList;
+    vector<uint32_t> probeList;
+    GenerateStream(generator, chunkNum, opNum, updateList);
+    GenerateStream(generator, chunkNum, opNum, probeList);
+    fprintf(stderr, "top-k: %lu, chunk num: %lu, op num: %lu\n", topK, chunkNum, opNum);
+
+    // the update phase
+    double heapUpdateTime = 0;
+    double tableUpdateTime = 0;
+    EcallEntryHeap* heapObj = NULL;
+    EcallTopKTable* tableObj = NULL;
+    for (uint32_t round = 0; round < roundNum; round++) {
+        vector<uint32_t> freqList(chunkNum, 0);
+        delete heapObj;
+        heapObj = new EcallEntryHeap();
+        heapObj->SetHeapSize(topK);
+        gettimeofday(&sTime, NULL);
+        UpdateHeap(heapObj, topK, fpList, updateList, freqList);
+        gettimeofday(&eTime, NULL);
+        double roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < heapUpdateTime) {
+            heapUpdateTime = roundTime;
+        }
+
+        freqList.assign(chunkNum, 0);
+        delete tableObj;
+        tableObj = new EcallTopKTable(topK);
+        gettimeofday(&sTime, NULL);
+        UpdateTable(tableObj, topK, fpList, updateList, freqList);
+        gettimeofday(&eTime, NULL);
+        roundTime = tool::GetTimeDiff(sTime, eTime);
+        if (round == 0 || roundTime < tableUpdateTime) {
+            tableUpdateTime = roundTime;
+        }
+    }
+
+    // both follow the same heap order, compare them position by position
+    bool sameContent = (heapObj->Size() == tableObj->Size());
+    for (size_t i = 0; sameContent && i < heapObj->Size(); i++) {
+        auto heapIt = heapObj->_heap[i];
+        HeapItem_t* tableItem = tableObj->GetHeapItem(i);
+        sameContent = (memcmp(&heapIt->first[0], tableObj->GetHeapFp(i),
+            CHUNK_HASH_SIZE) == 0) &&
+            (heapIt->second.chunkFreq == tableItem->chunkFreq) &&
+            (memcmp(&heapIt->second.address, &tableItem->address,
+            sizeof(RecipeEntry_t)) == 0);
+    }
+
+    // the probing phase in batches
+    vector<InQueryEntry_t> batchList(PROBE_BATCH_SIZE);
+    vector<HeapItem_t> itemList(PROBE_BATCH_SIZE);
+    string tmpHashStr;
+    tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
+    double heapProbeTime = 0;
+    double tableProbeTime = 0;
+    uint64_t heapHitNum = 0;
+    uint64_t tableHitNum = 0;
+    for (uint32_t round = 0; round < roundNum; round++) {
+        double heapTime = 0;
+        double tableTime = 0;
+        heapHitNum = 0;
+        tableHitNum = 0;
+        for (uint64_t start = 0; start < opNum; start += PROBE_BATCH_SIZE) {
+            size_t batchSize = std::min(static_cast<uint64_t>(PROBE_BATCH_SIZE),
+                opNum - start);
+            for (size_t i = 0; i < batchSize; i++) {
+                memcpy(batchList[i].chunkHash, fpList + probeList[start + i] *
+                    CHUNK_HASH_SIZE, CHUNK_HASH_SIZE);
+            }
+
+            gettimeofday(&sTime, NULL);
+            for (size_t i = 0; i < batchSize; i++) {
+                tmpHashStr.assign((char*)batchList[i].chunkHash, CHUNK_HASH_SIZE);
+                if (heapObj->Contains(tmpHashStr)) {
+                    memcpy(&batchList[i].chunkAddr, heapObj->GetPriority(tmpHashStr),
+                        sizeof(RecipeEntry_t));
+                    heapHitNum++;
+                }
+            }
+            gettimeofday(&eTime, NULL);
+            heapTime += tool::GetTimeDiff(sTime, eTime);
+
+            gettimeofday(&sTime, NULL);
+            tableObj->FindBatch(&batchList[0], batchSize, &itemList[0]);
+            for (size_t i = 0; i < batchSize; i++) {
+                if (itemList[i].idx != EcallTopKTable::EMPTY_SLOT) {
+                    memcpy(&batchList[i].chunkAddr, &itemList[i].address,
+                        sizeof(RecipeEntry_t));
+                    tableHitNum++;
+                }
+            }
+            gettimeofday(&eTime, NULL);
+            tableTime += tool::GetTimeDiff(sTime, eTime);
+        }
+        if (round == 0 || heapTime < heapProbeTime) {
+            heapProbeTime = heapTime;
+        }
+        if (round == 0 || tableTime < tableProbeTime) {
+            tableProbeTime = tableTime;
+        }
+    }
+
+    double heapUpdateSpeed = opNum / heapUpdateTime / 1000.0 / 1000.0;
+    double tableUpdateSpeed = opNum / tableUpdateTime / 1000.0 / 1000.0;
+    double heapProbeSpeed = opNum / heapProbeTime / 1000.0 / 1000.0;
+    double tableProbeSpeed = opNum / tableProbeTime / 1000.0 / 1000.0;
+    fprintf(stderr, "heap index: update (Mops/s): %lf, probe (Mops/s): %lf, "
+        "hit num: %lu\n", heapUpdateSpeed, heapProbeSpeed, heapHitNum);
+    fprintf(stderr, "flat table: update (Mops/s): %lf, probe (Mops/s): %lf, "
+        "hit num: %lu\n", tableUpdateSpeed, tableProbeSpeed, tableHitNum);
+    fprintf(stderr, "update speedup: %lf, probe speedup: %lf, same content: %s\n",
+        tableUpdateSpeed / heapUpdateSpeed, tableProbeSpeed / heapProbeSpeed,
+        (sameContent && heapHitNum == tableHitNum) ? "yes" : "no");
+
+    delete heapObj;
+    delete tableObj;
+    free(fpList);
+    return 0;
+}
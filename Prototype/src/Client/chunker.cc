@@ -10,6 +10,8 @@
  */
 #include <stdio.h>
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include "../../include/chunker.h"
 struct timeval sTimeChunking;
 struct timeval eTimeChunking;
@@ -43,17 +45,12 @@ void Chunker::ChunkerInit(string path) {
     readSize_ = config.GetReadSize();
     readSize_ *= 1024 * 1024;
     slidingWinSize_ = config.GetSlidingWinSize();
+    chunkingThreadNum_ = config.GetChunkingThreadNum();
     
     switch (chunkerType_) {
         case FIXED_SIZE_CHUNKING: {
             tool::Logging(myName_.c_str(), "using fixed size chunking.\n");
-            waitingForChunkingBuffer_ = (uint8_t*) calloc(readSize_, sizeof(uint8_t));
-            chunkBuffer_ = (uint8_t*) calloc(maxChunkSize_ , sizeof(uint8_t));
-
-            if ((!waitingForChunkingBuffer_) || (!chunkBuffer_)) {
-                tool::Logging(myName_.c_str(), "memory malloc error.\n");
-                exit(EXIT_FAILURE);
-            }
+            readBufferPool_ = new ReadBufferPool(2, 0, readSize_);
 
             if (minChunkSize_ >= avgChunkSize_ || minChunkSize_ >= maxChunkSize_) {
                 tool::Logging(myName_.c_str(), "minChunkSize_ setting error.\n");
@@ -68,14 +65,8 @@ void Chunker::ChunkerInit(string path) {
         }
         case FAST_CDC: {
             tool::Logging(myName_.c_str(), "using FastCDC chunking.\n");
-            waitingForChunkingBuffer_ = (uint8_t*) calloc(readSize_, sizeof(uint8_t));
             pos_ = 0;
 
-            if (!waitingForChunkingBuffer_) {
-                tool::Logging(myName_.c_str(), "memory malloc error.\n");
-                exit(EXIT_FAILURE);
-            }
-
             if (minChunkSize_ >= avgChunkSize_ || minChunkSize_ >= maxChunkSize_) {
                 tool::Logging(myName_.c_str(), "minChunkSize_ setting error.\n");
                 exit(EXIT_FAILURE);
@@ -90,16 +81,31 @@ void Chunker::ChunkerInit(string path) {
             uint32_t bits = (uint32_t) round(log2(static_cast<double>(avgChunkSize_))); 
             maskS_ = GenerateFastCDCMask(bits + 1);
             maskL_ = GenerateFastCDCMask(bits - 1);
+            gearHashObj_ = new GearHash(GearHash::DetectKernelType());
+            tool::Logging(myName_.c_str(), "using %s gear hash kernel.\n",
+                GearHash::GetKernelName(gearHashObj_->GetKernelType()));
+            if (chunkingThreadNum_ > 1 && isRegularFile_) {
+                tool::Logging(myName_.c_str(), "using %lu chunking threads, "
+                    "region size: %lu MiB.\n", chunkingThreadNum_, readSize_ / MiB_2_B);
+                // each region reads the max chunk after it
+                readBufferPool_ = new ReadBufferPool(chunkingThreadNum_, 0,
+                    readSize_ + maxChunkSize_);
+            } else {
+                // each read buffer keeps a headroom of the max chunk size for the
+                // tail carried from the previous buffer
+                readBufferPool_ = new ReadBufferPool(2, maxChunkSize_, readSize_);
+                filledBufferMQ_ = new MessageQueue<ReadBuffer_t*>(2);
+            }
             break;
         }
         case FSL_TRACE: {
             tool::Logging(myName_.c_str(), "using FSL trace chunking.\n");
-            chunkBuffer_ = (uint8_t*) calloc(maxChunkSize_, sizeof(uint8_t));
+            readBufferPool_ = new ReadBufferPool(2, 0, readSize_);
             break;
         }
         case UBC_TRACE: {
             tool::Logging(myName_.c_str(), "using FSL trace chunking.\n");
-            chunkBuffer_ = (uint8_t*) calloc(maxChunkSize_, sizeof(uint8_t));
+            readBufferPool_ = new ReadBufferPool(2, 0, readSize_);
             break;
         }
         default: {
@@ -115,44 +121,71 @@ void Chunker::ChunkerInit(string path) {
  * 
  */
 Chunker::~Chunker() {
+    this->StopRegionWorkers();
     delete compressGenObj_;
-    switch (chunkerType_) {
-        case FIXED_SIZE_CHUNKING: {
-            free(chunkBuffer_);
-            free(waitingForChunkingBuffer_);
-            break;
-        }
-        case FAST_CDC: {
-            free(waitingForChunkingBuffer_);
-            break;
-        }
-        case FSL_TRACE: {
-            free(chunkBuffer_);
-            break;
-        }
-        case UBC_TRACE: {
-            free(chunkBuffer_);
-            break;
+    if (chunkerType_ == FAST_CDC) {
+        if (!(chunkingThreadNum_ > 1 && isRegularFile_)) {
+            delete filledBufferMQ_;
         }
+        delete gearHashObj_;
     }
+    delete readBufferPool_;
     if (chunkingFile_.is_open()) {
         chunkingFile_.close();
     }
 
+    uint64_t totalFileSize = prevFileSize_ + _recipe.recipeHead.fileSize;
     fprintf(stderr, "========Chunker Info========\n");
-    fprintf(stderr, "total file size: %lu\n", _recipe.recipeHead.fileSize);
-    fprintf(stderr, "total chunk num: %lu\n", _recipe.recipeHead.totalChunkNum);
+    if (prevFileNum_ != 0) {
+        fprintf(stderr, "total file num: %lu\n", prevFileNum_ + 1);
+    }
+    fprintf(stderr, "total file size: %lu\n", totalFileSize);
+    fprintf(stderr, "total chunk num: %lu\n", prevChunkNum_ +
+        _recipe.recipeHead.totalChunkNum);
     fprintf(stderr, "total thread running time: %lf\n", totalTime_);
+    fprintf(stderr, "total input read time: %lf\n", readTime_);
 #if (CHUNKING_BREAKDOWN == 1)
     fprintf(stderr, "total MQ insert time: %lf\n", insertTime_);
     fprintf(stderr, "total chunking time: %lf\n", (totalTime_ - insertTime_));
     double chunkingBreakTime = ((totalTime_ - insertTime_) * 1024.0) / 
-        (_recipe.recipeHead.fileSize / 1024.0 / 1024.0);
+        (totalFileSize / 1024.0 / 1024.0);
     fprintf(stderr, "chunking time: %lf\n", chunkingBreakTime);
 #endif
     fprintf(stderr, "============================\n");
 }
 
+/**
+ * @brief reuse the chunker and its read buffers for the next file, the
+ * chunks of the last file must be copied out
+ * 
+ * @param path the next file path
+ */
+void Chunker::Reset(string path) {
+    prevFileNum_++;
+    prevFileSize_ += _recipe.recipeHead.fileSize;
+    prevChunkNum_ += _recipe.recipeHead.totalChunkNum;
+    _recipe.recipeHead.fileSize = 0;
+    _recipe.recipeHead.totalChunkNum = 0;
+    pos_ = 0;
+
+    bool wasParallel = (chunkingThreadNum_ > 1 && isRegularFile_);
+    this->LoadChunkFile(path);
+    bool isParallel = (chunkingThreadNum_ > 1 && isRegularFile_);
+    if (chunkerType_ == FAST_CDC && wasParallel != isParallel) {
+        // the parallel and the streaming FastCDC use different read buffers
+        delete readBufferPool_;
+        if (isParallel) {
+            delete filledBufferMQ_;
+            readBufferPool_ = new ReadBufferPool(chunkingThreadNum_, 0,
+                readSize_ + maxChunkSize_);
+        } else {
+            readBufferPool_ = new ReadBufferPool(2, maxChunkSize_, readSize_);
+            filledBufferMQ_ = new MessageQueue<ReadBuffer_t*>(2);
+        }
+    }
+    return ;
+}
+
 /**
  * @brief the chunking process
  * 
@@ -164,7 +197,15 @@ void Chunker::Chunking() {
             break;
         }
         case FAST_CDC: {
-            FastCDC();
+            if (chunkingThreadNum_ > 1 && isRegularFile_) {
+                ParallelFastCDC();
+            } else {
+                if (chunkingThreadNum_ > 1) {
+                    tool::Logging(myName_.c_str(), "input is not a regular file, "
+                        "fall back to streaming FastCDC.\n");
+                }
+                FastCDC();
+            }
             break;
         }
         case FSL_TRACE: {
@@ -187,19 +228,29 @@ void Chunker::Chunking() {
 /**
  * @brief load the input file 
  * 
- * @param path the path of the chunking file
+ * @param path the path of the chunking file ("-" for stdin)
  */
 void Chunker::LoadChunkFile(string path) {
     if (chunkingFile_.is_open()) {
         chunkingFile_.close();
     }
 
-    chunkingFile_.open(path, ios_base::in | ios::binary);
+    if (path == "-") {
+        // stream the input from stdin (e.g., tar | DEBEClient), which cannot seek
+        chunkingFile_.open("/dev/stdin", ios_base::in | ios::binary);
+        isRegularFile_ = false;
+    } else {
+        chunkingFile_.open(path, ios_base::in | ios::binary);
+        struct stat statBuf;
+        isRegularFile_ = (stat(path.c_str(), &statBuf) == 0) && 
+            S_ISREG(statBuf.st_mode);
+    }
     if (!chunkingFile_.is_open()) {
         tool::Logging(myName_.c_str(), "open file: %s error.\n", 
             path.c_str());
         exit(EXIT_FAILURE);
     }
+    chunkingFilePath_ = path;
     return ;
 }
 
@@ -209,57 +260,40 @@ void Chunker::LoadChunkFile(string path) {
  */
 void Chunker::fixSizeChunking() {
     uint64_t chunkIDCnt = 0;
-    memset(chunkBuffer_, 0, sizeof(uint8_t) * avgChunkSize_);
     uint64_t fileSize = 0;
     bool end = false;
 
     // start chunking
     while(!end) {
-        memset((char*)waitingForChunkingBuffer_, 0, sizeof(uint8_t) * readSize_);
-        chunkingFile_.read((char*)waitingForChunkingBuffer_, sizeof(uint8_t) * readSize_);
+        ReadBuffer_t* readBuffer = readBufferPool_->Acquire();
+        uint8_t* waitingForChunkingBuffer = readBuffer->buffer;
+        chunkingFile_.read((char*)waitingForChunkingBuffer, sizeof(uint8_t) * readSize_);
         end = chunkingFile_.eof();
         size_t len = chunkingFile_.gcount();
         size_t chunkedSize = 0;
         if (len == 0) {
+            ReadBufferPool::Release(readBuffer);
             break;
         }
         fileSize += len;
         
         size_t remainSize = len;
         while (chunkedSize < len) {
-            Data_t tempChunk;
-            memset(chunkBuffer_, 0, sizeof(uint8_t) * avgChunkSize_);
             if (remainSize > avgChunkSize_) {
-                // direct copy avgChunkSize
-                memcpy(chunkBuffer_, waitingForChunkingBuffer_ + chunkedSize,
-                    avgChunkSize_);
-                tempChunk.chunk.chunkSize = avgChunkSize_;
-                memcpy(tempChunk.chunk.data, chunkBuffer_, avgChunkSize_);
+                this->InsertChunkToMQ(waitingForChunkingBuffer + chunkedSize,
+                    avgChunkSize_, readBuffer);
                 chunkedSize += avgChunkSize_;
                 remainSize -= avgChunkSize_;
             } else {
-                // copy the tail chunk
-                memcpy(chunkBuffer_, waitingForChunkingBuffer_ + chunkedSize,
-                    remainSize);
-                tempChunk.chunk.chunkSize = remainSize;
-                memcpy(tempChunk.chunk.data, chunkBuffer_, remainSize);
+                // the tail chunk
+                this->InsertChunkToMQ(waitingForChunkingBuffer + chunkedSize,
+                    remainSize, readBuffer);
                 chunkedSize += remainSize;
                 remainSize -= remainSize;
             }
-            tempChunk.dataType = DATA_CHUNK;
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&sTimeMQ, NULL);
-#endif
-            if (!outputMQ_->Push(tempChunk)) {
-                tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
-                exit(EXIT_FAILURE);
-            }
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&eTimeMQ, NULL);
-            insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
-#endif
             chunkIDCnt++;
         }
+        ReadBufferPool::Release(readBuffer);
     }
     _recipe.recipeHead.totalChunkNum = chunkIDCnt;
     _recipe.recipeHead.fileSize = fileSize;
@@ -270,7 +304,7 @@ void Chunker::fixSizeChunking() {
         exit(EXIT_FAILURE);
     }
     // set the done flag
-    outputMQ_->done_ = true;
+    outputMQ_->SetDone();
 
     return ;      
 }
@@ -289,6 +323,10 @@ void Chunker::FSLChunking() {
     double compressionRatio = 0;
     gettimeofday(&sTimeChunking, NULL);
 
+    // the generated chunks are packed into the pooled read buffers
+    ReadBuffer_t* chunkBuffer = readBufferPool_->Acquire();
+    uint64_t bufferOffset = 0;
+
     // start chunking
     while (true) {
         // read the fingerprint recipe
@@ -314,7 +352,6 @@ void Chunker::FSLChunking() {
 
         // get the size of this chunk
         uint32_t size = atoi(item);
-        memset(chunkBuffer_, 0, sizeof(uint8_t) * maxChunkSize_);
         if (size > maxChunkSize_) {
             size = maxChunkSize_;
         }
@@ -334,30 +371,21 @@ void Chunker::FSLChunking() {
         uint32_t compressionInt = static_cast<uint32_t>(round(compressionRatio / 0.1));
 
         // generate the chunk
-        compressGenObj_->GenerateChunkFromCanditdateSet(chunkBuffer_, compressionInt, size);
-        memcpy(chunkBuffer_, chunkFp, 6);
-
-        Data_t tempChunk;
-        tempChunk.chunk.chunkSize = size;
-        memcpy(tempChunk.chunk.data, chunkBuffer_, size);
-        tempChunk.dataType = DATA_CHUNK;
-
-#if (CHUNKING_BREAKDOWN == 1)
-        gettimeofday(&sTimeMQ, NULL);
-#endif
-        if (!outputMQ_->Push(tempChunk)) {
-            tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
-            exit(EXIT_FAILURE);
+        if (bufferOffset + size > readSize_) {
+            ReadBufferPool::Release(chunkBuffer);
+            chunkBuffer = readBufferPool_->Acquire();
+            bufferOffset = 0;
         }
-#if (CHUNKING_BREAKDOWN == 1)
-        gettimeofday(&eTimeMQ, NULL);
-        insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
-#endif
-        
+        uint8_t* chunkData = chunkBuffer->buffer + bufferOffset;
+        compressGenObj_->GenerateChunkFromCanditdateSet(chunkData, compressionInt, size);
+        memcpy(chunkData, chunkFp, 6);
+        this->InsertChunkToMQ(chunkData, size, chunkBuffer);
+        bufferOffset += size;
+
         chunkIDCnt++;
         fileSize += size;
-        memset(chunkBuffer_, 0, MAX_CHUNK_SIZE);
     }
+    ReadBufferPool::Release(chunkBuffer);
     _recipe.recipeHead.totalChunkNum = chunkIDCnt;
     _recipe.recipeHead.fileSize = fileSize;
     _recipe.dataType = RECIPE_END;
@@ -367,7 +395,7 @@ void Chunker::FSLChunking() {
         exit(EXIT_FAILURE);
     }
     // set the done flag
-    outputMQ_->done_ = true;
+    outputMQ_->SetDone();
 
     gettimeofday(&eTimeChunking, NULL);
     totalTime_ += tool::GetTimeDiff(sTimeChunking, eTimeChunking);
@@ -388,6 +416,10 @@ void Chunker::UBCChunking() {
     double compressionRatio = 0;
     gettimeofday(&sTimeChunking, NULL);
 
+    // the generated chunks are packed into the pooled read buffers
+    ReadBuffer_t* chunkBuffer = readBufferPool_->Acquire();
+    uint64_t bufferOffset = 0;
+
     // start chunking
     while (true) {
         // read the fingerprint recipe
@@ -413,7 +445,6 @@ void Chunker::UBCChunking() {
 
         // get the size of this chunk
         uint32_t size = atoi(item);
-        memset(chunkBuffer_, 0, sizeof(uint8_t) * maxChunkSize_);
         if (size > maxChunkSize_) {
             size = maxChunkSize_;
         }
@@ -433,29 +464,21 @@ void Chunker::UBCChunking() {
         uint32_t compressionInt = static_cast<uint32_t>(round(compressionRatio / 0.1));
 
         // generate the chunk
-        compressGenObj_->GenerateChunkFromCanditdateSet(chunkBuffer_, compressionInt, size);
-        memcpy(chunkBuffer_, chunkFp, 5);
-
-        Data_t tempChunk;
-        tempChunk.chunk.chunkSize = size;
-        memcpy(tempChunk.chunk.data, chunkBuffer_, size);
-        tempChunk.dataType = DATA_CHUNK;
-
-#if (CHUNKING_BREAKDOWN == 1)
-        gettimeofday(&sTimeMQ, NULL);
-#endif
-        if (!outputMQ_->Push(tempChunk)) {
-            tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
-            exit(EXIT_FAILURE);
+        if (bufferOffset + size > readSize_) {
+            ReadBufferPool::Release(chunkBuffer);
+            chunkBuffer = readBufferPool_->Acquire();
+            bufferOffset = 0;
         }
-#if (CHUNKING_BREAKDOWN == 1)
-        gettimeofday(&eTimeMQ, NULL);
-        insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
-#endif
-        
+        uint8_t* chunkData = chunkBuffer->buffer + bufferOffset;
+        compressGenObj_->GenerateChunkFromCanditdateSet(chunkData, compressionInt, size);
+        memcpy(chunkData, chunkFp, 5);
+        this->InsertChunkToMQ(chunkData, size, chunkBuffer);
+        bufferOffset += size;
+
         chunkIDCnt++;
         fileSize += size;
     }
+    ReadBufferPool::Release(chunkBuffer);
     _recipe.recipeHead.totalChunkNum = chunkIDCnt;
     _recipe.recipeHead.fileSize = fileSize;
     _recipe.dataType = RECIPE_END;
@@ -465,13 +488,44 @@ void Chunker::UBCChunking() {
         exit(EXIT_FAILURE);
     }
     // set the done flag
-    outputMQ_->done_ = true;
+    outputMQ_->SetDone();
 
     gettimeofday(&eTimeChunking, NULL);
     totalTime_ += tool::GetTimeDiff(sTimeChunking, eTimeChunking);
     return ;
 }
 
+/**
+ * @brief read the input to the pooled read buffers (run by the I/O thread)
+ * 
+ */
+void Chunker::ReadInput() {
+    struct timeval sTimeRead;
+    struct timeval eTimeRead;
+    ReadBuffer_t* readBuffer;
+    bool end = false;
+
+    while (!end) {
+        // wait until the chunks of this buffer are copied out by the sender
+        readBuffer = readBufferPool_->Acquire();
+        gettimeofday(&sTimeRead, NULL);
+        chunkingFile_.read((char*)readBuffer->buffer + maxChunkSize_, 
+            sizeof(uint8_t) * readSize_);
+        if (chunkingFile_.bad()) {
+            tool::Logging(myName_.c_str(), "read the input error.\n");
+            exit(EXIT_FAILURE);
+        }
+        end = chunkingFile_.eof();
+        readBuffer->dataSize = chunkingFile_.gcount();
+        readBuffer->end = end;
+        gettimeofday(&eTimeRead, NULL);
+        readTime_ += tool::GetTimeDiff(sTimeRead, eTimeRead);
+
+        filledBufferMQ_->Push(readBuffer);
+    }
+    return ;
+}
+
 /**
  * @brief use FastCDC to do the chunking 
  * 
@@ -479,45 +533,135 @@ void Chunker::UBCChunking() {
 void Chunker::FastCDC() {
     uint64_t fileSize = 0;
     uint64_t chunkIDCnt = 0;
-    size_t totalOffset = 0;
     bool end = false;
     gettimeofday(&sTimeChunking, NULL);
 
+    // the I/O thread reads the next buffer while this buffer is chunked
+    boost::thread* ioThread = new boost::thread(&Chunker::ReadInput, this);
+
+    ReadBuffer_t* readBuffer = NULL;
+    ReadBuffer_t* prevBuffer = NULL;
+    uint8_t* tailStart = NULL;
+    size_t tailSize = 0;
     while (!end) {
-        memset((char*)waitingForChunkingBuffer_, 0, sizeof(uint8_t) * readSize_);
-        chunkingFile_.read((char*)waitingForChunkingBuffer_, sizeof(uint8_t) * readSize_);
-        end = chunkingFile_.eof();
-        size_t len = chunkingFile_.gcount();
-        if (len == 0) {
-            break;
+        filledBufferMQ_->BlockingPop(readBuffer);
+        end = readBuffer->end;
+
+        // carry the tail (< max chunk size) to the headroom of this buffer, such
+        // that the input is read only once without seeking back
+        uint8_t* chunkingBuffer = readBuffer->buffer + maxChunkSize_ - tailSize;
+        if (prevBuffer != NULL) {
+            memcpy(chunkingBuffer, tailStart, tailSize);
+            ReadBufferPool::Release(prevBuffer);
         }
+
+        size_t len = tailSize + readBuffer->dataSize;
         size_t localOffset = 0;
         while (((len - localOffset) >= maxChunkSize_) || (end && (localOffset < len))) {
-            uint32_t cp = CutPoint(waitingForChunkingBuffer_ + localOffset, len - localOffset);
-            Data_t tempChunk;
-            tempChunk.chunk.chunkSize = cp;
-            memcpy(tempChunk.chunk.data, waitingForChunkingBuffer_ + localOffset, cp);
-            tempChunk.dataType = DATA_CHUNK;
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&sTimeMQ, NULL);
-#endif
-            if (!outputMQ_->Push(tempChunk)) {
-                tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
-                exit(EXIT_FAILURE);
-            }
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&eTimeMQ, NULL);
-            insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
-#endif
+            uint32_t cp = CutPoint(chunkingBuffer + localOffset, len - localOffset);
+            this->InsertChunkToMQ(chunkingBuffer + localOffset, cp, readBuffer);
             localOffset += cp;
             fileSize += cp;
             chunkIDCnt++;
         }
         pos_ += localOffset;
-        totalOffset += localOffset;
-    
-        chunkingFile_.seekg(totalOffset, std::ios_base::beg);
+        tailStart = chunkingBuffer + localOffset;
+        tailSize = len - localOffset;
+        prevBuffer = readBuffer;
+    }
+    ioThread->join();
+    delete ioThread;
+    ReadBufferPool::Release(prevBuffer);
+
+    _recipe.recipeHead.totalChunkNum = chunkIDCnt;
+    _recipe.recipeHead.fileSize = fileSize;
+    _recipe.dataType = RECIPE_END;
+
+    if (!outputMQ_->Push(_recipe)) {
+        tool::Logging(myName_.c_str(), "insert recipe end to output MQ error.\n");
+        exit(EXIT_FAILURE);
+    }
+    // set the done flag
+    outputMQ_->SetDone();
+
+    gettimeofday(&eTimeChunking, NULL);
+    totalTime_ += tool::GetTimeDiff(sTimeChunking, eTimeChunking);
+    return ;
+}
+
+/**
+ * @brief use FastCDC with a pool of workers to do the chunking
+ * 
+ */
+void Chunker::ParallelFastCDC() {
+    uint64_t fileSize = 0;
+    uint64_t chunkIDCnt = 0;
+    gettimeofday(&sTimeChunking, NULL);
+
+    chunkingFile_.seekg(0, ios_base::end);
+    uint64_t totalSize = chunkingFile_.tellg();
+    chunkingFile_.seekg(0, ios_base::beg);
+
+    // the workers read their regions from one descriptor without seeking
+    regionFd_ = open(chunkingFilePath_.c_str(), O_RDONLY);
+    if (regionFd_ < 0) {
+        tool::Logging(myName_.c_str(), "open file: %s error.\n",
+            chunkingFilePath_.c_str());
+        exit(EXIT_FAILURE);
+    }
+    this->StartRegionWorkers();
+
+    // keep one region in flight per worker, region k uses the slot k % workers
+    uint64_t regionNum = (totalSize + readSize_ - 1) / readSize_;
+    uint64_t issuedNum = 0;
+    while (issuedNum < regionNum && issuedNum < chunkingThreadNum_) {
+        this->IssueRegion(issuedNum, issuedNum * readSize_, totalSize);
+        issuedNum++;
     }
+
+    // the start of the next chunk in sequential FastCDC
+    uint64_t nextChunkStart = 0;
+    for (uint64_t regionID = 0; regionID < regionNum; regionID++) {
+        ChunkRegion_t* regionPtr = NULL;
+        regionDoneMQList_[regionID % chunkingThreadNum_]->BlockingPop(regionPtr);
+        ChunkRegion_t& region = *regionPtr;
+
+        // re-synchronize the region seam in file order while the later regions
+        // are chunked: the chunks from a worker are only used once its chunk
+        // boundary meets the sequential one
+        uint64_t regionEnd = region.startOffset + region.regionSize;
+        uint64_t cutOffset = region.startOffset;
+        auto cutIter = region.cutList.begin();
+        while (nextChunkStart < regionEnd) {
+            while (cutIter != region.cutList.end() && cutOffset < nextChunkStart) {
+                cutOffset += *cutIter;
+                cutIter++;
+            }
+            uint64_t localOffset = nextChunkStart - region.startOffset;
+            uint32_t cp;
+            if (cutIter != region.cutList.end() && cutOffset == nextChunkStart) {
+                cp = *cutIter;
+            } else {
+                cp = CutPoint(region.buffer + localOffset,
+                    region.bufferSize - localOffset);
+            }
+            this->InsertChunkToMQ(region.buffer + localOffset, cp,
+                region.readBuffer);
+            nextChunkStart += cp;
+            fileSize += cp;
+            chunkIDCnt++;
+        }
+        ReadBufferPool::Release(region.readBuffer);
+
+        // the slot of this region takes the next region
+        if (issuedNum < regionNum) {
+            this->IssueRegion(issuedNum, issuedNum * readSize_, totalSize);
+            issuedNum++;
+        }
+    }
+    close(regionFd_);
+    regionFd_ = -1;
+
     _recipe.recipeHead.totalChunkNum = chunkIDCnt;
     _recipe.recipeHead.fileSize = fileSize;
     _recipe.dataType = RECIPE_END;
@@ -527,13 +671,148 @@ void Chunker::FastCDC() {
         exit(EXIT_FAILURE);
     }
     // set the done flag
-    outputMQ_->done_ = true;
+    outputMQ_->SetDone();
 
     gettimeofday(&eTimeChunking, NULL);
     totalTime_ += tool::GetTimeDiff(sTimeChunking, eTimeChunking);
     return ;
 }
 
+/**
+ * @brief hand a region to its worker, wait until its read buffer is free
+ * 
+ * @param regionID the region ID in the file
+ * @param regionStart the offset of the region
+ * @param totalSize the file size
+ */
+void Chunker::IssueRegion(uint64_t regionID, uint64_t regionStart, uint64_t totalSize) {
+    uint64_t workerID = regionID % chunkingThreadNum_;
+    ChunkRegion_t* region = &regionList_[workerID];
+    // wait until the chunks of the last region in this buffer are copied out
+    region->readBuffer = readBufferPool_->Acquire();
+    region->buffer = region->readBuffer->buffer;
+    region->startOffset = regionStart;
+    region->regionSize = std::min(readSize_, totalSize - regionStart);
+    region->bufferSize = std::min(readSize_ + maxChunkSize_, totalSize - regionStart);
+    regionTaskMQList_[workerID]->Push(region);
+    return ;
+}
+
+/**
+ * @brief start the region workers, which are kept for the next files
+ * 
+ */
+void Chunker::StartRegionWorkers() {
+    if (!regionThList_.empty()) {
+        return ;
+    }
+    regionList_.resize(chunkingThreadNum_);
+    for (uint64_t i = 0; i < chunkingThreadNum_; i++) {
+        regionTaskMQList_.push_back(new MessageQueue<ChunkRegion_t*>(1));
+        regionDoneMQList_.push_back(new MessageQueue<ChunkRegion_t*>(1));
+    }
+    for (uint64_t i = 0; i < chunkingThreadNum_; i++) {
+        regionThList_.push_back(new boost::thread(&Chunker::RegionWorker, this, i));
+    }
+    return ;
+}
+
+/**
+ * @brief stop the region workers
+ * 
+ */
+void Chunker::StopRegionWorkers() {
+    for (auto taskMQ : regionTaskMQList_) {
+        taskMQ->SetDone();
+    }
+    for (auto it : regionThList_) {
+        it->join();
+        delete it;
+    }
+    for (size_t i = 0; i < regionTaskMQList_.size(); i++) {
+        delete regionTaskMQList_[i];
+        delete regionDoneMQList_[i];
+    }
+    regionThList_.clear();
+    regionTaskMQList_.clear();
+    regionDoneMQList_.clear();
+    return ;
+}
+
+/**
+ * @brief chunk the regions of a worker until the chunker stops
+ * 
+ * @param workerID the worker ID
+ */
+void Chunker::RegionWorker(uint64_t workerID) {
+    ChunkRegion_t* region;
+    while (regionTaskMQList_[workerID]->BlockingPop(region)) {
+        this->ChunkRegion(region);
+        regionDoneMQList_[workerID]->Push(region);
+    }
+    return ;
+}
+
+/**
+ * @brief chunk a region from its start offset (run by a worker)
+ * 
+ * @param region the region to be chunked
+ */
+void Chunker::ChunkRegion(ChunkRegion_t* region) {
+    uint64_t readSize = 0;
+    while (readSize < region->bufferSize) {
+        ssize_t ret = pread(regionFd_, region->buffer + readSize,
+            region->bufferSize - readSize, region->startOffset + readSize);
+        if (ret <= 0) {
+            tool::Logging(myName_.c_str(), "read region at %lu error.\n",
+                region->startOffset);
+            exit(EXIT_FAILURE);
+        }
+        readSize += ret;
+    }
+
+    // chunk as if a chunk starts at the region start
+    region->cutList.clear();
+    uint64_t localOffset = 0;
+    while (localOffset < region->regionSize) {
+        uint32_t cp = CutPoint(region->buffer + localOffset,
+            region->bufferSize - localOffset);
+        region->cutList.push_back(cp);
+        localOffset += cp;
+    }
+    return ;
+}
+
+/**
+ * @brief insert a chunk descriptor to the output MQ
+ * 
+ * @param data the chunk data
+ * @param size the chunk size
+ * @param readBuffer the read buffer holding the chunk
+ */
+void Chunker::InsertChunkToMQ(uint8_t* data, uint32_t size, ReadBuffer_t* readBuffer) {
+    // the chunk is not copied here, the sender releases the buffer after
+    // copying the chunk to its send buffer
+    Data_t tempChunk;
+    tempChunk.chunk.chunkSize = size;
+    tempChunk.chunk.data = data;
+    tempChunk.chunk.readBuffer = readBuffer;
+    tempChunk.dataType = DATA_CHUNK;
+    ReadBufferPool::Ref(readBuffer);
+#if (CHUNKING_BREAKDOWN == 1)
+    gettimeofday(&sTimeMQ, NULL);
+#endif
+    if (!outputMQ_->Push(tempChunk)) {
+        tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
+        exit(EXIT_FAILURE);
+    }
+#if (CHUNKING_BREAKDOWN == 1)
+    gettimeofday(&eTimeMQ, NULL);
+    insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
+#endif
+    return ;
+}
+
 /**
  * @brief compute the normal size 
  * 
@@ -580,19 +859,19 @@ uint32_t Chunker::CutPoint(const uint8_t* src, const uint32_t len) {
     uint32_t i;
     i = std::min(len, static_cast<uint32_t>(minChunkSize_)); 
     n = std::min(normalSize_, len);
-    for (; i < n; i++) {
-        fp = (fp >> 1) + GEAR[src[i]];
-        if (!(fp & maskS_)) {
+    if (i < n) {
+        i = gearHashObj_->Scan(src, i, n, maskS_, fp);
+        if (i < n) {
             return (i + 1);
         }
     }
 
     n = std::min(static_cast<uint32_t>(maxChunkSize_), len);
-    for (; i < n; i++) {
-        fp = (fp >> 1) + GEAR[src[i]];
-        if (!(fp & maskL_)) {
+    if (i < n) {
+        i = gearHashObj_->Scan(src, i, n, maskL_, fp);
+        if (i < n) {
             return (i + 1);
         }
-    } 
+    }
     return i;
 }
\ No newline at end of file
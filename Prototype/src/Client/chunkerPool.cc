@@ -0,0 +1,144 @@
+/**
+ * @file chunkerPool.cc
+ * @brief implement the interface defined in chunkerPool.h
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/chunkerPool.h"
+
+/**
+ * @brief Construct a new ChunkerPool object
+ * 
+ * @param fileList the files to upload
+ */
+ChunkerPool::ChunkerPool(vector<string>& fileList) {
+    fileList_ = fileList;
+    workerNum_ = config.GetFileWorkerNum();
+    if (workerNum_ == 0) {
+        tool::Logging(myName_.c_str(), "fileWorkerNum_ setting error.\n");
+        exit(EXIT_FAILURE);
+    }
+    workerNum_ = std::min(workerNum_, static_cast<uint64_t>(fileList_.size()));
+    slotList_ = new ChunkerSlot_t[workerNum_];
+    for (size_t i = 0; i < workerNum_; i++) {
+        slotList_[i].chunkerObj = NULL;
+        slotList_[i].outputMQ = NULL;
+        slotList_[i].readyFileID = UINT64_MAX;
+    }
+    sentFileNum_ = 0;
+    _totalFileSize = 0;
+    _totalChunkNum = 0;
+    tool::Logging(myName_.c_str(), "init the ChunkerPool, file num: %lu, "
+        "worker num: %lu.\n", fileList_.size(), workerNum_);
+}
+
+/**
+ * @brief Destroy the ChunkerPool object
+ * 
+ */
+ChunkerPool::~ChunkerPool() {
+    delete[] slotList_;
+    fprintf(stderr, "========ChunkerPool Info========\n");
+    fprintf(stderr, "total file num: %lu\n", fileList_.size());
+    fprintf(stderr, "total file size: %lu\n", _totalFileSize.load());
+    fprintf(stderr, "total chunk num: %lu\n", _totalChunkNum.load());
+    fprintf(stderr, "total thread running time: %lf\n", totalTime_);
+    fprintf(stderr, "================================\n");
+}
+
+/**
+ * @brief the main process, chunk the files with the workers
+ * 
+ */
+void ChunkerPool::Run() {
+    struct timeval sTotalTime;
+    struct timeval eTotalTime;
+    vector<boost::thread*> thList;
+    boost::thread::attributes attrs;
+    attrs.set_stack_size(THREAD_STACK_SIZE);
+
+    gettimeofday(&sTotalTime, NULL);
+    for (uint64_t i = 0; i < workerNum_; i++) {
+        thList.push_back(new boost::thread(attrs,
+            boost::bind(&ChunkerPool::ChunkFiles, this, i)));
+    }
+    for (auto it : thList) {
+        it->join();
+        delete it;
+    }
+    gettimeofday(&eTotalTime, NULL);
+    totalTime_ += tool::GetTimeDiff(sTotalTime, eTotalTime);
+    tool::Logging(myName_.c_str(), "thread exit.\n");
+    return ;
+}
+
+/**
+ * @brief chunk the files assigned to a worker
+ * 
+ * @param workerID the worker ID
+ */
+void ChunkerPool::ChunkFiles(uint64_t workerID) {
+    ChunkerSlot_t* slot = &slotList_[workerID];
+    // the worker reuses one chunker and its read buffers for all its files
+    Chunker* chunkerObj = NULL;
+    for (uint64_t fileID = workerID; fileID < fileList_.size(); fileID += workerNum_) {
+        if (chunkerObj == NULL) {
+            chunkerObj = new Chunker(fileList_[fileID]);
+        } else {
+            chunkerObj->Reset(fileList_[fileID]);
+        }
+        slot->chunkerObj = chunkerObj;
+        slot->outputMQ = new MessageQueue<Data_t>(CHUNK_QUEUE_SIZE);
+        slot->chunkerObj->SetOutputMQ(slot->outputMQ);
+        {
+            boost::unique_lock<boost::mutex> lck(slotLck_);
+            slot->readyFileID.store(fileID, boost::memory_order_release);
+            slotCond_.notify_all();
+        }
+
+        slot->chunkerObj->Chunking();
+        _totalFileSize += slot->chunkerObj->_recipe.recipeHead.fileSize;
+        _totalChunkNum += slot->chunkerObj->_recipe.recipeHead.totalChunkNum;
+
+        // the chunks refer to the read buffers of the chunker, wait until the
+        // sender copies all of them
+        {
+            boost::unique_lock<boost::mutex> lck(slotLck_);
+            while (sentFileNum_.load(boost::memory_order_acquire) <= fileID) {
+                slotCond_.wait(lck);
+            }
+        }
+        delete slot->outputMQ;
+    }
+    delete chunkerObj;
+    return ;
+}
+
+/**
+ * @brief Get the chunks of a file, wait until its chunker is ready
+ * 
+ * @param fileID the file ID
+ * @return MessageQueue<Data_t>* the MQ of the file chunks
+ */
+MessageQueue<Data_t>* ChunkerPool::GetFileMQ(uint64_t fileID) {
+    ChunkerSlot_t* slot = &slotList_[fileID % workerNum_];
+    boost::unique_lock<boost::mutex> lck(slotLck_);
+    while (slot->readyFileID.load(boost::memory_order_acquire) != fileID) {
+        slotCond_.wait(lck);
+    }
+    return slot->outputMQ;
+}
+
+/**
+ * @brief notify that all chunks of a file are sent, such that its slot can
+ * be reused
+ * 
+ * @param fileID the file ID
+ */
+void ChunkerPool::FinishFile(uint64_t fileID) {
+    boost::unique_lock<boost::mutex> lck(slotLck_);
+    sentFileNum_.store(fileID + 1, boost::memory_order_release);
+    slotCond_.notify_all();
+    return ;
+}
@@ -57,6 +57,9 @@ DataRetriever::~DataRetriever() {
     fprintf(stderr, "total thread running time: %lf\n", totalTime_);
     fprintf(stderr, "total recv chunk num: %lu\n", _totalRecvChunkNum);
     fprintf(stderr, "total recv data size: %lu\n", _totalRecvDataSize);
+    if (transferMode_ == COMPRESSED_TRANSFER) {
+        fprintf(stderr, "total transfer data size: %lu\n", _totalTransferDataSize);
+    }
     fprintf(stderr, "==================================\n");
 }
 
@@ -81,6 +84,8 @@ void DataRetriever::RestoreLogin(string localSecret, uint8_t* fileNameHash) {
     msgBuf.header->dataSize = 0;
     msgBuf.dataBuffer = msgBuf.sendBuffer + sizeof(NetworkHead_t);
     msgBuf.header->messageType = CLIENT_LOGIN_DOWNLOAD;
+    // request the transfer mode, the server replies the accepted one
+    msgBuf.header->currentItemNum = config.GetTransferMode();
 
     memcpy(msgBuf.dataBuffer + msgBuf.header->dataSize, fileNameHash,
         CHUNK_HASH_SIZE);
@@ -112,6 +117,10 @@ void DataRetriever::RestoreLogin(string localSecret, uint8_t* fileNameHash) {
         case SERVER_LOGIN_RESPONSE: {
             tool::Logging(myName_.c_str(), "recv the server login response well, " 
                 "the server is ready to process the request.\n");
+            transferMode_ = msgBuf.header->currentItemNum;
+            if (transferMode_ == COMPRESSED_TRANSFER) {
+                tool::Logging(myName_.c_str(), "use the compressed transfer mode.\n");
+            }
             break;
         }
         default: {
@@ -166,7 +175,7 @@ void DataRetriever::Run() {
                     // close the connection
                     dataSecureChannel_->Finish(conChannelRecord_);
                     // set the done flag
-                    outputMQ_->done_ = true;
+                    outputMQ_->SetDone();
                     jobDoneFlag = true;
                     break;
                 default:
@@ -210,8 +219,24 @@ void DataRetriever::ProcessChunkBatch() {
         // copy the data into the chunk
         memcpy(&tmpChunk.chunkSize, decBuffer_ + offset, sizeof(uint32_t));
         offset += sizeof(uint32_t);
-        memcpy(tmpChunk.data, decBuffer_ + offset, tmpChunk.chunkSize);
-        offset += tmpChunk.chunkSize;
+        if (transferMode_ == COMPRESSED_TRANSFER &&
+            (tmpChunk.chunkSize & COMPRESSED_CHUNK_FLAG)) {
+            // the server flags the compressed chunk, decompress it
+            tmpChunk.chunkSize &= ~COMPRESSED_CHUNK_FLAG;
+            _totalTransferDataSize += tmpChunk.chunkSize;
+            int decompressedSize = LZ4_decompress_safe((char*)decBuffer_ + offset,
+                (char*)tmpChunk.data, tmpChunk.chunkSize, MAX_CHUNK_SIZE);
+            if (decompressedSize <= 0) {
+                tool::Logging(myName_.c_str(), "decompress the restored chunk error.\n");
+                exit(EXIT_FAILURE);
+            }
+            offset += tmpChunk.chunkSize;
+            tmpChunk.chunkSize = decompressedSize;
+        } else {
+            _totalTransferDataSize += tmpChunk.chunkSize;
+            memcpy(tmpChunk.data, decBuffer_ + offset, tmpChunk.chunkSize);
+            offset += tmpChunk.chunkSize;
+        }
 
         // insert hte chunk to the MQ
         if (!outputMQ_->Push(tmpChunk)) {
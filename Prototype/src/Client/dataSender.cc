@@ -20,24 +20,35 @@ DataSender::DataSender(SSLConnection* dataSecureChannel) {
     // set up the configuration
     clientID_ = config.GetClientID();
     sendChunkBatchSize_ = config.GetSendChunkBatchSize();
+    minChunkBatchSize_ = config.GetMinChunkBatchSize();
+    maxChunkBatchSize_ = config.GetMaxChunkBatchSize();
+    curChunkBatchSize_ = sendChunkBatchSize_;
     dataSecureChannel_ = dataSecureChannel;
     
-    // init the send chunk buffer: header + <chunkSize, chunk content>
-    sendChunkBuf_.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) +
-        sendChunkBatchSize_ * sizeof(Chunk_t));
-    sendChunkBuf_.header = (NetworkHead_t*) sendChunkBuf_.sendBuffer;
-    sendChunkBuf_.header->clientID = clientID_;
-    sendChunkBuf_.header->currentItemNum = 0;
-    sendChunkBuf_.header->dataSize = 0;
-    sendChunkBuf_.dataBuffer = sendChunkBuf_.sendBuffer + sizeof(NetworkHead_t);
-
-    sendEncBuffer_.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) +
-        sendChunkBatchSize_ * sizeof(Chunk_t));
-    sendEncBuffer_.header = (NetworkHead_t*) sendEncBuffer_.sendBuffer;
-    sendEncBuffer_.header->clientID = clientID_;
-    sendEncBuffer_.header->currentItemNum = 0;
-    sendEncBuffer_.header->dataSize = 0;
-    sendEncBuffer_.dataBuffer = sendEncBuffer_.sendBuffer + sizeof(NetworkHead_t);
+    // init the batch buffers: header + <chunkSize, chunk content>, each
+    // upload stream can hold a batch in sending, a batch holds the max batch size
+    batchBufferNum_ = 2 + std::max(config.GetUploadStreamNum(), 1U);
+    freeBatchMQ_ = new MessageQueue<SendBatch_t*>(batchBufferNum_);
+    encBatchMQ_ = new MessageQueue<SendBatch_t*>(batchBufferNum_);
+    sendBatchMQ_ = new MessageQueue<SendBatch_t*>(batchBufferNum_);
+    batchList_ = new SendBatch_t[batchBufferNum_];
+    for (size_t i = 0; i < batchBufferNum_; i++) {
+        SendMsgBuffer_t* msgBufList[2] = {&batchList_[i].plainBuf,
+            &batchList_[i].encBuf};
+        for (auto msgBuf : msgBufList) {
+            msgBuf->sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) +
+                maxChunkBatchSize_ * sizeof(Chunk_t));
+            msgBuf->header = (NetworkHead_t*) msgBuf->sendBuffer;
+            msgBuf->header->clientID = clientID_;
+            msgBuf->header->currentItemNum = 0;
+            msgBuf->header->dataSize = 0;
+            msgBuf->dataBuffer = msgBuf->sendBuffer + sizeof(NetworkHead_t);
+        }
+        SendBatch_t* freeBatch = &batchList_[i];
+        freeBatchMQ_->Push(freeBatch);
+    }
+    curBatch_ = NULL;
+    compressBuffer_ = (uint8_t*) malloc(maxChunkBatchSize_ * sizeof(Chunk_t));
 
     // prepare the crypto tool
     cryptoObj_ = new CryptoPrimitive(CIPHER_TYPE, HASH_TYPE);
@@ -51,15 +62,60 @@ DataSender::DataSender(SSLConnection* dataSecureChannel) {
  * 
  */
 DataSender::~DataSender() {
-    free(sendEncBuffer_.sendBuffer);
-    free(sendChunkBuf_.sendBuffer);
-    EVP_CIPHER_CTX_free(cipherCtx_);
-    EVP_MD_CTX_free(mdCtx_);
-    delete cryptoObj_;
     fprintf(stderr, "========DataSender Info========\n");
     fprintf(stderr, "total send batch num: %lu\n", batchNum_);
+    fprintf(stderr, "total send file num: %lu\n", fileNum_);
+    fprintf(stderr, "upload stream num: %u\n", streamNum_);
+    for (size_t i = 0; i < streamBatchNumList_.size(); i++) {
+        fprintf(stderr, "stream %lu: send batch num: %lu\n", i,
+            streamBatchNumList_[i]);
+    }
+    fprintf(stderr, "batch tune window: %u, feedback num: %lu\n", batchTuneWindow_,
+        feedbackNum_);
+    fprintf(stderr, "batch size: %lu (%lu - %lu), grow num: %lu, shrink num: %lu\n",
+        curChunkBatchSize_.load(), minChunkBatchSize_, maxChunkBatchSize_, growNum_,
+        shrinkNum_);
+    fprintf(stderr, "compressed batch num: %lu\n", compressedBatchNum_);
+    fprintf(stderr, "batch data size: %lu, transfer data size: %lu\n",
+        rawBatchSize_, transferBatchSize_);
     fprintf(stderr, "total thread running time: %lf\n", totalTime_);
+    // the occupancy of a stage is its busy time over the running time, the
+    // stage with the highest occupancy is the bottleneck
+    double fillTime = totalTime_ - inputStallTime_ - fillStallTime_;
+    fprintf(stderr, "fill stage: busy time: %lf, wait chunker time: %lf, "
+        "wait free batch time: %lf, occupancy: %lf\n", fillTime,
+        inputStallTime_, fillStallTime_, fillTime / totalTime_);
+    fprintf(stderr, "encryption stage: busy time: %lf, wait batch time: %lf, "
+        "occupancy: %lf\n", encTime_, encStallTime_, encTime_ / totalTime_);
+    fprintf(stderr, "send stage: busy time: %lf, wait batch time: %lf, "
+        "occupancy: %lf\n", sendTime_, sendStallTime_, sendTime_ / totalTime_);
+    // the stalls of the queues to size them: a full queue blocks the producer,
+    // and an empty queue blocks the consumer
+    fprintf(stderr, "chunk queue: full stall num: %lu, empty stall num: %lu\n",
+        inputFullStallNum_, inputEmptyStallNum_);
+    fprintf(stderr, "batch queue: free empty stall num: %lu, enc empty stall "
+        "num: %lu, send empty stall num: %lu\n", freeBatchMQ_->GetEmptyStallNum(),
+        encBatchMQ_->GetEmptyStallNum(), sendBatchMQ_->GetEmptyStallNum());
     fprintf(stderr, "===============================\n");
+    SendBatch_t* freeBatch;
+    while (freeBatchMQ_->Pop(freeBatch)) {
+        ;
+    }
+    for (size_t i = 0; i < batchBufferNum_; i++) {
+        free(batchList_[i].plainBuf.sendBuffer);
+        free(batchList_[i].encBuf.sendBuffer);
+    }
+    delete[] batchList_;
+    free(compressBuffer_);
+    delete freeBatchMQ_;
+    delete encBatchMQ_;
+    delete sendBatchMQ_;
+    for (auto streamMQ : streamMQList_) {
+        delete streamMQ;
+    }
+    EVP_CIPHER_CTX_free(cipherCtx_);
+    EVP_MD_CTX_free(mdCtx_);
+    delete cryptoObj_;
 }
 
 /**
@@ -74,15 +130,17 @@ void DataSender::UploadLogin(string localSecret, uint8_t* fileNameHash) {
     cryptoObj_->GenerateHash(mdCtx_, (uint8_t*)&localSecret[0], localSecret.size(),
         masterKey);
 
-    // header + fileNameHash + Enc(masterKey)
+    // header + fileNameHash + Enc(masterKey) + requested upload options
     SendMsgBuffer_t msgBuf;
     msgBuf.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) + 
-        CHUNK_HASH_SIZE + CHUNK_HASH_SIZE);
+        CHUNK_HASH_SIZE + CHUNK_HASH_SIZE + sizeof(UploadLoginOpt_t));
     msgBuf.header = (NetworkHead_t*) msgBuf.sendBuffer;
     msgBuf.header->clientID = clientID_;
     msgBuf.header->dataSize = 0;
     msgBuf.dataBuffer = msgBuf.sendBuffer + sizeof(NetworkHead_t);
     msgBuf.header->messageType = CLIENT_LOGIN_UPLOAD;
+    // request the transfer mode, the server replies the accepted one
+    msgBuf.header->currentItemNum = config.GetTransferMode();
 
     memcpy(msgBuf.dataBuffer + msgBuf.header->dataSize, fileNameHash, 
         CHUNK_HASH_SIZE);
@@ -90,6 +148,13 @@ void DataSender::UploadLogin(string localSecret, uint8_t* fileNameHash) {
     cryptoObj_->SessionKeyEnc(cipherCtx_, masterKey, CHUNK_HASH_SIZE, 
         sessionKey_, msgBuf.dataBuffer + CHUNK_HASH_SIZE);
     msgBuf.header->dataSize += CHUNK_HASH_SIZE;
+    UploadLoginOpt_t loginOpt;
+    loginOpt.streamNum = std::max(config.GetUploadStreamNum(), 1U);
+    loginOpt.batchTuneWindow = config.GetBatchTuneWindow();
+    loginOpt.maxChunkBatchSize = maxChunkBatchSize_;
+    memcpy(msgBuf.dataBuffer + msgBuf.header->dataSize, &loginOpt,
+        sizeof(UploadLoginOpt_t));
+    msgBuf.header->dataSize += sizeof(UploadLoginOpt_t);
 
     // send the upload login request
     if (!dataSecureChannel_->SendData(conChannelRecord_.second, 
@@ -109,11 +174,90 @@ void DataSender::UploadLogin(string localSecret, uint8_t* fileNameHash) {
     if (msgBuf.header->messageType == SERVER_LOGIN_RESPONSE) {
         tool::Logging(myName_.c_str(), "recv the server login response well, "
             "the server is ready to process the request.\n");
+        transferMode_ = msgBuf.header->currentItemNum;
+        if (transferMode_ == COMPRESSED_TRANSFER) {
+            tool::Logging(myName_.c_str(), "use the compressed transfer mode.\n");
+        }
+        if (msgBuf.header->dataSize == sizeof(UploadLoginOpt_t)) {
+            memcpy(&loginOpt, msgBuf.dataBuffer, sizeof(UploadLoginOpt_t));
+            streamNum_ = loginOpt.streamNum;
+            batchTuneWindow_ = loginOpt.batchTuneWindow;
+            // the batches cannot exceed the upload buffers of the server
+            maxChunkBatchSize_ = std::min(maxChunkBatchSize_,
+                (uint64_t)loginOpt.maxChunkBatchSize);
+            minChunkBatchSize_ = std::min(minChunkBatchSize_, maxChunkBatchSize_);
+            curChunkBatchSize_ = std::min(sendChunkBatchSize_, maxChunkBatchSize_);
+        }
+        if (batchTuneWindow_ == 0) {
+            // the fixed batch size
+            minChunkBatchSize_ = curChunkBatchSize_;
+            maxChunkBatchSize_ = curChunkBatchSize_;
+        }
     } else {
         tool::Logging(myName_.c_str(), "server response is wrong, it is not ready.\n");
         exit(EXIT_FAILURE);
     }
 
+    free(msgBuf.sendBuffer);
+
+    // the server may accept fewer streams than requested
+    streamRecordList_.push_back(conChannelRecord_);
+    if (streamNum_ > 1) {
+        this->OpenStreams(masterKey);
+    }
+    streamBatchNumList_.resize(streamNum_, 0);
+    return ;
+}
+
+/**
+ * @brief open the secondary upload streams of the session
+ * 
+ * @param masterKey the client master key
+ */
+void DataSender::OpenStreams(uint8_t* masterKey) {
+    // header + Enc(masterKey), the streams share the session key
+    SendMsgBuffer_t msgBuf;
+    msgBuf.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) + 
+        CHUNK_HASH_SIZE);
+    msgBuf.header = (NetworkHead_t*) msgBuf.sendBuffer;
+    msgBuf.dataBuffer = msgBuf.sendBuffer + sizeof(NetworkHead_t);
+    uint32_t recvSize = 0;
+
+    for (uint32_t streamID = 1; streamID < streamNum_; streamID++) {
+        pair<int, SSL*> streamRecord = dataSecureChannel_->ConnectSSL();
+        msgBuf.header->clientID = clientID_;
+        msgBuf.header->messageType = SGX_RA_NOT_NEED;
+        msgBuf.header->dataSize = 0;
+        if (!dataSecureChannel_->SendData(streamRecord.second, msgBuf.sendBuffer,
+            sizeof(NetworkHead_t))) {
+            tool::Logging(myName_.c_str(), "send RA_NOT_NEED of stream %u fails.\n",
+                streamID);
+            exit(EXIT_FAILURE);
+        }
+
+        msgBuf.header->messageType = CLIENT_LOGIN_UPLOAD_STREAM;
+        msgBuf.header->currentItemNum = streamID;
+        msgBuf.header->dataSize = CHUNK_HASH_SIZE;
+        cryptoObj_->SessionKeyEnc(cipherCtx_, masterKey, CHUNK_HASH_SIZE, 
+            sessionKey_, msgBuf.dataBuffer);
+        if (!dataSecureChannel_->SendData(streamRecord.second, msgBuf.sendBuffer,
+            sizeof(NetworkHead_t) + msgBuf.header->dataSize)) {
+            tool::Logging(myName_.c_str(), "send the login of stream %u error.\n",
+                streamID);
+            exit(EXIT_FAILURE);
+        }
+        if (!dataSecureChannel_->ReceiveData(streamRecord.second, 
+            msgBuf.sendBuffer, recvSize) ||
+            msgBuf.header->messageType != SERVER_LOGIN_RESPONSE) {
+            tool::Logging(myName_.c_str(), "recv the login response of stream "
+                "%u error.\n", streamID);
+            exit(EXIT_FAILURE);
+        }
+        streamRecordList_.push_back(streamRecord);
+        streamMQList_.push_back(new MessageQueue<SendBatch_t*>(batchBufferNum_));
+    }
+    tool::Logging(myName_.c_str(), "open %u upload streams.\n", streamNum_);
+
     free(msgBuf.sendBuffer);
     return ;
 }
@@ -123,20 +267,46 @@ void DataSender::UploadLogin(string localSecret, uint8_t* fileNameHash) {
  * 
  */
 void DataSender::Run() {
-    bool jobDoneFlag = false;
     Data_t tmpChunk;
     struct timeval sTotalTime;
     struct timeval eTotalTime;
+    struct timeval sStallTime;
+    struct timeval eStallTime;
 
     tool::Logging(myName_.c_str(), "the main thread is running.\n");
     gettimeofday(&sTotalTime, NULL);
-    while (true) {
-        // the main loop
-        if (inputMQ_->done_ && inputMQ_->IsEmpty()) {
-            jobDoneFlag = true;
+
+    // start the encryption and sending stages
+    boost::thread* encThread = new boost::thread(&DataSender::EncryptBatches, this);
+    boost::thread* sendThread = new boost::thread(&DataSender::SendBatches, this);
+    vector<boost::thread*> streamThreadList;
+    for (uint32_t streamID = 1; streamID < streamNum_; streamID++) {
+        streamThreadList.push_back(new boost::thread(
+            &DataSender::SendStreamBatches, this, streamID));
+    }
+    freeBatchMQ_->BlockingPop(curBatch_);
+    curBatch_->lastBatch = false;
+
+    uint64_t fileNum = chunkerPoolObj_->GetFileNum();
+    for (uint64_t fileID = 0; fileID < fileNum; fileID++) {
+        // the first file is announced by the upload login
+        if (fileID != 0) {
+            this->ProcessNewFile(chunkerPoolObj_->GetFilePath(fileID));
         }
+        inputMQ_ = chunkerPoolObj_->GetFileMQ(fileID);
+
+        while (true) {
+            // the main loop, park the thread when the chunker is slower
+            if (!inputMQ_->Pop(tmpChunk)) {
+                gettimeofday(&sStallTime, NULL);
+                bool hasChunk = inputMQ_->BlockingPop(tmpChunk);
+                gettimeofday(&eStallTime, NULL);
+                inputStallTime_ += tool::GetTimeDiff(sStallTime, eStallTime);
+                if (!hasChunk) {
+                    break;
+                }
+            }
 
-        if (inputMQ_->Pop(tmpChunk)) {
             switch (tmpChunk.dataType) {
                 case DATA_CHUNK: {
                     // this is a normal chunk
@@ -145,10 +315,8 @@ void DataSender::Run() {
                 }
                 case RECIPE_END: {
                     // this is the recipe tail
-                    this->ProcessRecipeEnd(tmpChunk.recipeHead);
-
-                    // close the connection
-                    dataSecureChannel_->Finish(conChannelRecord_);
+                    this->ProcessRecipeEnd(tmpChunk.recipeHead,
+                        fileID == fileNum - 1);
                     break;
                 }
                 default: {
@@ -157,9 +325,26 @@ void DataSender::Run() {
                 }
             }
         }
-        if (jobDoneFlag) {
-            break;
-        }
+        inputFullStallNum_ += inputMQ_->GetFullStallNum();
+        inputEmptyStallNum_ += inputMQ_->GetEmptyStallNum();
+
+        // all chunks of this file are copied, its chunker can be released
+        chunkerPoolObj_->FinishFile(fileID);
+        fileNum_++;
+    }
+
+    // wait for the pipeline to send the last recipe end
+    encThread->join();
+    sendThread->join();
+    delete encThread;
+    delete sendThread;
+
+    // close the connection, the server releases the other streams once the
+    // primary stream is closed
+    dataSecureChannel_->Finish(conChannelRecord_);
+    for (auto it : streamThreadList) {
+        it->join();
+        delete it;
     }
 
     gettimeofday(&eTotalTime, NULL);
@@ -172,75 +357,410 @@ void DataSender::Run() {
  * @brief process the recipe end
  * 
  * @param recipeHead the pointer to the recipe end
+ * @param lastFile whether this is the last file of the session
  */
-void DataSender::ProcessRecipeEnd(FileRecipeHead_t& recipeHead) {
-    // first check the send chunk buffer
-    if (sendChunkBuf_.header->currentItemNum != 0) {
-        this->SendChunks();
-    }
-
-    // send the recipe end (without session encryption)
-    sendChunkBuf_.header->messageType = CLIENT_UPLOAD_RECIPE_END;
-    sendChunkBuf_.header->dataSize = sizeof(FileRecipeHead_t);
-    memcpy(sendChunkBuf_.dataBuffer, &recipeHead,
-        sizeof(FileRecipeHead_t));
-    if (!dataSecureChannel_->SendData(conChannelRecord_.second,
-        sendChunkBuf_.sendBuffer, 
-        sizeof(NetworkHead_t) + sendChunkBuf_.header->dataSize)) {
-        tool::Logging(myName_.c_str(), "send the recipe end error.\n");
-        exit(EXIT_FAILURE);
+void DataSender::ProcessRecipeEnd(FileRecipeHead_t& recipeHead, bool lastFile) {
+    // first check the current batch
+    if (curBatch_->plainBuf.header->currentItemNum != 0) {
+        this->SubmitBatch();
     }
+
+    // send the recipe end (without session encryption) after the chunks
+    SendMsgBuffer_t* plainBuf = &curBatch_->plainBuf;
+    plainBuf->header->messageType = CLIENT_UPLOAD_RECIPE_END;
+    plainBuf->header->dataSize = sizeof(FileRecipeHead_t);
+    memcpy(plainBuf->dataBuffer, &recipeHead, sizeof(FileRecipeHead_t));
+    curBatch_->lastBatch = lastFile;
+    if (lastFile) {
+        encBatchMQ_->Push(curBatch_);
+        curBatch_ = NULL;
+    } else {
+        this->SubmitBatch();
+    }
+    return ;
+}
+
+/**
+ * @brief notify the server of the next file in this session
+ * 
+ * @param filePath the path of the next file
+ */
+void DataSender::ProcessNewFile(string& filePath) {
+    // the server names the recipe by the hash of the file name, the same as
+    // the file name hash in the upload login
+    string fileName = filePath + to_string(clientID_);
+    SendMsgBuffer_t* plainBuf = &curBatch_->plainBuf;
+    plainBuf->header->messageType = CLIENT_UPLOAD_NEW_FILE;
+    plainBuf->header->dataSize = CHUNK_HASH_SIZE;
+    cryptoObj_->GenerateHash(mdCtx_, (uint8_t*)&fileName[0], fileName.size(),
+        plainBuf->dataBuffer);
+    this->SubmitBatch();
     return ;
 }
 
 /**
  * @brief process a chunk
  * 
- * @param inputChunk the input chunk
+ * @param inputChunk the input chunk descriptor
  */
-void DataSender::ProcessChunk(Chunk_t& inputChunk) {
-    // update the send chunk buffer
-    memcpy(sendChunkBuf_.dataBuffer + sendChunkBuf_.header->dataSize,
+void DataSender::ProcessChunk(ChunkDesc_t& inputChunk) {
+    // update the current batch, this is the only copy of the chunk
+    SendMsgBuffer_t* plainBuf = &curBatch_->plainBuf;
+    memcpy(plainBuf->dataBuffer + plainBuf->header->dataSize,
         &inputChunk.chunkSize, sizeof(uint32_t));
-    sendChunkBuf_.header->dataSize += sizeof(uint32_t);
-    memcpy(sendChunkBuf_.dataBuffer + sendChunkBuf_.header->dataSize,
+    plainBuf->header->dataSize += sizeof(uint32_t);
+    memcpy(plainBuf->dataBuffer + plainBuf->header->dataSize,
         inputChunk.data, inputChunk.chunkSize);
-    sendChunkBuf_.header->dataSize += inputChunk.chunkSize;
-    sendChunkBuf_.header->currentItemNum++;
+    plainBuf->header->dataSize += inputChunk.chunkSize;
+    plainBuf->header->currentItemNum++;
+
+    // the read buffer can be reused by the chunker once all its chunks are copied
+    ReadBufferPool::Release(inputChunk.readBuffer);
 
-    if (sendChunkBuf_.header->currentItemNum % sendChunkBatchSize_ == 0) {
-        this->SendChunks();
+    if (plainBuf->header->currentItemNum >= curChunkBatchSize_.load(
+        std::memory_order_relaxed)) {
+        this->SubmitBatch();
     }
     return ;
 }
 
 /**
- * @brief send a batch of chunks
+ * @brief submit the current batch to the encryption stage, and take a
+ * free batch for filling
  * 
- * @param chunkBuffer the chunk buffer
  */
-void DataSender::SendChunks() {
-    sendChunkBuf_.header->messageType = CLIENT_UPLOAD_CHUNK;
+void DataSender::SubmitBatch() {
+    struct timeval sStallTime;
+    struct timeval eStallTime;
+    if (curBatch_->plainBuf.header->currentItemNum != 0) {
+        curBatch_->plainBuf.header->messageType = CLIENT_UPLOAD_CHUNK;
+        batchNum_++;
+    }
+    encBatchMQ_->Push(curBatch_);
 
-    // encrypt the payload with the session key
-    cryptoObj_->SessionKeyEnc(cipherCtx_, sendChunkBuf_.dataBuffer,
-        sendChunkBuf_.header->dataSize, sessionKey_,
-        sendEncBuffer_.dataBuffer);
+    // wait for a batch sent by the sending stage
+    gettimeofday(&sStallTime, NULL);
+    freeBatchMQ_->BlockingPop(curBatch_);
+    gettimeofday(&eStallTime, NULL);
+    fillStallTime_ += tool::GetTimeDiff(sStallTime, eStallTime);
 
-    memcpy(sendEncBuffer_.header, sendChunkBuf_.header, 
-        sizeof(NetworkHead_t));
-    
-    if (!dataSecureChannel_->SendData(conChannelRecord_.second, 
-        sendEncBuffer_.sendBuffer, 
-        sizeof(NetworkHead_t) + sendEncBuffer_.header->dataSize)) {
-        tool::Logging(myName_.c_str(), "send the chunk batch error.\n");
+    // clear the batch
+    curBatch_->plainBuf.header->currentItemNum = 0;
+    curBatch_->plainBuf.header->dataSize = 0;
+    curBatch_->lastBatch = false;
+    return ;
+}
+
+/**
+ * @brief the encryption stage of the batch pipeline
+ * 
+ */
+void DataSender::EncryptBatches() {
+    struct timeval sStageTime;
+    struct timeval eStageTime;
+    SendBatch_t* batch;
+    bool end = false;
+
+    while (!end) {
+        gettimeofday(&sStageTime, NULL);
+        encBatchMQ_->BlockingPop(batch);
+        gettimeofday(&eStageTime, NULL);
+        encStallTime_ += tool::GetTimeDiff(sStageTime, eStageTime);
+
+        SendMsgBuffer_t* plainBuf = &batch->plainBuf;
+        SendMsgBuffer_t* encBuf = &batch->encBuf;
+        memcpy(encBuf->header, plainBuf->header, sizeof(NetworkHead_t));
+        if (plainBuf->header->messageType == CLIENT_UPLOAD_CHUNK) {
+            rawBatchSize_ += plainBuf->header->dataSize;
+            int compressedSize = 0;
+            if (transferMode_ == COMPRESSED_TRANSFER) {
+                compressedSize = LZ4_compress_fast((char*)plainBuf->dataBuffer,
+                    (char*)compressBuffer_, plainBuf->header->dataSize,
+                    plainBuf->header->dataSize, 3);
+            }
+            if (compressedSize > 0) {
+                // compress the batch before the session encryption
+                cryptoObj_->SessionKeyEnc(cipherCtx_, compressBuffer_,
+                    compressedSize, sessionKey_, encBuf->dataBuffer);
+                encBuf->header->messageType = CLIENT_UPLOAD_COMPRESSED_CHUNK;
+                encBuf->header->dataSize = compressedSize;
+                compressedBatchNum_++;
+            } else {
+                // encrypt the payload with the session key
+                cryptoObj_->SessionKeyEnc(cipherCtx_, plainBuf->dataBuffer,
+                    plainBuf->header->dataSize, sessionKey_, encBuf->dataBuffer);
+            }
+            transferBatchSize_ += encBuf->header->dataSize;
+        } else {
+            // the recipe end and the new file are sent without session encryption
+            memcpy(encBuf->dataBuffer, plainBuf->dataBuffer,
+                plainBuf->header->dataSize);
+            end = batch->lastBatch;
+        }
+        gettimeofday(&sStageTime, NULL);
+        encTime_ += tool::GetTimeDiff(eStageTime, sStageTime);
+
+        sendBatchMQ_->Push(batch);
+    }
+    return ;
+}
+
+/**
+ * @brief the sending stage of the batch pipeline
+ * 
+ */
+void DataSender::SendBatches() {
+    struct timeval sStageTime;
+    struct timeval eStageTime;
+    SendBatch_t* batch;
+    bool end = false;
+    bool chunkBatch = false;
+    gettimeofday(&windowStartTime_, NULL);
+
+    while (!end) {
+        gettimeofday(&sStageTime, NULL);
+        sendBatchMQ_->BlockingPop(batch);
+        gettimeofday(&eStageTime, NULL);
+        sendStallTime_ += tool::GetTimeDiff(sStageTime, eStageTime);
+
+        SendMsgBuffer_t* encBuf = &batch->encBuf;
+        end = batch->lastBatch;
+        chunkBatch = (encBuf->header->messageType == CLIENT_UPLOAD_CHUNK ||
+            encBuf->header->messageType == CLIENT_UPLOAD_COMPRESSED_CHUNK);
+        if (chunkBatch) {
+            windowChunkNum_ += encBuf->header->currentItemNum;
+        }
+        if (streamNum_ > 1) {
+            if (chunkBatch) {
+                // stripe the chunk batches over the streams
+                uint32_t streamID = chunkBatchSeq_ % streamNum_;
+                chunkBatchSeq_++;
+                streamBatchNumList_[streamID]++;
+                if (streamID != 0) {
+                    streamMQList_[streamID - 1]->Push(batch);
+                    gettimeofday(&sStageTime, NULL);
+                    sendTime_ += tool::GetTimeDiff(eStageTime, sStageTime);
+                    continue;
+                }
+            } else if (encBuf->header->messageType == CLIENT_UPLOAD_RECIPE_END) {
+                // the server waits for the sync of the other streams before
+                // it finalizes the recipe
+                SendBatch_t* syncFlag = NULL;
+                for (auto streamMQ : streamMQList_) {
+                    streamMQ->Push(syncFlag);
+                }
+            }
+        }
+        if (!dataSecureChannel_->SendData(conChannelRecord_.second, 
+            encBuf->sendBuffer, sizeof(NetworkHead_t) + encBuf->header->dataSize)) {
+            switch (encBuf->header->messageType) {
+                case CLIENT_UPLOAD_RECIPE_END: {
+                    tool::Logging(myName_.c_str(), "send the recipe end error.\n");
+                    break;
+                }
+                case CLIENT_UPLOAD_NEW_FILE: {
+                    tool::Logging(myName_.c_str(), "send the new file error.\n");
+                    break;
+                }
+                default: {
+                    tool::Logging(myName_.c_str(), "send the chunk batch error.\n");
+                }
+            }
+            exit(EXIT_FAILURE);
+        }
+        gettimeofday(&sStageTime, NULL);
+        sendTime_ += tool::GetTimeDiff(eStageTime, sStageTime);
+
+        this->ReleaseBatch(batch);
+
+        if (chunkBatch && batchTuneWindow_ != 0) {
+            // the server reports a window of the batches on the primary connection
+            primaryBatchNum_++;
+            if (primaryBatchNum_ % batchTuneWindow_ == 0) {
+                this->CloseTuneWindow();
+            }
+        }
+    }
+
+    for (auto streamMQ : streamMQList_) {
+        streamMQ->SetDone();
+    }
+
+    // receive the remaining feedbacks before closing the connection
+    BatchFeedback_t feedback;
+    while (!tuneWindowList_.empty()) {
+        this->RecvBatchFeedback(feedback);
+        tuneWindowList_.pop_front();
+    }
+    return ;
+}
+
+/**
+ * @brief the sending stage of a secondary upload stream
+ * 
+ * @param streamID the stream ID
+ */
+void DataSender::SendStreamBatches(uint32_t streamID) {
+    MessageQueue<SendBatch_t*>* streamMQ = streamMQList_[streamID - 1];
+    SSL* streamSSL = streamRecordList_[streamID].second;
+    NetworkHead_t syncHeader;
+    syncHeader.clientID = clientID_;
+    syncHeader.messageType = CLIENT_UPLOAD_STREAM_SYNC;
+    syncHeader.currentItemNum = 0;
+    syncHeader.dataSize = 0;
+    SendBatch_t* batch;
+
+    while (streamMQ->BlockingPop(batch)) {
+        if (batch == NULL) {
+            // all batches of the current file are sent
+            if (!dataSecureChannel_->SendData(streamSSL, (uint8_t*)&syncHeader,
+                sizeof(NetworkHead_t))) {
+                tool::Logging(myName_.c_str(), "send the sync of stream %u error.\n",
+                    streamID);
+                exit(EXIT_FAILURE);
+            }
+            continue;
+        }
+
+        SendMsgBuffer_t* encBuf = &batch->encBuf;
+        if (!dataSecureChannel_->SendData(streamSSL, encBuf->sendBuffer,
+            sizeof(NetworkHead_t) + encBuf->header->dataSize)) {
+            tool::Logging(myName_.c_str(), "send the chunk batch of stream %u error.\n",
+                streamID);
+            exit(EXIT_FAILURE);
+        }
+        this->ReleaseBatch(batch);
+    }
+
+    // close the stream connection
+    dataSecureChannel_->Finish(streamRecordList_[streamID]);
+    return ;
+}
+
+/**
+ * @brief return a sent batch to the filling stage
+ * 
+ * @param batch the sent batch
+ */
+void DataSender::ReleaseBatch(SendBatch_t* batch) {
+    if (streamNum_ == 1) {
+        freeBatchMQ_->Push(batch);
+        return ;
+    }
+    // the free batch queue has a single producer
+    boost::unique_lock<boost::mutex> lck(freeBatchLck_);
+    freeBatchMQ_->Push(batch);
+    return ;
+}
+
+/**
+ * @brief close the current batch window, and tune the batch size by
+ * the feedback of the previous window
+ * 
+ */
+void DataSender::CloseTuneWindow() {
+    struct timeval curTime;
+    gettimeofday(&curTime, NULL);
+    tuneWindowList_.push_back(make_pair(tool::GetTimeDiff(windowStartTime_,
+        curTime), windowChunkNum_));
+    windowStartTime_ = curTime;
+    windowChunkNum_ = 0;
+
+    // the feedback of the previous window arrives while this window is sent,
+    // so that the sending stage does not wait for the server
+    if (tuneWindowList_.size() == 2) {
+        BatchFeedback_t feedback;
+        this->RecvBatchFeedback(feedback);
+        this->TuneBatchSize(feedback, tuneWindowList_.front().first,
+            tuneWindowList_.front().second);
+        tuneWindowList_.pop_front();
+    }
+    return ;
+}
+
+/**
+ * @brief receive the feedback of a batch window from the server
+ * 
+ * @param feedback the feedback of the window
+ */
+void DataSender::RecvBatchFeedback(BatchFeedback_t& feedback) {
+    uint32_t recvSize = 0;
+    NetworkHead_t* header = (NetworkHead_t*)feedbackBuffer_;
+    if (!dataSecureChannel_->ReceiveData(conChannelRecord_.second,
+        feedbackBuffer_, recvSize) || header->messageType != SERVER_BATCH_FEEDBACK) {
+        tool::Logging(myName_.c_str(), "recv the batch feedback error.\n");
         exit(EXIT_FAILURE);
     }
-    
-    // clear the current chunk buffer
-    sendChunkBuf_.header->currentItemNum = 0;
-    sendChunkBuf_.header->dataSize = 0;
-    batchNum_++;
+    memcpy(&feedback, feedbackBuffer_ + sizeof(NetworkHead_t),
+        sizeof(BatchFeedback_t));
+    feedbackNum_++;
+    return ;
+}
+
+/**
+ * @brief tune the batch size to reduce the time per chunk
+ * 
+ * @param feedback the feedback of the window
+ * @param clientTime the sending time of the window in the client
+ * @param chunkNum the chunks sent in the window
+ */
+void DataSender::TuneBatchSize(BatchFeedback_t& feedback, double clientTime,
+    uint64_t chunkNum) {
+    if (feedback.chunkNum == 0 || chunkNum == 0) {
+        return ;
+    }
+    if (skipWindowNum_ != 0) {
+        // this window has the batches of both the old and the new size
+        skipWindowNum_--;
+        return ;
+    }
+
+    // the upload runs at the pace of the slower side: the client (chunking,
+    // encryption and network) or the enclave, which runs the streams concurrently
+    double clientCost = clientTime / chunkNum;
+    double enclaveCost = feedback.enclaveTime / feedback.chunkNum / streamNum_;
+    double chunkCost = std::max(clientCost, enclaveCost);
 
+    // hill climbing: keep the direction while the cost decreases, step back
+    // when it increases, and probe again after holding for a while
+    bool probe = true;
+    if (lastChunkCost_ != 0) {
+        double costChange = (chunkCost - lastChunkCost_) / lastChunkCost_;
+        if (costChange > BATCH_TUNE_TOLERANCE) {
+            // keep the cost of the previous size to hold after stepping back
+            tuneDirection_ = -tuneDirection_;
+            chunkCost = lastChunkCost_;
+        } else if (costChange >= -BATCH_TUNE_TOLERANCE &&
+            holdWindowNum_ < BATCH_TUNE_HOLD_WINDOW) {
+            holdWindowNum_++;
+            probe = false;
+        }
+    }
+    lastChunkCost_ = chunkCost;
+    if (!probe) {
+        return ;
+    }
+
+    uint64_t curSize = curChunkBatchSize_.load();
+    uint64_t newSize = (tuneDirection_ > 0) ? curSize * 2 : curSize / 2;
+    newSize = std::max(std::min(newSize, maxChunkBatchSize_), minChunkBatchSize_);
+    if (newSize == curSize) {
+        // reach the bound, probe the other direction
+        tuneDirection_ = -tuneDirection_;
+        newSize = (tuneDirection_ > 0) ? curSize * 2 : curSize / 2;
+        newSize = std::max(std::min(newSize, maxChunkBatchSize_), minChunkBatchSize_);
+    }
+    holdWindowNum_ = 0;
+    if (newSize == curSize) {
+        return ;
+    }
+
+    if (newSize > curSize) {
+        growNum_++;
+    } else {
+        shrinkNum_++;
+    }
+    curChunkBatchSize_.store(newSize);
+    skipWindowNum_ = 1;
     return ;
-}
\ No newline at end of file
+}
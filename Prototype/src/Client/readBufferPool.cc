@@ -0,0 +1,92 @@
+/**
+ * @file readBufferPool.cc
+ * @brief implement the interface defined in readBufferPool.h
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/readBufferPool.h"
+
+/**
+ * @brief Construct a new ReadBufferPool object
+ * 
+ * @param bufferNum the number of buffers
+ * @param headroomSize the size of the headroom before the data of each buffer
+ * @param dataSize the data size of each buffer
+ */
+ReadBufferPool::ReadBufferPool(uint32_t bufferNum, uint64_t headroomSize,
+    uint64_t dataSize) {
+    bufferNum_ = bufferNum;
+    headroomSize_ = headroomSize;
+    dataSize_ = dataSize;
+    bufferList_ = new ReadBuffer_t[bufferNum_];
+    for (size_t i = 0; i < bufferNum_; i++) {
+        bufferList_[i].buffer = (uint8_t*) malloc(headroomSize_ + dataSize_);
+        if (!bufferList_[i].buffer) {
+            tool::Logging(myName_.c_str(), "memory malloc error.\n");
+            exit(EXIT_FAILURE);
+        }
+        bufferList_[i].dataSize = 0;
+        bufferList_[i].end = false;
+        bufferList_[i].refCnt = 0;
+        bufferList_[i].parkedNum = 0;
+    }
+}
+
+/**
+ * @brief Destroy the ReadBufferPool object
+ * 
+ */
+ReadBufferPool::~ReadBufferPool() {
+    for (size_t i = 0; i < bufferNum_; i++) {
+        free(bufferList_[i].buffer);
+    }
+    delete[] bufferList_;
+    fprintf(stderr, "========ReadBufferPool Info========\n");
+    fprintf(stderr, "buffer num: %u\n", bufferNum_);
+    fprintf(stderr, "buffer size: %lu\n", headroomSize_ + dataSize_);
+    fprintf(stderr, "acquire num: %lu\n", acquireNum_);
+    fprintf(stderr, "acquire park num: %lu\n", parkNum_);
+    fprintf(stderr, "total acquire wait time: %lf\n", acquireWaitTime_);
+    fprintf(stderr, "===================================\n");
+}
+
+/**
+ * @brief acquire the next buffer, wait until all its chunks are copied out
+ * 
+ * @return ReadBuffer_t* the buffer held by the caller (refCnt = 1)
+ */
+ReadBuffer_t* ReadBufferPool::Acquire() {
+    struct timeval sTimeAcquire;
+    struct timeval eTimeAcquire;
+    ReadBuffer_t* readBuffer = &bufferList_[nextIndex_];
+    nextIndex_ = (nextIndex_ + 1) % bufferNum_;
+
+    gettimeofday(&sTimeAcquire, NULL);
+    // spin for MQ_SPIN_ROUND tries, and then park until the last reference
+    // is released (or MQ_PARK_TIMEOUT)
+    uint32_t spinRound = 0;
+    while (readBuffer->refCnt.load(boost::memory_order_acquire) != 0) {
+        if (spinRound < MQ_SPIN_ROUND) {
+            spinRound++;
+            continue;
+        }
+        boost::unique_lock<boost::mutex> lck(readBuffer->parkLck);
+        readBuffer->parkedNum.fetch_add(1, boost::memory_order_relaxed);
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        if (readBuffer->refCnt.load(boost::memory_order_acquire) != 0) {
+            parkNum_++;
+            readBuffer->freeCond.timed_wait(lck,
+                boost::posix_time::microseconds(MQ_PARK_TIMEOUT));
+        }
+        readBuffer->parkedNum.fetch_sub(1, boost::memory_order_relaxed);
+    }
+    gettimeofday(&eTimeAcquire, NULL);
+    acquireWaitTime_ += tool::GetTimeDiff(sTimeAcquire, eTimeAcquire);
+    acquireNum_++;
+
+    readBuffer->dataSize = 0;
+    readBuffer->end = false;
+    readBuffer->refCnt.store(1, boost::memory_order_relaxed);
+    return readBuffer;
+}
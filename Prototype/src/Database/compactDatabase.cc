@@ -0,0 +1,701 @@
+/**
+ * @file compactDatabase.cc
+ * @brief implement the compact in-memory index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/compactDatabase.h"
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const uint64_t COMPACT_SNAPSHOT_MAGIC = 0x4442454353504e31ULL;
+
+// the header of the snapshot file
+typedef struct {
+    uint64_t magic;
+    uint64_t keySize;
+    uint64_t valueSize;
+    uint64_t slotNum;
+    uint64_t itemNum;
+    uint64_t hasZeroKey;
+    uint8_t zeroValue[64];
+} CompactSnapshotHead_t;
+
+/**
+ * @brief write a buffer at an offset of a file
+ * 
+ * @param fd the file
+ * @param buffer the buffer
+ * @param size the buffer size
+ * @param offset the file offset
+ * @return true success
+ * @return false fail
+ */
+static bool WriteAt(int fd, const uint8_t* buffer, size_t size, off_t offset) {
+    size_t writeSize = 0;
+    while (writeSize < size) {
+        ssize_t ret = pwrite(fd, buffer + writeSize, size - writeSize, offset + writeSize);
+        if (ret <= 0) {
+            return false;
+        }
+        writeSize += ret;
+    }
+    return true;
+}
+
+/**
+ * @brief Construct a new Compact Database object
+ * 
+ * @param dbName the path of the snapshot file
+ */
+CompactDatabase::CompactDatabase(std::string dbName) {
+    this->OpenDB(dbName);
+}
+
+/**
+ * @brief Destroy the Compact Database object
+ * 
+ */
+CompactDatabase::~CompactDatabase() {
+    if (snapshotThread_.joinable()) {
+        snapshotThread_.join();
+    }
+    // merge the logs into the snapshot at exit
+    if (!this->MergeLog()) {
+        fprintf(stderr, "CompactDatabase: cannot write the snapshot, "
+            "the log is kept.\n");
+    }
+    if (logFd_ != -1) {
+        close(logFd_);
+    }
+    this->FreeTable();
+}
+
+/**
+ * @brief allocate an empty table in an anonymous mapping
+ * 
+ * @param slotNum the number of slots
+ */
+void CompactDatabase::AllocTable(uint64_t slotNum) {
+    mapSize_ = slotNum * SLOT_SIZE;
+    void* mapAddr = mmap(NULL, mapSize_, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapAddr == MAP_FAILED) {
+        fprintf(stderr, "CompactDatabase: cannot allocate the table of %lu slots.\n",
+            slotNum);
+        exit(EXIT_FAILURE);
+    }
+    mapAddr_ = (uint8_t*)mapAddr;
+    table_ = mapAddr_;
+    slotNum_ = slotNum;
+    return ;
+}
+
+/**
+ * @brief release the mapping of the table
+ * 
+ */
+void CompactDatabase::FreeTable() {
+    if (mapAddr_ != NULL) {
+        munmap(mapAddr_, mapSize_);
+        mapAddr_ = NULL;
+        table_ = NULL;
+    }
+    return ;
+}
+
+/**
+ * @brief find the slot of a key
+ * 
+ * @param key the key (not all zero)
+ * @param hashVal the hash value of the key
+ * @return uint8_t* the slot of the key, or the empty slot to put it
+ */
+uint8_t* CompactDatabase::FindSlot(const char* key, uint64_t hashVal) {
+    uint64_t idx = hashVal & (slotNum_ - 1);
+    while (true) {
+        uint8_t* slot = table_ + idx * SLOT_SIZE;
+        if (memcmp(slot, key, KEY_SIZE) == 0 || this->IsZeroKey(slot)) {
+            return slot;
+        }
+        idx = (idx + 1) & (slotNum_ - 1);
+    }
+}
+
+/**
+ * @brief put a pair into the table without the log
+ * 
+ * @param key the key
+ * @param value the value
+ */
+void CompactDatabase::PutItem(const char* key, const char* value) {
+    if (this->IsZeroKey((const uint8_t*)key)) {
+        if (!hasZeroKey_) {
+            itemNum_++;
+        }
+        hasZeroKey_ = true;
+        memcpy(zeroValue_, value, VALUE_SIZE);
+        return ;
+    }
+
+    uint8_t* slot = this->FindSlot(key, this->HashKey(key));
+    if (this->IsZeroKey(slot)) {
+        // a new key
+        if ((itemNum_ + 1) * MAX_LOAD_DEN > slotNum_ * MAX_LOAD_NUM) {
+            this->Resize(slotNum_ * 2);
+            slot = this->FindSlot(key, this->HashKey(key));
+        }
+        memcpy(slot, key, KEY_SIZE);
+        itemNum_++;
+    }
+    memcpy(slot + KEY_SIZE, value, VALUE_SIZE);
+    return ;
+}
+
+/**
+ * @brief move the items to a new table
+ * 
+ * @param newSlotNum the number of slots of the new table
+ */
+void CompactDatabase::Resize(uint64_t newSlotNum) {
+    uint8_t* oldMapAddr = mapAddr_;
+    size_t oldMapSize = mapSize_;
+    uint8_t* oldTable = table_;
+    uint64_t oldSlotNum = slotNum_;
+
+    this->AllocTable(newSlotNum);
+    for (uint64_t i = 0; i < oldSlotNum; i++) {
+        uint8_t* oldSlot = oldTable + i * SLOT_SIZE;
+        if (!this->IsZeroKey(oldSlot)) {
+            uint8_t* slot = this->FindSlot((char*)oldSlot, this->HashKey((char*)oldSlot));
+            memcpy(slot, oldSlot, SLOT_SIZE);
+        }
+    }
+    munmap(oldMapAddr, oldMapSize);
+    return ;
+}
+
+/**
+ * @brief write the records of the current call to the log, the caller
+ * holds tableLck_
+ * 
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::FlushLog() {
+    if (logBuffer_.size() == 0) {
+        return true;
+    }
+    // one write per call, a crash keeps the records written before
+    size_t writeSize = 0;
+    while (writeSize < logBuffer_.size()) {
+        ssize_t ret = write(logFd_, &logBuffer_[writeSize], logBuffer_.size() - writeSize);
+        if (ret < 0) {
+            fprintf(stderr, "CompactDatabase: cannot write the log, errno: %d\n", errno);
+            logBuffer_.clear();
+            return false;
+        }
+        writeSize += ret;
+    }
+    logItemNum_ += logBuffer_.size() / SLOT_SIZE;
+    logBuffer_.clear();
+
+    if (logItemNum_ >= MIN_SNAPSHOT_LOG_NUM && logItemNum_ * 4 >= itemNum_ &&
+        !snapshotRunning_ && !snapshotFailed_) {
+        // bound the replay time of the next startup
+        this->StartSnapshot();
+    }
+    return true;
+}
+
+/**
+ * @brief map the snapshot file
+ * 
+ * @return true success
+ * @return false no valid snapshot
+ */
+bool CompactDatabase::LoadSnapshot() {
+    int snapshotFd = open(dbName_.c_str(), O_RDONLY);
+    if (snapshotFd == -1) {
+        return false;
+    }
+    CompactSnapshotHead_t snapshotHead;
+    struct stat fileStat;
+    if (pread(snapshotFd, &snapshotHead, sizeof(CompactSnapshotHead_t), 0) !=
+        sizeof(CompactSnapshotHead_t) || fstat(snapshotFd, &fileStat) != 0) {
+        close(snapshotFd);
+        return false;
+    }
+    if (snapshotHead.magic != COMPACT_SNAPSHOT_MAGIC || snapshotHead.keySize != KEY_SIZE ||
+        snapshotHead.valueSize != VALUE_SIZE ||
+        (uint64_t)fileStat.st_size != SNAPSHOT_HEAD_SIZE + snapshotHead.slotNum * SLOT_SIZE) {
+        fprintf(stderr, "CompactDatabase: the snapshot does not match the format.\n");
+        close(snapshotFd);
+        return false;
+    }
+
+    // the private mapping loads the pages on demand, the updates are not
+    // written back to the file
+    void* mapAddr = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+        snapshotFd, 0);
+    close(snapshotFd);
+    if (mapAddr == MAP_FAILED) {
+        fprintf(stderr, "CompactDatabase: cannot map the snapshot, errno: %d\n", errno);
+        return false;
+    }
+    madvise(mapAddr, fileStat.st_size, MADV_RANDOM);
+    mapAddr_ = (uint8_t*)mapAddr;
+    mapSize_ = fileStat.st_size;
+    table_ = mapAddr_ + SNAPSHOT_HEAD_SIZE;
+    slotNum_ = snapshotHead.slotNum;
+    itemNum_ = snapshotHead.itemNum;
+    hasZeroKey_ = snapshotHead.hasZeroKey;
+    memcpy(zeroValue_, snapshotHead.zeroValue, VALUE_SIZE);
+    return true;
+}
+
+/**
+ * @brief insert the records of a log into the table
+ * 
+ * @param logFd the log file
+ * @return uint64_t the number of records
+ */
+uint64_t CompactDatabase::ReplayLog(int logFd) {
+    struct stat fileStat;
+    fstat(logFd, &fileStat);
+    uint64_t recordNum = fileStat.st_size / SLOT_SIZE;
+    if ((uint64_t)fileStat.st_size != recordNum * SLOT_SIZE) {
+        // drop the record torn by a crash
+        if (ftruncate(logFd, recordNum * SLOT_SIZE) != 0) {
+            fprintf(stderr, "CompactDatabase: cannot truncate the log.\n");
+        }
+    }
+
+    const size_t readRecordNum = 4096;
+    string readBuffer;
+    readBuffer.resize(readRecordNum * SLOT_SIZE);
+    uint64_t readNum = 0;
+    while (readNum < recordNum) {
+        size_t curNum = min((uint64_t)readRecordNum, recordNum - readNum);
+        if (pread(logFd, &readBuffer[0], curNum * SLOT_SIZE, readNum * SLOT_SIZE) !=
+            (ssize_t)(curNum * SLOT_SIZE)) {
+            fprintf(stderr, "CompactDatabase: cannot read the log.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < curNum; i++) {
+            const char* record = &readBuffer[i * SLOT_SIZE];
+            this->PutItem(record, record + KEY_SIZE);
+        }
+        readNum += curNum;
+    }
+    return recordNum;
+}
+
+/**
+ * @brief write the table to a new snapshot, the inserts during the
+ * copy are also in the current log
+ * 
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::WriteSnapshot() {
+    string tmpName = dbName_ + ".tmp";
+    int snapshotFd = open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (snapshotFd == -1) {
+        return false;
+    }
+
+    string sliceBuffer;
+    sliceBuffer.resize(SNAPSHOT_SLICE_SLOT_NUM * SLOT_SIZE);
+    string headBuffer;
+    headBuffer.resize(SNAPSHOT_HEAD_SIZE, 0);
+    CompactSnapshotHead_t* snapshotHead = (CompactSnapshotHead_t*)&headBuffer[0];
+    bool isSuccess = true;
+    bool isDone = false;
+    while (isSuccess && !isDone) {
+        uint64_t slotNum;
+        {
+            lock_guard<mutex> lock(tableLck_);
+            if (table_ == NULL) {
+                isSuccess = false;
+                break;
+            }
+            slotNum = slotNum_;
+        }
+
+        // only a slice is copied under the lock, a slot of the snapshot is
+        // either before or after an insert, the log replays the inserts
+        isDone = true;
+        uint64_t snapshotItemNum = 0;
+        for (uint64_t start = 0; start < slotNum; start += SNAPSHOT_SLICE_SLOT_NUM) {
+            uint64_t sliceSlotNum = min(SNAPSHOT_SLICE_SLOT_NUM, slotNum - start);
+            {
+                lock_guard<mutex> lock(tableLck_);
+                if (slotNum_ != slotNum) {
+                    // the table is resized, copy the new table from the start
+                    isDone = false;
+                    break;
+                }
+                memcpy(&sliceBuffer[0], table_ + start * SLOT_SIZE,
+                    sliceSlotNum * SLOT_SIZE);
+            }
+            for (uint64_t i = 0; i < sliceSlotNum; i++) {
+                if (!this->IsZeroKey((uint8_t*)&sliceBuffer[i * SLOT_SIZE])) {
+                    snapshotItemNum++;
+                }
+            }
+            if (!WriteAt(snapshotFd, (uint8_t*)&sliceBuffer[0], sliceSlotNum * SLOT_SIZE,
+                SNAPSHOT_HEAD_SIZE + start * SLOT_SIZE)) {
+                isSuccess = false;
+                break;
+            }
+        }
+
+        if (isSuccess && isDone) {
+            lock_guard<mutex> lock(tableLck_);
+            snapshotHead->magic = COMPACT_SNAPSHOT_MAGIC;
+            snapshotHead->keySize = KEY_SIZE;
+            snapshotHead->valueSize = VALUE_SIZE;
+            snapshotHead->slotNum = slotNum;
+            snapshotHead->itemNum = snapshotItemNum + (hasZeroKey_ ? 1 : 0);
+            snapshotHead->hasZeroKey = hasZeroKey_;
+            memcpy(snapshotHead->zeroValue, zeroValue_, VALUE_SIZE);
+        }
+    }
+
+    isSuccess = isSuccess && WriteAt(snapshotFd, (uint8_t*)&headBuffer[0],
+        SNAPSHOT_HEAD_SIZE, 0);
+    isSuccess = isSuccess && (fsync(snapshotFd) == 0);
+    close(snapshotFd);
+    if (!isSuccess || rename(tmpName.c_str(), dbName_.c_str()) != 0) {
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief rotate the log and write the snapshot in the background,
+ * the caller holds tableLck_
+ * 
+ */
+void CompactDatabase::StartSnapshot() {
+    if (snapshotThread_.joinable()) {
+        // the last snapshot is done
+        snapshotThread_.join();
+    }
+
+    // the table has all records of the current log, the snapshot copied
+    // from now on covers them, the new records go to a new log
+    if (rename(logName_.c_str(), oldLogName_.c_str()) != 0) {
+        fprintf(stderr, "CompactDatabase: cannot rotate the log, errno: %d\n", errno);
+        return ;
+    }
+    int newLogFd = open(logName_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (newLogFd == -1) {
+        fprintf(stderr, "CompactDatabase: cannot open the new log, errno: %d\n", errno);
+        if (rename(oldLogName_.c_str(), logName_.c_str()) != 0) {
+            // the records stay in the old log, which is replayed at startup
+            snapshotFailed_ = true;
+        }
+        return ;
+    }
+    close(logFd_);
+    logFd_ = newLogFd;
+    logItemNum_ = 0;
+
+    snapshotRunning_ = true;
+    snapshotThread_ = thread(&CompactDatabase::RunSnapshot, this);
+    return ;
+}
+
+/**
+ * @brief the snapshot thread, remove the old log after the snapshot
+ * 
+ */
+void CompactDatabase::RunSnapshot() {
+    if (this->WriteSnapshot()) {
+        remove(oldLogName_.c_str());
+    } else {
+        // another rotation would overwrite the old log, retry at exit
+        fprintf(stderr, "CompactDatabase: cannot write the snapshot, the old log is "
+            "kept until the exit.\n");
+        snapshotFailed_ = true;
+    }
+    snapshotRunning_ = false;
+    return ;
+}
+
+/**
+ * @brief merge the logs into the snapshot without the concurrent
+ * inserts (at startup and at exit)
+ * 
+ * @return true success
+ * @return false fail, the logs are kept
+ */
+bool CompactDatabase::MergeLog() {
+    if (!this->WriteSnapshot()) {
+        return false;
+    }
+    // the snapshot holds all records of the logs, replaying them again is harmless
+    remove(oldLogName_.c_str());
+    if (logFd_ != -1 && ftruncate(logFd_, 0) == 0) {
+        logItemNum_ = 0;
+    }
+    snapshotFailed_ = false;
+    return true;
+}
+
+/**
+ * @brief open a database
+ * 
+ * @param dbName the path of the snapshot file
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::OpenDB(std::string dbName) {
+    dbName_ = dbName;
+    logName_ = dbName + "-log";
+    oldLogName_ = dbName + "-log.old";
+    if (!this->LoadSnapshot()) {
+        fprintf(stderr, "CompactDatabase: no snapshot, create a new one.\n");
+        this->AllocTable(INIT_SLOT_NUM);
+        itemNum_ = 0;
+        hasZeroKey_ = false;
+    }
+
+    // the log of an unfinished snapshot is older than the current log
+    uint64_t oldLogItemNum = 0;
+    int oldLogFd = open(oldLogName_.c_str(), O_RDWR);
+    if (oldLogFd != -1) {
+        oldLogItemNum = this->ReplayLog(oldLogFd);
+        close(oldLogFd);
+    }
+    logFd_ = open(logName_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (logFd_ == -1) {
+        fprintf(stderr, "CompactDatabase: cannot open the log: %s\n", logName_.c_str());
+        return false;
+    }
+    logItemNum_ = this->ReplayLog(logFd_);
+    fprintf(stderr, "CompactDatabase: loaded index size: %lu, replayed log records: %lu\n",
+        itemNum_, oldLogItemNum + logItemNum_);
+    if (oldLogFd != -1 && !this->MergeLog()) {
+        // keep both logs, the log is not rotated again
+        fprintf(stderr, "CompactDatabase: cannot merge the old log into the snapshot.\n");
+        snapshotFailed_ = true;
+    }
+    return true;
+}
+
+/**
+ * @brief execute query over database
+ * 
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::Query(const std::string& key, std::string& value) {
+    return this->QueryBuffer(key.c_str(), key.size(), value);
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::Insert(const std::string& key, const std::string& value) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), value.c_str(), value.size());
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key the key
+ * @param buffer the value
+ * @param bufferSize the value size
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::InsertBuffer(const std::string& key, const char* buffer,
+    size_t bufferSize) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), buffer, bufferSize);
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key the key
+ * @param keySize the key size
+ * @param buffer the value
+ * @param bufferSize the value size
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+    size_t bufferSize) {
+    if (keySize != KEY_SIZE || bufferSize != VALUE_SIZE) {
+        fprintf(stderr, "CompactDatabase: only holds the (fingerprint, address) pairs.\n");
+        return false;
+    }
+    lock_guard<mutex> lock(tableLck_);
+    this->PutItem(key, buffer);
+    logBuffer_.append(key, KEY_SIZE);
+    logBuffer_.append(buffer, VALUE_SIZE);
+    return this->FlushLog();
+}
+
+/**
+ * @brief query the (key, value) pair
+ * 
+ * @param key the key
+ * @param keySize the key size
+ * @param value the value <return>
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::QueryBuffer(const char* key, size_t keySize, std::string& value) {
+    if (keySize != KEY_SIZE) {
+        return false;
+    }
+    if (this->IsZeroKey((const uint8_t*)key)) {
+        if (hasZeroKey_) {
+            value.assign((char*)zeroValue_, VALUE_SIZE);
+        }
+        return hasZeroKey_;
+    }
+    uint8_t* slot = this->FindSlot(key, this->HashKey(key));
+    if (this->IsZeroKey(slot)) {
+        return false;
+    }
+    value.assign((char*)slot + KEY_SIZE, VALUE_SIZE);
+    return true;
+}
+
+/**
+ * @brief query a batch of fixed-size keys, the value of a found key
+ * is copied to its value slot
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value slot
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the value slots
+ * @param itemNum the number of keys
+ * @param selectList the keys to query (NULL: all), the others are not found
+ * @param foundList the query result of each key
+ * @return size_t the number of found keys
+ */
+size_t CompactDatabase::MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+    size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+    bool* foundList) {
+    if (keySize != KEY_SIZE || valueSize > VALUE_SIZE) {
+        memset(foundList, 0, itemNum * sizeof(bool));
+        return 0;
+    }
+
+    // hash the whole batch first, then probe with the slots of the next
+    // keys in flight
+    vector<uint64_t> hashList(itemNum);
+    for (size_t i = 0; i < itemNum; i++) {
+        hashList[i] = this->HashKey(keyList + i * itemStride);
+    }
+    for (size_t i = 0; i < itemNum && i < PREFETCH_DIST; i++) {
+        __builtin_prefetch(table_ + (hashList[i] & (slotNum_ - 1)) * SLOT_SIZE);
+    }
+
+    size_t foundNum = 0;
+    for (size_t i = 0; i < itemNum; i++) {
+        if (i + PREFETCH_DIST < itemNum) {
+            __builtin_prefetch(table_ + (hashList[i + PREFETCH_DIST] & (slotNum_ - 1)) *
+                SLOT_SIZE);
+        }
+        foundList[i] = false;
+        if (selectList != NULL && !selectList[i]) {
+            continue;
+        }
+        const char* key = keyList + i * itemStride;
+        const uint8_t* value = NULL;
+        if (this->IsZeroKey((const uint8_t*)key)) {
+            value = hasZeroKey_ ? zeroValue_ : NULL;
+        } else {
+            uint8_t* slot = this->FindSlot(key, hashList[i]);
+            value = this->IsZeroKey(slot) ? NULL : slot + KEY_SIZE;
+        }
+        if (value != NULL) {
+            memcpy(valueList + i * itemStride, value, valueSize);
+            foundList[i] = true;
+            foundNum++;
+        }
+    }
+    return foundNum;
+}
+
+/**
+ * @brief insert a batch of fixed-size (key, value) pairs in one write
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the values
+ * @param itemNum the number of pairs
+ * @param selectList the pairs to insert (NULL: all)
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::WriteBatchBuffer(const char* keyList, size_t keySize,
+    const char* valueList, size_t valueSize, size_t itemStride, size_t itemNum,
+    const bool* selectList) {
+    if (keySize != KEY_SIZE || valueSize != VALUE_SIZE) {
+        fprintf(stderr, "CompactDatabase: only holds the (fingerprint, address) pairs.\n");
+        return false;
+    }
+    lock_guard<mutex> lock(tableLck_);
+    for (size_t i = 0; i < itemNum; i++) {
+        if (selectList != NULL && !selectList[i]) {
+            continue;
+        }
+        this->PutItem(keyList + i * itemStride, valueList + i * itemStride);
+        logBuffer_.append(keyList + i * itemStride, KEY_SIZE);
+        logBuffer_.append(valueList + i * itemStride, VALUE_SIZE);
+    }
+    return this->FlushLog();
+}
+
+/**
+ * @brief check whether the database has no key
+ * 
+ * @return true it is empty
+ * @return false it has keys
+ */
+bool CompactDatabase::IsEmpty() {
+    return itemNum_ == 0;
+}
+
+/**
+ * @brief pass each key of the database to the handler once, the
+ * database must not be modified during the scan
+ * 
+ * @param keyHandler the key handler
+ * @return true success
+ * @return false fail
+ */
+bool CompactDatabase::ScanKey(KeyHandler_t keyHandler) {
+    for (uint64_t i = 0; i < slotNum_; i++) {
+        const uint8_t* slot = table_ + i * SLOT_SIZE;
+        if (!this->IsZeroKey(slot)) {
+            keyHandler((const char*)slot, KEY_SIZE);
+        }
+    }
+    if (hasZeroKey_) {
+        uint8_t zeroKey[KEY_SIZE] = {0};
+        keyHandler((const char*)zeroKey, KEY_SIZE);
+    }
+    return true;
+}
@@ -22,6 +22,14 @@ AbsDatabase* DatabaseFactory::CreateDatabase(int type, string path) {
             fprintf(stderr, "Database: using In-Memory Index.\n");
             return new InMemoryDatabase(path);
             break;
+        case COMPACT_MEMORY:
+            fprintf(stderr, "Database: using Compact In-Memory Index.\n");
+            return new CompactDatabase(path);
+            break;
+        case SSD_LOG:
+            fprintf(stderr, "Database: using SSD-resident Index.\n");
+            return new SsdLogDatabase(path);
+            break;
         default:
             break;
     }
@@ -189,4 +189,99 @@ bool InMemoryDatabase::QueryBuffer(const char* key, size_t keySize, std::string&
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief query a batch of fixed-size keys, the value of a found key
+ * is copied to its value slot
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value slot
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the value slots
+ * @param itemNum the number of keys
+ * @param selectList the keys to query (NULL: all), the others are not found
+ * @param foundList the query result of each key
+ * @return size_t the number of found keys
+ */
+size_t InMemoryDatabase::MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+    size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+    bool* foundList) {
+    // reuse one key string for the whole batch
+    string keyStr;
+    keyStr.reserve(keySize);
+    size_t foundNum = 0;
+    for (size_t i = 0; i < itemNum; i++) {
+        if (selectList != NULL && !selectList[i]) {
+            foundList[i] = false;
+            continue;
+        }
+        keyStr.assign(keyList + i * itemStride, keySize);
+        auto findResult = indexObj_.find(keyStr);
+        if (findResult != indexObj_.end()) {
+            // it exists in the index
+            memcpy(valueList + i * itemStride, findResult->second.c_str(), valueSize);
+            foundList[i] = true;
+            foundNum++;
+        } else {
+            foundList[i] = false;
+        }
+    }
+    return foundNum;
+}
+
+/**
+ * @brief insert a batch of fixed-size (key, value) pairs in one write
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the values
+ * @param itemNum the number of pairs
+ * @param selectList the pairs to insert (NULL: all)
+ * @return true success
+ * @return false fail
+ */
+bool InMemoryDatabase::WriteBatchBuffer(const char* keyList, size_t keySize,
+    const char* valueList, size_t valueSize, size_t itemStride, size_t itemNum,
+    const bool* selectList) {
+    // no reserve here: a reserve per batch rehashes the table in small steps
+    // instead of the geometric growth of the inserts
+    string keyStr;
+    keyStr.reserve(keySize);
+    for (size_t i = 0; i < itemNum; i++) {
+        if (selectList != NULL && !selectList[i]) {
+            continue;
+        }
+        keyStr.assign(keyList + i * itemStride, keySize);
+        indexObj_[keyStr].assign(valueList + i * itemStride, valueSize);
+    }
+    return true;
+}
+
+/**
+ * @brief check whether the database has no key
+ * 
+ * @return true it is empty
+ * @return false it has keys
+ */
+bool InMemoryDatabase::IsEmpty() {
+    return indexObj_.empty();
+}
+
+/**
+ * @brief pass each key of the database to the handler once, the
+ * database must not be modified during the scan
+ * 
+ * @param keyHandler the key handler
+ * @return true success
+ * @return false fail
+ */
+bool InMemoryDatabase::ScanKey(KeyHandler_t keyHandler) {
+    for (auto& item : indexObj_) {
+        keyHandler(item.first.c_str(), item.first.size());
+    }
+    return true;
+}
@@ -136,4 +136,121 @@ bool LeveldbDatabase::QueryBuffer(const char* key, size_t keySize, std::string&
     leveldb::Status queryStatus = this->levelDBObj_->Get(leveldb::ReadOptions(),
         leveldb::Slice(key, keySize), &value);
     return queryStatus.ok();
-}
\ No newline at end of file
+}
+
+/**
+ * @brief query a batch of fixed-size keys, the value of a found key
+ * is copied to its value slot
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value slot
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the value slots
+ * @param itemNum the number of keys
+ * @param selectList the keys to query (NULL: all), the others are not found
+ * @param foundList the query result of each key
+ * @return size_t the number of found keys
+ */
+size_t LeveldbDatabase::MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+    size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+    bool* foundList) {
+    // probe the keys in the key order, the adjacent keys share the index
+    // and the data blocks in the block cache
+    vector<uint32_t> orderList;
+    orderList.reserve(itemNum);
+    for (size_t i = 0; i < itemNum; i++) {
+        if (selectList != NULL && !selectList[i]) {
+            foundList[i] = false;
+            continue;
+        }
+        orderList.push_back(i);
+    }
+    sort(orderList.begin(), orderList.end(), [&](uint32_t a, uint32_t b) {
+        return memcmp(keyList + a * itemStride, keyList + b * itemStride, keySize) < 0;
+    });
+
+    // the batch reads one snapshot
+    leveldb::ReadOptions readOptions;
+    readOptions.snapshot = levelDBObj_->GetSnapshot();
+    string value;
+    size_t foundNum = 0;
+    for (size_t i = 0; i < orderList.size(); i++) {
+        uint32_t idx = orderList[i];
+        leveldb::Status queryStatus = levelDBObj_->Get(readOptions,
+            leveldb::Slice(keyList + idx * itemStride, keySize), &value);
+        if (queryStatus.ok()) {
+            memcpy(valueList + idx * itemStride, &value[0], valueSize);
+            foundList[idx] = true;
+            foundNum++;
+        } else {
+            foundList[idx] = false;
+        }
+    }
+    levelDBObj_->ReleaseSnapshot(readOptions.snapshot);
+    return foundNum;
+}
+
+/**
+ * @brief insert a batch of fixed-size (key, value) pairs in one write
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the values
+ * @param itemNum the number of pairs
+ * @param selectList the pairs to insert (NULL: all)
+ * @return true success
+ * @return false fail
+ */
+bool LeveldbDatabase::WriteBatchBuffer(const char* keyList, size_t keySize,
+    const char* valueList, size_t valueSize, size_t itemStride, size_t itemNum,
+    const bool* selectList) {
+    leveldb::WriteBatch writeBatch;
+    for (size_t i = 0; i < itemNum; i++) {
+        if (selectList != NULL && !selectList[i]) {
+            continue;
+        }
+        writeBatch.Put(leveldb::Slice(keyList + i * itemStride, keySize),
+            leveldb::Slice(valueList + i * itemStride, valueSize));
+    }
+    leveldb::Status insertStatus = levelDBObj_->Write(leveldb::WriteOptions(), &writeBatch);
+    return insertStatus.ok();
+}
+
+/**
+ * @brief check whether the database has no key
+ * 
+ * @return true it is empty
+ * @return false it has keys
+ */
+bool LeveldbDatabase::IsEmpty() {
+    leveldb::Iterator* it = levelDBObj_->NewIterator(leveldb::ReadOptions());
+    it->SeekToFirst();
+    bool isEmpty = !it->Valid();
+    delete it;
+    return isEmpty;
+}
+
+/**
+ * @brief pass each key of the database to the handler once, the
+ * database must not be modified during the scan
+ * 
+ * @param keyHandler the key handler
+ * @return true success
+ * @return false fail
+ */
+bool LeveldbDatabase::ScanKey(KeyHandler_t keyHandler) {
+    leveldb::Iterator* it = levelDBObj_->NewIterator(leveldb::ReadOptions());
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        keyHandler(it->key().data(), it->key().size());
+    }
+    bool ret = it->status().ok();
+    if (!ret) {
+        fprintf(stderr, "LeveldbDatabase: scan the keys error: %s\n",
+            it->status().ToString().c_str());
+    }
+    delete it;
+    return ret;
+}
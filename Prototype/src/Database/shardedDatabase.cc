@@ -0,0 +1,341 @@
+/**
+ * @file shardedDatabase.cc
+ * @brief implement the concurrent out-enclave index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/shardedDatabase.h"
+#include "../../include/factoryDatabase.h"
+
+/**
+ * @brief Construct a new Sharded Database object
+ * 
+ * @param dbType the backend type of the shards
+ * @param dbName the db path
+ * @param shardNum the number of shards
+ */
+ShardedDatabase::ShardedDatabase(int dbType, std::string dbName, uint32_t shardNum) {
+    dbType_ = dbType;
+    shardNum_ = (shardNum == 0) ? 1 : shardNum;
+    if (dbType_ == LEVEL_DB) {
+        // LevelDB serves the concurrent reads and writes by itself
+        isThreadSafe_ = true;
+        if (shardNum_ != 1) {
+            fprintf(stderr, "ShardedDatabase: LevelDB is thread-safe, do not shard it.\n");
+            shardNum_ = 1;
+        }
+    }
+    this->OpenDB(dbName);
+}
+
+/**
+ * @brief Destroy the Sharded Database object
+ * 
+ */
+ShardedDatabase::~ShardedDatabase() {
+    for (auto shardObj : shardList_) {
+        delete shardObj;
+    }
+    if (shardLckList_ != NULL) {
+        for (uint32_t i = 0; i < shardNum_; i++) {
+            pthread_rwlock_destroy(&shardLckList_[i]);
+        }
+        delete[] shardLckList_;
+    }
+}
+
+/**
+ * @brief check the shard num of an existing index
+ * 
+ */
+void ShardedDatabase::CheckShardNum() {
+    // the index without the shard file is not sharded
+    string shardFileName = dbName_ + "-shard";
+    uint32_t oldShardNum = 1;
+    ifstream shardFile;
+    shardFile.open(shardFileName, ios_base::in);
+    bool isExist = shardFile.is_open();
+    if (isExist) {
+        shardFile >> oldShardNum;
+        shardFile.close();
+    } else {
+        isExist = (access(dbName_.c_str(), F_OK) == 0);
+    }
+    if (isExist && oldShardNum != shardNum_) {
+        // the keys cannot be found in the other shards
+        fprintf(stderr, "ShardedDatabase: the index has %u shards, cannot open it "
+            "with %u shards.\n", oldShardNum, shardNum_);
+        exit(EXIT_FAILURE);
+    }
+
+    if (shardNum_ != 1) {
+        ofstream newShardFile;
+        newShardFile.open(shardFileName, ios_base::trunc);
+        newShardFile << shardNum_ << endl;
+        newShardFile.close();
+    }
+    return ;
+}
+
+/**
+ * @brief open a database
+ * 
+ * @param dbName the db path, the shards are in dbName-shard<ID>
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::OpenDB(std::string dbName) {
+    dbName_ = dbName;
+    this->CheckShardNum();
+
+    DatabaseFactory dbFactory;
+    for (uint32_t i = 0; i < shardNum_; i++) {
+        string shardName = (shardNum_ == 1) ? dbName_ :
+            dbName_ + "-shard" + to_string(i);
+        AbsDatabase* shardObj = dbFactory.CreateDatabase(dbType_, shardName);
+        if (shardObj == NULL) {
+            fprintf(stderr, "ShardedDatabase: cannot create the shard: %s\n",
+                shardName.c_str());
+            exit(EXIT_FAILURE);
+        }
+        shardList_.push_back(shardObj);
+    }
+    shardLckList_ = new pthread_rwlock_t[shardNum_];
+    for (uint32_t i = 0; i < shardNum_; i++) {
+        pthread_rwlock_init(&shardLckList_[i], NULL);
+    }
+    fprintf(stderr, "ShardedDatabase: shard num: %u\n", shardNum_);
+    return true;
+}
+
+/**
+ * @brief execute query over database
+ * 
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::Query(const std::string& key, std::string& value) {
+    return this->QueryBuffer(key.c_str(), key.size(), value);
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::Insert(const std::string& key, const std::string& value) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), value.c_str(), value.size());
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key the key
+ * @param buffer the value
+ * @param bufferSize the value size
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::InsertBuffer(const std::string& key, const char* buffer,
+    size_t bufferSize) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), buffer, bufferSize);
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key the key
+ * @param keySize the key size
+ * @param buffer the value
+ * @param bufferSize the value size
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+    size_t bufferSize) {
+    uint32_t shardId = this->GetShardId(key, keySize);
+    this->LockShard(shardId, true);
+    bool ret = shardList_[shardId]->InsertBothBuffer(key, keySize, buffer, bufferSize);
+    this->UnlockShard(shardId);
+    return ret;
+}
+
+/**
+ * @brief query the (key, value) pair
+ * 
+ * @param key the key
+ * @param keySize the key size
+ * @param value the value <return>
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::QueryBuffer(const char* key, size_t keySize, std::string& value) {
+    uint32_t shardId = this->GetShardId(key, keySize);
+    this->LockShard(shardId, false);
+    bool ret = shardList_[shardId]->QueryBuffer(key, keySize, value);
+    this->UnlockShard(shardId);
+    return ret;
+}
+
+/**
+ * @brief query a batch of fixed-size keys, the value of a found key
+ * is copied to its value slot
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value slot
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the value slots
+ * @param itemNum the number of keys
+ * @param selectList the keys to query (NULL: all), the others are not found
+ * @param foundList the query result of each key
+ * @return size_t the number of found keys
+ */
+size_t ShardedDatabase::MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+    size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+    bool* foundList) {
+    size_t foundNum = 0;
+    if (shardNum_ == 1) {
+        this->LockShard(0, false);
+        foundNum = shardList_[0]->MultiQueryBuffer(keyList, keySize, valueList, valueSize,
+            itemStride, itemNum, selectList, foundList);
+        this->UnlockShard(0);
+        return foundNum;
+    }
+
+    // split the batch by shard, a shard is locked only for its own keys
+    uint32_t* shardIdList = (uint32_t*) malloc(itemNum * sizeof(uint32_t));
+    bool* shardSelectList = (bool*) malloc(itemNum * sizeof(bool));
+    bool* shardFoundList = (bool*) malloc(itemNum * sizeof(bool));
+    vector<size_t> shardItemNum(shardNum_, 0);
+    for (size_t i = 0; i < itemNum; i++) {
+        foundList[i] = false;
+        if (selectList != NULL && !selectList[i]) {
+            shardIdList[i] = shardNum_;
+            continue;
+        }
+        shardIdList[i] = this->GetShardId(keyList + i * itemStride, keySize);
+        shardItemNum[shardIdList[i]]++;
+    }
+
+    for (uint32_t shardId = 0; shardId < shardNum_; shardId++) {
+        if (shardItemNum[shardId] == 0) {
+            continue;
+        }
+        for (size_t i = 0; i < itemNum; i++) {
+            shardSelectList[i] = (shardIdList[i] == shardId);
+        }
+        this->LockShard(shardId, false);
+        foundNum += shardList_[shardId]->MultiQueryBuffer(keyList, keySize, valueList,
+            valueSize, itemStride, itemNum, shardSelectList, shardFoundList);
+        this->UnlockShard(shardId);
+        for (size_t i = 0; i < itemNum; i++) {
+            if (shardSelectList[i]) {
+                foundList[i] = shardFoundList[i];
+            }
+        }
+    }
+    free(shardIdList);
+    free(shardSelectList);
+    free(shardFoundList);
+    return foundNum;
+}
+
+/**
+ * @brief insert a batch of fixed-size (key, value) pairs in one write
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the values
+ * @param itemNum the number of pairs
+ * @param selectList the pairs to insert (NULL: all)
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::WriteBatchBuffer(const char* keyList, size_t keySize,
+    const char* valueList, size_t valueSize, size_t itemStride, size_t itemNum,
+    const bool* selectList) {
+    bool ret = true;
+    if (shardNum_ == 1) {
+        this->LockShard(0, true);
+        ret = shardList_[0]->WriteBatchBuffer(keyList, keySize, valueList, valueSize,
+            itemStride, itemNum, selectList);
+        this->UnlockShard(0);
+        return ret;
+    }
+
+    // split the batch by shard, a shard is locked only for its own pairs
+    uint32_t* shardIdList = (uint32_t*) malloc(itemNum * sizeof(uint32_t));
+    bool* shardSelectList = (bool*) malloc(itemNum * sizeof(bool));
+    vector<size_t> shardItemNum(shardNum_, 0);
+    for (size_t i = 0; i < itemNum; i++) {
+        if (selectList != NULL && !selectList[i]) {
+            shardIdList[i] = shardNum_;
+            continue;
+        }
+        shardIdList[i] = this->GetShardId(keyList + i * itemStride, keySize);
+        shardItemNum[shardIdList[i]]++;
+    }
+
+    for (uint32_t shardId = 0; shardId < shardNum_; shardId++) {
+        if (shardItemNum[shardId] == 0) {
+            continue;
+        }
+        for (size_t i = 0; i < itemNum; i++) {
+            shardSelectList[i] = (shardIdList[i] == shardId);
+        }
+        this->LockShard(shardId, true);
+        ret = shardList_[shardId]->WriteBatchBuffer(keyList, keySize, valueList,
+            valueSize, itemStride, itemNum, shardSelectList) && ret;
+        this->UnlockShard(shardId);
+    }
+    free(shardIdList);
+    free(shardSelectList);
+    return ret;
+}
+
+/**
+ * @brief check whether the database has no key
+ * 
+ * @return true it is empty
+ * @return false it has keys
+ */
+bool ShardedDatabase::IsEmpty() {
+    for (uint32_t shardId = 0; shardId < shardNum_; shardId++) {
+        this->LockShard(shardId, false);
+        bool isEmpty = shardList_[shardId]->IsEmpty();
+        this->UnlockShard(shardId);
+        if (!isEmpty) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief pass each key of the database to the handler once, the
+ * database must not be modified during the scan
+ * 
+ * @param keyHandler the key handler
+ * @return true success
+ * @return false fail
+ */
+bool ShardedDatabase::ScanKey(KeyHandler_t keyHandler) {
+    for (uint32_t shardId = 0; shardId < shardNum_; shardId++) {
+        this->LockShard(shardId, false);
+        bool ret = shardList_[shardId]->ScanKey(keyHandler);
+        this->UnlockShard(shardId);
+        if (!ret) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,919 @@
+/**
+ * @file ssdLogDatabase.cc
+ * @brief implement the SSD-resident index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/ssdLogDatabase.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+static const uint64_t SSD_SNAPSHOT_MAGIC = 0x4442455353444231ULL;
+static const uint32_t SSD_JOURNAL_MAGIC = 0x53534a31;
+
+// the header of the snapshot file
+typedef struct {
+    uint64_t magic;
+    uint64_t keySize;
+    uint64_t valueSize;
+    uint64_t pageSize;
+    uint64_t bucketNum;
+} SsdSnapshotHead_t;
+
+// the header of a page
+typedef struct {
+    uint32_t bucketId;
+    uint32_t itemNum;
+} SsdPageHead_t;
+
+// the header of the bucket updates of a flush in the journal
+typedef struct {
+    uint32_t magic;
+    uint32_t recordNum;
+} SsdJournalHead_t;
+
+typedef struct {
+    uint32_t bucketId;
+    SsdBucket_t bucket;
+} SsdJournalRecord_t;
+
+/**
+ * @brief Construct a new Ssd Log Database object
+ * 
+ * @param dbName the path of the page file
+ */
+SsdLogDatabase::SsdLogDatabase(std::string dbName) : queryNum_(0), readPageNum_(0) {
+    this->OpenDB(dbName);
+}
+
+/**
+ * @brief Destroy the Ssd Log Database object
+ * 
+ */
+SsdLogDatabase::~SsdLogDatabase() {
+    if (pageFd_ != -1) {
+        // write the buffer to the pages, then merge the journal into the snapshot
+        if (!this->FlushBuffer() || !this->WriteSnapshot()) {
+            fprintf(stderr, "SsdLogDatabase: cannot write the snapshot, "
+                "the journal is kept.\n");
+        }
+        close(pageFd_);
+    }
+    if (walFd_ != -1) {
+        close(walFd_);
+    }
+    if (journalFd_ != -1) {
+        close(journalFd_);
+    }
+    free(readPage_);
+    fprintf(stderr, "========SsdLogDatabase Info========\n");
+    fprintf(stderr, "item num: %lu\n", itemNum_);
+    fprintf(stderr, "bucket num: %lu, global depth: %u\n", bucketList_.size(),
+        globalDepth_);
+    fprintf(stderr, "page num: %lu, free page num: %lu\n", pageNum_,
+        freePageList_.size());
+    fprintf(stderr, "query num: %lu, page read per query: %lf\n", queryNum_.load(),
+        this->GetReadPerQuery());
+    fprintf(stderr, "flush num: %lu, written page num: %lu\n", flushNum_, writePageNum_);
+    fprintf(stderr, "===================================\n");
+}
+
+/**
+ * @brief read the page of a bucket
+ * 
+ * @param pageId the page ID
+ * @param pageBuffer the page <return>
+ */
+void SsdLogDatabase::ReadPage(uint32_t pageId, uint8_t* pageBuffer) {
+    if (pread(pageFd_, pageBuffer, PAGE_SIZE, (off_t)pageId * PAGE_SIZE) !=
+        (ssize_t)PAGE_SIZE) {
+        fprintf(stderr, "SsdLogDatabase: cannot read page %u, errno: %d\n", pageId, errno);
+        exit(EXIT_FAILURE);
+    }
+    return ;
+}
+
+/**
+ * @brief find a key in a page
+ * 
+ * @param pageBuffer the page
+ * @param key the key
+ * @return const uint8_t* the value of the key, NULL if not found
+ */
+const uint8_t* SsdLogDatabase::FindInPage(const uint8_t* pageBuffer, const char* key) {
+    SsdPageHead_t pageHead;
+    memcpy(&pageHead, pageBuffer, sizeof(SsdPageHead_t));
+    size_t itemNum = min((size_t)pageHead.itemNum, (size_t)PAGE_ITEM_NUM);
+    const uint8_t* entry = pageBuffer + PAGE_HEAD_SIZE;
+    for (size_t i = 0; i < itemNum; i++) {
+        if (memcmp(entry, key, KEY_SIZE) == 0) {
+            return entry + KEY_SIZE;
+        }
+        entry += ENTRY_SIZE;
+    }
+    return NULL;
+}
+
+/**
+ * @brief put a pair into the write buffer without the log
+ * 
+ * @param key the key
+ * @param value the value
+ */
+void SsdLogDatabase::PutItem(const char* key, const char* value) {
+    string keyStr(key, KEY_SIZE);
+    auto findRes = bufferIndex_.find(keyStr);
+    if (findRes != bufferIndex_.end()) {
+        memcpy(&bufferEntryList_[findRes->second * ENTRY_SIZE + KEY_SIZE], value,
+            VALUE_SIZE);
+        return ;
+    }
+    bufferIndex_[keyStr] = bufferEntryList_.size() / ENTRY_SIZE;
+    bufferEntryList_.append(key, KEY_SIZE);
+    bufferEntryList_.append(value, VALUE_SIZE);
+    return ;
+}
+
+/**
+ * @brief write the records of the current call to the log, flush the
+ * buffer if it is full
+ * 
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::FlushLog() {
+    // one write per call, a crash keeps the records written before
+    size_t writeSize = 0;
+    while (writeSize < walBuffer_.size()) {
+        ssize_t ret = write(walFd_, &walBuffer_[writeSize], walBuffer_.size() - writeSize);
+        if (ret < 0) {
+            fprintf(stderr, "SsdLogDatabase: cannot write the log, errno: %d\n", errno);
+            walBuffer_.clear();
+            return false;
+        }
+        writeSize += ret;
+    }
+    walBuffer_.clear();
+
+    if (bufferIndex_.size() >= WRITE_BUFFER_ITEM_NUM) {
+        return this->FlushBuffer();
+    }
+    return true;
+}
+
+/**
+ * @brief split a bucket by the next bit of the hash
+ * 
+ * @param bucketId the bucket ID
+ * @return uint32_t the new bucket ID
+ */
+uint32_t SsdLogDatabase::SplitBucket(uint32_t bucketId) {
+    uint16_t localDepth = bucketList_[bucketId].localDepth;
+    if (localDepth == globalDepth_) {
+        if (globalDepth_ == MAX_GLOBAL_DEPTH) {
+            fprintf(stderr, "SsdLogDatabase: the directory reaches the max depth.\n");
+            exit(EXIT_FAILURE);
+        }
+        // double the directory, the new half points to the same buckets
+        size_t dirSize = directory_.size();
+        directory_.resize(dirSize * 2);
+        std::copy(directory_.begin(), directory_.begin() + dirSize,
+            directory_.begin() + dirSize);
+        globalDepth_++;
+    }
+
+    SsdBucket_t newBucket;
+    newBucket.pageId = INVALID_PAGE;
+    newBucket.prefix = bucketList_[bucketId].prefix | (1U << localDepth);
+    newBucket.localDepth = localDepth + 1;
+    newBucket.itemNum = 0;
+    uint32_t newBucketId = bucketList_.size();
+    bucketList_.push_back(newBucket);
+    bucketList_[bucketId].localDepth++;
+
+    // the directory entries of the new prefix point to the new bucket
+    for (uint64_t i = newBucket.prefix; i < directory_.size();
+        i += (1ULL << newBucket.localDepth)) {
+        directory_[i] = newBucketId;
+    }
+    return newBucketId;
+}
+
+/**
+ * @brief write the pairs of a bucket to new pages, split the bucket
+ * if its pairs exceed a page
+ * 
+ * @param bucketId the bucket ID
+ * @param entryList the pairs of the bucket
+ */
+void SsdLogDatabase::BuildBucketPage(uint32_t bucketId, const string& entryList) {
+    size_t itemNum = entryList.size() / ENTRY_SIZE;
+    if (itemNum > PAGE_ITEM_NUM) {
+        uint16_t splitBit = bucketList_[bucketId].localDepth;
+        uint32_t newBucketId = this->SplitBucket(bucketId);
+        string lowList;
+        string highList;
+        for (size_t i = 0; i < itemNum; i++) {
+            const char* entry = &entryList[i * ENTRY_SIZE];
+            if ((this->HashKey(entry) >> splitBit) & 1) {
+                highList.append(entry, ENTRY_SIZE);
+            } else {
+                lowList.append(entry, ENTRY_SIZE);
+            }
+        }
+        this->BuildBucketPage(bucketId, lowList);
+        this->BuildBucketPage(newBucketId, highList);
+        return ;
+    }
+
+    bucketList_[bucketId].itemNum = itemNum;
+    flushBucketList_.push_back(bucketId);
+    if (itemNum == 0) {
+        bucketList_[bucketId].pageId = INVALID_PAGE;
+        return ;
+    }
+    // the page ID is set after the page is written
+    size_t pageOffset = flushPageList_.size();
+    flushPageList_.resize(pageOffset + PAGE_SIZE, 0);
+    SsdPageHead_t pageHead;
+    pageHead.bucketId = bucketId;
+    pageHead.itemNum = itemNum;
+    memcpy(&flushPageList_[pageOffset], &pageHead, sizeof(SsdPageHead_t));
+    memcpy(&flushPageList_[pageOffset + PAGE_HEAD_SIZE], entryList.c_str(),
+        entryList.size());
+    return ;
+}
+
+/**
+ * @brief write the new pages in the ascending page order
+ * 
+ * @param pageIdList the page ID of each new page
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::WritePages(const vector<uint32_t>& pageIdList) {
+    size_t startIdx = 0;
+    while (startIdx < pageIdList.size()) {
+        // one write per run of adjacent pages
+        size_t endIdx = startIdx + 1;
+        while (endIdx < pageIdList.size() &&
+            pageIdList[endIdx] == pageIdList[endIdx - 1] + 1) {
+            endIdx++;
+        }
+        const char* runBuffer = &flushPageList_[startIdx * PAGE_SIZE];
+        size_t runSize = (endIdx - startIdx) * PAGE_SIZE;
+        off_t runOffset = (off_t)pageIdList[startIdx] * PAGE_SIZE;
+        size_t writeSize = 0;
+        while (writeSize < runSize) {
+            ssize_t ret = pwrite(pageFd_, runBuffer + writeSize, runSize - writeSize,
+                runOffset + writeSize);
+            if (ret <= 0) {
+                fprintf(stderr, "SsdLogDatabase: cannot write the pages, errno: %d\n",
+                    errno);
+                return false;
+            }
+            writeSize += ret;
+        }
+        startIdx = endIdx;
+    }
+    return fdatasync(pageFd_) == 0;
+}
+
+/**
+ * @brief append the bucket updates of a flush to the journal
+ * 
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::WriteJournal() {
+    string journalBuffer;
+    SsdJournalHead_t journalHead;
+    journalHead.magic = SSD_JOURNAL_MAGIC;
+    journalHead.recordNum = flushBucketList_.size();
+    journalBuffer.append((char*)&journalHead, sizeof(SsdJournalHead_t));
+    for (auto bucketId : flushBucketList_) {
+        SsdJournalRecord_t journalRecord;
+        journalRecord.bucketId = bucketId;
+        journalRecord.bucket = bucketList_[bucketId];
+        journalBuffer.append((char*)&journalRecord, sizeof(SsdJournalRecord_t));
+    }
+
+    // the updates of a flush are applied together, a torn tail is dropped
+    size_t writeSize = 0;
+    while (writeSize < journalBuffer.size()) {
+        ssize_t ret = write(journalFd_, &journalBuffer[writeSize],
+            journalBuffer.size() - writeSize);
+        if (ret <= 0) {
+            fprintf(stderr, "SsdLogDatabase: cannot write the journal, errno: %d\n", errno);
+            return false;
+        }
+        writeSize += ret;
+    }
+    journalRecordNum_ += flushBucketList_.size();
+    return fdatasync(journalFd_) == 0;
+}
+
+/**
+ * @brief merge the write buffer into the pages of its buckets
+ * 
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::FlushBuffer() {
+    if (bufferIndex_.empty()) {
+        return true;
+    }
+
+    // group the pairs by bucket, each bucket is read and written once
+    size_t bufferItemNum = bufferEntryList_.size() / ENTRY_SIZE;
+    vector<pair<uint32_t, uint32_t>> groupList(bufferItemNum);
+    for (size_t i = 0; i < bufferItemNum; i++) {
+        groupList[i].first = this->GetBucketId(this->HashKey(
+            &bufferEntryList_[i * ENTRY_SIZE]));
+        groupList[i].second = i;
+    }
+    sort(groupList.begin(), groupList.end());
+
+    flushPageList_.clear();
+    flushBucketList_.clear();
+    vector<uint32_t> oldPageList;
+    string entryList;
+    size_t groupIdx = 0;
+    while (groupIdx < bufferItemNum) {
+        uint32_t bucketId = groupList[groupIdx].first;
+        uint32_t oldPageId = bucketList_[bucketId].pageId;
+        entryList.clear();
+        if (oldPageId != INVALID_PAGE) {
+            this->ReadPage(oldPageId, readPage_);
+            SsdPageHead_t pageHead;
+            memcpy(&pageHead, readPage_, sizeof(SsdPageHead_t));
+            entryList.assign((char*)readPage_ + PAGE_HEAD_SIZE,
+                min((size_t)pageHead.itemNum, (size_t)PAGE_ITEM_NUM) * ENTRY_SIZE);
+            oldPageList.push_back(oldPageId);
+        }
+        size_t oldItemNum = entryList.size() / ENTRY_SIZE;
+
+        for (; groupIdx < bufferItemNum && groupList[groupIdx].first == bucketId;
+            groupIdx++) {
+            const char* entry = &bufferEntryList_[groupList[groupIdx].second * ENTRY_SIZE];
+            // the keys in the buffer are distinct, only the old pairs may match
+            bool isOldKey = false;
+            for (size_t i = 0; i < oldItemNum; i++) {
+                if (memcmp(&entryList[i * ENTRY_SIZE], entry, KEY_SIZE) == 0) {
+                    memcpy(&entryList[i * ENTRY_SIZE + KEY_SIZE], entry + KEY_SIZE,
+                        VALUE_SIZE);
+                    isOldKey = true;
+                    break;
+                }
+            }
+            if (!isOldKey) {
+                entryList.append(entry, ENTRY_SIZE);
+            }
+        }
+        itemNum_ = itemNum_ - oldItemNum + entryList.size() / ENTRY_SIZE;
+        this->BuildBucketPage(bucketId, entryList);
+    }
+
+    // out-of-place: the new pages take the free pages first, then the file
+    // tail, both in the ascending order
+    size_t newPageNum = flushPageList_.size() / PAGE_SIZE;
+    size_t reuseNum = min(newPageNum, freePageList_.size());
+    if (pageNum_ + newPageNum - reuseNum >= INVALID_PAGE) {
+        fprintf(stderr, "SsdLogDatabase: the page file reaches the max size.\n");
+        exit(EXIT_FAILURE);
+    }
+    vector<uint32_t> pageIdList(newPageNum);
+    for (size_t i = 0; i < newPageNum; i++) {
+        pageIdList[i] = (i < reuseNum) ? freePageList_[i] : pageNum_ + (i - reuseNum);
+    }
+
+    // the pages are durable before the journal points to them, the log keeps
+    // the buffer until both are written
+    if (!this->WritePages(pageIdList)) {
+        fprintf(stderr, "SsdLogDatabase: cannot flush the buffer, the log is kept.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < newPageNum; i++) {
+        SsdPageHead_t pageHead;
+        memcpy(&pageHead, &flushPageList_[i * PAGE_SIZE], sizeof(SsdPageHead_t));
+        bucketList_[pageHead.bucketId].pageId = pageIdList[i];
+    }
+    if (!this->WriteJournal()) {
+        fprintf(stderr, "SsdLogDatabase: cannot flush the buffer, the log is kept.\n");
+        exit(EXIT_FAILURE);
+    }
+    freePageList_.erase(freePageList_.begin(), freePageList_.begin() + reuseNum);
+    pageNum_ += newPageNum - reuseNum;
+
+    // the old pages are not referred by the journal anymore
+    freePageList_.insert(freePageList_.end(), oldPageList.begin(), oldPageList.end());
+    sort(freePageList_.begin(), freePageList_.end());
+
+    bufferEntryList_.clear();
+    bufferIndex_.clear();
+    if (ftruncate(walFd_, 0) != 0) {
+        fprintf(stderr, "SsdLogDatabase: cannot truncate the log.\n");
+    }
+    flushNum_++;
+    writePageNum_ += newPageNum;
+
+    if (journalRecordNum_ >= MAX_JOURNAL_RECORD_NUM &&
+        journalRecordNum_ >= bucketList_.size()) {
+        // bound the replay time of the next startup
+        this->WriteSnapshot();
+    }
+    return true;
+}
+
+/**
+ * @brief write the bucket list to a new snapshot, then clear the journal
+ * 
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::WriteSnapshot() {
+    string tmpName = snapshotName_ + ".tmp";
+    int snapshotFd = open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (snapshotFd == -1) {
+        return false;
+    }
+
+    SsdSnapshotHead_t snapshotHead;
+    snapshotHead.magic = SSD_SNAPSHOT_MAGIC;
+    snapshotHead.keySize = KEY_SIZE;
+    snapshotHead.valueSize = VALUE_SIZE;
+    snapshotHead.pageSize = PAGE_SIZE;
+    snapshotHead.bucketNum = bucketList_.size();
+    bool isSuccess = (write(snapshotFd, &snapshotHead, sizeof(SsdSnapshotHead_t)) ==
+        (ssize_t)sizeof(SsdSnapshotHead_t));
+    const char* bucketBuffer = (const char*)&bucketList_[0];
+    uint64_t bucketListSize = bucketList_.size() * sizeof(SsdBucket_t);
+    uint64_t writeSize = 0;
+    while (isSuccess && writeSize < bucketListSize) {
+        ssize_t ret = write(snapshotFd, bucketBuffer + writeSize, bucketListSize - writeSize);
+        if (ret <= 0) {
+            isSuccess = false;
+            break;
+        }
+        writeSize += ret;
+    }
+    isSuccess = isSuccess && (fsync(snapshotFd) == 0);
+    close(snapshotFd);
+    if (!isSuccess || rename(tmpName.c_str(), snapshotName_.c_str()) != 0) {
+        remove(tmpName.c_str());
+        return false;
+    }
+
+    // the snapshot holds all updates of the journal, replaying them again is harmless
+    if (journalFd_ != -1 && ftruncate(journalFd_, 0) == 0) {
+        journalRecordNum_ = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief load the snapshot and replay the journal
+ * 
+ */
+void SsdLogDatabase::LoadBucketList() {
+    bucketList_.clear();
+    int snapshotFd = open(snapshotName_.c_str(), O_RDONLY);
+    if (snapshotFd != -1) {
+        SsdSnapshotHead_t snapshotHead;
+        struct stat fileStat;
+        bool isValid = (pread(snapshotFd, &snapshotHead, sizeof(SsdSnapshotHead_t), 0) ==
+            sizeof(SsdSnapshotHead_t)) && (fstat(snapshotFd, &fileStat) == 0) &&
+            snapshotHead.magic == SSD_SNAPSHOT_MAGIC && snapshotHead.keySize == KEY_SIZE &&
+            snapshotHead.valueSize == VALUE_SIZE && snapshotHead.pageSize == PAGE_SIZE &&
+            (uint64_t)fileStat.st_size == sizeof(SsdSnapshotHead_t) +
+            snapshotHead.bucketNum * sizeof(SsdBucket_t);
+        if (isValid) {
+            bucketList_.resize(snapshotHead.bucketNum);
+            uint64_t bucketListSize = snapshotHead.bucketNum * sizeof(SsdBucket_t);
+            if (pread(snapshotFd, &bucketList_[0], bucketListSize,
+                sizeof(SsdSnapshotHead_t)) != (ssize_t)bucketListSize) {
+                bucketList_.clear();
+            }
+        } else {
+            fprintf(stderr, "SsdLogDatabase: the snapshot does not match the format.\n");
+        }
+        close(snapshotFd);
+    }
+    if (bucketList_.empty()) {
+        // a single bucket of depth 0 covers all keys
+        SsdBucket_t rootBucket;
+        rootBucket.pageId = INVALID_PAGE;
+        rootBucket.prefix = 0;
+        rootBucket.localDepth = 0;
+        rootBucket.itemNum = 0;
+        bucketList_.push_back(rootBucket);
+    }
+
+    // apply the updates of each complete flush in the journal
+    struct stat fileStat;
+    fstat(journalFd_, &fileStat);
+    string journalBuffer;
+    journalBuffer.resize(fileStat.st_size);
+    if (fileStat.st_size > 0 && pread(journalFd_, &journalBuffer[0], fileStat.st_size, 0) !=
+        fileStat.st_size) {
+        fprintf(stderr, "SsdLogDatabase: cannot read the journal.\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t readOffset = 0;
+    while (readOffset + sizeof(SsdJournalHead_t) <= journalBuffer.size()) {
+        SsdJournalHead_t journalHead;
+        memcpy(&journalHead, &journalBuffer[readOffset], sizeof(SsdJournalHead_t));
+        size_t flushSize = sizeof(SsdJournalHead_t) +
+            journalHead.recordNum * sizeof(SsdJournalRecord_t);
+        if (journalHead.magic != SSD_JOURNAL_MAGIC ||
+            readOffset + flushSize > journalBuffer.size()) {
+            break;
+        }
+        for (size_t i = 0; i < journalHead.recordNum; i++) {
+            SsdJournalRecord_t journalRecord;
+            memcpy(&journalRecord, &journalBuffer[readOffset + sizeof(SsdJournalHead_t) +
+                i * sizeof(SsdJournalRecord_t)], sizeof(SsdJournalRecord_t));
+            if (journalRecord.bucketId >= bucketList_.size()) {
+                // the buckets split in a flush come in any order, all are in the flush
+                bucketList_.resize(journalRecord.bucketId + 1, journalRecord.bucket);
+            }
+            bucketList_[journalRecord.bucketId] = journalRecord.bucket;
+        }
+        journalRecordNum_ += journalHead.recordNum;
+        readOffset += flushSize;
+    }
+    if (readOffset != journalBuffer.size()) {
+        // drop the flush torn by a crash, its pages are free
+        if (ftruncate(journalFd_, readOffset) != 0) {
+            fprintf(stderr, "SsdLogDatabase: cannot truncate the journal.\n");
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief rebuild the directory and the free pages from the bucket list
+ * 
+ */
+void SsdLogDatabase::RebuildDirectory() {
+    globalDepth_ = 0;
+    itemNum_ = 0;
+    for (auto& bucket : bucketList_) {
+        globalDepth_ = max(globalDepth_, (uint32_t)bucket.localDepth);
+        itemNum_ += bucket.itemNum;
+    }
+    directory_.assign(1ULL << globalDepth_, 0);
+    for (size_t bucketId = 0; bucketId < bucketList_.size(); bucketId++) {
+        SsdBucket_t& bucket = bucketList_[bucketId];
+        for (uint64_t i = bucket.prefix; i < directory_.size();
+            i += (1ULL << bucket.localDepth)) {
+            directory_[i] = bucketId;
+        }
+    }
+
+    // the pages not referred by any bucket are free
+    vector<bool> usedPageList(pageNum_, false);
+    for (auto& bucket : bucketList_) {
+        if (bucket.pageId != INVALID_PAGE && bucket.pageId < pageNum_) {
+            usedPageList[bucket.pageId] = true;
+        }
+    }
+    freePageList_.clear();
+    for (uint64_t i = 0; i < pageNum_; i++) {
+        if (!usedPageList[i]) {
+            freePageList_.push_back(i);
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief insert the records of the log into the write buffer
+ * 
+ */
+void SsdLogDatabase::ReplayLog() {
+    struct stat fileStat;
+    fstat(walFd_, &fileStat);
+    uint64_t recordNum = fileStat.st_size / ENTRY_SIZE;
+    if ((uint64_t)fileStat.st_size != recordNum * ENTRY_SIZE) {
+        // drop the record torn by a crash
+        if (ftruncate(walFd_, recordNum * ENTRY_SIZE) != 0) {
+            fprintf(stderr, "SsdLogDatabase: cannot truncate the log.\n");
+        }
+    }
+
+    const size_t readRecordNum = 4096;
+    string readBuffer;
+    readBuffer.resize(readRecordNum * ENTRY_SIZE);
+    uint64_t readNum = 0;
+    while (readNum < recordNum) {
+        size_t curNum = min((uint64_t)readRecordNum, recordNum - readNum);
+        if (pread(walFd_, &readBuffer[0], curNum * ENTRY_SIZE, readNum * ENTRY_SIZE) !=
+            (ssize_t)(curNum * ENTRY_SIZE)) {
+            fprintf(stderr, "SsdLogDatabase: cannot read the log.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < curNum; i++) {
+            const char* record = &readBuffer[i * ENTRY_SIZE];
+            this->PutItem(record, record + KEY_SIZE);
+        }
+        readNum += curNum;
+    }
+    return ;
+}
+
+/**
+ * @brief open a database
+ * 
+ * @param dbName the path of the page file
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::OpenDB(std::string dbName) {
+    dbName_ = dbName;
+    walName_ = dbName + "-wal";
+    snapshotName_ = dbName + "-dir";
+    journalName_ = dbName + "-journal";
+
+    pageFd_ = open(dbName_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (pageFd_ == -1) {
+        fprintf(stderr, "SsdLogDatabase: cannot open the page file: %s\n", dbName_.c_str());
+        return false;
+    }
+    // a query reads one page, no readahead
+    posix_fadvise(pageFd_, 0, 0, POSIX_FADV_RANDOM);
+    struct stat fileStat;
+    fstat(pageFd_, &fileStat);
+    pageNum_ = fileStat.st_size / PAGE_SIZE;
+    readPage_ = (uint8_t*) aligned_alloc(PAGE_SIZE, PAGE_SIZE);
+
+    journalFd_ = open(journalName_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (journalFd_ == -1) {
+        fprintf(stderr, "SsdLogDatabase: cannot open the journal: %s\n",
+            journalName_.c_str());
+        return false;
+    }
+    this->LoadBucketList();
+    this->RebuildDirectory();
+
+    walFd_ = open(walName_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (walFd_ == -1) {
+        fprintf(stderr, "SsdLogDatabase: cannot open the log: %s\n", walName_.c_str());
+        return false;
+    }
+    this->ReplayLog();
+    fprintf(stderr, "SsdLogDatabase: loaded index size: %lu, bucket num: %lu, "
+        "replayed log records: %lu\n", itemNum_, bucketList_.size(), bufferIndex_.size());
+    return true;
+}
+
+/**
+ * @brief execute query over database
+ * 
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::Query(const std::string& key, std::string& value) {
+    return this->QueryBuffer(key.c_str(), key.size(), value);
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::Insert(const std::string& key, const std::string& value) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), value.c_str(), value.size());
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key the key
+ * @param buffer the value
+ * @param bufferSize the value size
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::InsertBuffer(const std::string& key, const char* buffer,
+    size_t bufferSize) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), buffer, bufferSize);
+}
+
+/**
+ * @brief insert the (key, value) pair
+ * 
+ * @param key the key
+ * @param keySize the key size
+ * @param buffer the value
+ * @param bufferSize the value size
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+    size_t bufferSize) {
+    if (keySize != KEY_SIZE || bufferSize != VALUE_SIZE) {
+        fprintf(stderr, "SsdLogDatabase: only holds the (fingerprint, address) pairs.\n");
+        return false;
+    }
+    this->PutItem(key, buffer);
+    walBuffer_.append(key, KEY_SIZE);
+    walBuffer_.append(buffer, VALUE_SIZE);
+    return this->FlushLog();
+}
+
+/**
+ * @brief query the (key, value) pair
+ * 
+ * @param key the key
+ * @param keySize the key size
+ * @param value the value <return>
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::QueryBuffer(const char* key, size_t keySize, std::string& value) {
+    if (keySize != KEY_SIZE) {
+        return false;
+    }
+    queryNum_++;
+    auto findRes = bufferIndex_.find(string(key, KEY_SIZE));
+    if (findRes != bufferIndex_.end()) {
+        value.assign(&bufferEntryList_[findRes->second * ENTRY_SIZE + KEY_SIZE], VALUE_SIZE);
+        return true;
+    }
+    uint32_t pageId = bucketList_[this->GetBucketId(this->HashKey(key))].pageId;
+    if (pageId == INVALID_PAGE) {
+        return false;
+    }
+    uint8_t pageBuffer[PAGE_SIZE];
+    this->ReadPage(pageId, pageBuffer);
+    readPageNum_++;
+    const uint8_t* pageValue = this->FindInPage(pageBuffer, key);
+    if (pageValue == NULL) {
+        return false;
+    }
+    value.assign((char*)pageValue, VALUE_SIZE);
+    return true;
+}
+
+/**
+ * @brief query a batch of fixed-size keys, the value of a found key
+ * is copied to its value slot
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value slot
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the value slots
+ * @param itemNum the number of keys
+ * @param selectList the keys to query (NULL: all), the others are not found
+ * @param foundList the query result of each key
+ * @return size_t the number of found keys
+ */
+size_t SsdLogDatabase::MultiQueryBuffer(const char* keyList, size_t keySize, char* valueList,
+    size_t valueSize, size_t itemStride, size_t itemNum, const bool* selectList,
+    bool* foundList) {
+    if (keySize != KEY_SIZE || valueSize > VALUE_SIZE) {
+        memset(foundList, 0, itemNum * sizeof(bool));
+        return 0;
+    }
+
+    // answer the keys in the buffer, collect the pages of the others
+    size_t foundNum = 0;
+    vector<pair<uint32_t, uint32_t>> readList;
+    string keyStr;
+    for (size_t i = 0; i < itemNum; i++) {
+        foundList[i] = false;
+        if (selectList != NULL && !selectList[i]) {
+            continue;
+        }
+        queryNum_++;
+        const char* key = keyList + i * itemStride;
+        keyStr.assign(key, KEY_SIZE);
+        auto findRes = bufferIndex_.find(keyStr);
+        if (findRes != bufferIndex_.end()) {
+            memcpy(valueList + i * itemStride,
+                &bufferEntryList_[findRes->second * ENTRY_SIZE + KEY_SIZE], valueSize);
+            foundList[i] = true;
+            foundNum++;
+            continue;
+        }
+        uint32_t pageId = bucketList_[this->GetBucketId(this->HashKey(key))].pageId;
+        if (pageId != INVALID_PAGE) {
+            readList.push_back(make_pair(pageId, i));
+        }
+    }
+    sort(readList.begin(), readList.end());
+
+    // issue the reads of the batch together to use the parallelism of the SSD
+    for (size_t i = 0; i < readList.size(); i++) {
+        if (i == 0 || readList[i].first != readList[i - 1].first) {
+            posix_fadvise(pageFd_, (off_t)readList[i].first * PAGE_SIZE, PAGE_SIZE,
+                POSIX_FADV_WILLNEED);
+        }
+    }
+
+    // the keys of the same page share one read
+    uint8_t pageBuffer[PAGE_SIZE];
+    uint32_t curPageId = INVALID_PAGE;
+    for (auto& readItem : readList) {
+        if (readItem.first != curPageId) {
+            this->ReadPage(readItem.first, pageBuffer);
+            readPageNum_++;
+            curPageId = readItem.first;
+        }
+        const uint8_t* pageValue = this->FindInPage(pageBuffer,
+            keyList + readItem.second * itemStride);
+        if (pageValue != NULL) {
+            memcpy(valueList + readItem.second * itemStride, pageValue, valueSize);
+            foundList[readItem.second] = true;
+            foundNum++;
+        }
+    }
+    return foundNum;
+}
+
+/**
+ * @brief insert a batch of fixed-size (key, value) pairs in one write
+ * 
+ * @param keyList the first key
+ * @param keySize the key size
+ * @param valueList the first value
+ * @param valueSize the value size
+ * @param itemStride the stride of the keys and the values
+ * @param itemNum the number of pairs
+ * @param selectList the pairs to insert (NULL: all)
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::WriteBatchBuffer(const char* keyList, size_t keySize,
+    const char* valueList, size_t valueSize, size_t itemStride, size_t itemNum,
+    const bool* selectList) {
+    if (keySize != KEY_SIZE || valueSize != VALUE_SIZE) {
+        fprintf(stderr, "SsdLogDatabase: only holds the (fingerprint, address) pairs.\n");
+        return false;
+    }
+    for (size_t i = 0; i < itemNum; i++) {
+        if (selectList != NULL && !selectList[i]) {
+            continue;
+        }
+        this->PutItem(keyList + i * itemStride, valueList + i * itemStride);
+        walBuffer_.append(keyList + i * itemStride, KEY_SIZE);
+        walBuffer_.append(valueList + i * itemStride, VALUE_SIZE);
+    }
+    return this->FlushLog();
+}
+
+/**
+ * @brief check whether the database has no key
+ * 
+ * @return true it is empty
+ * @return false it has keys
+ */
+bool SsdLogDatabase::IsEmpty() {
+    return itemNum_ == 0 && bufferIndex_.empty();
+}
+
+/**
+ * @brief pass each key of the database to the handler once, the
+ * database must not be modified during the scan
+ * 
+ * @param keyHandler the key handler
+ * @return true success
+ * @return false fail
+ */
+bool SsdLogDatabase::ScanKey(KeyHandler_t keyHandler) {
+    // the keys in the pages, a key updated in the write buffer is passed there
+    uint8_t* pageBuffer = (uint8_t*) malloc(PAGE_SIZE);
+    string keyStr;
+    for (auto& bucket : bucketList_) {
+        if (bucket.pageId == INVALID_PAGE) {
+            continue;
+        }
+        this->ReadPage(bucket.pageId, pageBuffer);
+        SsdPageHead_t pageHead;
+        memcpy(&pageHead, pageBuffer, sizeof(SsdPageHead_t));
+        size_t itemNum = min((size_t)pageHead.itemNum, (size_t)PAGE_ITEM_NUM);
+        const uint8_t* entry = pageBuffer + PAGE_HEAD_SIZE;
+        for (size_t i = 0; i < itemNum; i++) {
+            keyStr.assign((const char*)entry, KEY_SIZE);
+            if (bufferIndex_.find(keyStr) == bufferIndex_.end()) {
+                keyHandler((const char*)entry, KEY_SIZE);
+            }
+            entry += ENTRY_SIZE;
+        }
+    }
+    free(pageBuffer);
+
+    // the keys in the write buffer
+    for (size_t offset = 0; offset < bufferEntryList_.size(); offset += ENTRY_SIZE) {
+        keyHandler(&bufferEntryList_[offset], KEY_SIZE);
+    }
+    return true;
+}
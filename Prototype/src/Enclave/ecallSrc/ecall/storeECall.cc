@@ -158,6 +158,45 @@ void Ecall_Init_Client(uint32_t clientID, int type, int optType,
     return ;
 }
 
+/**
+ * @brief join an upload client to the parallel streams of a session
+ * 
+ * @param ret false if the stream does not belong to the session
+ * @param sgxClient the sgx-client ptr of the stream
+ * @param primaryUpOutSGX the upload out-enclave var of the primary stream
+ * @param streamID the stream ID (0 for the primary stream)
+ * @param streamNum the number of streams in the session
+ */
+void Ecall_Join_Stream(bool* ret, void* sgxClient, UpOutSGX_t* primaryUpOutSGX,
+    uint32_t streamID, uint32_t streamNum) {
+    EnclaveClient* sgxClientPtr = (EnclaveClient*)sgxClient;
+    EnclaveClient* primaryClient = (EnclaveClient*)primaryUpOutSGX->sgxClient;
+    *ret = false;
+    if (streamID >= streamNum || streamNum > MAX_UPLOAD_STREAM_NUM) {
+        Enclave::Logging("StoreECall", "wrong upload stream ID: %u.\n", streamID);
+        return ;
+    }
+    if (streamID == 0) {
+        // the primary stream merges the recipe entries of all streams
+        primaryClient->_recipeMerger = new EcallRecipeMerger(primaryUpOutSGX);
+    }
+    if (primaryClient->_recipeMerger == NULL ||
+        memcmp(sgxClientPtr->_masterKey, primaryClient->_masterKey, 
+        CHUNK_HASH_SIZE) != 0) {
+        // reject this stream only, the other sessions go on
+        Enclave::Logging("StoreECall", "stream %u does not belong to the session.\n",
+            streamID);
+        return ;
+    }
+
+    sgxClientPtr->_recipeMerger = primaryClient->_recipeMerger;
+    sgxClientPtr->_streamID = streamID;
+    sgxClientPtr->_streamNum = streamNum;
+    sgxClientPtr->_nextBatchSeq = streamID;
+    *ret = true;
+    return ;
+}
+
 /**
  * @brief destroy the inside client var
  * 
@@ -184,8 +223,15 @@ void Ecall_Enclave_Init(EnclaveConfig_t* enclaveConfig) {
 
     // config
     sendChunkBatchSize_ = enclaveConfig->sendChunkBatchSize;
+    maxChunkBatchSize_ = enclaveConfig->maxChunkBatchSize;
     sendRecipeBatchSize_ = enclaveConfig->sendRecipeBatchSize;
     topKParam_ = enclaveConfig->topKParam;
+    topKEPCBudget_ = enclaveConfig->topKEPCBudget;
+    sketchWidth_ = enclaveConfig->sketchWidth;
+    sketchDepth_ = enclaveConfig->sketchDepth;
+    freqPolicy_ = enclaveConfig->freqPolicy;
+    outQueryPipeline_ = enclaveConfig->outQueryPipeline;
+    workerPool_ = new EcallWorkerPool(enclaveConfig->enclaveWorkerNum);
 
     // check the file 
     size_t readFileSize = 0;
@@ -234,6 +280,29 @@ void Ecall_Enclave_Destroy() {
     // free the enclave key, index query key and the global secret
     free(enclaveKey_); 
     free(indexQueryKey_);
+
+    // the workers leave the enclave
+    delete workerPool_;
+    return ;
+}
+
+/**
+ * @brief run an enclave worker until the enclave is destroyed
+ * 
+ * @param workerID the worker ID
+ */
+void Ecall_Worker_Run(uint32_t workerID) {
+    workerPool_->Run(workerID);
+    return ;
+}
+
+/**
+ * @brief get the number of the enclave workers inside the enclave
+ * 
+ * @param runningNum the number of the running workers <return>
+ */
+void Ecall_Worker_Running_Num(uint32_t* runningNum) {
+    *runningNum = workerPool_->GetRunningNum();
     return ;
 }
 
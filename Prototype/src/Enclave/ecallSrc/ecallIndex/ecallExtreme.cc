@@ -63,12 +63,10 @@ void EcallExtremeBinIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Segment_t* segment = &sgxClient->_segment;
 
     // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);   
+    this->DecodeBatch(recvChunkBuf, sgxClient);   
     
     // get the chunk num
     uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
@@ -81,14 +79,17 @@ void EcallExtremeBinIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     uint32_t chunkHashVal = 0;
     SegmentMeta_t* curSegmentMetaPtr;
     
+    // step-2: compute the hash over the plaintext chunks of the batch
+    InQueryEntry_t* hashEntry = sgxClient->_inQueryBase;
+    cryptoObj_->GenerateHashBatch(mdCtx, recvBuffer, chunkNum, hashEntry->chunkHash,
+        sizeof(InQueryEntry_t));
+
     for (size_t i = 0; i < chunkNum; i++) {
-        // step-2: compute the hash over the plaintext chunk
         // read the chunk size
         memcpy(&tmpChunkSize, recvBuffer + offset, sizeof(tmpChunkSize));
         offset += sizeof(tmpChunkSize);
 
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + offset, 
-            tmpChunkSize, (uint8_t*)&tmpHashStr[0]);
+        memcpy(&tmpHashStr[0], hashEntry[i].chunkHash, CHUNK_HASH_SIZE);
 
         chunkHashVal = this->ConvertHashToValue((uint8_t*)&tmpHashStr[0]);
 
@@ -123,8 +124,8 @@ void EcallExtremeBinIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     }
 
     // reset
-    memset(recvBuffer, 0, Enclave::sendChunkBatchSize_ * sizeof(Chunk_t));
-    memset(recvChunkBuf->dataBuffer, 0, Enclave::sendChunkBatchSize_ * sizeof(Chunk_t));
+    memset(recvBuffer, 0, offset);
+    memset(recvChunkBuf->dataBuffer, 0, recvChunkBuf->header->dataSize);
     return ;
 }
 
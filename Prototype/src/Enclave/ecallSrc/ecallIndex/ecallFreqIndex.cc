@@ -17,9 +17,21 @@
  */
 EcallFreqIndex::EcallFreqIndex() {
     topThreshold_ = Enclave::topKParam_;
-    insideDedupIndex_ = new EcallEntryHeap();
-    insideDedupIndex_->SetHeapSize(topThreshold_);
-    cmSketch_ = new EcallCMSketch(sketchWidth_, sketchDepth_);
+    sketchWidth_ = Enclave::sketchWidth_;
+    sketchDepth_ = Enclave::sketchDepth_;
+    epcBudget_ = Enclave::topKEPCBudget_;
+    cmSketch_ = new EcallCMSketch(sketchWidth_, sketchDepth_, SKETCH_UPDATE);
+    freqPolicy_ = Enclave::freqPolicy_;
+    agingPeriod_ = FREQ_AGING_FACTOR * topThreshold_;
+    if (freqPolicy_ & FREQ_DOORKEEPER) {
+        doorkeeper_ = new EcallDoorkeeper(DOORKEEPER_BITS_PER_CHUNK * agingPeriod_);
+    }
+    if (epcBudget_ != 0) {
+        // the initial k also stays in the budget
+        size_t maxTopKSize = this->GetMaxTopKSize();
+        topThreshold_ = (topThreshold_ > maxTopKSize) ? maxTopKSize : topThreshold_;
+    }
+    insideDedupIndex_ = new EcallTopKTable(topThreshold_);
 
     if (ENABLE_SEALING) {
         if (!this->LoadDedupIndex()) {
@@ -48,27 +60,37 @@ EcallFreqIndex::~EcallFreqIndex() {
     if (ENABLE_SEALING) {
         this->PersistDedupIndex();
     }
-    delete insideDedupIndex_;
-    delete cmSketch_;
     Enclave::Logging(myName_.c_str(), "========EcallFreqIndex Info========\n");
     Enclave::Logging(myName_.c_str(), "logical chunk num: %lu\n", _logicalChunkNum);
     Enclave::Logging(myName_.c_str(), "logical data size: %lu\n", _logicalDataSize);
     Enclave::Logging(myName_.c_str(), "unique chunk num: %lu\n", _uniqueChunkNum);
     Enclave::Logging(myName_.c_str(), "unique data size: %lu\n", _uniqueDataSize);
     Enclave::Logging(myName_.c_str(), "compressed data size: %lu\n", _compressedDataSize); 
+    Enclave::Logging(myName_.c_str(), "top-k size: %lu, top-k hit ratio: %lf\n",
+        topThreshold_, (totalLookupNum_ == 0) ? 0 :
+        static_cast<double>(totalHitNum_) / totalLookupNum_);
+    if (freqPolicy_ != 0) {
+        Enclave::Logging(myName_.c_str(), "freq policy: %u, aging num: %lu\n",
+            freqPolicy_, agingNum_);
+    }
     // Enclave::Logging(myName_.c_str(), "inside dedup chunk num: %lu\n", insideDedupChunkNum_);
     // Enclave::Logging(myName_.c_str(), "inside dedup data size: %lu\n", insideDedupDataSize_);
     Enclave::Logging(myName_.c_str(), "===================================\n");
+    delete insideDedupIndex_;
+    delete cmSketch_;
+    if (doorkeeper_ != NULL) {
+        delete doorkeeper_;
+    }
 }
 
 /**
  * @brief update the inside-enclave with only freq
  * 
- * @param ChunkFp the chunk fp
+ * @param heapItem the item of the chunk in the top-k index
  * @param currentFreq the current frequency
  */
-void EcallFreqIndex::UpdateInsideIndexFreq(const string& chunkFp, uint32_t currentFreq) {
-    insideDedupIndex_->Update(chunkFp, currentFreq);
+void EcallFreqIndex::UpdateInsideIndexFreq(HeapItem_t* heapItem, uint32_t currentFreq) {
+    insideDedupIndex_->Update(heapItem, currentFreq);
     return ;
 }
 
@@ -84,6 +106,15 @@ void EcallFreqIndex::ProcessTailBatch(UpOutSGX_t* upOutSGX) {
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     uint8_t* masterKey = sgxClient->_masterKey;
 
+#if (IMPACT_OF_TOP_K == 0)
+    // finish the batch whose out-enclave query is in flight
+    WorkerCtx_t callerCtx;
+    callerCtx.cipherCtx = cipherCtx;
+    callerCtx.mdCtx = sgxClient->_mdCtx;
+    callerCtx.chunkCipherCtx = sgxClient->_chunkCipherCtx;
+    this->FinishPendingBatch(upOutSGX, &callerCtx);
+#endif
+
     if (inRecipe->recipeNum != 0) {
         // the out-enclave info
         Recipe_t* outRecipe = (Recipe_t*)upOutSGX->outRecipe;
@@ -118,16 +149,17 @@ bool EcallFreqIndex::PersistDedupIndex() {
     // a pointer to store tmp buffer
     uint8_t* tmpBuffer = NULL;
 
-    // step-1: persist the sketch state
-    uint32_t** counterArrary = cmSketch_->GetCounterArray();
+    // step-1: persist the sketch state (the head + the counter blocks)
+    SketchHead_t sketchHead;
+    cmSketch_->GetHead(&sketchHead);
     Ocall_InitWriteSealedFile(&persistenceStatus, SEALED_SKETCH);
     if (persistenceStatus == false) {
         Ocall_SGX_Exit_Error("EcallFreqIndex: cannot init the sketch sealed file.");
     }
 
-    for (size_t i = 0; i < sketchDepth_; i++) {
-        Enclave::WriteBufferToFile((uint8_t*)counterArrary[i], sketchWidth_ * sizeof(uint32_t), SEALED_SKETCH);
-    }
+    Enclave::WriteBufferToFile((uint8_t*)&sketchHead, sizeof(SketchHead_t), SEALED_SKETCH);
+    Enclave::WriteBufferToFile(cmSketch_->GetCounterArray(),
+        cmSketch_->GetCounterArraySize(), SEALED_SKETCH);
     Ocall_CloseWriteSealedFile(SEALED_SKETCH);
 
     // step-2: persist the min-heap 
@@ -137,16 +169,21 @@ bool EcallFreqIndex::PersistDedupIndex() {
         Ocall_SGX_Exit_Error("EcallFreqIndex: cannot init the heap sealed file.");
     }
 
-    auto heapPtr = &insideDedupIndex_->_heap;
-    itemNum = heapPtr->size();
-    requiredBufferSize = sizeof(size_t) + itemNum * (CHUNK_HASH_SIZE + sizeof(HeapItem_t));
+    // keep the layout of the heap order: the head, <fp, item> of each heap position
+    itemNum = insideDedupIndex_->Size();
+    TopKHead_t topKHead;
+    topKHead.layout = ADAPTIVE_TOP_K_LAYOUT;
+    topKHead.reserved = 0;
+    topKHead.capacity = topThreshold_;
+    topKHead.itemNum = itemNum;
+    requiredBufferSize = sizeof(TopKHead_t) + itemNum * (CHUNK_HASH_SIZE + sizeof(HeapItem_t));
     tmpBuffer = (uint8_t*) malloc(sizeof(uint8_t) * requiredBufferSize);
-    memcpy(tmpBuffer + offset, &itemNum, sizeof(size_t));
-    offset += sizeof(size_t);
+    memcpy(tmpBuffer + offset, &topKHead, sizeof(TopKHead_t));
+    offset += sizeof(TopKHead_t);
     for (size_t i = 0; i < itemNum; i++) {
-        memcpy(tmpBuffer + offset, &(*heapPtr)[i]->first[0], CHUNK_HASH_SIZE);
+        memcpy(tmpBuffer + offset, insideDedupIndex_->GetHeapFp(i), CHUNK_HASH_SIZE);
         offset += CHUNK_HASH_SIZE;
-        memcpy(tmpBuffer + offset, &(*heapPtr)[i]->second, sizeof(HeapItem_t));
+        memcpy(tmpBuffer + offset, insideDedupIndex_->GetHeapItem(i), sizeof(HeapItem_t));
         offset += sizeof(HeapItem_t);
     }
     Enclave::WriteBufferToFile(tmpBuffer, requiredBufferSize, SEALED_FREQ_INDEX);
@@ -164,26 +201,56 @@ bool EcallFreqIndex::PersistDedupIndex() {
  */
 bool EcallFreqIndex::LoadDedupIndex() {
     size_t itemNum;
-    string tmpChunkFp;
-    tmpChunkFp.resize(CHUNK_HASH_SIZE, 0);
+    uint8_t tmpChunkFp[CHUNK_HASH_SIZE];
     size_t sealedDataSize;
     size_t offset = 0;
 
     // step-1: load the sketch state 
-    uint32_t** counterArray = cmSketch_->GetCounterArray();
+    SketchHead_t sketchHead;
+    SketchHead_t sealedHead;
+    cmSketch_->GetHead(&sketchHead);
     Ocall_InitReadSealedFile(&sealedDataSize, SEALED_SKETCH);
     if (sealedDataSize == 0) {
         return false;
     }   
 
-    for (size_t i = 0; i < sketchDepth_; i++) {
-        Enclave::ReadFileToBuffer((uint8_t*)counterArray[i], sizeof(uint32_t) * sketchWidth_, SEALED_SKETCH);
+    memset(&sealedHead, 0, sizeof(SketchHead_t));
+    if (sealedDataSize >= sizeof(SketchHead_t)) {
+        Enclave::ReadFileToBuffer((uint8_t*)&sealedHead, sizeof(SketchHead_t), SEALED_SKETCH);
+    }
+    if (sealedHead.layout == BLOCKED_SKETCH_LAYOUT &&
+        memcmp(&sealedHead, &sketchHead, sizeof(SketchHead_t)) != 0) {
+        // the counters only make sense with their dims, keep the sealed dims
+        EcallCMSketch* sealedSketch = new EcallCMSketch(sealedHead.width, sealedHead.depth,
+            SKETCH_UPDATE);
+        if (sealedDataSize == sizeof(SketchHead_t) + sealedSketch->GetCounterArraySize()) {
+            Enclave::Logging(myName_.c_str(), "use the sealed sketch dims (width: %u, "
+                "depth: %u) instead of the config.\n", sealedHead.width, sealedHead.depth);
+            delete cmSketch_;
+            cmSketch_ = sealedSketch;
+            sketchWidth_ = sealedHead.width;
+            sketchDepth_ = sealedHead.depth;
+            cmSketch_->GetHead(&sketchHead);
+        } else {
+            delete sealedSketch;
+        }
+    }
+    if (memcmp(&sealedHead, &sketchHead, sizeof(SketchHead_t)) == 0 &&
+        sealedDataSize == sizeof(SketchHead_t) + cmSketch_->GetCounterArraySize()) {
+        Enclave::ReadFileToBuffer(cmSketch_->GetCounterArray(),
+            cmSketch_->GetCounterArraySize(), SEALED_SKETCH);
+    } else {
+        // the freqs of the top-k items are counted by the sealed sketch, they
+        // would stay above the freqs of an empty sketch, drop both (the top-k
+        // items are also in the out-enclave index)
+        Enclave::Logging(myName_.c_str(), "drop the sealed sketch of a different layout "
+            "and the sealed top-k index.\n");
+        Ocall_CloseReadSealedFile(SEALED_SKETCH);
+        return false;
     }
     Ocall_CloseReadSealedFile(SEALED_SKETCH);
 
     // step-2: load the min-heap 
-    auto heapPtr = &insideDedupIndex_->_heap;
-    auto indexPtr = &insideDedupIndex_->_index;
     Ocall_InitReadSealedFile(&sealedDataSize, SEALED_FREQ_INDEX);
     if (sealedDataSize == 0) {
         return false;
@@ -191,18 +258,63 @@ bool EcallFreqIndex::LoadDedupIndex() {
 
     uint8_t* tmpIndexBuffer = (uint8_t*) malloc(sealedDataSize * sizeof(uint8_t));
     Enclave::ReadFileToBuffer(tmpIndexBuffer, sealedDataSize, SEALED_FREQ_INDEX);
-    memcpy(&itemNum, tmpIndexBuffer + offset, sizeof(size_t));
-    offset += sizeof(size_t);
+    TopKHead_t topKHead;
+    size_t entrySize = CHUNK_HASH_SIZE + sizeof(HeapItem_t);
+    memset(&topKHead, 0, sizeof(TopKHead_t));
+    if (sealedDataSize >= sizeof(TopKHead_t)) {
+        memcpy(&topKHead, tmpIndexBuffer, sizeof(TopKHead_t));
+    }
+    if (topKHead.layout == ADAPTIVE_TOP_K_LAYOUT &&
+        sealedDataSize == sizeof(TopKHead_t) + topKHead.itemNum * entrySize) {
+        itemNum = topKHead.itemNum;
+        offset += sizeof(TopKHead_t);
+        if (epcBudget_ != 0 && topKHead.capacity != topThreshold_) {
+            // restore the adapted k in the current budget
+            size_t maxTopKSize = this->GetMaxTopKSize();
+            size_t newTopKSize = (topKHead.capacity > maxTopKSize) ? maxTopKSize :
+                topKHead.capacity;
+            if (insideDedupIndex_->Resize(newTopKSize)) {
+                topThreshold_ = newTopKSize;
+            }
+        }
+    } else {
+        // the sealed index without the head: <item num, <fp, item>...>
+        itemNum = 0;
+        if (sealedDataSize >= sizeof(size_t)) {
+            memcpy(&itemNum, tmpIndexBuffer + offset, sizeof(size_t));
+            offset += sizeof(size_t);
+        }
+        if (sealedDataSize < sizeof(size_t) ||
+            itemNum > (sealedDataSize - sizeof(size_t)) / entrySize) {
+            // a truncated or unknown sealed index, start from an empty top-k index
+            Enclave::Logging(myName_.c_str(), "the sealed top-k index is corrupted "
+                "(size: %lu), drop it.\n", sealedDataSize);
+            Ocall_CloseReadSealedFile(SEALED_FREQ_INDEX);
+            free(tmpIndexBuffer);
+            return false;
+        }
+    }
+    if (epcBudget_ != 0 && topThreshold_ > this->GetMaxTopKSize()) {
+        // the sealed sketch can be larger than the configured one
+        if (insideDedupIndex_->Resize(this->GetMaxTopKSize())) {
+            topThreshold_ = this->GetMaxTopKSize();
+        }
+    }
     HeapItem_t tmpItem;
-    string tmpFp;
-    tmpFp.resize(CHUNK_HASH_SIZE, 0);
     for (size_t i = 0; i < itemNum; i++) {
-        memcpy(&tmpChunkFp[0], tmpIndexBuffer + offset, CHUNK_HASH_SIZE);
+        memcpy(tmpChunkFp, tmpIndexBuffer + offset, CHUNK_HASH_SIZE);
         offset += CHUNK_HASH_SIZE;
         memcpy(&tmpItem, tmpIndexBuffer + offset, sizeof(HeapItem_t));
         offset += sizeof(HeapItem_t);
-        auto tmpIt = indexPtr->insert({tmpChunkFp, tmpItem}).first;
-        heapPtr->push_back(tmpIt);
+        // the items are in the heap order, the sift-up in Add does not move them
+        if (insideDedupIndex_->Size() == topThreshold_) {
+            // the sealed index is larger than current k, keep the top-k items
+            if (tmpItem.chunkFreq <= insideDedupIndex_->TopEntry()) {
+                continue;
+            }
+            insideDedupIndex_->Pop();
+        }
+        insideDedupIndex_->Add(tmpChunkFp, tmpItem);
     }
     Ocall_CloseReadSealedFile(SEALED_FREQ_INDEX);
 
@@ -229,6 +341,76 @@ bool EcallFreqIndex::CheckIfAddToHeap(uint32_t chunkFreq) {
     return false;
 }
 
+/**
+ * @brief check whether admit a new chunk to the heap, with the doorkeeper
+ * the chunk must beat the min freq of the full heap (TinyLFU)
+ * 
+ * @param chunkFreq the chunk freq
+ */
+bool EcallFreqIndex::CheckIfAdmit(uint32_t chunkFreq) {
+    if (doorkeeper_ == NULL || insideDedupIndex_->Size() < topThreshold_) {
+        return true;
+    }
+    // a tie does not evict the victim
+    return chunkFreq > insideDedupIndex_->TopEntry();
+}
+
+/**
+ * @brief set the sketch count of each chunk of a batch under the freq
+ * policy, a chunk seen for the first time in the period only enters
+ * the doorkeeper
+ * 
+ * @param entryList the query entries of the batch
+ * @param entryNum the number of entries
+ * @param countList the count of each entry
+ */
+void EcallFreqIndex::SetFreqCount(const InQueryEntry_t* entryList, size_t entryNum,
+    uint32_t* countList) {
+    for (size_t i = 0; i < entryNum; i++) {
+        countList[i] = this->GetFreqWeight(entryList[i].chunkSize);
+        if (doorkeeper_ != NULL && !doorkeeper_->TestAndSet(entryList[i].chunkHash)) {
+            countList[i] = 0;
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief count the chunks of a batch, and halve the frequencies and
+ * clear the doorkeeper at the end of a period, the writers of the
+ * top-k index are serialized by the caller
+ * 
+ * @param chunkNum the number of chunks in the batch
+ */
+void EcallFreqIndex::AgeFreq(uint64_t chunkNum) {
+    if ((freqPolicy_ & (FREQ_AGING | FREQ_DOORKEEPER)) == 0) {
+        return ;
+    }
+    periodChunkNum_ += chunkNum;
+    if (periodChunkNum_ < agingPeriod_) {
+        return ;
+    }
+
+    if (freqPolicy_ & FREQ_AGING) {
+#if (MULTI_CLIENT == 1)
+        // the conservative update writes the counters under the sketch lock
+        Enclave::sketchLck_.lock();
+#endif
+        cmSketch_->Halve();
+#if (MULTI_CLIENT == 1)
+        Enclave::sketchLck_.unlock();
+#endif
+        // the halving keeps the order of the heap
+        insideDedupIndex_->Age();
+        agingNum_++;
+    }
+    if (doorkeeper_ != NULL) {
+        doorkeeper_->Clear();
+    }
+    periodChunkNum_ = 0;
+    return ;
+}
+
 /**
  * @brief Add the information of this chunk to the heap
  * 
@@ -237,7 +419,7 @@ bool EcallFreqIndex::CheckIfAddToHeap(uint32_t chunkFreq) {
  * @param chunkFp the chunk fp
  */
 void EcallFreqIndex::AddChunkToHeap(uint32_t chunkFreq, RecipeEntry_t* chunkAddr, 
-    const string& chunkFp) {
+    const uint8_t* chunkFp) {
     HeapItem_t tmpHeapEntry;
     // pop the minimum item
     if (insideDedupIndex_->Size() == topThreshold_) {
@@ -250,83 +432,167 @@ void EcallFreqIndex::AddChunkToHeap(uint32_t chunkFreq, RecipeEntry_t* chunkAddr
     return ;
 }
 
+/**
+ * @brief compress and encrypt the unique chunks of a batch with the
+ * enclave workers window by window, and save them in the batch order
+ * 
+ * @param chunkNum the number of chunks in the batch
+ * @param upOutSGX the upload out-enclave var
+ * @param callerCtx the crypto context of the client
+ */
+void EcallFreqIndex::SaveUniqueChunks(uint32_t chunkNum, UpOutSGX_t* upOutSGX,
+    WorkerCtx_t* callerCtx) {
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
+    InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
+    OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
+    uint8_t* recvBuffer = sgxClient->_recvBuffer;
+    uint32_t* chunkOffsetList = sgxClient->_chunkOffsetList;
+    uint32_t* encodeIdxList = sgxClient->_encodeIdxList;
+    uint8_t* encodeIVList = sgxClient->_encodeIVList;
+    uint32_t* encodeSizeList = sgxClient->_encodeSizeList;
+    uint8_t* encodeBuffer = sgxClient->_encodeBuffer;
+
+    WorkerTask_t encodeTask = [&](size_t idx, WorkerCtx_t* workerCtx) {
+        InQueryEntry_t* inQueryEntry = inQueryBase + encodeIdxList[idx];
+        encodeSizeList[idx] = this->EncodeChunk(recvBuffer + chunkOffsetList[encodeIdxList[idx]],
+            inQueryEntry->chunkSize, encodeIVList + idx * CRYPTO_BLOCK_SIZE,
+            workerCtx->chunkCipherCtx, encodeBuffer + idx * MAX_CHUNK_SIZE);
+    };
+
+    size_t windowNum = 0;
+    for (size_t i = 0; i < chunkNum; i++) {
+        InQueryEntry_t* inQueryEntry = inQueryBase + i;
+        // the unique chunk of both indexes, its offset points to the out-enclave query
+        if (inQueryEntry->dedupFlag == UNIQUE &&
+            outQueryBase[inQueryEntry->chunkAddr.offset].dedupFlag == UNIQUE) {
+            // pick the iv in the batch order as the single-thread processing
+            encodeIdxList[windowNum] = i;
+            memcpy(encodeIVList + windowNum * CRYPTO_BLOCK_SIZE, sgxClient->PickNewIV(),
+                CRYPTO_BLOCK_SIZE);
+            windowNum++;
+        }
+        if (windowNum == ENCLAVE_ENCODE_WINDOW || (i + 1 == chunkNum && windowNum != 0)) {
+            Enclave::workerPool_->ParallelFor(windowNum, callerCtx, encodeTask);
+            // the container placement stays in the batch order
+            for (size_t j = 0; j < windowNum; j++) {
+                _compressedDataSize += encodeSizeList[j];
+                storageCoreObj_->SaveChunk((char*)(encodeBuffer + j * MAX_CHUNK_SIZE),
+                    encodeSizeList[j], &inQueryBase[encodeIdxList[j]].chunkAddr, upOutSGX);
+            }
+            windowNum = 0;
+        }
+    }
+    return ;
+}
+
 #if (IMPACT_OF_TOP_K == 0)
 
 /**
- * @brief process one batch
+ * @brief decrypt a batch into the batch buffers, compute the chunk
+ * hashes, and update the sketch
  * 
  * @param recvChunkBuf the recv chunk buffer
- * @param upOutSGX the pointer to the enclave-related var 
+ * @param upOutSGX the upload out-enclave var
+ * @param callerCtx the crypto context of the client
+ * @param batch the batch state
  */
-void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf, 
-    UpOutSGX_t* upOutSGX) {
+void EcallFreqIndex::HashBatch(SendMsgBuffer_t* recvChunkBuf, UpOutSGX_t* upOutSGX,
+    WorkerCtx_t* callerCtx, BatchState_t* batch) {
     // the in-enclave info
     EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
-    EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
-    EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
-    Recipe_t* inRecipe = &sgxClient->_inRecipe;
     InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
-    OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
-
-    // tmp var
-    OutQueryEntry_t* outQueryEntry = outQueryBase;
-    uint32_t outQueryNum = 0;
-    string tmpHashStr;
-    tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
 
     // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    this->DecodeBatch(recvChunkBuf, sgxClient);
     
     // get the chunk num
     uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
 
-    // compute the hash of each chunk
+    // locate each chunk, then compute the hash with the enclave workers
     InQueryEntry_t* inQueryEntry = inQueryBase;
+    uint32_t* chunkOffsetList = sgxClient->_chunkOffsetList;
     size_t currentOffset = 0;
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the plaintext chunk
         memcpy(&inQueryEntry->chunkSize, recvBuffer + currentOffset,
             sizeof(uint32_t));
         currentOffset += sizeof(uint32_t);
-
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset,
-            inQueryEntry->chunkSize, inQueryEntry->chunkHash);
+        chunkOffsetList[i] = currentOffset;
         currentOffset += inQueryEntry->chunkSize;
         inQueryEntry++;
     }
+    Enclave::workerPool_->ParallelFor(chunkNum, callerCtx,
+        [&](size_t idx, WorkerCtx_t* workerCtx) {
+        // compute the hash over the plaintext chunk
+        cryptoObj_->GenerateHash(workerCtx->mdCtx, recvBuffer + chunkOffsetList[idx],
+            inQueryBase[idx].chunkSize, inQueryBase[idx].chunkHash);
+    });
 
 {
+    // the count of each chunk under the freq policy (NULL: count 1)
+    uint32_t* freqCountList = NULL;
+    if (freqPolicy_ != 0) {
+        freqCountList = sgxClient->_freqCountList;
+        this->SetFreqCount(inQueryBase, chunkNum, freqCountList);
+    }
 #if (MULTI_CLIENT == 1)
     Enclave::sketchLck_.lock();
 #endif
     // update the sketch and freq
-    inQueryEntry = inQueryBase;
-    for (size_t i = 0; i < chunkNum; i++) {
-        cmSketch_->Update(inQueryEntry->chunkHash, CHUNK_HASH_SIZE, 1);
-        inQueryEntry->chunkFreq = cmSketch_->Estimate(inQueryEntry->chunkHash,
-            CHUNK_HASH_SIZE);
-        inQueryEntry++;
+    if (freqCountList != NULL) {
+        cmSketch_->UpdateBatch(inQueryBase, chunkNum, freqCountList);
+    } else {
+        cmSketch_->UpdateBatch(inQueryBase, chunkNum, 1);
     }
 #if (MULTI_CLIENT == 1)
     Enclave::sketchLck_.unlock();
 #endif
+    if (doorkeeper_ != NULL) {
+        // the doorkeeper holds one occurrence of each chunk in the period
+        for (size_t i = 0; i < chunkNum; i++) {
+            inQueryBase[i].chunkFreq += this->GetFreqWeight(inQueryBase[i].chunkSize);
+        }
+    }
 }
 
+    batch->chunkNum = chunkNum;
+    batch->outQueryNum = 0;
+    batch->topKLookupNum = 0;
+    batch->topKHitNum = 0;
+    return ;
+}
+
+/**
+ * @brief check a hashed batch with the top-k index and the local index,
+ * and fill the out-enclave query buffer with the missed chunks
+ * 
+ * @param upOutSGX the upload out-enclave var
+ * @param batch the batch state
+ */
+void EcallFreqIndex::ProbeBatch(UpOutSGX_t* upOutSGX, BatchState_t* batch) {
+    // the in-enclave info
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
+    EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
+    InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
+    HeapItem_t* topKItemList = sgxClient->_topKItemList;
+    OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
+    uint8_t* outQueryHashList = sgxClient->_outQueryHashList;
+    uint32_t chunkNum = batch->chunkNum;
+
+    // tmp var
+    OutQueryEntry_t* outQueryEntry = outQueryBase;
+    uint32_t outQueryNum = 0;
+    uint64_t topKLookupNum = 0;
+    uint64_t topKHitNum = 0;
+    string tmpHashStr;
+    tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
+
 {
-#if (MULTI_CLIENT == 1)
-    Enclave::topKIndexLck_.lock();
-#endif
-    // check the top-k index
-    uint32_t minFreq;
-    if (insideDedupIndex_->Size() == topThreshold_) {
-        minFreq = insideDedupIndex_->TopEntry();
-    } else {
-        minFreq = 0;
-    }
-    inQueryEntry = inQueryBase;
+    // check the top-k index without the lock, the probing copies the items
+    // and only retries the chunks that overlap the heap update of other clients
+    uint32_t minFreq = insideDedupIndex_->GetMinFreq();
+    insideDedupIndex_->FindBatch(inQueryBase, chunkNum, topKItemList);
+    InQueryEntry_t* inQueryEntry = inQueryBase;
     
     for (size_t i = 0; i < chunkNum; i++) {
         tmpHashStr.assign((char*)inQueryEntry->chunkHash, CHUNK_HASH_SIZE);
@@ -357,11 +623,12 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
             findEntry->chunkFreq = inQueryEntry->chunkFreq;
         } else {
             // it does not exists in the batch index, compare the freq 
+            topKLookupNum++;
             if (inQueryEntry->chunkFreq < minFreq) {
                 // its frequency is smaller than the minimum value in the heap, must not exist in the heap
-                // encrypt its fingerprint, write to the outside buffer
-                cryptoObj_->IndexAESCMCEnc(cipherCtx, inQueryEntry->chunkHash,
-                    CHUNK_HASH_SIZE, Enclave::indexQueryKey_, outQueryEntry->chunkHash);
+                // keep its fingerprint, encrypted to the outside buffer after the loop
+                memcpy(outQueryHashList + outQueryNum * CHUNK_HASH_SIZE,
+                    inQueryEntry->chunkHash, CHUNK_HASH_SIZE);
                 
                 // update the in-enclave query buffer
                 inQueryEntry->dedupFlag = UNIQUE;
@@ -372,16 +639,16 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
                 outQueryNum++;
             } else {
                 // its frequency is higher than the minimum value in the heap, check the heap
-                bool topKRes = insideDedupIndex_->Contains(tmpHashStr);
-                if (topKRes) {
+                if (topKItemList[i].idx != EcallTopKTable::EMPTY_SLOT) {
                     // it exists in the heap, directly read
+                    topKHitNum++;
                     inQueryEntry->dedupFlag = DUPLICATE;
-                    memcpy(&inQueryEntry->chunkAddr, insideDedupIndex_->GetPriority(tmpHashStr),
+                    memcpy(&inQueryEntry->chunkAddr, &topKItemList[i].address,
                         sizeof(RecipeEntry_t));
                 } else {
                     // it does not exist in the heap
-                    cryptoObj_->IndexAESCMCEnc(cipherCtx, inQueryEntry->chunkHash, CHUNK_HASH_SIZE,
-                        Enclave::indexQueryKey_, outQueryEntry->chunkHash);
+                    memcpy(outQueryHashList + outQueryNum * CHUNK_HASH_SIZE,
+                        inQueryEntry->chunkHash, CHUNK_HASH_SIZE);
                     
                     // update the dedup list
                     inQueryEntry->dedupFlag = UNIQUE;
@@ -397,20 +664,58 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         }
         inQueryEntry++;
     }
-#if (MULTI_CLIENT == 1)
-    Enclave::topKIndexLck_.unlock();
-#endif
 }
-    // check the out-enclave index
+
+    if (outQueryNum != 0) {
+        // encrypt the fingerprints of all queries with the index key in one pass
+        cryptoObj_->IndexAESCMCEncBatch(cipherCtx, &indexKeySchedule_, outQueryHashList,
+            CHUNK_HASH_SIZE, outQueryNum, CHUNK_HASH_SIZE, outQueryBase->chunkHash,
+            sizeof(OutQueryEntry_t));
+    }
+
+    batch->outQueryNum = outQueryNum;
+    batch->topKLookupNum = topKLookupNum;
+    batch->topKHitNum = topKHitNum;
+    return ;
+}
+
+/**
+ * @brief save the unique chunks of a queried batch, update the recipe,
+ * the out-enclave query buffer, and the top-k index
+ * 
+ * @param upOutSGX the upload out-enclave var
+ * @param callerCtx the crypto context of the client
+ * @param batch the batch state
+ */
+void EcallFreqIndex::FinishBatch(UpOutSGX_t* upOutSGX, WorkerCtx_t* callerCtx,
+    BatchState_t* batch) {
+    // the in-enclave info
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
+    EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
+    Recipe_t* inRecipe = &sgxClient->_inRecipe;
+    InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
+    OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
+    RecipeEntry_t* outQueryAddrList = sgxClient->_outQueryAddrList;
+    uint32_t chunkNum = batch->chunkNum;
+    uint32_t outQueryNum = batch->outQueryNum;
+    uint64_t topKLookupNum = batch->topKLookupNum;
+    uint64_t topKHitNum = batch->topKHitNum;
+
     if (outQueryNum != 0) {
-        upOutSGX->outQuery->queryNum = outQueryNum;
-        Ocall_QueryOutIndex(upOutSGX->outClient);
+        // decrypt the addresses of all queries in one pass, only the
+        // duplicate ones are used
+        cryptoObj_->AESCBCDecBatch(cipherCtx, &indexKeySchedule_,
+            (uint8_t*)&outQueryBase->chunkAddr, sizeof(OutQueryEntry_t), outQueryNum,
+            sizeof(RecipeEntry_t), (uint8_t*)outQueryAddrList, sizeof(RecipeEntry_t));
+
+        // compress, encrypt, and save the unique chunks before the metadata
+        this->SaveUniqueChunks(chunkNum, upOutSGX, callerCtx);
     }
 
     // process the unique chunks and update the metadata
-    inQueryEntry = inQueryBase;
-    outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
+    InQueryEntry_t* inQueryEntry = inQueryBase;
+    OutQueryEntry_t* outQueryEntry = outQueryBase;
+    size_t currentOffset = 0;
     string tmpChunkAddr;
     tmpChunkAddr.resize(sizeof(RecipeEntry_t), 0);
     InQueryEntry_t* tmpQueryEntry;
@@ -445,24 +750,21 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
                 switch (outQueryEntry->dedupFlag) {
                     case DUPLICATE: {
                         // it is duplicate for the out-enclave index
-                        cryptoObj_->AESCBCDec(cipherCtx, (uint8_t*)&outQueryEntry->chunkAddr,
-                            sizeof(RecipeEntry_t), Enclave::indexQueryKey_,
-                            (uint8_t*)&inQueryEntry->chunkAddr);
+                        memcpy(&inQueryEntry->chunkAddr,
+                            outQueryAddrList + (outQueryEntry - outQueryBase),
+                            sizeof(RecipeEntry_t));
                         tmpChunkAddr.assign((char*)&inQueryEntry->chunkAddr,
                             sizeof(RecipeEntry_t));
                         break;
                     }
                     case UNIQUE: {
-                        // it also unique for the out-enclave index
-                        this->ProcessUniqueChunk(&inQueryEntry->chunkAddr,
-                            recvBuffer + currentOffset, tmpChunkSize, upOutSGX);
+                        // it also unique for the out-enclave index, saved by SaveUniqueChunks
                         tmpChunkAddr.assign((char*)&inQueryEntry->chunkAddr,
                             sizeof(RecipeEntry_t));
 
-                        // encrypt the chunk address, write to the out-enclave buffer
-                        cryptoObj_->AESCBCEnc(cipherCtx, (uint8_t*)&inQueryEntry->chunkAddr,
-                            sizeof(RecipeEntry_t), Enclave::indexQueryKey_,
-                            (uint8_t*)&outQueryEntry->chunkAddr);
+                        // keep the chunk address, encrypted to the out-enclave buffer later
+                        memcpy(outQueryAddrList + (outQueryEntry - outQueryBase),
+                            &inQueryEntry->chunkAddr, sizeof(RecipeEntry_t));
 
                         // update the statistic
                         _uniqueChunkNum++;
@@ -501,39 +803,139 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         _logicalChunkNum++;
     }
 
+    if (outQueryNum != 0) {
+        // encrypt the addresses of all queries in one pass, the duplicate
+        // ones get the same ciphertext since the iv is fixed
+        cryptoObj_->AESCBCEncBatch(cipherCtx, &indexKeySchedule_, (uint8_t*)outQueryAddrList,
+            sizeof(RecipeEntry_t), outQueryNum, sizeof(RecipeEntry_t),
+            (uint8_t*)&outQueryBase->chunkAddr, sizeof(OutQueryEntry_t));
+    }
+
 {
 #if (MULTI_CLIENT == 1)
+    // only the heap update of the batch is serialized
     Enclave::topKIndexLck_.lock();
 #endif
-    // update the min-heap
+    // update the min-heap, probe again since Add/Pop move the items
     inQueryEntry = inQueryBase;
+    HeapItem_t* heapItem;
     for (size_t i = 0; i < chunkNum; i++) {
+        if (i + EcallTopKTable::PREFETCH_DIST < chunkNum) {
+            insideDedupIndex_->Prefetch(inQueryBase[i + EcallTopKTable::PREFETCH_DIST].chunkHash);
+        }
         if (inQueryEntry->dedupFlag == UNIQUE || 
             inQueryEntry->dedupFlag == DUPLICATE) {
             uint32_t chunkFreq = inQueryEntry->chunkFreq;
             if (this->CheckIfAddToHeap(chunkFreq)) {
                 // add this chunk to the top-k index
-                tmpHashStr.assign((char*)inQueryEntry->chunkHash, CHUNK_HASH_SIZE);
-                if (insideDedupIndex_->Contains(tmpHashStr)) {
+                heapItem = insideDedupIndex_->Find(inQueryEntry->chunkHash);
+                if (heapItem != NULL) {
                     // it exists in the min-heap
-                    this->UpdateInsideIndexFreq(tmpHashStr, chunkFreq);
-                } else {
+                    this->UpdateInsideIndexFreq(heapItem, chunkFreq);
+                } else if (this->CheckIfAdmit(chunkFreq)) {
                     // it does not exist in the min-heap
                     this->AddChunkToHeap(chunkFreq, &inQueryEntry->chunkAddr,
-                        tmpHashStr);
+                        inQueryEntry->chunkHash);
                 }
             }
         }
         inQueryEntry++;
     }
+
+    // resize the top-k index by its hit ratio within the budget
+    this->AdaptTopKSize(topKLookupNum, topKHitNum);
+
+    // age the frequencies at the end of a period
+    this->AgeFreq(chunkNum);
 #if (MULTI_CLIENT == 1)
     Enclave::topKIndexLck_.unlock();
 #endif
 }
-    // update the out-enclave index
-    upOutSGX->outQuery->queryNum = outQueryNum;
     sgxClient->_localIndex.clear();
+    return ;
+}
 
+
+
+/**
+ * @brief wait for the out-enclave query of the pending batch, then
+ * finish it and update the out-enclave index
+ * 
+ * @param upOutSGX the upload out-enclave var
+ * @param callerCtx the crypto context of the client
+ */
+void EcallFreqIndex::FinishPendingBatch(UpOutSGX_t* upOutSGX, WorkerCtx_t* callerCtx) {
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
+    BatchState_t* pendingBatch = &sgxClient->_pendingBatch;
+    if (pendingBatch->chunkNum == 0) {
+        return ;
+    }
+
+    if (pendingBatch->outQueryNum != 0) {
+        Ocall_WaitOutIndex(upOutSGX->outClient);
+    }
+    this->FinishBatch(upOutSGX, callerCtx, pendingBatch);
+    if (pendingBatch->outQueryNum != 0) {
+        // the query buffer is reused by the next batch, update it in place
+        upOutSGX->outQuery->queryNum = pendingBatch->outQueryNum;
+        Ocall_UpdateOutIndex(upOutSGX->outClient);
+        upOutSGX->outQuery->queryNum = 0;
+    }
+    pendingBatch->chunkNum = 0;
+    return ;
+}
+
+/**
+ * @brief process one batch
+ * 
+ * @param recvChunkBuf the recv chunk buffer
+ * @param upOutSGX the pointer to the enclave-related var 
+ */
+void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf, 
+    UpOutSGX_t* upOutSGX) {
+    // the in-enclave info
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
+    WorkerCtx_t callerCtx;
+    callerCtx.cipherCtx = sgxClient->_cipherCtx;
+    callerCtx.mdCtx = sgxClient->_mdCtx;
+    callerCtx.chunkCipherCtx = sgxClient->_chunkCipherCtx;
+    BatchState_t curBatch;
+
+    if (sgxClient->_spareRecvBuffer == NULL) {
+        // process the batch stage by stage
+        this->HashBatch(recvChunkBuf, upOutSGX, &callerCtx, &curBatch);
+        this->ProbeBatch(upOutSGX, &curBatch);
+        if (curBatch.outQueryNum != 0) {
+            // check the out-enclave index
+            upOutSGX->outQuery->queryNum = curBatch.outQueryNum;
+            Ocall_QueryOutIndex(upOutSGX->outClient);
+        }
+        this->FinishBatch(upOutSGX, &callerCtx, &curBatch);
+
+        // update the out-enclave index
+        upOutSGX->outQuery->queryNum = curBatch.outQueryNum;
+        return ;
+    }
+
+    // hash this batch into the spare buffers while the out-enclave query of
+    // the pending batch is in flight
+    sgxClient->SwapBatchBuffer();
+    this->HashBatch(recvChunkBuf, upOutSGX, &callerCtx, &curBatch);
+    sgxClient->SwapBatchBuffer();
+
+    // the pending batch updates the top-k index and the local index before
+    // this batch probes them, as the stage-by-stage processing
+    this->FinishPendingBatch(upOutSGX, &callerCtx);
+
+    sgxClient->SwapBatchBuffer();
+    this->ProbeBatch(upOutSGX, &curBatch);
+    if (curBatch.outQueryNum != 0) {
+        Ocall_QueryOutIndexAsync(upOutSGX->outClient, curBatch.outQueryNum);
+    }
+    sgxClient->_pendingBatch = curBatch;
+
+    // the enclave updates the out-enclave index when it finishes this batch
+    upOutSGX->outQuery->queryNum = 0;
     return ;
 }
 
@@ -552,7 +954,6 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Recipe_t* inRecipe = &sgxClient->_inRecipe;
 
     string tmpChunkAddrStr;
@@ -565,8 +966,7 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     Ocall_GetCurrentTime(&_startTime);
 #endif
     // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    this->DecodeBatch(recvChunkBuf, sgxClient);
 #if (SGX_BREAKDOWN == 1)
     Ocall_GetCurrentTime(&_endTime);
     _dataTransTime += (_endTime - _startTime);
@@ -610,11 +1010,8 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 #if (SGX_BREAKDOWN == 1)
         Ocall_GetCurrentTime(&_startTime);
 #endif
-        // update the sketch 
-        cmSketch_->Update((uint8_t*)&tmpHashStr[0], CHUNK_HASH_SIZE, 1);
-
-        // estimate the current frequency
-        chunkFreq = cmSketch_->Estimate((uint8_t*)&tmpHashStr[0], CHUNK_HASH_SIZE);
+        // update the sketch and estimate the current frequency
+        chunkFreq = cmSketch_->UpdateEstimate((uint8_t*)&tmpHashStr[0], 1);
 #if (SGX_BREAKDOWN == 1)
         Ocall_GetCurrentTime(&_endTime);
         _freqTime += (_endTime - _startTime);
@@ -692,7 +1089,8 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 #if (SGX_BREAKDOWN == 1)
             Ocall_GetCurrentTime(&_startTime);
 #endif
-            bool heapFindResult = insideDedupIndex_->Contains(tmpHashStr);
+            HeapItem_t* heapItem = insideDedupIndex_->Find((uint8_t*)&tmpHashStr[0]);
+            bool heapFindResult = (heapItem != NULL);
 #if (SGX_BREAKDOWN == 1)
             Ocall_GetCurrentTime(&_endTime);
             _firstDedupTime += (_endTime - _startTime);
@@ -702,10 +1100,10 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 #if (SGX_BREAKDOWN == 1)
                 Ocall_GetCurrentTime(&_startTime);
 #endif
-                tmpChunkAddrStr.assign((char*)insideDedupIndex_->GetPriority(tmpHashStr),
+                tmpChunkAddrStr.assign((char*)&heapItem->address,
                     sizeof(RecipeEntry_t));
                 // update the frequency
-                this->UpdateInsideIndexFreq(tmpHashStr, chunkFreq);
+                this->UpdateInsideIndexFreq(heapItem, chunkFreq);
                 insideDedupChunkNum_++;
                 insideDedupDataSize_ += tmpChunkSize;
 #if (SGX_BREAKDOWN == 1)
@@ -768,7 +1166,7 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
                 Ocall_GetCurrentTime(&_startTime);
 #endif
                 this->AddChunkToHeap(chunkFreq, (RecipeEntry_t*)&tmpChunkAddrStr[0],
-                    tmpHashStr);
+                    (uint8_t*)&tmpHashStr[0]);
 #if (SGX_BREAKDOWN == 1)
                 Ocall_GetCurrentTime(&_endTime);
                 _firstDedupTime += (_endTime - _startTime);
@@ -794,4 +1192,81 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     return ;
 }
 
-#endif
\ No newline at end of file
+#endif
+/**
+ * @brief get the max k that the memory budget holds with the sketch and
+ * the doorkeeper
+ * 
+ * @return size_t the max k
+ */
+size_t EcallFreqIndex::GetMaxTopKSize() {
+    size_t sketchSize = cmSketch_->GetCounterArraySize();
+    if (doorkeeper_ != NULL) {
+        sketchSize += doorkeeper_->GetSize();
+    }
+    // a resize holds the old and the new arrays, each of at most the max k
+    size_t maxTopKSize = 0;
+    if (epcBudget_ > sketchSize) {
+        maxTopKSize = (epcBudget_ - sketchSize) / (2 * EcallTopKTable::ItemMemSize());
+    }
+    return (maxTopKSize < TOP_K_MIN_CAPACITY) ? TOP_K_MIN_CAPACITY : maxTopKSize;
+}
+
+/**
+ * @brief count the top-k lookups of a batch, and resize the top-k index by
+ * the hit ratio at the end of a window, the writers of the top-k index
+ * are serialized by the caller
+ * 
+ * @param lookupNum the number of chunks that probe the top-k index
+ * @param hitNum the number of chunks found in the top-k index
+ */
+void EcallFreqIndex::AdaptTopKSize(uint64_t lookupNum, uint64_t hitNum) {
+    windowLookupNum_ += lookupNum;
+    windowHitNum_ += hitNum;
+    totalLookupNum_ += lookupNum;
+    totalHitNum_ += hitNum;
+    windowBatchNum_++;
+    if (epcBudget_ == 0 || windowBatchNum_ < TOP_K_ADAPT_WINDOW) {
+        return ;
+    }
+
+    if (windowLookupNum_ == 0) {
+        windowBatchNum_ = 0;
+        return ;
+    }
+    double hitRatio = static_cast<double>(windowHitNum_) / windowLookupNum_;
+    size_t maxTopKSize = this->GetMaxTopKSize();
+    size_t newTopKSize = topThreshold_;
+    if (topThreshold_ > maxTopKSize) {
+        // out of the budget
+        newTopKSize = maxTopKSize;
+    } else if (preGrowSize_ != 0 && hitRatio < lastHitRatio_ + TOP_K_MIN_GAIN) {
+        // the items added by the last growth are not hit enough, give back the memory
+        newTopKSize = preGrowSize_;
+        holdWindowNum_ = TOP_K_HOLD_WINDOW;
+    } else if (holdWindowNum_ != 0) {
+        holdWindowNum_--;
+    } else if (insideDedupIndex_->Size() == topThreshold_ && topThreshold_ < maxTopKSize) {
+        // the top-k index is full, try a larger one
+        newTopKSize = (topThreshold_ * 2 > maxTopKSize) ? maxTopKSize : topThreshold_ * 2;
+    }
+    newTopKSize = (newTopKSize < TOP_K_MIN_CAPACITY) ? TOP_K_MIN_CAPACITY : newTopKSize;
+
+    preGrowSize_ = (newTopKSize > topThreshold_) ? topThreshold_ : 0;
+    lastHitRatio_ = hitRatio;
+    if (newTopKSize != topThreshold_) {
+        if (insideDedupIndex_->Resize(newTopKSize)) {
+            Enclave::Logging(myName_.c_str(), "resize the top-k index: %lu -> %lu "
+                "(hit ratio: %lf).\n", topThreshold_, newTopKSize, hitRatio);
+            topThreshold_ = newTopKSize;
+        } else {
+            Enclave::Logging(myName_.c_str(), "cannot resize the top-k index: %lu -> %lu, "
+                "keep the old one.\n", topThreshold_, newTopKSize);
+            preGrowSize_ = 0;
+        }
+    }
+    windowLookupNum_ = 0;
+    windowHitNum_ = 0;
+    windowBatchNum_ = 0;
+    return ;
+}
@@ -177,12 +177,10 @@ void EcallInEnclaveIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Recipe_t* inRecipe = &sgxClient->_inRecipe;
     
     // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    this->DecodeBatch(recvChunkBuf, sgxClient);
 
     // get the chunk num
     uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
@@ -195,13 +193,16 @@ void EcallInEnclaveIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     string tmpHashStr;
     tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
 
+    // compute the hash over the plaintext chunks of the batch
+    InQueryEntry_t* hashEntry = sgxClient->_inQueryBase;
+    cryptoObj_->GenerateHashBatch(mdCtx, recvBuffer, chunkNum, hashEntry->chunkHash,
+        sizeof(InQueryEntry_t));
+
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the plaintext chunk
         memcpy(&tmpChunkSize, recvBuffer + currentOffset, sizeof(uint32_t));
         currentOffset += sizeof(uint32_t);
 
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset, 
-            tmpChunkSize, (uint8_t*)&tmpHashStr[0]);
+        memcpy(&tmpHashStr[0], hashEntry[i].chunkHash, CHUNK_HASH_SIZE);
         
         if (insideIndexObj_.count(tmpHashStr) != 0) {
             // it is duplicate chunk
@@ -46,12 +46,10 @@ void EcallOutEnclaveIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Recipe_t* inRecipe = &sgxClient->_inRecipe;
 
     // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer, 
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    this->DecodeBatch(recvChunkBuf, sgxClient);
 
     // get the chunk num
     uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
@@ -61,24 +59,27 @@ void EcallOutEnclaveIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     tmpChunkAddrStr.resize(sizeof(RecipeEntry_t), 0);
     size_t currentOffset = 0; 
     uint32_t tmpChunkSize = 0;
-    string tmpHashStr;
-    tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
     string tmpCipherHashStr;
     tmpCipherHashStr.resize(CHUNK_HASH_SIZE, 0);
     string tmpCipherAddrStr;
     tmpCipherAddrStr.resize(sizeof(RecipeEntry_t), 0);
     bool status;
 
+    // compute the hash over the plaintext chunks of the batch
+    InQueryEntry_t* hashEntry = sgxClient->_inQueryBase;
+    cryptoObj_->GenerateHashBatch(mdCtx, recvBuffer, chunkNum, hashEntry->chunkHash,
+        sizeof(InQueryEntry_t));
+
+    // encrypt the fingerprints with the index key in one pass (in-place)
+    cryptoObj_->IndexAESCMCEncBatch(cipherCtx, &indexKeySchedule_, hashEntry->chunkHash,
+        sizeof(InQueryEntry_t), chunkNum, CHUNK_HASH_SIZE, hashEntry->chunkHash,
+        sizeof(InQueryEntry_t));
+
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the plaintext chunk
         memcpy(&tmpChunkSize, recvBuffer + currentOffset, sizeof(tmpChunkSize));
         currentOffset += sizeof(tmpChunkSize);
 
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset, 
-            tmpChunkSize, (uint8_t*)&tmpHashStr[0]);
-        
-        cryptoObj_->IndexAESCMCEnc(cipherCtx, (uint8_t*)&tmpHashStr[0], CHUNK_HASH_SIZE, 
-            Enclave::indexQueryKey_, (uint8_t*)&tmpCipherHashStr[0]);
+        memcpy(&tmpCipherHashStr[0], hashEntry[i].chunkHash, CHUNK_HASH_SIZE);
 
         status = this->ReadIndexStore(tmpCipherHashStr, tmpCipherAddrStr, upOutSGX);
         if (status == false) {
@@ -113,8 +114,8 @@ void EcallOutEnclaveIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 
     // reset
     this->ResetCurrentSegment(sgxClient);
-    memset(recvBuffer, 0, Enclave::sendChunkBatchSize_ * sizeof(Chunk_t));
-    memset(recvChunkBuf->dataBuffer, 0, Enclave::sendChunkBatchSize_ * sizeof(Chunk_t));
+    memset(recvBuffer, 0, currentOffset);
+    memset(recvChunkBuf->dataBuffer, 0, recvChunkBuf->header->dataSize);
     return ;
 }
 
@@ -22,6 +22,7 @@ EnclaveBase::EnclaveBase() {
     // the new object 
     storageCoreObj_ = new EcallStorageCore();
     cryptoObj_ = new EcallCrypto(CIPHER_TYPE, HASH_TYPE);
+    cryptoObj_->InitKeySchedule(Enclave::indexQueryKey_, &indexKeySchedule_);
     /// 
 
     Enclave::Logging(myName_.c_str(), "init the EnclaveBase.\n");
@@ -95,13 +96,31 @@ uint32_t EnclaveBase::ConvertHashToValue(const uint8_t* inputHash) {
  */
 void EnclaveBase::UpdateFileRecipe(string& chunkAddrStr, Recipe_t* inRecipe,
     UpOutSGX_t* upOutSGX) {
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
+    if (sgxClient->_recipeMerger != NULL) {
+        // parallel streams: hand over the entries batch by batch, the merger
+        // writes them to the recipe of the primary stream in the batch order
+        if (sgxClient->_streamBatchList.size() == 0) {
+            Ocall_SGX_Exit_Error("EnclaveBase: recipe entry without a batch.");
+        }
+        auto curBatch = &sgxClient->_streamBatchList.front();
+        sgxClient->_streamBatchEntry.append(chunkAddrStr.c_str(), sizeof(RecipeEntry_t));
+        curBatch->second--;
+        if (curBatch->second == 0) {
+            sgxClient->_recipeMerger->AddBatch(curBatch->first,
+                sgxClient->_streamBatchEntry);
+            sgxClient->_streamBatchEntry.clear();
+            sgxClient->_streamBatchList.pop_front();
+        }
+        return ;
+    }
+
     memcpy(inRecipe->entryList + inRecipe->recipeNum * sizeof(RecipeEntry_t), 
         chunkAddrStr.c_str(), sizeof(RecipeEntry_t));
     inRecipe->recipeNum++;
 
     if ((inRecipe->recipeNum % Enclave::sendRecipeBatchSize_) == 0) {
         // in-enclave info 
-        EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
         EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
         uint8_t* masterKey = sgxClient->_masterKey;
 
@@ -120,6 +139,46 @@ void EnclaveBase::UpdateFileRecipe(string& chunkAddrStr, Recipe_t* inRecipe,
     return ;
 }
 
+/**
+ * @brief decrypt the received batch with the session key, and decompress
+ * it if the client sends it in the compressed transfer mode
+ * 
+ * @param recvChunkBuf the recv chunk buffer
+ * @param sgxClient the enclave client, the plaintext batch is in its
+ * recv buffer
+ */
+void EnclaveBase::DecodeBatch(SendMsgBuffer_t* recvChunkBuf, 
+    EnclaveClient* sgxClient) {
+    EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
+    uint8_t* sessionKey = sgxClient->_sessionKey;
+    uint8_t* recvBuffer = sgxClient->_recvBuffer;
+
+    if (sgxClient->_recipeMerger != NULL) {
+        // the recipe entries of this batch are merged by its sequence number
+        sgxClient->_streamBatchList.push_back(make_pair(sgxClient->_nextBatchSeq,
+            recvChunkBuf->header->currentItemNum));
+        sgxClient->_nextBatchSeq += sgxClient->_streamNum;
+    }
+
+    if (recvChunkBuf->header->messageType != CLIENT_UPLOAD_COMPRESSED_CHUNK) {
+        cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
+            recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+        return ;
+    }
+
+    // the client compresses the batch before the session encryption
+    uint8_t* decodeBuffer = sgxClient->_decodeBuffer;
+    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
+        recvChunkBuf->header->dataSize, sessionKey, decodeBuffer);
+    int batchSize = LZ4_decompress_safe((char*)decodeBuffer, (char*)recvBuffer,
+        recvChunkBuf->header->dataSize, Enclave::maxChunkBatchSize_ * sizeof(Chunk_t));
+    if (batchSize < 0) {
+        Ocall_SGX_Exit_Error("EnclaveBase: cannot decompress the recv batch.");
+    }
+    memset(decodeBuffer, 0, recvChunkBuf->header->dataSize);
+    return ;
+}
+
 /**
  * @brief process an unique chunk
  * 
@@ -132,7 +191,7 @@ void EnclaveBase::ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuf
     uint32_t chunkSize, UpOutSGX_t* upOutSGX) {
     EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
     uint8_t* currentIV = sgxClient->PickNewIV();
-    EVP_CIPHER_CTX* cipher = sgxClient->_cipherCtx;
+    EVP_CIPHER_CTX* cipher = sgxClient->_chunkCipherCtx;
     uint8_t tmpCompressedChunk[MAX_CHUNK_SIZE];
     int tmpCompressedChunkSize = 0;
 
@@ -156,7 +215,7 @@ void EnclaveBase::ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuf
         _compressedDataSize += tmpCompressedChunkSize;
 
         // do encryption
-        cryptoObj_->EncryptWithKeyIV(cipher, tmpCompressedChunk, tmpCompressedChunkSize,
+        cryptoObj_->EncryptWithKeyCtx(cipher, tmpCompressedChunk, tmpCompressedChunkSize,
             Enclave::enclaveKey_, tmpCipherChunk, currentIV);
     } else {
         // it cannot be compressed
@@ -164,7 +223,7 @@ void EnclaveBase::ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuf
         tmpCompressedChunkSize = chunkSize;
 
         // do encryption
-        cryptoObj_->EncryptWithKeyIV(cipher, chunkBuffer, chunkSize, Enclave::enclaveKey_,
+        cryptoObj_->EncryptWithKeyCtx(cipher, chunkBuffer, chunkSize, Enclave::enclaveKey_,
             tmpCipherChunk, currentIV);
     }
 #if (SGX_BREAKDOWN == 1)
@@ -179,6 +238,34 @@ void EnclaveBase::ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuf
     return ;
 }
 
+/**
+ * @brief compress and encrypt an unique chunk without saving it, the
+ * enclave workers can call it concurrently
+ * 
+ * @param chunkBuffer the chunk buffer
+ * @param chunkSize the chunk size
+ * @param iv the iv of this chunk
+ * @param chunkCipherCtx the chunk cipher ctx of the calling thread
+ * @param cipherChunk the encoded chunk (MAX_CHUNK_SIZE)
+ * @return uint32_t the size of the encoded chunk
+ */
+uint32_t EnclaveBase::EncodeChunk(uint8_t* chunkBuffer, uint32_t chunkSize, uint8_t* iv,
+    EVP_CIPHER_CTX* chunkCipherCtx, uint8_t* cipherChunk) {
+    uint8_t tmpCompressedChunk[MAX_CHUNK_SIZE];
+    int tmpCompressedChunkSize = LZ4_compress_fast((char*)(chunkBuffer),
+        (char*)tmpCompressedChunk, chunkSize, chunkSize, 3);
+    if (tmpCompressedChunkSize > 0) {
+        // it can be compressed
+        cryptoObj_->EncryptWithKeyCtx(chunkCipherCtx, tmpCompressedChunk, tmpCompressedChunkSize,
+            Enclave::enclaveKey_, cipherChunk, iv);
+        return tmpCompressedChunkSize;
+    }
+    // it cannot be compressed
+    cryptoObj_->EncryptWithKeyCtx(chunkCipherCtx, chunkBuffer, chunkSize, Enclave::enclaveKey_,
+        cipherChunk, iv);
+    return chunkSize;
+}
+
 
 /**
  * @brief update the index store
@@ -95,7 +95,8 @@ void EcallRecvDecoder::ProcRecipeBatch(uint8_t* recipeBuffer, size_t recipeNum,
                 uint32_t offset = sgxClient->_enclaveRecipeBuffer[idx].offset;
                 uint32_t chunkSize = sgxClient->_enclaveRecipeBuffer[idx].length;
                 uint8_t* chunkBuffer = containerArray[containerID] + offset;
-                this->RecoverOneChunk(chunkBuffer, chunkSize, restoreChunkBuf, cipherCtx);
+                this->RecoverOneChunk(chunkBuffer, chunkSize, restoreChunkBuf, cipherCtx,
+                    resOutSGX->transferMode);
                 if (restoreChunkBuf->header->currentItemNum % 
                     Enclave::sendChunkBatchSize_ == 0) {
                     cryptoObj_->SessionKeyEnc(cipherCtx, restoreChunkBuf->dataBuffer,
@@ -150,7 +151,7 @@ void EcallRecvDecoder::ProcRecipeTailBatch(ResOutSGX_t* resOutSGX) {
             uint32_t chunkSize = sgxClient->_enclaveRecipeBuffer[idx].length;
             uint8_t* chunkBuffer = containerArray[containerID] + offset;
             this->RecoverOneChunk(chunkBuffer, chunkSize, restoreChunkBuf, 
-                cipherCtx);
+                cipherCtx, resOutSGX->transferMode);
             remainChunkNum--;
             if (remainChunkNum == 0) {
                 // this is the last batch of chunks;
@@ -198,15 +199,17 @@ void EcallRecvDecoder::ProcRecipeTailBatch(ResOutSGX_t* resOutSGX) {
  * @param chunkSize the chunk size
  * @param restoreChunkBuf the restore chunk buffer
  * @param cipherCtx the pointer to the EVP cipher
+ * @param transferMode the transfer mode of the restored chunks
  * 
  */
 void EcallRecvDecoder::RecoverOneChunk(uint8_t* chunkBuffer, uint32_t chunkSize, 
-    SendMsgBuffer_t* restoreChunkBuf, EVP_CIPHER_CTX* cipherCtx) {
+    SendMsgBuffer_t* restoreChunkBuf, EVP_CIPHER_CTX* cipherCtx,
+    uint32_t transferMode) {
     uint8_t* iv = chunkBuffer + chunkSize; 
     uint8_t* outputBuffer = restoreChunkBuf->dataBuffer + 
         restoreChunkBuf->header->dataSize;
     uint8_t decompressedChunk[MAX_CHUNK_SIZE];
-    
+
     // first decrypt the chunk first
     cryptoObj_->DecryptionWithKeyIV(cipherCtx, chunkBuffer, chunkSize, 
         Enclave::enclaveKey_, decompressedChunk, iv);
@@ -214,7 +217,16 @@ void EcallRecvDecoder::RecoverOneChunk(uint8_t* chunkBuffer, uint32_t chunkSize,
     // try to decompress the chunk
     int decompressedSize = LZ4_decompress_safe((char*)decompressedChunk, 
         (char*)(outputBuffer + sizeof(uint32_t)), chunkSize, MAX_CHUNK_SIZE);
-    if (decompressedSize > 0) {
+    if (transferMode == COMPRESSED_TRANSFER) {
+        // ship the stored chunk, flag it if the client has to decompress it
+        uint32_t chunkHead = chunkSize;
+        if (decompressedSize > 0) {
+            chunkHead |= COMPRESSED_CHUNK_FLAG;
+        }
+        memcpy(outputBuffer, &chunkHead, sizeof(uint32_t));
+        memcpy(outputBuffer + sizeof(uint32_t), decompressedChunk, chunkSize);
+        restoreChunkBuf->header->dataSize += sizeof(uint32_t) + chunkSize;
+    } else if (decompressedSize > 0) {
         // it can do the decompression, write back the decompressed chunk size
         memcpy(outputBuffer, &decompressedSize, sizeof(uint32_t));
         restoreChunkBuf->header->dataSize += sizeof(uint32_t) + decompressedSize; 
@@ -18,14 +18,22 @@ namespace Enclave {
     bool firstBootstrap_; // 
     // config
     uint64_t sendChunkBatchSize_;
+    uint64_t maxChunkBatchSize_;
     uint64_t sendRecipeBatchSize_;
     uint64_t topKParam_;
+    uint64_t topKEPCBudget_;
+    uint64_t sketchWidth_;
+    uint64_t sketchDepth_;
+    uint64_t freqPolicy_;
+    uint64_t outQueryPipeline_;
     // lock
     mutex sessionKeyLck_;
     mutex sketchLck_;
     mutex topKIndexLck_;
     // the obj to the enclave index
     EnclaveBase* enclaveBaseObj_;
+    // the worker threads inside the enclave
+    EcallWorkerPool* workerPool_;
 };
 
 void Enclave::Logging(const char* logger, const char* fmt, ...) {
@@ -0,0 +1,281 @@
+/**
+ * @file ecallAes.cc
+ * @brief implement the AES-256 kernel with AES-NI
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/ecallAes.h"
+
+// the enclave is built without the intrinsic headers, use the vector
+// extensions and the builtins of the AES instructions, __builtin_shufflevector
+// is accepted by both clang and gcc (>= 12)
+typedef long long AesVec_t __attribute__((vector_size(16)));
+typedef int AesWordVec_t __attribute__((vector_size(16)));
+
+#define AES_TARGET __attribute__((target("aes,ssse3")))
+
+/**
+ * @brief xor the words of the previous round key as the key expansion
+ * 
+ * @param roundKey the previous round key
+ * @return AesVec_t w0, w0^w1, w0^w1^w2, w0^w1^w2^w3
+ */
+AES_TARGET static inline AesVec_t ChainWords(AesVec_t roundKey) {
+    // shift the words up by one word with the zero fill
+    const AesWordVec_t zero = {0, 0, 0, 0};
+    AesWordVec_t words = (AesWordVec_t)roundKey;
+    AesWordVec_t tmpWords = __builtin_shufflevector(words, zero, 4, 0, 1, 2);
+    words ^= tmpWords;
+    tmpWords = __builtin_shufflevector(tmpWords, zero, 4, 0, 1, 2);
+    words ^= tmpWords;
+    tmpWords = __builtin_shufflevector(tmpWords, zero, 4, 0, 1, 2);
+    words ^= tmpWords;
+    return (AesVec_t)words;
+}
+
+/**
+ * @brief generate the even round key (RotWord, SubWord, and rcon)
+ * 
+ * @tparam RCON the round constant
+ * @param prevEven the previous even round key
+ * @param prevOdd the previous odd round key
+ * @return AesVec_t the round key
+ */
+template <int RCON>
+AES_TARGET static inline AesVec_t NextEvenKey(AesVec_t prevEven, AesVec_t prevOdd) {
+    AesWordVec_t assist = (AesWordVec_t)__builtin_ia32_aeskeygenassist128(prevOdd, RCON);
+    assist = __builtin_shufflevector(assist, assist, 3, 3, 3, 3);
+    return ChainWords(prevEven) ^ (AesVec_t)assist;
+}
+
+/**
+ * @brief generate the odd round key (SubWord only)
+ * 
+ * @param prevOdd the previous odd round key
+ * @param curEven the current even round key
+ * @return AesVec_t the round key
+ */
+AES_TARGET static inline AesVec_t NextOddKey(AesVec_t prevOdd, AesVec_t curEven) {
+    AesWordVec_t assist = (AesWordVec_t)__builtin_ia32_aeskeygenassist128(curEven, 0);
+    assist = __builtin_shufflevector(assist, assist, 2, 2, 2, 2);
+    return ChainWords(prevOdd) ^ (AesVec_t)assist;
+}
+
+/**
+ * @brief expand the encryption and decryption round keys
+ * 
+ * @param key the 256-bit key
+ * @param keySchedule the key schedule
+ */
+AES_TARGET void EcallAes::ExpandKey(const uint8_t* key, AesKeySchedule_t* keySchedule) {
+    memcpy(keySchedule->key, key, sizeof(keySchedule->key));
+    AesVec_t roundKey[AES_256_ROUND_KEY_NUM];
+    memcpy(&roundKey[0], key, sizeof(AesVec_t));
+    memcpy(&roundKey[1], key + sizeof(AesVec_t), sizeof(AesVec_t));
+    roundKey[2] = NextEvenKey<0x01>(roundKey[0], roundKey[1]);
+    roundKey[3] = NextOddKey(roundKey[1], roundKey[2]);
+    roundKey[4] = NextEvenKey<0x02>(roundKey[2], roundKey[3]);
+    roundKey[5] = NextOddKey(roundKey[3], roundKey[4]);
+    roundKey[6] = NextEvenKey<0x04>(roundKey[4], roundKey[5]);
+    roundKey[7] = NextOddKey(roundKey[5], roundKey[6]);
+    roundKey[8] = NextEvenKey<0x08>(roundKey[6], roundKey[7]);
+    roundKey[9] = NextOddKey(roundKey[7], roundKey[8]);
+    roundKey[10] = NextEvenKey<0x10>(roundKey[8], roundKey[9]);
+    roundKey[11] = NextOddKey(roundKey[9], roundKey[10]);
+    roundKey[12] = NextEvenKey<0x20>(roundKey[10], roundKey[11]);
+    roundKey[13] = NextOddKey(roundKey[11], roundKey[12]);
+    roundKey[14] = NextEvenKey<0x40>(roundKey[12], roundKey[13]);
+    memcpy(keySchedule->encRoundKey, roundKey, sizeof(roundKey));
+
+    // the equivalent inverse cipher uses the reversed keys with InvMixColumns
+    AesVec_t decRoundKey[AES_256_ROUND_KEY_NUM];
+    decRoundKey[0] = roundKey[AES_256_ROUND_KEY_NUM - 1];
+    for (size_t i = 1; i < AES_256_ROUND_KEY_NUM - 1; i++) {
+        decRoundKey[i] = __builtin_ia32_aesimc128(roundKey[AES_256_ROUND_KEY_NUM - 1 - i]);
+    }
+    decRoundKey[AES_256_ROUND_KEY_NUM - 1] = roundKey[0];
+    memcpy(keySchedule->decRoundKey, decRoundKey, sizeof(decRoundKey));
+    return ;
+}
+
+/**
+ * @brief encrypt the items of the lanes with AES-256-CBC
+ * 
+ * @param keySchedule the key schedule
+ * @param inputList the input of each lane
+ * @param outputList the output of each lane (NULL: the idle lane)
+ * @param blockNum the number of blocks per item
+ */
+AES_TARGET void EcallAes::CBCEncLanes(const AesKeySchedule_t* keySchedule,
+    const uint8_t** inputList, uint8_t** outputList, size_t blockNum) {
+    const AesVec_t* roundKey = (const AesVec_t*)keySchedule->encRoundKey;
+    AesVec_t chainList[LANE_NUM] = {}; // the zero iv
+    for (size_t block = 0; block < blockNum; block++) {
+        AesVec_t stateList[LANE_NUM];
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            memcpy(&stateList[lane], inputList[lane] + block * BLOCK_SIZE, BLOCK_SIZE);
+            stateList[lane] ^= chainList[lane] ^ roundKey[0];
+        }
+        // the lanes are independent, the rounds of them are pipelined
+        for (size_t round = 1; round < AES_256_ROUND_KEY_NUM - 1; round++) {
+            for (size_t lane = 0; lane < LANE_NUM; lane++) {
+                stateList[lane] = __builtin_ia32_aesenc128(stateList[lane], roundKey[round]);
+            }
+        }
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            chainList[lane] = __builtin_ia32_aesenclast128(stateList[lane],
+                roundKey[AES_256_ROUND_KEY_NUM - 1]);
+            if (outputList[lane] != NULL) {
+                memcpy(outputList[lane] + block * BLOCK_SIZE, &chainList[lane], BLOCK_SIZE);
+            }
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief decrypt the items of the lanes with AES-256-CBC
+ * 
+ * @param keySchedule the key schedule
+ * @param inputList the input of each lane
+ * @param outputList the output of each lane (NULL: the idle lane)
+ * @param blockNum the number of blocks per item
+ */
+AES_TARGET void EcallAes::CBCDecLanes(const AesKeySchedule_t* keySchedule,
+    const uint8_t** inputList, uint8_t** outputList, size_t blockNum) {
+    const AesVec_t* roundKey = (const AesVec_t*)keySchedule->decRoundKey;
+    AesVec_t chainList[LANE_NUM] = {}; // the zero iv
+    for (size_t block = 0; block < blockNum; block++) {
+        AesVec_t cipherList[LANE_NUM];
+        AesVec_t stateList[LANE_NUM];
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            memcpy(&cipherList[lane], inputList[lane] + block * BLOCK_SIZE, BLOCK_SIZE);
+            stateList[lane] = cipherList[lane] ^ roundKey[0];
+        }
+        for (size_t round = 1; round < AES_256_ROUND_KEY_NUM - 1; round++) {
+            for (size_t lane = 0; lane < LANE_NUM; lane++) {
+                stateList[lane] = __builtin_ia32_aesdec128(stateList[lane], roundKey[round]);
+            }
+        }
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            stateList[lane] = __builtin_ia32_aesdeclast128(stateList[lane],
+                roundKey[AES_256_ROUND_KEY_NUM - 1]) ^ chainList[lane];
+            chainList[lane] = cipherList[lane];
+            if (outputList[lane] != NULL) {
+                memcpy(outputList[lane] + block * BLOCK_SIZE, &stateList[lane], BLOCK_SIZE);
+            }
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief encrypt the items with AES-256-CBC, the items can be in-place
+ * 
+ * @param keySchedule the key schedule
+ * @param input the first input item
+ * @param inputStride the stride of the input items
+ * @param itemNum the number of items
+ * @param itemSize the item size (multiple of BLOCK_SIZE)
+ * @param output the first output item
+ * @param outputStride the stride of the output items
+ */
+void EcallAes::CBCEncBatch(const AesKeySchedule_t* keySchedule, const uint8_t* input,
+    size_t inputStride, size_t itemNum, size_t itemSize, uint8_t* output,
+    size_t outputStride) {
+    const uint8_t* inputList[LANE_NUM];
+    uint8_t* outputList[LANE_NUM];
+    for (size_t start = 0; start < itemNum; start += LANE_NUM) {
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            if (start + lane < itemNum) {
+                inputList[lane] = input + (start + lane) * inputStride;
+                outputList[lane] = output + (start + lane) * outputStride;
+            } else {
+                // the idle lane repeats the first item without the output
+                inputList[lane] = inputList[0];
+                outputList[lane] = NULL;
+            }
+        }
+        CBCEncLanes(keySchedule, inputList, outputList, itemSize / BLOCK_SIZE);
+    }
+    return ;
+}
+
+/**
+ * @brief decrypt the items with AES-256-CBC, the items can be in-place
+ * 
+ * @param keySchedule the key schedule
+ * @param input the first input item
+ * @param inputStride the stride of the input items
+ * @param itemNum the number of items
+ * @param itemSize the item size (multiple of BLOCK_SIZE)
+ * @param output the first output item
+ * @param outputStride the stride of the output items
+ */
+void EcallAes::CBCDecBatch(const AesKeySchedule_t* keySchedule, const uint8_t* input,
+    size_t inputStride, size_t itemNum, size_t itemSize, uint8_t* output,
+    size_t outputStride) {
+    const uint8_t* inputList[LANE_NUM];
+    uint8_t* outputList[LANE_NUM];
+    for (size_t start = 0; start < itemNum; start += LANE_NUM) {
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            if (start + lane < itemNum) {
+                inputList[lane] = input + (start + lane) * inputStride;
+                outputList[lane] = output + (start + lane) * outputStride;
+            } else {
+                inputList[lane] = inputList[0];
+                outputList[lane] = NULL;
+            }
+        }
+        CBCDecLanes(keySchedule, inputList, outputList, itemSize / BLOCK_SIZE);
+    }
+    return ;
+}
+
+/**
+ * @brief encrypt the items with AES-CMC (CBC, reverse the bytes, CBC),
+ * the intermediate result stays in the local buffer
+ * 
+ * @param keySchedule the key schedule
+ * @param input the first input item
+ * @param inputStride the stride of the input items
+ * @param itemNum the number of items
+ * @param itemSize the item size (multiple of BLOCK_SIZE, <= MAX_CMC_ITEM_SIZE)
+ * @param output the first output item
+ * @param outputStride the stride of the output items
+ */
+void EcallAes::CMCEncBatch(const AesKeySchedule_t* keySchedule, const uint8_t* input,
+    size_t inputStride, size_t itemNum, size_t itemSize, uint8_t* output,
+    size_t outputStride) {
+    uint8_t tmpBuffer[LANE_NUM][MAX_CMC_ITEM_SIZE];
+    const uint8_t* inputList[LANE_NUM];
+    uint8_t* tmpList[LANE_NUM];
+    const uint8_t* tmpInputList[LANE_NUM];
+    uint8_t* outputList[LANE_NUM];
+    for (size_t start = 0; start < itemNum; start += LANE_NUM) {
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            tmpList[lane] = tmpBuffer[lane];
+            tmpInputList[lane] = tmpBuffer[lane];
+            if (start + lane < itemNum) {
+                inputList[lane] = input + (start + lane) * inputStride;
+                outputList[lane] = output + (start + lane) * outputStride;
+            } else {
+                inputList[lane] = inputList[0];
+                outputList[lane] = NULL;
+            }
+        }
+        CBCEncLanes(keySchedule, inputList, tmpList, itemSize / BLOCK_SIZE);
+        for (size_t lane = 0; lane < LANE_NUM; lane++) {
+            uint8_t* lo = tmpBuffer[lane];
+            uint8_t* hi = tmpBuffer[lane] + itemSize - 1;
+            while (lo < hi) {
+                uint8_t swap = *lo;
+                *lo++ = *hi;
+                *hi-- = swap;
+            }
+        }
+        CBCEncLanes(keySchedule, tmpInputList, outputList, itemSize / BLOCK_SIZE);
+    }
+    return ;
+}
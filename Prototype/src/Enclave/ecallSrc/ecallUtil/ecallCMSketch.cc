@@ -1,7 +1,7 @@
 /**
  * @file ecallCMSketch.cc
  * @author Zuoru YANG (zryang@cse.cuhk.edu.hk)
- * @brief implement the interface defined in EcallCMSketch 
+ * @brief implement the interface defined in EcallCMSketch
  * @version 0.1
  * @date 2021-01-13
  * 
@@ -11,32 +11,81 @@
 
 #include "../../include/ecallCMSketch.h"
 
+// the 4 counters of a row in a block
+typedef uint32_t RowVec_t __attribute__((vector_size(16)));
+typedef int32_t RowMask_t __attribute__((vector_size(16)));
+
 /**
  * @brief Construct a new Count Min Sketch:: Count Min Sketch object
  * 
  * @param width the width of the sketch
- * @param depth the depth of the sketch
+ * @param depth the depth of the sketch (at most 16)
+ * @param updateType the update type
  */
-EcallCMSketch::EcallCMSketch(uint32_t width, uint32_t depth) {
+EcallCMSketch::EcallCMSketch(uint32_t width, uint32_t depth, uint32_t updateType) {
     width_ = width;
-    depth_ = depth;
+    // each row takes at least one lane of the block
+    depth_ = (depth == 0) ? 1 : ((depth > BLOCK_COUNTER_NUM) ? BLOCK_COUNTER_NUM : depth);
+    laneNum_ = BLOCK_COUNTER_NUM / depth_;
+    updateType_ = updateType;
     total_ = 0;
-    /**initialize counter array */
-    counterArray_ = (uint32_t**) malloc(sizeof(uint32_t*) * depth_);
-    size_t i, j;
-    for (i = 0; i < depth_; i++) {
-        counterArray_[i] = (uint32_t*) malloc(sizeof(uint32_t) * width_);
-        for (j = 0; j < width_; j++) {
-            counterArray_[i][j] = 0;
-        }
+
+    /**initialize counter array, same number of counters as width_ * depth_ */
+    blockNum_ = ((uint64_t)width_ * depth_ + BLOCK_COUNTER_NUM - 1) / BLOCK_COUNTER_NUM;
+    if (blockNum_ == 0) {
+        blockNum_ = 1;
     }
+    rawBuffer_ = (uint8_t*) malloc(blockNum_ * BLOCK_SIZE + BLOCK_SIZE);
+    counterArray_ = (uint32_t*)(((uintptr_t)rawBuffer_ + BLOCK_SIZE - 1) &
+        ~((uintptr_t)BLOCK_SIZE - 1));
+    memset(counterArray_, 0, blockNum_ * BLOCK_SIZE);
+}
 
-    /**initialize depth_ pairwise indepent hashes */
-    resultHash_ = (uint32_t*) malloc(sizeof(uint32_t) * depth_);
+/**
+ * @brief the update and estimation of a 4-row block with the vector
+ * instructions
+ * 
+ * @param block the block
+ * @param laneBits the lane bits
+ * @param count count number
+ * @return uint32_t the frequency after the update
+ */
+uint32_t EcallCMSketch::UpdateBlockVec(uint32_t* block, uint64_t laneBits, uint32_t count) {
+    const RowVec_t laneIdx = {0, 1, 2, 3};
+    RowVec_t* rowList = (RowVec_t*)block;
+    RowMask_t selList[4];
+    RowVec_t minVec = {UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX};
+    for (size_t i = 0; i < 4; i++) {
+        uint32_t lane = this->GetLaneIdx(laneBits, i) - i * 4;
+        RowVec_t laneVec = {lane, lane, lane, lane};
+        selList[i] = (laneIdx == laneVec);
+        // the counters out of the selected lanes do not affect the min
+        RowVec_t rowVec = rowList[i] | ~(RowVec_t)selList[i];
+        minVec = (rowVec < minVec) ? rowVec : minVec;
+    }
+    uint32_t minVal = minVec[0];
+    for (size_t i = 1; i < 4; i++) {
+        minVal = (minVec[i] < minVal) ? minVec[i] : minVal;
+    }
+    uint32_t newVal = minVal + count;
+    RowVec_t countVec = {count, count, count, count};
+
+    if (updateType_ == CONSERVATIVE_UPDATE) {
+        RowVec_t newVec = {newVal, newVal, newVal, newVal};
+        for (size_t i = 0; i < 4; i++) {
+            // raise the selected counters below the new estimate
+            rowList[i] = (selList[i] & (rowList[i] < newVec)) ? newVec : rowList[i];
+        }
+    } else {
+        for (size_t i = 0; i < 4; i++) {
+            rowList[i] += countVec & (RowVec_t)selList[i];
+        }
+    }
+    return newVal;
 }
 
 /**
- * @brief estimate the chunk count 
+ * @brief estimate the chunk count
  * 
  * @param chunkHash the input chunk hash
  * @param chunkHashLen the length of the chunk hash
@@ -44,12 +93,11 @@ EcallCMSketch::EcallCMSketch(uint32_t width, uint32_t depth) {
  */
 uint32_t EcallCMSketch::Estimate(const uint8_t* chunkHash, size_t chunkHashLen) {
     uint32_t minVal = UINT32_MAX; // max uint32_t value
-    uint32_t pos;
-    const uint32_t* chunkHashPtr = reinterpret_cast<const uint32_t*>(chunkHash);
-    // MurmurHash3_x64_128(chunkHash, chunkHashLen, constSeed_, resultHash_);
+    uint32_t* block = this->GetBlock(chunkHash);
+    uint64_t laneBits = this->GetLaneBits(chunkHash);
     for (size_t i = 0; i < depth_; i++) {
-        pos = chunkHashPtr[i] % width_;
-        minVal = min(minVal, counterArray_[i][pos]);
+        uint32_t counter = block[this->GetLaneIdx(laneBits, i)];
+        minVal = (counter < minVal) ? counter : minVal;
     }
     return minVal;
 }
@@ -60,11 +108,7 @@ uint32_t EcallCMSketch::Estimate(const uint8_t* chunkHash, size_t chunkHashLen)
  * 
  */
 EcallCMSketch::~EcallCMSketch() {
-    for (size_t index = 0; index < depth_; index++) {
-        free(counterArray_[index]);
-    }
-    free(counterArray_);
-    free(resultHash_);
+    free(rawBuffer_);
 }
 
 /**
@@ -84,28 +128,113 @@ size_t EcallCMSketch::TotalCount() {
  * @param count count number
  */
 void EcallCMSketch::Update(const uint8_t* chunkHash, size_t chunkHashLen, uint32_t count) {
+    this->UpdateEstimate(chunkHash, count);
+    return ;
+}
+
+/**
+ * @brief update the sketch and estimate the chunk count in one pass
+ * 
+ * @param chunkHash the input chunk hash
+ * @param count count number
+ * @return uint32_t count number after the update
+ */
+uint32_t EcallCMSketch::UpdateEstimate(const uint8_t* chunkHash, uint32_t count) {
     total_ += count;
-    uint32_t pos;
-    const uint32_t* chunkHashPtr = reinterpret_cast<const uint32_t*>(chunkHash);
-    // MurmurHash3_x64_128(chunkHash, chunkHashLen, constSeed_, resultHash_);
+    uint32_t* block = this->GetBlock(chunkHash);
+    uint64_t laneBits = this->GetLaneBits(chunkHash);
+    if (depth_ == 4) {
+        return this->UpdateBlockVec(block, laneBits, count);
+    }
+
+    uint32_t minVal = UINT32_MAX;
+    uint32_t* counterList[BLOCK_COUNTER_NUM];
     for (size_t i = 0; i < depth_; i++) {
-        pos = chunkHashPtr[i] % width_;
-        counterArray_[i][pos] += count;
+        counterList[i] = block + this->GetLaneIdx(laneBits, i);
+        minVal = (*counterList[i] < minVal) ? *counterList[i] : minVal;
+    }
+    uint32_t newVal = minVal + count;
+    for (size_t i = 0; i < depth_; i++) {
+        if (updateType_ == CONSERVATIVE_UPDATE) {
+            // raise the counters below the new estimate
+            *counterList[i] = (*counterList[i] < newVal) ? newVal : *counterList[i];
+        } else {
+            *counterList[i] += count;
+        }
+    }
+    return newVal;
+}
+
+/**
+ * @brief update the sketch with the chunks of a batch, and set the
+ * chunk freq of each entry
+ * 
+ * @param entryList the query entries of the batch
+ * @param entryNum the number of entries
+ * @param count count number
+ */
+void EcallCMSketch::UpdateBatch(InQueryEntry_t* entryList, size_t entryNum, uint32_t count) {
+    for (size_t i = 0; i < entryNum && i < PREFETCH_DIST; i++) {
+        __builtin_prefetch(this->GetBlock(entryList[i].chunkHash), 1);
+    }
+    for (size_t i = 0; i < entryNum; i++) {
+        if (i + PREFETCH_DIST < entryNum) {
+            __builtin_prefetch(this->GetBlock(entryList[i + PREFETCH_DIST].chunkHash), 1);
+        }
+        entryList[i].chunkFreq = this->UpdateEstimate(entryList[i].chunkHash, count);
     }
     return ;
 }
 
 /**
- * @brief clear the state of this sketch
+ * @brief update the sketch with the chunks of a batch by the count of
+ * each chunk, and set the chunk freq of each entry
  * 
+ * @param entryList the query entries of the batch
+ * @param entryNum the number of entries
+ * @param countList the count of each entry (0: only estimate)
  */
-void EcallCMSketch::ClearUp() {
-    size_t indexWidth;
-    size_t indexDepth;
-    for (indexWidth = 0; indexWidth < width_; indexWidth++) {
-        for (indexDepth = 0; indexDepth < depth_; indexDepth++) {
-            counterArray_[indexDepth][indexWidth] = 0;
+void EcallCMSketch::UpdateBatch(InQueryEntry_t* entryList, size_t entryNum,
+    const uint32_t* countList) {
+    for (size_t i = 0; i < entryNum && i < PREFETCH_DIST; i++) {
+        __builtin_prefetch(this->GetBlock(entryList[i].chunkHash), 1);
+    }
+    for (size_t i = 0; i < entryNum; i++) {
+        if (i + PREFETCH_DIST < entryNum) {
+            __builtin_prefetch(this->GetBlock(entryList[i + PREFETCH_DIST].chunkHash), 1);
         }
+        entryList[i].chunkFreq = this->UpdateEstimate(entryList[i].chunkHash, countList[i]);
     }
     return ;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief halve all counters (aging), the clients can merge their deltas
+ * concurrently
+ * 
+ */
+void EcallCMSketch::Halve() {
+    uint64_t counterNum = blockNum_ * BLOCK_COUNTER_NUM;
+    for (uint64_t i = 0; i < counterNum; i++) {
+        uint32_t counter = __atomic_load_n(&counterArray_[i], __ATOMIC_RELAXED);
+        // retry if a merge adds to the counter in between
+        while (counter != 0 && !__atomic_compare_exchange_n(&counterArray_[i], &counter,
+            counter >> 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        }
+    }
+    uint64_t total = __atomic_load_n(&total_, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&total_, &total, total >> 1, true,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    return ;
+}
+
+/**
+ * @brief clear the state of this sketch
+ * 
+ */
+void EcallCMSketch::ClearUp() {
+    memset(counterArray_, 0, blockNum_ * BLOCK_SIZE);
+    total_ = 0;
+    return ;
+}
@@ -10,6 +10,7 @@
  */
 
 #include "../../include/ecallClient.h"
+#include "../../include/ecallRecipeMerger.h"
 
 /**
  * @brief Construct a new Enclave Client object
@@ -27,6 +28,7 @@ EnclaveClient::EnclaveClient(uint32_t clientID, int indexType, int optType) {
     // init the ctx
     _cipherCtx = EVP_CIPHER_CTX_new();
     _mdCtx = EVP_MD_CTX_new();
+    _chunkCipherCtx = EVP_CIPHER_CTX_new();
 
     // get a random iv
     sgx_read_rand(_iv, CRYPTO_BLOCK_SIZE); 
@@ -67,6 +69,7 @@ EnclaveClient::~EnclaveClient() {
     }
     EVP_CIPHER_CTX_free(_cipherCtx);
     EVP_MD_CTX_free(_mdCtx);
+    EVP_CIPHER_CTX_free(_chunkCipherCtx);
 }
 
 /**
@@ -74,7 +77,9 @@ EnclaveClient::~EnclaveClient() {
  * 
  */
 void EnclaveClient::InitUploadBuffer() {
-    _recvBuffer = (uint8_t*) malloc(Enclave::sendChunkBatchSize_ * sizeof(Chunk_t));
+    // the client tunes the batch size up to the max batch size
+    _recvBuffer = (uint8_t*) malloc(Enclave::maxChunkBatchSize_ * sizeof(Chunk_t));
+    _decodeBuffer = (uint8_t*) malloc(Enclave::maxChunkBatchSize_ * sizeof(Chunk_t));
     _inRecipe.entryList = (uint8_t*) malloc(Enclave::sendRecipeBatchSize_ *
         sizeof(RecipeEntry_t));
     _inRecipe.recipeNum = 0;
@@ -88,12 +93,48 @@ void EnclaveClient::InitUploadBuffer() {
         _segment.segmentSize = 0;
     }
 
-    _inQueryBase = (InQueryEntry_t*) malloc(Enclave::sendChunkBatchSize_ * 
+    _inQueryBase = (InQueryEntry_t*) malloc(Enclave::maxChunkBatchSize_ * 
         sizeof(InQueryEntry_t));
-    _localIndex.reserve(Enclave::sendChunkBatchSize_);
+    _topKItemList = (HeapItem_t*) malloc(Enclave::maxChunkBatchSize_ *
+        sizeof(HeapItem_t));
+    _localIndex.reserve(Enclave::maxChunkBatchSize_);
     _inContainer.buf = (uint8_t*) malloc(MAX_CONTAINER_SIZE * sizeof(uint8_t));
     _inContainer.curSize = 0;
 
+    if (indexType_ == FREQ_INDEX) {
+        _chunkOffsetList = (uint32_t*) malloc(Enclave::maxChunkBatchSize_ *
+            sizeof(uint32_t));
+        _encodeIdxList = (uint32_t*) malloc(ENCLAVE_ENCODE_WINDOW * sizeof(uint32_t));
+        _encodeIVList = (uint8_t*) malloc(ENCLAVE_ENCODE_WINDOW * CRYPTO_BLOCK_SIZE);
+        _encodeSizeList = (uint32_t*) malloc(ENCLAVE_ENCODE_WINDOW * sizeof(uint32_t));
+        _encodeBuffer = (uint8_t*) malloc(ENCLAVE_ENCODE_WINDOW * MAX_CHUNK_SIZE);
+        _outQueryHashList = (uint8_t*) malloc(Enclave::maxChunkBatchSize_ *
+            CHUNK_HASH_SIZE);
+        _outQueryAddrList = (RecipeEntry_t*) malloc(Enclave::maxChunkBatchSize_ *
+            sizeof(RecipeEntry_t));
+        _freqCountList = (uint32_t*) malloc(Enclave::maxChunkBatchSize_ *
+            sizeof(uint32_t));
+    }
+
+    _pendingBatch.chunkNum = 0;
+    _spareRecvBuffer = NULL;
+    _spareInQueryBase = NULL;
+    _spareChunkOffsetList = NULL;
+    if (indexType_ == FREQ_INDEX && Enclave::outQueryPipeline_ != 0) {
+        // the next batch is hashed while the query of the pending batch is in flight
+        _spareRecvBuffer = (uint8_t*) malloc(Enclave::maxChunkBatchSize_ * sizeof(Chunk_t));
+        _spareInQueryBase = (InQueryEntry_t*) malloc(Enclave::maxChunkBatchSize_ *
+            sizeof(InQueryEntry_t));
+        _spareChunkOffsetList = (uint32_t*) malloc(Enclave::maxChunkBatchSize_ *
+            sizeof(uint32_t));
+    }
+
+    // a single stream by default, Ecall_Join_Stream sets the parallel streams
+    _recipeMerger = NULL;
+    _streamID = 0;
+    _streamNum = 1;
+    _nextBatchSeq = 0;
+
     return ;
 }
 
@@ -103,13 +144,33 @@ void EnclaveClient::InitUploadBuffer() {
  */
 void EnclaveClient::DestroyUploadBuffer() {
     free(_recvBuffer);
+    free(_decodeBuffer);
     free(_inRecipe.entryList);
     if (indexType_ == EXTREME_BIN || indexType_ == SPARSE_INDEX) {
         free(_segment.buffer);
         free(_segment.metadata);
     }
     free(_inQueryBase);
+    free(_topKItemList);
     free(_inContainer.buf);
+    if (indexType_ == FREQ_INDEX) {
+        free(_chunkOffsetList);
+        free(_encodeIdxList);
+        free(_encodeIVList);
+        free(_encodeSizeList);
+        free(_encodeBuffer);
+        free(_outQueryHashList);
+        free(_outQueryAddrList);
+        free(_freqCountList);
+    }
+    if (_spareRecvBuffer != NULL) {
+        free(_spareRecvBuffer);
+        free(_spareInQueryBase);
+        free(_spareChunkOffsetList);
+    }
+    if (_recipeMerger != NULL && _streamID == 0) {
+        delete _recipeMerger;
+    }
     return ;
 }
 
@@ -0,0 +1,74 @@
+/**
+ * @file ecallDoorkeeper.cc
+ * @brief implement the doorkeeper of the freq index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/ecallDoorkeeper.h"
+
+/**
+ * @brief Construct a new EcallDoorkeeper object
+ * 
+ * @param bitNum the number of bits
+ */
+EcallDoorkeeper::EcallDoorkeeper(uint64_t bitNum) {
+    blockNum_ = (bitNum + BLOCK_BIT_NUM - 1) / BLOCK_BIT_NUM;
+    if (blockNum_ == 0) {
+        blockNum_ = 1;
+    }
+    rawBuffer_ = (uint8_t*) malloc(blockNum_ * BLOCK_SIZE + BLOCK_SIZE);
+    wordArray_ = (uint64_t*)(((uintptr_t)rawBuffer_ + BLOCK_SIZE - 1) &
+        ~((uintptr_t)BLOCK_SIZE - 1));
+    memset(wordArray_, 0, blockNum_ * BLOCK_SIZE);
+}
+
+/**
+ * @brief Destroy the EcallDoorkeeper object
+ * 
+ */
+EcallDoorkeeper::~EcallDoorkeeper() {
+    free(rawBuffer_);
+}
+
+/**
+ * @brief check whether a chunk is in the doorkeeper, and insert it, the
+ * clients can insert concurrently
+ * 
+ * @param chunkHash the chunk hash
+ * @return true the chunk was in the doorkeeper
+ * @return false the chunk is inserted for the first time
+ */
+bool EcallDoorkeeper::TestAndSet(const uint8_t* chunkHash) {
+    uint64_t blockBits;
+    uint64_t posBits;
+    memcpy(&blockBits, chunkHash + FP_OFFSET, sizeof(uint64_t));
+    memcpy(&posBits, chunkHash + FP_OFFSET + sizeof(uint64_t), sizeof(uint64_t));
+    uint64_t* block = wordArray_ + BLOCK_WORD_NUM *
+        (uint64_t)(((unsigned __int128)blockBits * blockNum_) >> 64);
+
+    bool existFlag = true;
+    for (uint32_t i = 0; i < HASH_NUM; i++) {
+        // 9 bits per position in the 512-bit block
+        uint32_t bitPos = (posBits >> (i * 9)) & (BLOCK_BIT_NUM - 1);
+        uint64_t mask = 1ULL << (bitPos & 63);
+        uint64_t* word = block + (bitPos >> 6);
+        if ((__atomic_load_n(word, __ATOMIC_RELAXED) & mask) == 0) {
+            __atomic_fetch_or(word, mask, __ATOMIC_RELAXED);
+            existFlag = false;
+        }
+    }
+    return existFlag;
+}
+
+/**
+ * @brief clear all bits at the end of a period
+ * 
+ */
+void EcallDoorkeeper::Clear() {
+    uint64_t wordNum = blockNum_ * BLOCK_WORD_NUM;
+    for (uint64_t i = 0; i < wordNum; i++) {
+        __atomic_store_n(&wordArray_[i], 0, __ATOMIC_RELAXED);
+    }
+    return ;
+}
@@ -32,6 +32,16 @@ EcallCrypto::EcallCrypto(int cipherType, int hashType) {
         Ocall_SGX_Exit_Error("EcallCrypto: allocate iv fails");
     }
     memset(iv_, 0, sizeof(uint8_t) * CRYPTO_BLOCK_SIZE);
+
+    // check the SHA extensions and AES-NI (cpuid is an ocall inside the enclave)
+    int leaf1Info[4];
+    int leaf7Info[4];
+    if (sgx_cpuidex(leaf1Info, 1, 0) == SGX_SUCCESS &&
+        sgx_cpuidex(leaf7Info, 7, 0) == SGX_SUCCESS) {
+        shaNI_ = (hashType_ == SHA_256) && EcallSha256::CheckCPU(
+            static_cast<uint32_t>(leaf1Info[2]), static_cast<uint32_t>(leaf7Info[1]));
+        aesNI_ = EcallAes::CheckCPU(static_cast<uint32_t>(leaf1Info[2]));
+    }
 }
 
 
@@ -54,6 +64,11 @@ EcallCrypto::~EcallCrypto() {
  * @param hash the result hash
  */
 void EcallCrypto::GenerateHash(EVP_MD_CTX* mdCtx, uint8_t* dataBuffer, const int dataSize, uint8_t* hash) {
+    if (shaNI_) {
+        EcallSha256::Hash(dataBuffer, dataSize, hash);
+        return ;
+    }
+
     int expectedHashSize = 0;
     switch (hashType_) {
         case SHA_1:
@@ -91,6 +106,35 @@ void EcallCrypto::GenerateHash(EVP_MD_CTX* mdCtx, uint8_t* dataBuffer, const int
     return ;
 }
 
+/**
+ * @brief generate the hash of each chunk in a batch buffer, whose
+ * layout is (uint32_t chunk size, chunk data) per chunk
+ * 
+ * @param mdCtx hasher ctx
+ * @param batchBuffer the batch buffer
+ * @param chunkNum the number of chunks
+ * @param hashList the hash of chunk i is at hashList + i * hashStride
+ * @param hashStride the stride of the hashes
+ */
+void EcallCrypto::GenerateHashBatch(EVP_MD_CTX* mdCtx, uint8_t* batchBuffer, size_t chunkNum,
+    uint8_t* hashList, size_t hashStride) {
+    if (shaNI_) {
+        EcallSha256::HashBatch(batchBuffer, chunkNum, hashList, hashStride);
+        return ;
+    }
+
+    size_t currentOffset = 0;
+    uint32_t tmpChunkSize = 0;
+    for (size_t i = 0; i < chunkNum; i++) {
+        memcpy(&tmpChunkSize, batchBuffer + currentOffset, sizeof(uint32_t));
+        currentOffset += sizeof(uint32_t);
+        this->GenerateHash(mdCtx, batchBuffer + currentOffset, tmpChunkSize,
+            hashList + i * hashStride);
+        currentOffset += tmpChunkSize;
+    }
+    return ;
+}
+
 
 /**
  * @brief Encrypt the data with the encryption key 
@@ -299,6 +343,169 @@ void EcallCrypto::SessionKeyDec(EVP_CIPHER_CTX* ctx, uint8_t* ciphertext, const
     return ;
 }
 
+/**
+ * @brief init the key schedule of the batch AES-CBC/CMC
+ * 
+ * @param key the 256-bit key
+ * @param keySchedule the key schedule
+ */
+void EcallCrypto::InitKeySchedule(uint8_t* key, AesKeySchedule_t* keySchedule) {
+    if (aesNI_) {
+        EcallAes::ExpandKey(key, keySchedule);
+    } else {
+        memcpy(keySchedule->key, key, sizeof(keySchedule->key));
+    }
+    return ;
+}
+
+/**
+ * @brief encrypt the items with AES-CBC-256 (same as AESCBCEnc) in one pass
+ * 
+ * @param ctx cipher ctx (for the EVP fallback)
+ * @param keySchedule the key schedule
+ * @param dataBuffer the first input item
+ * @param dataStride the stride of the input items
+ * @param itemNum the number of items
+ * @param dataSize the item size
+ * @param ciphertext the first output item
+ * @param cipherStride the stride of the output items
+ */
+void EcallCrypto::AESCBCEncBatch(EVP_CIPHER_CTX* ctx, const AesKeySchedule_t* keySchedule,
+    uint8_t* dataBuffer, size_t dataStride, size_t itemNum, const int dataSize,
+    uint8_t* ciphertext, size_t cipherStride) {
+    if (aesNI_ && dataSize % EcallAes::BLOCK_SIZE == 0) {
+        EcallAes::CBCEncBatch(keySchedule, dataBuffer, dataStride, itemNum, dataSize,
+            ciphertext, cipherStride);
+        return ;
+    }
+    for (size_t i = 0; i < itemNum; i++) {
+        this->AESCBCEnc(ctx, dataBuffer + i * dataStride, dataSize,
+            (uint8_t*)keySchedule->key, ciphertext + i * cipherStride);
+    }
+    return ;
+}
+
+/**
+ * @brief decrypt the items with AES-CBC-256 (same as AESCBCDec) in one pass
+ * 
+ * @param ctx cipher ctx (for the EVP fallback)
+ * @param keySchedule the key schedule
+ * @param ciphertext the first input item
+ * @param cipherStride the stride of the input items
+ * @param itemNum the number of items
+ * @param dataSize the item size
+ * @param dataBuffer the first output item
+ * @param dataStride the stride of the output items
+ */
+void EcallCrypto::AESCBCDecBatch(EVP_CIPHER_CTX* ctx, const AesKeySchedule_t* keySchedule,
+    uint8_t* ciphertext, size_t cipherStride, size_t itemNum, const int dataSize,
+    uint8_t* dataBuffer, size_t dataStride) {
+    if (aesNI_ && dataSize % EcallAes::BLOCK_SIZE == 0) {
+        EcallAes::CBCDecBatch(keySchedule, ciphertext, cipherStride, itemNum, dataSize,
+            dataBuffer, dataStride);
+        return ;
+    }
+    for (size_t i = 0; i < itemNum; i++) {
+        this->AESCBCDec(ctx, ciphertext + i * cipherStride, dataSize,
+            (uint8_t*)keySchedule->key, dataBuffer + i * dataStride);
+    }
+    return ;
+}
+
+/**
+ * @brief encrypt the index keys with AES-CMC (same as IndexAESCMCEnc) in one pass
+ * 
+ * @param ctx cipher ctx (for the EVP fallback)
+ * @param keySchedule the key schedule
+ * @param dataBuffer the first input item
+ * @param dataStride the stride of the input items
+ * @param itemNum the number of items
+ * @param dataSize the item size
+ * @param ciphertext the first output item
+ * @param cipherStride the stride of the output items
+ */
+void EcallCrypto::IndexAESCMCEncBatch(EVP_CIPHER_CTX* ctx, const AesKeySchedule_t* keySchedule,
+    uint8_t* dataBuffer, size_t dataStride, size_t itemNum, const int dataSize,
+    uint8_t* ciphertext, size_t cipherStride) {
+    if (aesNI_ && dataSize % EcallAes::BLOCK_SIZE == 0 &&
+        dataSize <= EcallAes::MAX_CMC_ITEM_SIZE) {
+        EcallAes::CMCEncBatch(keySchedule, dataBuffer, dataStride, itemNum, dataSize,
+            ciphertext, cipherStride);
+        return ;
+    }
+    for (size_t i = 0; i < itemNum; i++) {
+        this->IndexAESCMCEnc(ctx, dataBuffer + i * dataStride, dataSize,
+            (uint8_t*)keySchedule->key, ciphertext + i * cipherStride);
+    }
+    return ;
+}
+
+/**
+ * @brief Encrypt the data with encryption key and iv (same as EncryptWithKeyIV),
+ * the ctx keeps the key schedule across the calls, so it must only be used
+ * with this key
+ * 
+ * @param keyCtx the cipher ctx of the key
+ * @param dataBuffer input data buffer
+ * @param dataSize input data size
+ * @param key encryption key
+ * @param ciphertext output ciphertext
+ * @param iv the iv
+ */
+void EcallCrypto::EncryptWithKeyCtx(EVP_CIPHER_CTX* keyCtx, uint8_t* dataBuffer, const int dataSize,
+    uint8_t* key, uint8_t* ciphertext, uint8_t* iv) {
+    int cipherLen = 0;
+    int len = 0;
+
+    if (EVP_CIPHER_CTX_cipher(keyCtx) == NULL) {
+        // the first call, set up the key schedule
+        const EVP_CIPHER* cipher = NULL;
+        switch (cipherType_) {
+            case AES_128_CFB:
+                cipher = EVP_aes_128_cfb();
+                break;
+            case AES_256_CFB:
+                cipher = EVP_aes_256_cfb();
+                break;
+            case AES_256_GCM:
+                cipher = EVP_aes_256_gcm();
+                break;
+            case AES_128_GCM:
+                cipher = EVP_aes_128_gcm();
+                break;
+        }
+        EVP_EncryptInit_ex(keyCtx, cipher, NULL, NULL, NULL);
+        if (cipherType_ == AES_256_GCM || cipherType_ == AES_128_GCM) {
+            EVP_CIPHER_CTX_ctrl(keyCtx, EVP_CTRL_AEAD_SET_IVLEN, CRYPTO_BLOCK_SIZE, NULL);
+        }
+        if (!EVP_EncryptInit_ex(keyCtx, NULL, NULL, key, NULL)) {
+            Ocall_SGX_Exit_Error("EcallCrypto: Cipher init error");
+        }
+    }
+
+    // only reset the iv, the key schedule is kept
+    if (!EVP_EncryptInit_ex(keyCtx, NULL, NULL, NULL, iv)) {
+        Ocall_SGX_Exit_Error("EcallCrypto: Cipher init error");
+    }
+    if (cipherType_ == AES_256_GCM || cipherType_ == AES_128_GCM) {
+        EVP_EncryptUpdate(keyCtx, NULL, &cipherLen, ecall_gcm_aad, sizeof(ecall_gcm_aad));
+    }
+
+    // encrypt the plaintext
+    if (!EVP_EncryptUpdate(keyCtx, ciphertext, &cipherLen, dataBuffer, 
+        dataSize)) {
+        Ocall_SGX_Exit_Error("EcallCrypto: Encryption error");
+    }
+
+    EVP_EncryptFinal_ex(keyCtx, ciphertext + cipherLen, &len);
+
+    cipherLen += len;
+    if (cipherLen != dataSize) {
+        Ocall_SGX_Exit_Error("EcallCrypto: encryption output size not equal to origin size");
+    }
+    return ;
+}
+
 /**
  * @brief Encrypt the data with encryption key and iv
  * 
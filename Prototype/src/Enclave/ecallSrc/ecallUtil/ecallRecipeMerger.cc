@@ -0,0 +1,93 @@
+/**
+ * @file ecallRecipeMerger.cc
+ * @brief implement the merger of the recipe entries from the parallel upload streams
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/ecallRecipeMerger.h"
+
+/**
+ * @brief Construct a new EcallRecipeMerger object
+ * 
+ * @param upOutSGX the upload out-enclave var of the primary stream
+ */
+EcallRecipeMerger::EcallRecipeMerger(UpOutSGX_t* upOutSGX) {
+    upOutSGX_ = upOutSGX;
+    cryptoObj_ = new EcallCrypto(CIPHER_TYPE, HASH_TYPE);
+    cipherCtx_ = EVP_CIPHER_CTX_new();
+}
+
+/**
+ * @brief Destroy the EcallRecipeMerger object
+ * 
+ */
+EcallRecipeMerger::~EcallRecipeMerger() {
+    if (pendingBatch_.size() != 0) {
+        Enclave::Logging(myName_.c_str(), "%lu batches are not merged.\n",
+            pendingBatch_.size());
+    }
+    Enclave::Logging(myName_.c_str(), "merged batch num: %lu, max pending batch "
+        "num: %lu\n", mergedBatchNum_, maxPendingBatchNum_);
+    EVP_CIPHER_CTX_free(cipherCtx_);
+    delete cryptoObj_;
+}
+
+/**
+ * @brief add the recipe entries of a processed batch, and merge the
+ * batches in the order of the batch sequence number
+ * 
+ * @param batchSeq the batch sequence number in the session
+ * @param batchEntry the recipe entries of the batch
+ */
+void EcallRecipeMerger::AddBatch(uint64_t batchSeq, string& batchEntry) {
+    lock_guard<mutex> lock(mergeLck_);
+    if (batchSeq != nextBatchSeq_) {
+        // wait for the preceding batches from the other streams
+        pendingBatch_[batchSeq].swap(batchEntry);
+        if (pendingBatch_.size() > maxPendingBatchNum_) {
+            maxPendingBatchNum_ = pendingBatch_.size();
+        }
+        return ;
+    }
+
+    this->AppendBatch(batchEntry);
+    auto it = pendingBatch_.begin();
+    while (it != pendingBatch_.end() && it->first == nextBatchSeq_) {
+        this->AppendBatch(it->second);
+        it = pendingBatch_.erase(it);
+    }
+    return ;
+}
+
+/**
+ * @brief append the entries of a batch to the recipe of the primary stream
+ * 
+ * @param batchEntry the recipe entries of the batch
+ */
+void EcallRecipeMerger::AppendBatch(string& batchEntry) {
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX_->sgxClient;
+    Recipe_t* inRecipe = &sgxClient->_inRecipe;
+    size_t entryNum = batchEntry.size() / sizeof(RecipeEntry_t);
+
+    for (size_t i = 0; i < entryNum; i++) {
+        memcpy(inRecipe->entryList + inRecipe->recipeNum * sizeof(RecipeEntry_t),
+            &batchEntry[i * sizeof(RecipeEntry_t)], sizeof(RecipeEntry_t));
+        inRecipe->recipeNum++;
+
+        if ((inRecipe->recipeNum % Enclave::sendRecipeBatchSize_) == 0) {
+            // the same encryption unit as the single stream upload
+            Recipe_t* outRecipe = (Recipe_t*)upOutSGX_->outRecipe;
+            cryptoObj_->EncryptWithKey(cipherCtx_, inRecipe->entryList,
+                inRecipe->recipeNum * sizeof(RecipeEntry_t), sgxClient->_masterKey,
+                outRecipe->entryList);
+            outRecipe->recipeNum = inRecipe->recipeNum;
+            Ocall_UpdateFileRecipe(upOutSGX_->outClient);
+            inRecipe->recipeNum = 0;
+        }
+    }
+
+    nextBatchSeq_++;
+    mergedBatchNum_++;
+    return ;
+}
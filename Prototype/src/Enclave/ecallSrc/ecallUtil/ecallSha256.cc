@@ -0,0 +1,145 @@
+/**
+ * @file ecallSha256.cc
+ * @brief implement the SHA-256 kernel with the SHA extensions
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/ecallSha256.h"
+
+// the enclave is built without the intrinsic headers, use the vector
+// extensions and the builtins of the SHA instructions, __builtin_shufflevector
+// is accepted by both clang and gcc (>= 12)
+typedef int ShaVec_t __attribute__((vector_size(16)));
+typedef char ShaByteVec_t __attribute__((vector_size(16)));
+
+static const uint32_t SHA256_INIT_STATE[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t SHA256_ROUND_CONST[64] __attribute__((aligned(16))) = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/**
+ * @brief compress the blocks into the state
+ * 
+ * @param state the state (a-h)
+ * @param data the blocks
+ * @param blockNum the number of blocks
+ */
+__attribute__((target("sha,sse4.1")))
+void EcallSha256::CompressBlocks(uint32_t* state, const uint8_t* data, size_t blockNum) {
+    // the rounds take the state as (F, E, B, A) and (H, G, D, C) from the low word
+    ShaVec_t abcd;
+    ShaVec_t efgh;
+    memcpy(&abcd, state, sizeof(ShaVec_t));
+    memcpy(&efgh, state + 4, sizeof(ShaVec_t));
+    ShaVec_t state0 = __builtin_shufflevector(efgh, abcd, 1, 0, 5, 4); // ABEF
+    ShaVec_t state1 = __builtin_shufflevector(efgh, abcd, 3, 2, 7, 6); // CDGH
+
+    for (size_t block = 0; block < blockNum; block++) {
+        ShaVec_t saveState0 = state0;
+        ShaVec_t saveState1 = state1;
+        ShaVec_t msgList[4];
+#pragma GCC unroll 4
+        for (size_t i = 0; i < 4; i++) {
+            ShaByteVec_t msgBytes;
+            memcpy(&msgBytes, data + block * BLOCK_SIZE + i * sizeof(ShaVec_t),
+                sizeof(ShaVec_t));
+            // the message words are big-endian
+            msgList[i] = (ShaVec_t)__builtin_shufflevector(msgBytes, msgBytes,
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        }
+
+        // unroll the rounds to keep the message words in the registers
+#pragma GCC unroll 16
+        for (size_t group = 0; group < 16; group++) {
+            if (group >= 4) {
+                // W[g] = msg2(msg1(W[g - 4], W[g - 3]) + (W[g - 2]:W[g - 1] >> 32), W[g - 1])
+                ShaVec_t prev1 = msgList[(group - 1) % 4];
+                ShaVec_t prev2 = msgList[(group - 2) % 4];
+                ShaVec_t tmpMsg = __builtin_ia32_sha256msg1(msgList[group % 4],
+                    msgList[(group - 3) % 4]);
+                tmpMsg += __builtin_shufflevector(prev2, prev1, 1, 2, 3, 4);
+                msgList[group % 4] = __builtin_ia32_sha256msg2(tmpMsg, prev1);
+            }
+            ShaVec_t roundConst;
+            memcpy(&roundConst, SHA256_ROUND_CONST + group * 4, sizeof(ShaVec_t));
+            ShaVec_t msg = msgList[group % 4] + roundConst;
+            state1 = __builtin_ia32_sha256rnds2(state1, state0, msg);
+            msg = __builtin_shufflevector(msg, msg, 2, 3, 0, 0);
+            state0 = __builtin_ia32_sha256rnds2(state0, state1, msg);
+        }
+        state0 += saveState0;
+        state1 += saveState1;
+    }
+
+    abcd = __builtin_shufflevector(state0, state1, 3, 2, 7, 6);
+    efgh = __builtin_shufflevector(state0, state1, 1, 0, 5, 4);
+    memcpy(state, &abcd, sizeof(ShaVec_t));
+    memcpy(state + 4, &efgh, sizeof(ShaVec_t));
+    return ;
+}
+
+/**
+ * @brief compute the digest of the input data
+ * 
+ * @param data the input data
+ * @param dataSize the input data size
+ * @param digest the digest (DIGEST_SIZE)
+ */
+void EcallSha256::Hash(const uint8_t* data, size_t dataSize, uint8_t* digest) {
+    uint32_t state[8];
+    memcpy(state, SHA256_INIT_STATE, sizeof(state));
+    size_t blockNum = dataSize / BLOCK_SIZE;
+    CompressBlocks(state, data, blockNum);
+
+    // pad the tail with 0x80, the zeros, and the bit length (big-endian)
+    uint8_t tailBuffer[BLOCK_SIZE * 2];
+    size_t tailSize = dataSize - blockNum * BLOCK_SIZE;
+    memcpy(tailBuffer, data + blockNum * BLOCK_SIZE, tailSize);
+    tailBuffer[tailSize] = 0x80;
+    size_t tailBlockNum = (tailSize + 1 + sizeof(uint64_t) > BLOCK_SIZE) ? 2 : 1;
+    memset(tailBuffer + tailSize + 1, 0, tailBlockNum * BLOCK_SIZE - tailSize - 1);
+    uint64_t bitLen = __builtin_bswap64((uint64_t)dataSize * 8);
+    memcpy(tailBuffer + tailBlockNum * BLOCK_SIZE - sizeof(uint64_t), &bitLen,
+        sizeof(uint64_t));
+    CompressBlocks(state, tailBuffer, tailBlockNum);
+
+    for (size_t i = 0; i < 8; i++) {
+        uint32_t word = __builtin_bswap32(state[i]);
+        memcpy(digest + i * sizeof(uint32_t), &word, sizeof(uint32_t));
+    }
+    return ;
+}
+
+/**
+ * @brief compute the digests of the chunks in a batch buffer, whose
+ * layout is (uint32_t chunk size, chunk data) per chunk
+ * 
+ * @param batchBuffer the batch buffer
+ * @param chunkNum the number of chunks
+ * @param hashList the digest of chunk i is at hashList + i * hashStride
+ * @param hashStride the stride of the digests
+ */
+void EcallSha256::HashBatch(const uint8_t* batchBuffer, size_t chunkNum,
+    uint8_t* hashList, size_t hashStride) {
+    size_t currentOffset = 0;
+    for (size_t i = 0; i < chunkNum; i++) {
+        uint32_t chunkSize;
+        memcpy(&chunkSize, batchBuffer + currentOffset, sizeof(uint32_t));
+        currentOffset += sizeof(uint32_t);
+        Hash(batchBuffer + currentOffset, chunkSize, hashList + i * hashStride);
+        currentOffset += chunkSize;
+    }
+    return ;
+}
@@ -0,0 +1,360 @@
+/**
+ * @file ecallTopKTable.cc
+ * @brief implement the flat top-k index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/ecallTopKTable.h"
+
+/**
+ * @brief Construct a new EcallTopKTable object
+ * 
+ * @param capacity the max number of items (k)
+ */
+EcallTopKTable::EcallTopKTable(size_t capacity) {
+    capacity_ = (capacity == 0) ? 1 : capacity;
+    slotNum_ = 2 * (uint64_t)capacity_;
+    slotList_ = (TopKSlot_t*) malloc(slotNum_ * sizeof(TopKSlot_t));
+    for (uint64_t i = 0; i < slotNum_; i++) {
+        slotList_[i].item.idx = EMPTY_SLOT;
+    }
+    heap_ = (TopKHeapEntry_t*) malloc(capacity_ * sizeof(TopKHeapEntry_t));
+}
+
+/**
+ * @brief Destroy the EcallTopKTable object
+ * 
+ */
+EcallTopKTable::~EcallTopKTable() {
+    free(slotList_);
+    free(heap_);
+}
+
+/**
+ * @brief find the slot of a chunk fp
+ * 
+ * @param chunkFp the chunk fp
+ * @param slotIdx the home slot index
+ * @return TopKSlot_t* the slot (NULL if non-exist)
+ */
+TopKSlot_t* EcallTopKTable::ProbeSlot(const uint8_t* chunkFp, uint64_t slotIdx) {
+    while (slotList_[slotIdx].item.idx != EMPTY_SLOT) {
+        if (memcmp(slotList_[slotIdx].chunkFp, chunkFp, CHUNK_HASH_SIZE) == 0) {
+            return &slotList_[slotIdx];
+        }
+        slotIdx = this->NextSlot(slotIdx);
+    }
+    return NULL;
+}
+
+/**
+ * @brief copy the item of a chunk fp while the table may be modified,
+ * the probing stops after all slots since the slots can be inconsistent
+ * 
+ * @param chunkFp the chunk fp
+ * @param slotList the slots read in the same sequence as slotNum
+ * @param slotNum the number of slots
+ * @param item the copied item (idx is EMPTY_SLOT if non-exist)
+ */
+void EcallTopKTable::ProbeCopy(const uint8_t* chunkFp, const TopKSlot_t* slotList,
+    uint64_t slotNum, HeapItem_t* item) {
+    uint64_t slotIdx = HomeSlot(chunkFp, slotNum);
+    for (uint64_t i = 0; i < slotNum; i++) {
+        const TopKSlot_t* slot = &slotList[slotIdx];
+        if (slot->item.idx == EMPTY_SLOT) {
+            break;
+        }
+        if (memcmp(slot->chunkFp, chunkFp, CHUNK_HASH_SIZE) == 0) {
+            *item = slot->item;
+            return ;
+        }
+        slotIdx = (slotIdx + 1 == slotNum) ? 0 : (slotIdx + 1);
+    }
+    item->idx = EMPTY_SLOT;
+    return ;
+}
+
+/**
+ * @brief Swap up the entry
+ * 
+ * @param idx the heap position
+ */
+void EcallTopKTable::SwapUp(uint32_t idx) {
+    TopKHeapEntry_t entry = heap_[idx];
+    while (idx > 0) {
+        uint32_t parent = (idx - 1) / 2;
+        if (!(entry.chunkFreq < heap_[parent].chunkFreq)) {
+            break;
+        }
+        this->PlaceHeapEntry(idx, heap_[parent]);
+        idx = parent;
+    }
+    this->PlaceHeapEntry(idx, entry);
+    return ;
+}
+
+/**
+ * @brief Swap down the entry
+ * 
+ * @param idx the heap position
+ */
+void EcallTopKTable::SwapDown(uint32_t idx) {
+    TopKHeapEntry_t entry = heap_[idx];
+    uint32_t child;
+    for (child = idx * 2 + 1; child < heapSize_; child = idx * 2 + 1) {
+        child += ((child + 1 < heapSize_) &&
+            (heap_[child + 1].chunkFreq < heap_[child].chunkFreq));
+        if (!(heap_[child].chunkFreq < entry.chunkFreq)) {
+            break;
+        }
+        this->PlaceHeapEntry(idx, heap_[child]);
+        idx = child;
+    }
+    this->PlaceHeapEntry(idx, entry);
+    return ;
+}
+
+/**
+ * @brief erase a slot with the backward shift, which keeps the probing
+ * sequences without tombstones
+ * 
+ * @param slotIdx the slot index
+ */
+void EcallTopKTable::EraseSlot(uint64_t slotIdx) {
+    uint64_t curIdx = slotIdx;
+    while (true) {
+        curIdx = this->NextSlot(curIdx);
+        if (slotList_[curIdx].item.idx == EMPTY_SLOT) {
+            break;
+        }
+        // the entry stays if its home slot is cyclically in (slotIdx, curIdx]
+        uint64_t homeIdx = this->HomeSlot(slotList_[curIdx].chunkFp);
+        bool stay = (slotIdx <= curIdx) ? (slotIdx < homeIdx && homeIdx <= curIdx) :
+            (slotIdx < homeIdx || homeIdx <= curIdx);
+        if (stay) {
+            continue;
+        }
+        slotList_[slotIdx] = slotList_[curIdx];
+        heap_[slotList_[slotIdx].item.idx].slotIdx = slotIdx;
+        slotIdx = curIdx;
+    }
+    slotList_[slotIdx].item.idx = EMPTY_SLOT;
+    return ;
+}
+
+/**
+ * @brief pop the element with the min freq
+ * 
+ */
+void EcallTopKTable::Pop() {
+    this->WriteBegin();
+    uint32_t slotIdx = heap_[0].slotIdx;
+    heapSize_--;
+    if (heapSize_ != 0) {
+        // move the last entry to the top
+        heap_[0] = heap_[heapSize_];
+        this->SwapDown(0);
+    }
+    this->EraseSlot(slotIdx);
+    this->WriteEnd();
+    return ;
+}
+
+/**
+ * @brief add an element, the table must not be full
+ * 
+ * @param chunkFp the chunk fp
+ * @param value the value
+ * @return HeapItem_t* the item in the table
+ */
+HeapItem_t* EcallTopKTable::Add(const uint8_t* chunkFp, const HeapItem_t& value) {
+    this->WriteBegin();
+    uint64_t slotIdx = this->HomeSlot(chunkFp);
+    while (slotList_[slotIdx].item.idx != EMPTY_SLOT) {
+        slotIdx = this->NextSlot(slotIdx);
+    }
+    TopKSlot_t* slot = &slotList_[slotIdx];
+    memcpy(slot->chunkFp, chunkFp, CHUNK_HASH_SIZE);
+    slot->item = value;
+
+    // the heap entries move in the sift, the slot does not
+    heap_[heapSize_].chunkFreq = value.chunkFreq;
+    heap_[heapSize_].slotIdx = slotIdx;
+    heapSize_++;
+    this->SwapUp(heapSize_ - 1);
+    this->WriteEnd();
+    return &slot->item;
+}
+
+/**
+ * @brief find an element, the item is valid until the next Add or Pop
+ * 
+ * @param chunkFp the chunk fp
+ * @return HeapItem_t* the item (NULL if non-exist)
+ */
+HeapItem_t* EcallTopKTable::Find(const uint8_t* chunkFp) {
+    TopKSlot_t* slot = this->ProbeSlot(chunkFp, this->HomeSlot(chunkFp));
+    return (slot == NULL) ? NULL : &slot->item;
+}
+
+/**
+ * @brief get the min freq to enter the table without the lock
+ * 
+ * @return uint32_t the min freq (0 if the table is not full)
+ */
+uint32_t EcallTopKTable::GetMinFreq() const {
+    uint32_t readerSlot = this->EnterRead();
+    uint64_t seq;
+    uint32_t minFreq;
+    do {
+        seq = this->ReadBegin();
+        const TopKHeapEntry_t* heap = __atomic_load_n(&heap_, __ATOMIC_RELAXED);
+        uint32_t capacity = __atomic_load_n(&capacity_, __ATOMIC_RELAXED);
+        if (this->ReadRetry(seq)) {
+            continue;
+        }
+        minFreq = (heapSize_ == capacity) ? heap[0].chunkFreq : 0;
+    } while (this->ReadRetry(seq));
+    this->ExitRead(readerSlot);
+    return minFreq;
+}
+
+/**
+ * @brief find the elements of a batch without the lock and copy the
+ * items, prefetch the slots of the following chunks while probing
+ * 
+ * @param entryList the query entries of the batch
+ * @param entryNum the number of entries
+ * @param itemList the copied items (idx is EMPTY_SLOT if non-exist)
+ */
+void EcallTopKTable::FindBatch(InQueryEntry_t* entryList, size_t entryNum,
+    HeapItem_t* itemList) const {
+    // the arrays replaced by a concurrent Resize are kept until the batch ends
+    uint32_t readerSlot = this->EnterRead();
+    for (size_t i = 0; i < entryNum && i < PREFETCH_DIST; i++) {
+        this->Prefetch(entryList[i].chunkHash);
+    }
+    for (size_t i = 0; i < entryNum; i++) {
+        if (i + PREFETCH_DIST < entryNum) {
+            this->Prefetch(entryList[i + PREFETCH_DIST].chunkHash);
+        }
+        // only retry the chunk whose probing overlaps a modification
+        uint64_t seq;
+        do {
+            seq = this->ReadBegin();
+            // Resize replaces the slots, only probe a consistent (slots, num) pair
+            const TopKSlot_t* slotList = __atomic_load_n(&slotList_, __ATOMIC_RELAXED);
+            uint64_t slotNum = __atomic_load_n(&slotNum_, __ATOMIC_RELAXED);
+            if (this->ReadRetry(seq)) {
+                continue;
+            }
+            ProbeCopy(entryList[i].chunkHash, slotList, slotNum, &itemList[i]);
+        } while (this->ReadRetry(seq));
+    }
+    this->ExitRead(readerSlot);
+    return ;
+}
+
+/**
+ * @brief update the frequency of an element
+ * 
+ * @param item the item returned by Find
+ * @param freq the new freq
+ */
+void EcallTopKTable::Update(HeapItem_t* item, uint32_t freq) {
+    this->WriteBegin();
+    uint32_t idx = item->idx;
+    item->chunkFreq = freq;
+    heap_[idx].chunkFreq = freq;
+    // try swap up/down into place
+    this->SwapUp(idx);
+    this->SwapDown(item->idx);
+    this->WriteEnd();
+    return ;
+}
+
+/**
+ * @brief halve the freq of all elements (aging), the halving keeps the
+ * heap order, the writers are serialized by the caller
+ * 
+ */
+void EcallTopKTable::Age() {
+    this->WriteBegin();
+    for (uint32_t i = 0; i < heapSize_; i++) {
+        heap_[i].chunkFreq >>= 1;
+        slotList_[heap_[i].slotIdx].item.chunkFreq = heap_[i].chunkFreq;
+    }
+    this->WriteEnd();
+    return ;
+}
+
+/**
+ * @brief change the max number of items, the items of the min freq are
+ * popped to shrink the table, the writers are serialized by the caller
+ * 
+ * @param capacity the new max number of items (k)
+ * @return true success
+ * @return false no memory for the new arrays, the table is unchanged
+ */
+bool EcallTopKTable::Resize(size_t capacity) {
+    capacity = (capacity == 0) ? 1 : capacity;
+    uint64_t newSlotNum = 2 * (uint64_t)capacity;
+    TopKSlot_t* newSlotList = (TopKSlot_t*) malloc(newSlotNum * sizeof(TopKSlot_t));
+    TopKHeapEntry_t* newHeap = (TopKHeapEntry_t*) malloc(capacity * sizeof(TopKHeapEntry_t));
+    if (newSlotList == NULL || newHeap == NULL) {
+        // keep the old table
+        free(newSlotList);
+        free(newHeap);
+        return false;
+    }
+    for (uint64_t i = 0; i < newSlotNum; i++) {
+        newSlotList[i].item.idx = EMPTY_SLOT;
+    }
+    while (heapSize_ > capacity) {
+        this->Pop();
+    }
+
+    // move the items in the heap order, which keeps the heap positions
+    for (uint32_t i = 0; i < heapSize_; i++) {
+        const TopKSlot_t* slot = &slotList_[heap_[i].slotIdx];
+        uint64_t slotIdx = HomeSlot(slot->chunkFp, newSlotNum);
+        while (newSlotList[slotIdx].item.idx != EMPTY_SLOT) {
+            slotIdx = (slotIdx + 1 == newSlotNum) ? 0 : (slotIdx + 1);
+        }
+        newSlotList[slotIdx] = *slot;
+        newHeap[i].chunkFreq = heap_[i].chunkFreq;
+        newHeap[i].slotIdx = slotIdx;
+    }
+
+    TopKSlot_t* oldSlotList = slotList_;
+    TopKHeapEntry_t* oldHeap = heap_;
+    this->WriteBegin();
+    __atomic_store_n(&slotList_, newSlotList, __ATOMIC_RELAXED);
+    __atomic_store_n(&slotNum_, newSlotNum, __ATOMIC_RELAXED);
+    __atomic_store_n(&heap_, newHeap, __ATOMIC_RELAXED);
+    __atomic_store_n(&capacity_, (uint32_t)capacity, __ATOMIC_RELAXED);
+    this->WriteEnd();
+
+    // the lock-free readers may still probe the old arrays
+    this->WaitReaders();
+    free(oldSlotList);
+    free(oldHeap);
+    return true;
+}
+
+/**
+ * @brief start a new epoch and wait for the readers of the last epoch,
+ * the writers are serialized by the caller
+ * 
+ */
+void EcallTopKTable::WaitReaders() {
+    uint64_t oldEpoch = epoch_;
+    // the readers that enter after this see the new arrays
+    __atomic_store_n(&epoch_, oldEpoch + 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&readerNum_[oldEpoch & 1], __ATOMIC_SEQ_CST) != 0) {
+        // a reader only holds the epoch for one batch
+        __builtin_ia32_pause();
+    }
+    return ;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file ecallWorkerPool.cc
+ * @brief implement the worker pool inside the enclave
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/ecallWorkerPool.h"
+
+/**
+ * @brief Construct a new EcallWorkerPool object
+ * 
+ * @param workerNum the number of worker threads
+ */
+EcallWorkerPool::EcallWorkerPool(uint32_t workerNum) {
+    workerNum_ = workerNum;
+}
+
+/**
+ * @brief Destroy the EcallWorkerPool object
+ * 
+ */
+EcallWorkerPool::~EcallWorkerPool() {
+    this->Stop();
+}
+
+/**
+ * @brief claim and process the items until all are claimed
+ * 
+ * @param taskFunc the task
+ * @param taskNum the number of items
+ * @param workerCtx the context of this thread
+ */
+void EcallWorkerPool::ClaimItems(const WorkerTask_t& taskFunc, size_t taskNum,
+    WorkerCtx_t* workerCtx) {
+    while (true) {
+        size_t startIdx = __atomic_fetch_add(&nextItem_, CLAIM_ITEM_NUM,
+            __ATOMIC_RELAXED);
+        if (startIdx >= taskNum) {
+            break;
+        }
+        size_t endIdx = (startIdx + CLAIM_ITEM_NUM < taskNum) ?
+            (startIdx + CLAIM_ITEM_NUM) : taskNum;
+        for (size_t i = startIdx; i < endIdx; i++) {
+            taskFunc(i, workerCtx);
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief the main loop of a worker thread, return after Stop
+ * 
+ * @param workerID the worker ID
+ */
+void EcallWorkerPool::Run(uint32_t workerID) {
+    WorkerCtx_t workerCtx;
+    workerCtx.cipherCtx = EVP_CIPHER_CTX_new();
+    workerCtx.mdCtx = EVP_MD_CTX_new();
+    workerCtx.chunkCipherCtx = EVP_CIPHER_CTX_new();
+    uint64_t lastSeq = 0;
+
+    unique_lock<mutex> taskLock(taskLck_);
+    if (stop_ || workerID >= workerNum_) {
+        taskLock.unlock();
+        Enclave::Logging(myName_.c_str(), "worker %u is not needed.\n", workerID);
+        EVP_CIPHER_CTX_free(workerCtx.cipherCtx);
+        EVP_MD_CTX_free(workerCtx.mdCtx);
+        EVP_CIPHER_CTX_free(workerCtx.chunkCipherCtx);
+        return ;
+    }
+    __atomic_add_fetch(&runningNum_, 1, __ATOMIC_RELAXED);
+    while (true) {
+        taskCV_.wait(taskLock, [&] {
+            return stop_ || (taskFunc_ != NULL && taskSeq_ != lastSeq);
+        });
+        if (stop_) {
+            break;
+        }
+        // join the current task
+        lastSeq = taskSeq_;
+        const WorkerTask_t* taskFunc = taskFunc_;
+        size_t taskNum = taskNum_;
+        busyNum_++;
+        taskLock.unlock();
+
+        this->ClaimItems(*taskFunc, taskNum, &workerCtx);
+
+        taskLock.lock();
+        busyNum_--;
+        if (busyNum_ == 0) {
+            doneCV_.notify_all();
+        }
+    }
+    __atomic_sub_fetch(&runningNum_, 1, __ATOMIC_RELAXED);
+    doneCV_.notify_all();
+    taskLock.unlock();
+
+    EVP_CIPHER_CTX_free(workerCtx.cipherCtx);
+    EVP_MD_CTX_free(workerCtx.mdCtx);
+    EVP_CIPHER_CTX_free(workerCtx.chunkCipherCtx);
+    return ;
+}
+
+/**
+ * @brief stop the workers, and wait for them to leave the enclave
+ * 
+ */
+void EcallWorkerPool::Stop() {
+    unique_lock<mutex> taskLock(taskLck_);
+    stop_ = true;
+    taskCV_.notify_all();
+    doneCV_.wait(taskLock, [&] {
+        return runningNum_ == 0;
+    });
+    return ;
+}
+
+/**
+ * @brief process the items of a batch with the workers, the caller
+ * also processes the items and returns after all are done; it processes
+ * them alone if no worker runs or another batch is using the workers
+ * 
+ * @param taskNum the number of items
+ * @param callerCtx the context of the caller
+ * @param taskFunc the task
+ */
+void EcallWorkerPool::ParallelFor(size_t taskNum, WorkerCtx_t* callerCtx,
+    const WorkerTask_t& taskFunc) {
+    if (this->GetRunningNum() == 0 || taskNum <= CLAIM_ITEM_NUM ||
+        !runLck_.try_lock()) {
+        for (size_t i = 0; i < taskNum; i++) {
+            taskFunc(i, callerCtx);
+        }
+        return ;
+    }
+
+    // publish the task
+    {
+        lock_guard<mutex> taskLock(taskLck_);
+        taskFunc_ = &taskFunc;
+        taskNum_ = taskNum;
+        nextItem_ = 0;
+        taskSeq_++;
+    }
+    taskCV_.notify_all();
+
+    this->ClaimItems(taskFunc, taskNum, callerCtx);
+
+    // all items are claimed, wait for the workers in this task; a worker
+    // that wakes up later skips the withdrawn task
+    {
+        unique_lock<mutex> taskLock(taskLck_);
+        doneCV_.wait(taskLock, [&] {
+            return busyNum_ == 0;
+        });
+        taskFunc_ = NULL;
+    }
+    runLck_.unlock();
+    return ;
+}
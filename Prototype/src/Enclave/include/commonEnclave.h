@@ -33,6 +33,7 @@
 #include "ecallClient.h"
 
 class EnclaveBase;
+class EcallWorkerPool;
 
 using namespace std;
 namespace Enclave {
@@ -45,14 +46,22 @@ namespace Enclave {
     extern bool firstBootstrap_; // use to control the RA
     // config
     extern uint64_t sendChunkBatchSize_;
+    extern uint64_t maxChunkBatchSize_;
     extern uint64_t sendRecipeBatchSize_;
     extern uint64_t topKParam_;
+    extern uint64_t topKEPCBudget_;
+    extern uint64_t sketchWidth_;
+    extern uint64_t sketchDepth_;
+    extern uint64_t freqPolicy_;
+    extern uint64_t outQueryPipeline_;
     // mutex
     extern mutex sessionKeyLck_;
     extern mutex sketchLck_;
     extern mutex topKIndexLck_;
     // the obj to the enclave index
     extern EnclaveBase* enclaveBaseObj_;
+    // the worker threads inside the enclave
+    extern EcallWorkerPool* workerPool_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+/**
+ * @file ecallAes.h
+ * @brief define the AES-256 kernel with AES-NI, which keeps the expanded key
+ * schedule and interleaves the CBC chains of several small items, the output
+ * is the same as EVP_aes_256_cbc with the zero iv and without padding
+ * @version 0.1
+ * 
+ */
+
+#ifndef ECALL_AES_H
+#define ECALL_AES_H
+
+// only the std library, the kernel does not depend on the sgx library
+#include "stdint.h"
+#include "stddef.h"
+#include "string.h"
+
+static const size_t AES_256_ROUND_KEY_NUM = 15;
+static const size_t AES_ROUND_KEY_SIZE = 16;
+
+// the expanded key schedule of AES-256
+typedef struct {
+    uint8_t key[AES_ROUND_KEY_SIZE * 2]; // the key, for the EVP fallback
+    uint8_t encRoundKey[AES_256_ROUND_KEY_NUM * AES_ROUND_KEY_SIZE] __attribute__((aligned(16)));
+    uint8_t decRoundKey[AES_256_ROUND_KEY_NUM * AES_ROUND_KEY_SIZE] __attribute__((aligned(16)));
+} AesKeySchedule_t;
+
+class EcallAes {
+    private:
+        // the number of the interleaved items
+        static const size_t LANE_NUM = 4;
+
+        /**
+         * @brief encrypt the items of the lanes with AES-256-CBC
+         * 
+         * @param keySchedule the key schedule
+         * @param inputList the input of each lane
+         * @param outputList the output of each lane (NULL: the idle lane)
+         * @param blockNum the number of blocks per item
+         */
+        static void CBCEncLanes(const AesKeySchedule_t* keySchedule, const uint8_t** inputList,
+            uint8_t** outputList, size_t blockNum);
+
+        /**
+         * @brief decrypt the items of the lanes with AES-256-CBC
+         * 
+         * @param keySchedule the key schedule
+         * @param inputList the input of each lane
+         * @param outputList the output of each lane (NULL: the idle lane)
+         * @param blockNum the number of blocks per item
+         */
+        static void CBCDecLanes(const AesKeySchedule_t* keySchedule, const uint8_t** inputList,
+            uint8_t** outputList, size_t blockNum);
+
+    public:
+        static const size_t BLOCK_SIZE = 16;
+        // the max item size of CMCEncBatch
+        static const size_t MAX_CMC_ITEM_SIZE = 64;
+
+        /**
+         * @brief check whether the CPU supports the kernel
+         * 
+         * @param leaf1Ecx the ecx of cpuid leaf 1
+         * @return true the kernel is supported
+         * @return false use the EVP cipher
+         */
+        static inline bool CheckCPU(uint32_t leaf1Ecx) {
+            // SSSE3 (bit 9), and AES-NI (bit 25)
+            return (leaf1Ecx & (1U << 9)) && (leaf1Ecx & (1U << 25));
+        }
+
+        /**
+         * @brief expand the encryption and decryption round keys
+         * 
+         * @param key the 256-bit key
+         * @param keySchedule the key schedule
+         */
+        static void ExpandKey(const uint8_t* key, AesKeySchedule_t* keySchedule);
+
+        /**
+         * @brief encrypt the items with AES-256-CBC, the items can be in-place
+         * 
+         * @param keySchedule the key schedule
+         * @param input the first input item
+         * @param inputStride the stride of the input items
+         * @param itemNum the number of items
+         * @param itemSize the item size (multiple of BLOCK_SIZE)
+         * @param output the first output item
+         * @param outputStride the stride of the output items
+         */
+        static void CBCEncBatch(const AesKeySchedule_t* keySchedule, const uint8_t* input,
+            size_t inputStride, size_t itemNum, size_t itemSize, uint8_t* output,
+            size_t outputStride);
+
+        /**
+         * @brief decrypt the items with AES-256-CBC, the items can be in-place
+         * 
+         * @param keySchedule the key schedule
+         * @param input the first input item
+         * @param inputStride the stride of the input items
+         * @param itemNum the number of items
+         * @param itemSize the item size (multiple of BLOCK_SIZE)
+         * @param output the first output item
+         * @param outputStride the stride of the output items
+         */
+        static void CBCDecBatch(const AesKeySchedule_t* keySchedule, const uint8_t* input,
+            size_t inputStride, size_t itemNum, size_t itemSize, uint8_t* output,
+            size_t outputStride);
+
+        /**
+         * @brief encrypt the items with AES-CMC (CBC, reverse the bytes, CBC),
+         * the intermediate result stays in the local buffer
+         * 
+         * @param keySchedule the key schedule
+         * @param input the first input item
+         * @param inputStride the stride of the input items
+         * @param itemNum the number of items
+         * @param itemSize the item size (multiple of BLOCK_SIZE, <= MAX_CMC_ITEM_SIZE)
+         * @param output the first output item
+         * @param outputStride the stride of the output items
+         */
+        static void CMCEncBatch(const AesKeySchedule_t* keySchedule, const uint8_t* input,
+            size_t inputStride, size_t itemNum, size_t itemSize, uint8_t* output,
+            size_t outputStride);
+};
+
+#endif
@@ -13,35 +13,107 @@
 #ifndef ECALL_CM_SKETCH_H
 #define ECALL_CM_SKETCH_H
 
-#include "commonEnclave.h"
-
-#define LONG_PRIME 4294967311l
+// only the std library, the sketch does not depend on the sgx library
+#include "stdint.h"
+#include "stdlib.h"
+#include "string.h"
+#include "../../../include/constVar.h"
+#include "../../../include/chunkStructure.h"
+
+// the layout tag of the sealed sketch, changed with the lane mapping of the keys
+static const uint32_t BLOCKED_SKETCH_LAYOUT = 0x4b4c4232;
+
+typedef struct {
+    uint32_t layout; // BLOCKED_SKETCH_LAYOUT
+    uint32_t width;
+    uint32_t depth;
+} SketchHead_t;
 
 class EcallCMSketch {
-    /**width, depth */
+    private:
+        // the counters of a key share one block (a cache line), the row i
+        // takes one counter in the lanes [i * laneNum_, (i + 1) * laneNum_)
+        static const uint32_t BLOCK_SIZE = 64;
+        static const uint32_t BLOCK_COUNTER_NUM = BLOCK_SIZE / sizeof(uint32_t);
+        // the number of keys prefetched ahead in the batch update
+        static const uint32_t PREFETCH_DIST = 8;
+
+        /**width, depth */
         uint32_t width_;
         uint32_t depth_;
+        uint32_t laneNum_;
+        uint64_t blockNum_;
+
+        // the update type (STANDARD_UPDATE / CONSERVATIVE_UPDATE)
+        uint32_t updateType_;
 
         /**total count */
-        size_t total_;
+        uint64_t total_;
+
+        /**the blocks of counters, aligned to the cache line */
+        uint32_t* counterArray_;
+        uint8_t* rawBuffer_;
+
+        /**
+         * @brief get the block of a chunk hash
+         * 
+         * @param chunkHash the input chunk hash
+         * @return uint32_t* the block
+         */
+        inline uint32_t* GetBlock(const uint8_t* chunkHash) const {
+            // the chunk hash is uniformly distributed, map its prefix to [0, blockNum_)
+            uint64_t hashVal;
+            memcpy(&hashVal, chunkHash, sizeof(uint64_t));
+            return counterArray_ + BLOCK_COUNTER_NUM *
+                (uint64_t)(((unsigned __int128)hashVal * blockNum_) >> 64);
+        }
+
+        /**
+         * @brief get the lane bits of a chunk hash (4 bits per row)
+         * 
+         * @param chunkHash the input chunk hash
+         * @return uint64_t the lane bits
+         */
+        inline uint64_t GetLaneBits(const uint8_t* chunkHash) const {
+            uint64_t laneBits;
+            memcpy(&laneBits, chunkHash + sizeof(uint64_t), sizeof(uint64_t));
+            return laneBits;
+        }
 
-        /**array of arrays of counters */
-        uint32_t** counterArray_;
+        /**
+         * @brief get the lane of a row in the block
+         * 
+         * @param laneBits the lane bits of the chunk hash
+         * @param row the row
+         * @return uint32_t the lane in the block
+         */
+        inline uint32_t GetLaneIdx(uint64_t laneBits, uint32_t row) const {
+            // map the 4 bits to [0, laneNum_) without the division
+            return row * laneNum_ + ((((laneBits >> (row * 4)) & 0xf) * laneNum_) >> 4);
+        }
 
-        // hard code a seed for murmurhash
-        // uint32_t constSeed_ = 1;
+        /**
+         * @brief the update and estimation of a 4-row block with the vector
+         * instructions
+         * 
+         * @param block the block
+         * @param laneBits the lane bits
+         * @param count count number
+         * @return uint32_t the frequency after the update
+         */
+        uint32_t UpdateBlockVec(uint32_t* block, uint64_t laneBits, uint32_t count);
 
-        // the buffer to store the hash result
-        uint32_t* resultHash_;
     public:
 
         /**
          * @brief Construct a new Count Min Sketch object
          * 
          * @param width the width of the sketch
-         * @param depth the depth of the sketch
+         * @param depth the depth of the sketch (at most 16)
+         * @param updateType the update type
          */
-        EcallCMSketch(uint32_t width, uint32_t depth = 4);
+        EcallCMSketch(uint32_t width, uint32_t depth = 4,
+            uint32_t updateType = STANDARD_UPDATE);
 
         /**
          * @brief Update the sketch
@@ -53,7 +125,7 @@ class EcallCMSketch {
         void Update(const uint8_t* chunkHash, size_t chunkHashLen, uint32_t count);
 
         /**
-         * @brief estimate the chunk count 
+         * @brief estimate the chunk count
          * 
          * @param chunkHash the input chunk hash
          * @param chunkHashLen the length of the chunk hash
@@ -61,6 +133,42 @@ class EcallCMSketch {
          */
         uint32_t Estimate(const uint8_t* chunkHash, size_t chunkHashLen);
 
+        /**
+         * @brief update the sketch and estimate the chunk count in one pass
+         * 
+         * @param chunkHash the input chunk hash
+         * @param count count number
+         * @return uint32_t count number after the update
+         */
+        uint32_t UpdateEstimate(const uint8_t* chunkHash, uint32_t count);
+
+        /**
+         * @brief update the sketch with the chunks of a batch, and set the
+         * chunk freq of each entry
+         * 
+         * @param entryList the query entries of the batch
+         * @param entryNum the number of entries
+         * @param count count number
+         */
+        void UpdateBatch(InQueryEntry_t* entryList, size_t entryNum, uint32_t count);
+
+        /**
+         * @brief update the sketch with the chunks of a batch by the count of
+         * each chunk, and set the chunk freq of each entry
+         * 
+         * @param entryList the query entries of the batch
+         * @param entryNum the number of entries
+         * @param countList the count of each entry (0: only estimate)
+         */
+        void UpdateBatch(InQueryEntry_t* entryList, size_t entryNum, const uint32_t* countList);
+
+        /**
+         * @brief halve all counters (aging), the clients can merge their deltas
+         * concurrently
+         * 
+         */
+        void Halve();
+
         /**
          * @brief return the total number of processed items
          * 
@@ -80,14 +188,35 @@ class EcallCMSketch {
          */
         void ClearUp();
 
+        /**
+         * @brief Get the head of the sealed sketch
+         * 
+         * @param sketchHead the sketch head
+         */
+        void GetHead(SketchHead_t* sketchHead) {
+            sketchHead->layout = BLOCKED_SKETCH_LAYOUT;
+            sketchHead->width = width_;
+            sketchHead->depth = depth_;
+            return ;
+        }
+
         /**
          * @brief Get the Counter Array object
          * 
-         * @return uint32_t** the pointer to the counter array
+         * @return uint8_t* the pointer to the counter blocks
+         */
+        uint8_t* GetCounterArray() {
+            return (uint8_t*)counterArray_;
+        }
+
+        /**
+         * @brief Get the size of the counter blocks
+         * 
+         * @return size_t the size of the counter blocks
          */
-        uint32_t** GetCounterArray() {
-            return this->counterArray_;
+        size_t GetCounterArraySize() {
+            return blockNum_ * BLOCK_SIZE;
         }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -17,11 +17,21 @@
 
 using namespace std;
 
+class EcallRecipeMerger;
+
 typedef struct {
     uint8_t* buf;
     uint32_t curSize;
 } InContainer;
 
+// the state of a batch between the processing stages
+typedef struct {
+    uint32_t chunkNum; // 0: no batch
+    uint32_t outQueryNum;
+    uint64_t topKLookupNum;
+    uint64_t topKHitNum;
+} BatchState_t;
+
 class EnclaveClient {
     private:
         int indexType_ = 0;
@@ -82,6 +92,7 @@ class EnclaveClient {
         // for crypto operations
         EVP_CIPHER_CTX* _cipherCtx;
         EVP_MD_CTX* _mdCtx;
+        EVP_CIPHER_CTX* _chunkCipherCtx; // keeps the key schedule of the data key
         uint8_t _iv[CRYPTO_BLOCK_SIZE]; // for store the current iv;
 
         // the client key
@@ -95,12 +106,38 @@ class EnclaveClient {
 
         // for upload
         InQueryEntry_t* _inQueryBase; // dedup buffer
+        HeapItem_t* _topKItemList; // the copied top-k probing result of the batch
         Recipe_t _inRecipe; // the in-enclave recipe buffer
         uint8_t* _recvBuffer;
+        uint8_t* _decodeBuffer; // the decrypted batch in the compressed transfer mode
         Segment_t _segment;
         unordered_map<string, uint32_t> _localIndex;
         InContainer _inContainer;
 
+        // for the enclave workers (the freq index)
+        uint32_t* _chunkOffsetList; // the offset of each chunk in the recv buffer
+        uint32_t* _encodeIdxList; // the query entry of each unique chunk in the window
+        uint8_t* _encodeIVList; // the iv of each unique chunk in the window
+        uint32_t* _encodeSizeList; // the size of each encoded chunk in the window
+        uint8_t* _encodeBuffer; // the encoded chunks of the window
+        uint8_t* _outQueryHashList; // the plaintext fp of each out-enclave query
+        RecipeEntry_t* _outQueryAddrList; // the plaintext address of each out-enclave query
+        uint32_t* _freqCountList; // the sketch count of each chunk under the freq policy
+
+        // for the out-enclave query pipeline (the freq index)
+        BatchState_t _pendingBatch; // the batch whose out-enclave query is in flight
+        uint8_t* _spareRecvBuffer; // the recv buffer of the other batch
+        InQueryEntry_t* _spareInQueryBase; // the dedup buffer of the other batch
+        uint32_t* _spareChunkOffsetList; // the chunk offsets of the other batch
+
+        // for the parallel upload streams of a session (NULL for a single stream)
+        EcallRecipeMerger* _recipeMerger; // owned by the primary stream (stream 0)
+        uint32_t _streamID;
+        uint32_t _streamNum;
+        uint64_t _nextBatchSeq; // the batch i of the session is sent by stream i % streamNum
+        list<pair<uint64_t, uint32_t>> _streamBatchList; // <batch seq, chunk num> of the unfinished batches
+        string _streamBatchEntry; // the recipe entries of the oldest unfinished batch
+
         /**
          * @brief Construct a new Enclave Client object
          * 
@@ -135,6 +172,23 @@ class EnclaveClient {
          * @param secretSize the input secret size
          */
         void SetMasterKey(uint8_t* encryptedSecret, size_t secretSize);
+
+        /**
+         * @brief swap the batch buffers with the spare ones
+         * 
+         */
+        inline void SwapBatchBuffer() {
+            uint8_t* tmpRecvBuffer = _recvBuffer;
+            _recvBuffer = _spareRecvBuffer;
+            _spareRecvBuffer = tmpRecvBuffer;
+            InQueryEntry_t* tmpInQueryBase = _inQueryBase;
+            _inQueryBase = _spareInQueryBase;
+            _spareInQueryBase = tmpInQueryBase;
+            uint32_t* tmpChunkOffsetList = _chunkOffsetList;
+            _chunkOffsetList = _spareChunkOffsetList;
+            _spareChunkOffsetList = tmpChunkOffsetList;
+            return ;
+        }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+/**
+ * @file ecallDoorkeeper.h
+ * @brief define the doorkeeper of the freq index: a blocked bloom filter that
+ * keeps the chunks seen once in the current period, so that a one-hit chunk
+ * does not raise the counters of the sketch (TinyLFU)
+ * @version 0.1
+ * 
+ */
+
+#ifndef ECALL_DOORKEEPER_H
+#define ECALL_DOORKEEPER_H
+
+// only the std library, the doorkeeper does not depend on the sgx library
+#include "stdint.h"
+#include "stdlib.h"
+#include "string.h"
+#include "../../../include/chunkStructure.h"
+
+class EcallDoorkeeper {
+    private:
+        // the bits of a key are in one block (a cache line)
+        static const uint32_t BLOCK_SIZE = 64;
+        static const uint32_t BLOCK_WORD_NUM = BLOCK_SIZE / sizeof(uint64_t);
+        static const uint32_t BLOCK_BIT_NUM = BLOCK_SIZE * 8;
+        // the bits set per key
+        static const uint32_t HASH_NUM = 4;
+        // the doorkeeper takes the fp bytes after the ones of the sketch
+        static const uint32_t FP_OFFSET = 16;
+
+        uint64_t blockNum_;
+        uint64_t* wordArray_;
+        uint8_t* rawBuffer_;
+
+    public:
+        /**
+         * @brief Construct a new EcallDoorkeeper object
+         * 
+         * @param bitNum the number of bits
+         */
+        EcallDoorkeeper(uint64_t bitNum);
+
+        /**
+         * @brief Destroy the EcallDoorkeeper object
+         * 
+         */
+        ~EcallDoorkeeper();
+
+        /**
+         * @brief check whether a chunk is in the doorkeeper, and insert it, the
+         * clients can insert concurrently
+         * 
+         * @param chunkHash the chunk hash
+         * @return true the chunk was in the doorkeeper
+         * @return false the chunk is inserted for the first time
+         */
+        bool TestAndSet(const uint8_t* chunkHash);
+
+        /**
+         * @brief clear all bits at the end of a period
+         * 
+         */
+        void Clear();
+
+        /**
+         * @brief Get the memory size of the bits
+         * 
+         * @return size_t the size of the bits
+         */
+        inline size_t GetSize() const {
+            return blockNum_ * BLOCK_SIZE;
+        }
+};
+
+#endif
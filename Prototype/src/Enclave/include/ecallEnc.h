@@ -20,6 +20,9 @@
 #include "../../../include/constVar.h"
 
 #include "commonEnclave.h"
+#include "ecallSha256.h"
+#include "ecallAes.h"
+#include "sgx_cpuid.h"
 
 static const unsigned char ecall_gcm_aad[] = {
     0x4d, 0x23, 0xc3, 0xce, 0xc3, 0x34, 0xb4, 0x9b, 0xdb, 0x37, 0x0c, 0x43,
@@ -37,6 +40,11 @@ class EcallCrypto {
         // initialized vector
         uint8_t* iv_;
 
+        // whether SHA-256 uses the SHA extensions instead of EVP
+        bool shaNI_ = false;
+        // whether the batch AES-CBC/CMC uses AES-NI instead of EVP
+        bool aesNI_ = false;
+
         /**
          * @brief revise the buffer
          * 
@@ -79,6 +87,19 @@ class EcallCrypto {
          */
         void GenerateHash(EVP_MD_CTX* mdCtx, uint8_t* dataBuffer, const int dataSize, uint8_t* hash);
 
+        /**
+         * @brief generate the hash of each chunk in a batch buffer, whose
+         * layout is (uint32_t chunk size, chunk data) per chunk
+         * 
+         * @param mdCtx hasher ctx
+         * @param batchBuffer the batch buffer
+         * @param chunkNum the number of chunks
+         * @param hashList the hash of chunk i is at hashList + i * hashStride
+         * @param hashStride the stride of the hashes
+         */
+        void GenerateHashBatch(EVP_MD_CTX* mdCtx, uint8_t* batchBuffer, size_t chunkNum,
+            uint8_t* hashList, size_t hashStride);
+
         /**
          * @brief Encrypt the data with the encryption key 
          * 
@@ -103,6 +124,77 @@ class EcallCrypto {
         void DecryptWithKey(EVP_CIPHER_CTX* ctx, uint8_t* ciphertext, const int dataSize, 
             uint8_t* key, uint8_t* dataBuffer);
 
+        /**
+         * @brief init the key schedule of the batch AES-CBC/CMC
+         * 
+         * @param key the 256-bit key
+         * @param keySchedule the key schedule
+         */
+        void InitKeySchedule(uint8_t* key, AesKeySchedule_t* keySchedule);
+
+        /**
+         * @brief encrypt the items with AES-CBC-256 (same as AESCBCEnc) in one pass
+         * 
+         * @param ctx cipher ctx (for the EVP fallback)
+         * @param keySchedule the key schedule
+         * @param dataBuffer the first input item
+         * @param dataStride the stride of the input items
+         * @param itemNum the number of items
+         * @param dataSize the item size
+         * @param ciphertext the first output item
+         * @param cipherStride the stride of the output items
+         */
+        void AESCBCEncBatch(EVP_CIPHER_CTX* ctx, const AesKeySchedule_t* keySchedule,
+            uint8_t* dataBuffer, size_t dataStride, size_t itemNum, const int dataSize,
+            uint8_t* ciphertext, size_t cipherStride);
+
+        /**
+         * @brief decrypt the items with AES-CBC-256 (same as AESCBCDec) in one pass
+         * 
+         * @param ctx cipher ctx (for the EVP fallback)
+         * @param keySchedule the key schedule
+         * @param ciphertext the first input item
+         * @param cipherStride the stride of the input items
+         * @param itemNum the number of items
+         * @param dataSize the item size
+         * @param dataBuffer the first output item
+         * @param dataStride the stride of the output items
+         */
+        void AESCBCDecBatch(EVP_CIPHER_CTX* ctx, const AesKeySchedule_t* keySchedule,
+            uint8_t* ciphertext, size_t cipherStride, size_t itemNum, const int dataSize,
+            uint8_t* dataBuffer, size_t dataStride);
+
+        /**
+         * @brief encrypt the index keys with AES-CMC (same as IndexAESCMCEnc) in one pass
+         * 
+         * @param ctx cipher ctx (for the EVP fallback)
+         * @param keySchedule the key schedule
+         * @param dataBuffer the first input item
+         * @param dataStride the stride of the input items
+         * @param itemNum the number of items
+         * @param dataSize the item size
+         * @param ciphertext the first output item
+         * @param cipherStride the stride of the output items
+         */
+        void IndexAESCMCEncBatch(EVP_CIPHER_CTX* ctx, const AesKeySchedule_t* keySchedule,
+            uint8_t* dataBuffer, size_t dataStride, size_t itemNum, const int dataSize,
+            uint8_t* ciphertext, size_t cipherStride);
+
+        /**
+         * @brief Encrypt the data with encryption key and iv (same as EncryptWithKeyIV),
+         * the ctx keeps the key schedule across the calls, so it must only be used
+         * with this key
+         * 
+         * @param keyCtx the cipher ctx of the key
+         * @param dataBuffer input data buffer
+         * @param dataSize input data size
+         * @param key encryption key
+         * @param ciphertext output ciphertext
+         * @param iv the iv
+         */
+        void EncryptWithKeyCtx(EVP_CIPHER_CTX* keyCtx, uint8_t* dataBuffer, const int dataSize,
+            uint8_t* key, uint8_t* ciphertext, uint8_t* iv);
+
         /**
          * @brief Encrypt the data with encryption key and iv
          * 
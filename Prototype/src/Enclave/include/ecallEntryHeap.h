@@ -12,8 +12,15 @@
 #ifndef ECALL_NEW_ENTRY_HEAP_H
 #define ECALL_NEW_ENTRY_HEAP_H
 
-#include "commonEnclave.h"
+// only the std library, the benchmark compares it outside the enclave
+#include "stdint.h"
+#include "string"
+#include "vector"
+#include "unordered_map"
 #include "functional"
+#include "../../../include/chunkStructure.h"
+
+using namespace std;
 
 class EcallEntryHeap {
     private:
@@ -14,11 +14,23 @@
 
 #include "enclaveBase.h"
 #include "ecallCMSketch.h"
-#include "ecallEntryHeap.h"
+#include "ecallDoorkeeper.h"
+#include "ecallTopKTable.h"
+#include "ecallWorkerPool.h"
 
 #define SEALED_FREQ_INDEX "freq-index"
 #define SEALED_SKETCH "cm-sketch"
 
+// the layout tag of the sealed top-k index with the head
+static const uint32_t ADAPTIVE_TOP_K_LAYOUT = 0x4b504f54;
+
+typedef struct {
+    uint32_t layout; // ADAPTIVE_TOP_K_LAYOUT
+    uint32_t reserved;
+    uint64_t capacity; // the k when sealed
+    uint64_t itemNum;
+} TopKHead_t;
+
 class EcallFreqIndex : public EnclaveBase {
     private:
         string myName_ = "EcallFreqIndex";
@@ -29,12 +41,36 @@ class EcallFreqIndex : public EnclaveBase {
         // the pointer to the cm-sketch inside the enclave
         EcallCMSketch* cmSketch_;
 
-        // the width of the sketch
-        size_t sketchWidth_ = 256 * 1024;
-        size_t sketchDepth_ = 4;
+        // the width of the sketch (from the config, or the sealed sketch)
+        size_t sketchWidth_;
+        size_t sketchDepth_;
 
         // the deduplication index
-        EcallEntryHeap* insideDedupIndex_;
+        EcallTopKTable* insideDedupIndex_;
+
+        // the memory budget of the sketch and the top-k index (0: fixed k)
+        uint64_t epcBudget_;
+
+        // the top-k lookups and hits of the current adapt window
+        uint64_t windowLookupNum_ = 0;
+        uint64_t windowHitNum_ = 0;
+        uint32_t windowBatchNum_ = 0;
+        // the hit ratio of the last window, and the k before the growth after
+        // it (0: no growth)
+        double lastHitRatio_ = 0;
+        size_t preGrowSize_ = 0;
+        uint32_t holdWindowNum_ = 0;
+        uint64_t totalLookupNum_ = 0;
+        uint64_t totalHitNum_ = 0;
+
+        // the freq policy (the bits of FREQ_POLICY)
+        uint32_t freqPolicy_;
+        // the chunks seen in the current period (NULL: no FREQ_DOORKEEPER)
+        EcallDoorkeeper* doorkeeper_ = NULL;
+        // the chunks of a period, and the chunks of the current period
+        uint64_t agingPeriod_;
+        uint64_t periodChunkNum_ = 0;
+        uint64_t agingNum_ = 0;
 
         uint64_t insideDedupChunkNum_ = 0;
         uint64_t insideDedupDataSize_ = 0;
@@ -42,10 +78,10 @@ class EcallFreqIndex : public EnclaveBase {
         /**
          * @brief update the inside-enclave with only freq
          * 
-         * @param ChunkFp the chunk fp
+         * @param heapItem the item of the chunk in the top-k index
          * @param currentFreq the current frequency
          */
-        void UpdateInsideIndexFreq(const string& chunkFp, uint32_t currentFreq);
+        void UpdateInsideIndexFreq(HeapItem_t* heapItem, uint32_t currentFreq);
 
         /**
          * @brief check whether add this chunk to the heap
@@ -54,6 +90,48 @@ class EcallFreqIndex : public EnclaveBase {
          */
         bool CheckIfAddToHeap(uint32_t chunkFreq);
 
+        /**
+         * @brief check whether admit a new chunk to the heap, with the doorkeeper
+         * the chunk must beat the min freq of the full heap (TinyLFU)
+         * 
+         * @param chunkFreq the chunk freq
+         */
+        bool CheckIfAdmit(uint32_t chunkFreq);
+
+        /**
+         * @brief get the weight of a chunk in the sketch
+         * 
+         * @param chunkSize the chunk size
+         * @return uint32_t the weight
+         */
+        inline uint32_t GetFreqWeight(uint32_t chunkSize) const {
+            if (freqPolicy_ & FREQ_BYTE_WEIGHT) {
+                return (chunkSize + FREQ_WEIGHT_UNIT - 1) / FREQ_WEIGHT_UNIT;
+            }
+            return 1;
+        }
+
+        /**
+         * @brief set the sketch count of each chunk of a batch under the freq
+         * policy, a chunk seen for the first time in the period only enters
+         * the doorkeeper
+         * 
+         * @param entryList the query entries of the batch
+         * @param entryNum the number of entries
+         * @param countList the count of each entry
+         */
+        void SetFreqCount(const InQueryEntry_t* entryList, size_t entryNum,
+            uint32_t* countList);
+
+        /**
+         * @brief count the chunks of a batch, and halve the frequencies and
+         * clear the doorkeeper at the end of a period, the writers of the
+         * top-k index are serialized by the caller
+         * 
+         * @param chunkNum the number of chunks in the batch
+         */
+        void AgeFreq(uint64_t chunkNum);
+
         /**
          * @brief Add the information of this chunk to the heap
          * 
@@ -61,7 +139,79 @@ class EcallFreqIndex : public EnclaveBase {
          * @param chunkAddr the chunk address
          * @param chunkFp the chunk fp
          */
-        void AddChunkToHeap(uint32_t chunkFreq, RecipeEntry_t* chunkAddr, const string& chunkFp);
+        void AddChunkToHeap(uint32_t chunkFreq, RecipeEntry_t* chunkAddr, const uint8_t* chunkFp);
+
+        /**
+         * @brief get the max k that the memory budget holds with the sketch
+         * and the doorkeeper
+         * 
+         * @return size_t the max k
+         */
+        size_t GetMaxTopKSize();
+
+        /**
+         * @brief count the top-k lookups of a batch, and resize the top-k index by
+         * the hit ratio at the end of a window, the writers of the top-k index
+         * are serialized by the caller
+         * 
+         * @param lookupNum the number of chunks that probe the top-k index
+         * @param hitNum the number of chunks found in the top-k index
+         */
+        void AdaptTopKSize(uint64_t lookupNum, uint64_t hitNum);
+
+        /**
+         * @brief compress and encrypt the unique chunks of a batch with the
+         * enclave workers window by window, and save them in the batch order
+         * 
+         * @param chunkNum the number of chunks in the batch
+         * @param upOutSGX the upload out-enclave var
+         * @param callerCtx the crypto context of the client
+         */
+        void SaveUniqueChunks(uint32_t chunkNum, UpOutSGX_t* upOutSGX,
+            WorkerCtx_t* callerCtx);
+
+#if (IMPACT_OF_TOP_K == 0)
+        /**
+         * @brief decrypt a batch into the batch buffers, compute the chunk
+         * hashes, and update the sketch
+         * 
+         * @param recvChunkBuf the recv chunk buffer
+         * @param upOutSGX the upload out-enclave var
+         * @param callerCtx the crypto context of the client
+         * @param batch the batch state
+         */
+        void HashBatch(SendMsgBuffer_t* recvChunkBuf, UpOutSGX_t* upOutSGX,
+            WorkerCtx_t* callerCtx, BatchState_t* batch);
+
+        /**
+         * @brief check a hashed batch with the top-k index and the local index,
+         * and fill the out-enclave query buffer with the missed chunks
+         * 
+         * @param upOutSGX the upload out-enclave var
+         * @param batch the batch state
+         */
+        void ProbeBatch(UpOutSGX_t* upOutSGX, BatchState_t* batch);
+
+        /**
+         * @brief save the unique chunks of a queried batch, update the recipe,
+         * the out-enclave query buffer, and the top-k index
+         * 
+         * @param upOutSGX the upload out-enclave var
+         * @param callerCtx the crypto context of the client
+         * @param batch the batch state
+         */
+        void FinishBatch(UpOutSGX_t* upOutSGX, WorkerCtx_t* callerCtx,
+            BatchState_t* batch);
+
+        /**
+         * @brief wait for the out-enclave query of the pending batch, then
+         * finish it and update the out-enclave index
+         * 
+         * @param upOutSGX the upload out-enclave var
+         * @param callerCtx the crypto context of the client
+         */
+        void FinishPendingBatch(UpOutSGX_t* upOutSGX, WorkerCtx_t* callerCtx);
+#endif
 
         /**
          * @brief persist the deduplication index into the disk
@@ -0,0 +1,65 @@
+/**
+ * @file ecallRecipeMerger.h
+ * @brief define the merger of the recipe entries from the parallel upload streams
+ * @version 0.1
+ * 
+ */
+
+#ifndef ECALL_RECIPE_MERGER_H
+#define ECALL_RECIPE_MERGER_H
+
+#include "commonEnclave.h"
+#include "ecallEnc.h"
+#include "map"
+
+class EcallRecipeMerger {
+    private:
+        string myName_ = "EcallRecipeMerger";
+
+        // the upload var of the primary stream, which owns the file recipe
+        UpOutSGX_t* upOutSGX_;
+
+        // the crypto obj to encrypt the merged recipe
+        EcallCrypto* cryptoObj_;
+        EVP_CIPHER_CTX* cipherCtx_;
+
+        // the batches that arrive before their preceding batches, <batch seq, entries>
+        map<uint64_t, string> pendingBatch_;
+        uint64_t nextBatchSeq_ = 0;
+        mutex mergeLck_;
+
+        uint64_t mergedBatchNum_ = 0;
+        uint64_t maxPendingBatchNum_ = 0;
+
+        /**
+         * @brief append the entries of a batch to the recipe of the primary stream
+         * 
+         * @param batchEntry the recipe entries of the batch
+         */
+        void AppendBatch(string& batchEntry);
+
+    public:
+        /**
+         * @brief Construct a new EcallRecipeMerger object
+         * 
+         * @param upOutSGX the upload out-enclave var of the primary stream
+         */
+        EcallRecipeMerger(UpOutSGX_t* upOutSGX);
+
+        /**
+         * @brief Destroy the EcallRecipeMerger object
+         * 
+         */
+        ~EcallRecipeMerger();
+
+        /**
+         * @brief add the recipe entries of a processed batch, and merge the
+         * batches in the order of the batch sequence number
+         * 
+         * @param batchSeq the batch sequence number in the session
+         * @param batchEntry the recipe entries of the batch
+         */
+        void AddBatch(uint64_t batchSeq, string& batchEntry);
+};
+
+#endif
@@ -34,10 +34,12 @@ class EcallRecvDecoder {
          * @param chunkSize the chunk size
          * @param restoreChunkBuf the restore chunk buffer
          * @param cipherCtx the pointer to the EVP cipher
+         * @param transferMode the transfer mode of the restored chunks
          * 
          */
         void RecoverOneChunk(uint8_t* chunkBuffer, uint32_t chunkSize, 
-            SendMsgBuffer_t* restoreChunkBuf, EVP_CIPHER_CTX* cipherCtx);
+            SendMsgBuffer_t* restoreChunkBuf, EVP_CIPHER_CTX* cipherCtx,
+            uint32_t transferMode);
     public:
         /**
          * @brief Construct a new EcallRecvDecoder object
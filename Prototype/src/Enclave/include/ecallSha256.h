@@ -0,0 +1,69 @@
+/**
+ * @file ecallSha256.h
+ * @brief define the SHA-256 kernel with the SHA extensions (SHA-NI), which
+ * computes the same digest as EVP_sha256
+ * @version 0.1
+ * 
+ */
+
+#ifndef ECALL_SHA256_H
+#define ECALL_SHA256_H
+
+// only the std library, the kernel does not depend on the sgx library
+#include "stdint.h"
+#include "stddef.h"
+#include "string.h"
+
+class EcallSha256 {
+    private:
+        static const size_t BLOCK_SIZE = 64;
+
+        /**
+         * @brief compress the blocks into the state
+         * 
+         * @param state the state (a-h)
+         * @param data the blocks
+         * @param blockNum the number of blocks
+         */
+        static void CompressBlocks(uint32_t* state, const uint8_t* data, size_t blockNum);
+
+    public:
+        static const size_t DIGEST_SIZE = 32;
+
+        /**
+         * @brief check whether the CPU supports the kernel
+         * 
+         * @param leaf1Ecx the ecx of cpuid leaf 1
+         * @param leaf7Ebx the ebx of cpuid leaf 7 (sub-leaf 0)
+         * @return true the kernel is supported
+         * @return false use the EVP digest
+         */
+        static inline bool CheckCPU(uint32_t leaf1Ecx, uint32_t leaf7Ebx) {
+            // SSSE3 (bit 9), SSE4.1 (bit 19), and SHA (bit 29)
+            return (leaf1Ecx & (1U << 9)) && (leaf1Ecx & (1U << 19)) &&
+                (leaf7Ebx & (1U << 29));
+        }
+
+        /**
+         * @brief compute the digest of the input data
+         * 
+         * @param data the input data
+         * @param dataSize the input data size
+         * @param digest the digest (DIGEST_SIZE)
+         */
+        static void Hash(const uint8_t* data, size_t dataSize, uint8_t* digest);
+
+        /**
+         * @brief compute the digests of the chunks in a batch buffer, whose
+         * layout is (uint32_t chunk size, chunk data) per chunk
+         * 
+         * @param batchBuffer the batch buffer
+         * @param chunkNum the number of chunks
+         * @param hashList the digest of chunk i is at hashList + i * hashStride
+         * @param hashStride the stride of the digests
+         */
+        static void HashBatch(const uint8_t* batchBuffer, size_t chunkNum,
+            uint8_t* hashList, size_t hashStride);
+};
+
+#endif
@@ -0,0 +1,366 @@
+/**
+ * @file ecallTopKTable.h
+ * @brief define the flat top-k index: an open-addressing table keyed by the
+ * chunk fp with the min-heap positions stored inline
+ * @version 0.1
+ * 
+ */
+
+#ifndef ECALL_TOP_K_TABLE_H
+#define ECALL_TOP_K_TABLE_H
+
+#include "stdint.h"
+#include "stdlib.h"
+#include "string.h"
+#include "../../../include/chunkStructure.h"
+
+typedef struct {
+    uint8_t chunkFp[CHUNK_HASH_SIZE];
+    HeapItem_t item; // item.idx is the heap position of this slot
+} TopKSlot_t;
+
+typedef struct {
+    uint32_t chunkFreq; // the copy of the freq to compare in the heap array
+    uint32_t slotIdx;
+} TopKHeapEntry_t;
+
+class EcallTopKTable {
+    private:
+        // the slots with linear probing, the load factor is at most 1/2
+        TopKSlot_t* slotList_;
+        uint64_t slotNum_;
+
+        // the sequence number of the modification (odd while modifying), the
+        // probing does not take the lock and retries if it changes
+        uint64_t seq_ = 0;
+
+        // the min-heap over the slots by the chunk freq
+        TopKHeapEntry_t* heap_;
+        uint32_t heapSize_ = 0;
+        uint32_t capacity_;
+
+        // the lock-free readers of each epoch, Resize frees the replaced arrays
+        // after the readers of the last epoch have left
+        uint64_t epoch_ = 0;
+        mutable uint64_t readerNum_[2] = {0, 0};
+
+        /**
+         * @brief get the home slot of a chunk fp
+         * 
+         * @param chunkFp the chunk fp
+         * @param slotNum the number of slots
+         * @return uint64_t the home slot index
+         */
+        static inline uint64_t HomeSlot(const uint8_t* chunkFp, uint64_t slotNum) {
+            // the fp is uniformly distributed, map its prefix to [0, slotNum)
+            uint64_t hashVal;
+            memcpy(&hashVal, chunkFp, sizeof(uint64_t));
+            return (uint64_t)(((unsigned __int128)hashVal * slotNum) >> 64);
+        }
+
+        /**
+         * @brief get the home slot of a chunk fp
+         * 
+         * @param chunkFp the chunk fp
+         * @return uint64_t the home slot index
+         */
+        inline uint64_t HomeSlot(const uint8_t* chunkFp) const {
+            return HomeSlot(chunkFp, slotNum_);
+        }
+
+        /**
+         * @brief get the next slot index in the probing
+         * 
+         * @param slotIdx the current slot index
+         * @return uint64_t the next slot index
+         */
+        inline uint64_t NextSlot(uint64_t slotIdx) const {
+            return (slotIdx + 1 == slotNum_) ? 0 : (slotIdx + 1);
+        }
+
+        /**
+         * @brief find the slot of a chunk fp
+         * 
+         * @param chunkFp the chunk fp
+         * @param slotIdx the home slot index
+         * @return TopKSlot_t* the slot (NULL if non-exist)
+         */
+        TopKSlot_t* ProbeSlot(const uint8_t* chunkFp, uint64_t slotIdx);
+
+        /**
+         * @brief copy the item of a chunk fp while the table may be modified,
+         * the probing stops after all slots since the slots can be inconsistent
+         * 
+         * @param chunkFp the chunk fp
+         * @param slotList the slots read in the same sequence as slotNum
+         * @param slotNum the number of slots
+         * @param item the copied item (idx is EMPTY_SLOT if non-exist)
+         */
+        static void ProbeCopy(const uint8_t* chunkFp, const TopKSlot_t* slotList,
+            uint64_t slotNum, HeapItem_t* item);
+
+        /**
+         * @brief start a modification, the writers are serialized by the caller
+         * 
+         */
+        inline void WriteBegin() {
+            __atomic_store_n(&seq_, seq_ + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief end a modification
+         * 
+         */
+        inline void WriteEnd() {
+            __atomic_store_n(&seq_, seq_ + 1, __ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief enter a read without the lock, the arrays seen by the read
+         * are not freed until ExitRead
+         * 
+         * @return uint32_t the reader slot of the epoch
+         */
+        inline uint32_t EnterRead() const {
+            while (true) {
+                uint64_t epoch = __atomic_load_n(&epoch_, __ATOMIC_SEQ_CST);
+                __atomic_add_fetch(&readerNum_[epoch & 1], 1, __ATOMIC_SEQ_CST);
+                if (__atomic_load_n(&epoch_, __ATOMIC_SEQ_CST) == epoch) {
+                    return epoch & 1;
+                }
+                // a resize started in between, enter the new epoch
+                __atomic_sub_fetch(&readerNum_[epoch & 1], 1, __ATOMIC_RELEASE);
+            }
+        }
+
+        /**
+         * @brief exit a read without the lock
+         * 
+         * @param readerSlot the reader slot from EnterRead
+         */
+        inline void ExitRead(uint32_t readerSlot) const {
+            __atomic_sub_fetch(&readerNum_[readerSlot], 1, __ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief start a new epoch and wait for the readers of the last epoch,
+         * the writers are serialized by the caller
+         * 
+         */
+        void WaitReaders();
+
+        /**
+         * @brief move a heap entry to a heap position
+         * 
+         * @param idx the heap position
+         * @param entry the heap entry
+         */
+        inline void PlaceHeapEntry(uint32_t idx, const TopKHeapEntry_t& entry) {
+            heap_[idx] = entry;
+            slotList_[entry.slotIdx].item.idx = idx;
+        }
+
+        /**
+         * @brief Swap up the entry
+         * 
+         * @param idx the heap position
+         */
+        void SwapUp(uint32_t idx);
+
+        /**
+         * @brief Swap down the entry
+         * 
+         * @param idx the heap position
+         */
+        void SwapDown(uint32_t idx);
+
+        /**
+         * @brief erase a slot with the backward shift, which keeps the probing
+         * sequences without tombstones
+         * 
+         * @param slotIdx the slot index
+         */
+        void EraseSlot(uint64_t slotIdx);
+
+    public:
+        // the number of chunks probed ahead in the batch probing
+        static const uint32_t PREFETCH_DIST = 8;
+        // the slot is empty if its heap position is EMPTY_SLOT, which also marks
+        // a missed item in FindBatch
+        static const uint32_t EMPTY_SLOT = UINT32_MAX;
+
+        /**
+         * @brief Construct a new EcallTopKTable object
+         * 
+         * @param capacity the max number of items (k)
+         */
+        EcallTopKTable(size_t capacity);
+
+        /**
+         * @brief Destroy the EcallTopKTable object
+         * 
+         */
+        ~EcallTopKTable();
+
+        /**
+         * @brief get the memory of the table per item
+         * 
+         * @return size_t the bytes per item (k)
+         */
+        static inline size_t ItemMemSize() {
+            return 2 * sizeof(TopKSlot_t) + sizeof(TopKHeapEntry_t);
+        }
+
+        /**
+         * @brief change the max number of items, the items of the min freq are
+         * popped to shrink the table, the writers are serialized by the caller
+         * 
+         * @param capacity the new max number of items (k)
+         * @return true success
+         * @return false no memory for the new arrays, the table is unchanged
+         */
+        bool Resize(size_t capacity);
+
+        /**
+         * @brief get the freq of the top element
+         * 
+         * @return uint32_t the min freq in the table
+         */
+        inline uint32_t TopEntry() const {
+            return heap_[0].chunkFreq;
+        }
+
+        /**
+         * @brief start a read without the lock
+         * 
+         * @return uint64_t the sequence number (even) to validate the read
+         */
+        inline uint64_t ReadBegin() const {
+            uint64_t seq;
+            while ((seq = __atomic_load_n(&seq_, __ATOMIC_ACQUIRE)) & 1) {
+                // a writer is modifying the table
+                __builtin_ia32_pause();
+            }
+            return seq;
+        }
+
+        /**
+         * @brief check whether the table was modified during the read
+         * 
+         * @param seq the sequence number from ReadBegin
+         * @return true the read must be retried
+         * @return false the read is consistent
+         */
+        inline bool ReadRetry(uint64_t seq) const {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            return __atomic_load_n(&seq_, __ATOMIC_RELAXED) != seq;
+        }
+
+        /**
+         * @brief get the min freq to enter the table without the lock
+         * 
+         * @return uint32_t the min freq (0 if the table is not full)
+         */
+        uint32_t GetMinFreq() const;
+
+        /**
+         * @brief Get the size object
+         * 
+         * @return size_t the number of items
+         */
+        inline size_t Size() const {
+            return heapSize_;
+        }
+
+        /**
+         * @brief Get the capacity object
+         * 
+         * @return size_t the max number of items
+         */
+        inline size_t Capacity() const {
+            return capacity_;
+        }
+
+        /**
+         * @brief prefetch the home slot of a chunk fp
+         * 
+         * @param chunkFp the chunk fp
+         */
+        inline void Prefetch(const uint8_t* chunkFp) const {
+            const TopKSlot_t* slotList = __atomic_load_n(&slotList_, __ATOMIC_RELAXED);
+            uint64_t slotNum = __atomic_load_n(&slotNum_, __ATOMIC_RELAXED);
+            __builtin_prefetch(&slotList[HomeSlot(chunkFp, slotNum)]);
+        }
+
+        /**
+         * @brief pop the element with the min freq
+         * 
+         */
+        void Pop();
+
+        /**
+         * @brief add an element, the table must not be full
+         * 
+         * @param chunkFp the chunk fp
+         * @param value the value
+         * @return HeapItem_t* the item in the table
+         */
+        HeapItem_t* Add(const uint8_t* chunkFp, const HeapItem_t& value);
+
+        /**
+         * @brief find an element, the item is valid until the next Add or Pop
+         * 
+         * @param chunkFp the chunk fp
+         * @return HeapItem_t* the item (NULL if non-exist)
+         */
+        HeapItem_t* Find(const uint8_t* chunkFp);
+
+        /**
+         * @brief find the elements of a batch without the lock and copy the
+         * items, prefetch the slots of the following chunks while probing
+         * 
+         * @param entryList the query entries of the batch
+         * @param entryNum the number of entries
+         * @param itemList the copied items (idx is EMPTY_SLOT if non-exist)
+         */
+        void FindBatch(InQueryEntry_t* entryList, size_t entryNum,
+            HeapItem_t* itemList) const;
+
+        /**
+         * @brief update the frequency of an element
+         * 
+         * @param item the item returned by Find
+         * @param freq the new freq
+         */
+        void Update(HeapItem_t* item, uint32_t freq);
+
+        /**
+         * @brief halve the freq of all elements (aging), the halving keeps the
+         * heap order, the writers are serialized by the caller
+         * 
+         */
+        void Age();
+
+        /**
+         * @brief Get the fp at a heap position (for persistence)
+         * 
+         * @param idx the heap position
+         * @return const uint8_t* the chunk fp
+         */
+        inline const uint8_t* GetHeapFp(size_t idx) const {
+            return slotList_[heap_[idx].slotIdx].chunkFp;
+        }
+
+        /**
+         * @brief Get the item at a heap position (for persistence)
+         * 
+         * @param idx the heap position
+         * @return HeapItem_t* the item
+         */
+        inline HeapItem_t* GetHeapItem(size_t idx) const {
+            return &slotList_[heap_[idx].slotIdx].item;
+        }
+};
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @file ecallWorkerPool.h
+ * @brief define the worker pool inside the enclave, the worker threads enter
+ * the enclave via Ecall_Worker_Run and process the items of a batch with the
+ * calling thread
+ * @version 0.1
+ * 
+ */
+
+#ifndef ECALL_WORKER_POOL_H
+#define ECALL_WORKER_POOL_H
+
+#include "commonEnclave.h"
+#include "condition_variable"
+#include "functional"
+
+// the crypto context of a thread in the pool
+typedef struct {
+    EVP_CIPHER_CTX* cipherCtx;
+    EVP_MD_CTX* mdCtx;
+    EVP_CIPHER_CTX* chunkCipherCtx; // keeps the key schedule of the data key
+} WorkerCtx_t;
+
+// process an item with the context of the thread
+typedef function<void(size_t, WorkerCtx_t*)> WorkerTask_t;
+
+class EcallWorkerPool {
+    private:
+        string myName_ = "EcallWorkerPool";
+        // the number of items claimed by a thread at a time
+        static const size_t CLAIM_ITEM_NUM = 4;
+
+        uint32_t workerNum_;
+        uint32_t runningNum_ = 0; // the workers inside the enclave
+
+        // only one batch uses the workers at a time, the other clients
+        // process their batches alone
+        mutex runLck_;
+
+        // the current task, protected by taskLck_
+        mutex taskLck_;
+        condition_variable taskCV_;
+        condition_variable doneCV_;
+        const WorkerTask_t* taskFunc_ = NULL;
+        size_t taskNum_ = 0;
+        uint64_t taskSeq_ = 0;
+        uint32_t busyNum_ = 0; // the workers in the current task
+        bool stop_ = false;
+
+        // the next item to claim
+        size_t nextItem_ = 0;
+
+        /**
+         * @brief claim and process the items until all are claimed
+         * 
+         * @param taskFunc the task
+         * @param taskNum the number of items
+         * @param workerCtx the context of this thread
+         */
+        void ClaimItems(const WorkerTask_t& taskFunc, size_t taskNum,
+            WorkerCtx_t* workerCtx);
+
+    public:
+        /**
+         * @brief Construct a new EcallWorkerPool object
+         * 
+         * @param workerNum the number of worker threads
+         */
+        EcallWorkerPool(uint32_t workerNum);
+
+        /**
+         * @brief Destroy the EcallWorkerPool object
+         * 
+         */
+        ~EcallWorkerPool();
+
+        /**
+         * @brief the main loop of a worker thread, return after Stop
+         * 
+         * @param workerID the worker ID
+         */
+        void Run(uint32_t workerID);
+
+        /**
+         * @brief stop the workers, and wait for them to leave the enclave
+         * 
+         */
+        void Stop();
+
+        /**
+         * @brief process the items of a batch with the workers, the caller
+         * also processes the items and returns after all are done; it processes
+         * them alone if no worker runs or another batch is using the workers
+         * 
+         * @param taskNum the number of items
+         * @param callerCtx the context of the caller
+         * @param taskFunc the task
+         */
+        void ParallelFor(size_t taskNum, WorkerCtx_t* callerCtx,
+            const WorkerTask_t& taskFunc);
+
+        /**
+         * @brief Get the number of the running workers
+         * 
+         * @return uint32_t the number of workers
+         */
+        inline uint32_t GetRunningNum() {
+            return __atomic_load_n(&runningNum_, __ATOMIC_RELAXED);
+        }
+};
+
+#endif
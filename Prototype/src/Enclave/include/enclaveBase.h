@@ -17,6 +17,7 @@
 #include "ecallEnc.h"
 #include "ecallStorage.h"
 #include "ecallLz4.h"
+#include "ecallRecipeMerger.h"
 
 #define ENABLE_SEALING 1
 static const double SEC_TO_USEC = 1000 * 1000;
@@ -33,6 +34,9 @@ class EnclaveBase {
         // crypto obj inside the enclave 
         EcallCrypto* cryptoObj_;
 
+        // the key schedule of the index query key for the batch AES-CBC/CMC
+        AesKeySchedule_t indexKeySchedule_;
+
         // for the limitation 
         uint64_t maxSegmentChunkNum_ = 0;
 
@@ -65,6 +69,16 @@ class EnclaveBase {
         void UpdateFileRecipe(string& chunkAddrStr, Recipe_t* inRecipe,
             UpOutSGX_t* upOutSGX);
 
+        /**
+         * @brief decrypt the received batch with the session key, and decompress
+         * it if the client sends it in the compressed transfer mode
+         * 
+         * @param recvChunkBuf the recv chunk buffer
+         * @param sgxClient the enclave client, the plaintext batch is in its
+         * recv buffer
+         */
+        void DecodeBatch(SendMsgBuffer_t* recvChunkBuf, EnclaveClient* sgxClient);
+
         /**
          * @brief process an unique chunk
          * 
@@ -76,6 +90,20 @@ class EnclaveBase {
         void ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuffer, 
             uint32_t chunkSize, UpOutSGX_t* upOutSGX);
 
+        /**
+         * @brief compress and encrypt an unique chunk without saving it, the
+         * enclave workers can call it concurrently
+         * 
+         * @param chunkBuffer the chunk buffer
+         * @param chunkSize the chunk size
+         * @param iv the iv of this chunk
+         * @param chunkCipherCtx the chunk cipher ctx of the calling thread
+         * @param cipherChunk the encoded chunk (MAX_CHUNK_SIZE)
+         * @return uint32_t the size of the encoded chunk
+         */
+        uint32_t EncodeChunk(uint8_t* chunkBuffer, uint32_t chunkSize, uint8_t* iv,
+            EVP_CIPHER_CTX* chunkCipherCtx, uint8_t* cipherChunk);
+
         /**
          * @brief update the index store
          * 
@@ -27,6 +27,9 @@
 // for ecall store
 #include "ecallStorage.h"
 
+// for the enclave workers
+#include "ecallWorkerPool.h"
+
 #define ENCLAVE_KEY_FILE_NAME "enclave-key"
 #define ENCLAVE_INDEX_INFO_NAME "enclave-index-info"
 
@@ -77,6 +80,18 @@ void Ecall_ProcTailChunkBatch(UpOutSGX_t* upOutSGX);
 void Ecall_Init_Client(uint32_t clientID, int type, int optType, 
     uint8_t* encMasterKey, void** sgxClient);
 
+/**
+ * @brief join an upload client to the parallel streams of a session
+ * 
+ * @param ret false if the stream does not belong to the session
+ * @param sgxClient the sgx-client ptr of the stream
+ * @param primaryUpOutSGX the upload out-enclave var of the primary stream
+ * @param streamID the stream ID (0 for the primary stream)
+ * @param streamNum the number of streams in the session
+ */
+void Ecall_Join_Stream(bool* ret, void* sgxClient, UpOutSGX_t* primaryUpOutSGX,
+    uint32_t streamID, uint32_t streamNum);
+
 /**
  * @brief destroy the inside client var
  * 
@@ -97,6 +112,20 @@ void Ecall_Enclave_Init(EnclaveConfig_t* enclaveConfig);
  */
 void Ecall_Enclave_Destroy();
 
+/**
+ * @brief run an enclave worker until the enclave is destroyed
+ * 
+ * @param workerID the worker ID
+ */
+void Ecall_Worker_Run(uint32_t workerID);
+
+/**
+ * @brief get the number of the enclave workers inside the enclave
+ * 
+ * @param runningNum the number of the running workers <return>
+ */
+void Ecall_Worker_Running_Num(uint32_t* runningNum);
+
 /**
  * @brief get the enclave info 
  * 
@@ -4,7 +4,9 @@
 #include "ocallUtil.h"
 #include "../../../include/storageCore.h"
 #include "../../../include/clientVar.h"
+#include "../../../include/outQueryWorker.h"
 #include "../../../include/absDatabase.h"
+#include "../../../include/cuckooFilter.h"
 #include "../../../include/dataWriter.h"
 #include "../../../include/enclaveRecvDecoder.h"
 
@@ -22,6 +24,7 @@ namespace OutEnclave {
     extern StorageCore* storageCoreObj_;
     extern DataWriter* dataWriterObj_;
     extern AbsDatabase* indexStoreObj_;
+    extern CuckooFilter* outIndexFilter_; // NULL: no filter
 
     // ocall for restore
     extern EnclaveRecvDecoder* enclaveRecvDecoderObj_;
@@ -31,8 +34,8 @@ namespace OutEnclave {
     extern ofstream outSealedFile_;
     extern ifstream inSealedFile_;
 
-    // rw lock for index
-    extern pthread_rwlock_t outIdxLck_;
+    // rw lock for the filter, the index locks its own shards
+    extern pthread_rwlock_t outFilterLck_;
     
     /**
      * @brief setup the ocall var
@@ -188,6 +191,22 @@ void Ocall_SendRestoreData(void* outClient);
  */
 void Ocall_QueryOutIndex(void* outClient);
 
+/**
+ * @brief query the outside deduplication index on the helper thread of the
+ * client, the enclave processes the next batch in the meantime
+ * 
+ * @param outClient the out-enclave client ptr
+ * @param queryNum the number of queries in the query buffer
+ */
+void Ocall_QueryOutIndexAsync(void* outClient, uint32_t queryNum);
+
+/**
+ * @brief wait for the query of the outside deduplication index
+ * 
+ * @param outClient the out-enclave client ptr
+ */
+void Ocall_WaitOutIndex(void* outClient);
+
 /**
  * @brief update the outside deduplication index
  * 
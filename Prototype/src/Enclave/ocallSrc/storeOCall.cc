@@ -15,6 +15,8 @@ namespace OutEnclave {
     // for upload
     StorageCore* storageCoreObj_ = NULL;
     AbsDatabase* indexStoreObj_ = NULL;
+    CuckooFilter* outIndexFilter_ = NULL;
+    string outIndexFilterPath_;
     DataWriter* dataWriterObj_ = NULL;
     ofstream outSealedFile_;
     ifstream inSealedFile_;
@@ -23,8 +25,8 @@ namespace OutEnclave {
     EnclaveRecvDecoder* enclaveRecvDecoderObj_ = NULL;
     string myName_ = "OCall";
 
-    // for lock
-    pthread_rwlock_t outIdxLck_;
+    // for lock, the index locks its own shards
+    pthread_rwlock_t outFilterLck_;
 };
 
 using namespace OutEnclave;
@@ -46,8 +48,39 @@ void OutEnclave::Init(DataWriter* dataWriterObj,
     storageCoreObj_ = storageCoreObj;
     enclaveRecvDecoderObj_ = enclaveRecvDecoderObj;
 
+    // init the filter of the out-enclave index
+    outIndexFilterPath_ = config.GetFp2ChunkDBName() + "-filter";
+    if (config.GetOutIndexFilterSize() != 0) {
+        outIndexFilter_ = new CuckooFilter(config.GetOutIndexFilterSize() * 1024);
+        if (outIndexFilter_->Load(outIndexFilterPath_)) {
+            // the file is written again at exit, a crash leaves no stale filter
+            remove(outIndexFilterPath_.c_str());
+        } else if (!indexStoreObj_->IsEmpty()) {
+            // the keys of the index are not in the filter, rebuild it
+            tool::Logging(myName_.c_str(), "the index has no valid filter file, "
+                "rebuild the filter from the index.\n");
+            bool scanRet = indexStoreObj_->ScanKey([](const char* key, size_t keySize) {
+                if (keySize == CHUNK_HASH_SIZE) {
+                    outIndexFilter_->Insert(key);
+                }
+            });
+            if (!scanRet || outIndexFilter_->IsOverflow()) {
+                tool::Logging(myName_.c_str(), "cannot rebuild the filter, "
+                    "disable the filter.\n");
+                delete outIndexFilter_;
+                outIndexFilter_ = NULL;
+            } else {
+                tool::Logging(myName_.c_str(), "rebuilt filter item num: %lu\n",
+                    outIndexFilter_->GetItemNum());
+            }
+        }
+    } else {
+        // this run updates the index without the filter, the file becomes stale
+        remove(outIndexFilterPath_.c_str());
+    }
+
     // init the lck
-    pthread_rwlock_init(&outIdxLck_, NULL);
+    pthread_rwlock_init(&outFilterLck_, NULL);
     return ;
 }
 
@@ -56,8 +89,19 @@ void OutEnclave::Init(DataWriter* dataWriterObj,
  * 
  */
 void OutEnclave::Destroy() {
+    if (outIndexFilter_ != NULL) {
+        // a full filter misses some keys, do not keep it
+        if (!outIndexFilter_->IsOverflow() &&
+            !outIndexFilter_->Persist(outIndexFilterPath_)) {
+            tool::Logging(myName_.c_str(), "cannot persist the filter, it is "
+                "rebuilt at the next start.\n");
+        }
+        delete outIndexFilter_;
+        outIndexFilter_ = NULL;
+    }
+
     // destroy the lck
-    pthread_rwlock_destroy(&outIdxLck_);
+    pthread_rwlock_destroy(&outFilterLck_);
     return ;
 }
 
@@ -125,6 +169,16 @@ void Ocall_Printf(const char* str) {
 void Ocall_UpdateIndexStoreBuffer(bool* ret, const char* key, size_t keySize, 
     const uint8_t* buffer, size_t bufferSize) {
     *ret = indexStoreObj_->InsertBothBuffer(key, keySize, (char*)buffer, bufferSize);
+    if (outIndexFilter_ != NULL && keySize == CHUNK_HASH_SIZE) {
+        // keep the filter in sync with the fingerprints of the index
+#if (MULTI_CLIENT == 1)
+        pthread_rwlock_wrlock(&outFilterLck_);
+#endif
+        outIndexFilter_->Insert(key);
+#if (MULTI_CLIENT == 1)
+        pthread_rwlock_unlock(&outFilterLck_);
+#endif
+    }
     return ;
 }
 
@@ -306,37 +360,92 @@ void Ocall_SendRestoreData(void* outClient) {
 }
 
 /**
- * @brief query the outside deduplication index 
+ * @brief query the outside deduplication index with the first queries
+ * of the query buffer
  * 
- * @param outClient the out-enclave client ptr
+ * @param outClientPtr the out-enclave client ptr
+ * @param queryNum the number of queries
  */
-void Ocall_QueryOutIndex(void* outClient) {
+static void QueryOutIndex(ClientVar* outClientPtr, uint32_t queryNum) {
+    OutQueryEntry_t* entry = outClientPtr->_outQuery.outQueryBase;
+    bool* foundList = outClientPtr->_outQueryFlagList;
+    bool* probeList = NULL;
+    size_t probeNum = queryNum;
+    if (outIndexFilter_ != NULL) {
+        // the chunks that miss the filter are definitely unique
+        probeList = outClientPtr->_outQueryProbeList;
+        probeNum = 0;
 #if (MULTI_CLIENT == 1)
-    pthread_rwlock_rdlock(&outIdxLck_);
+        pthread_rwlock_rdlock(&outFilterLck_);
 #endif
-    ClientVar* outClientPtr = (ClientVar*)outClient;
-    OutQuery_t* outQuery = &outClientPtr->_outQuery;
-    OutQueryEntry_t* entry = outQuery->outQueryBase;
-    string tmpChunkAddress;
-    tmpChunkAddress.resize(sizeof(RecipeEntry_t), 0);
-    bool queryResult;
-    for (size_t i = 0; i < outQuery->queryNum; i++) {
-        // check the outside index
-        queryResult = indexStoreObj_->QueryBuffer((char*)entry->chunkHash, 
-            CHUNK_HASH_SIZE, tmpChunkAddress);
-        if (queryResult) {
-            // this chunk is duplicate in the outside index
-            // store the query result in the buffer 
-            entry->dedupFlag = DUPLICATE;
-            memcpy(&entry->chunkAddr, &tmpChunkAddress[0], sizeof(RecipeEntry_t));
-        } else {
-            entry->dedupFlag = UNIQUE;
+        for (size_t i = 0; i < queryNum; i++) {
+            probeList[i] = outIndexFilter_->Contain((char*)entry[i].chunkHash);
+            probeNum += probeList[i];
         }
-        entry++; 
-    }
 #if (MULTI_CLIENT == 1)
-    pthread_rwlock_unlock(&outIdxLck_);
+        pthread_rwlock_unlock(&outFilterLck_);
 #endif
+    }
+
+    // check the outside index with one batch query, the index only locks
+    // the shards of the batch
+    size_t foundNum = 0;
+    if (probeNum != 0) {
+        foundNum = indexStoreObj_->MultiQueryBuffer((char*)entry->chunkHash, CHUNK_HASH_SIZE,
+            (char*)&entry->chunkAddr, sizeof(RecipeEntry_t), sizeof(OutQueryEntry_t),
+            queryNum, probeList, foundList);
+    } else {
+        memset(foundList, 0, queryNum * sizeof(bool));
+    }
+    if (outIndexFilter_ != NULL) {
+        outIndexFilter_->AddFalsePositive(probeNum - foundNum);
+    }
+    for (size_t i = 0; i < queryNum; i++) {
+        // the address of the duplicate chunk is stored in the buffer
+        entry->dedupFlag = foundList[i] ? DUPLICATE : UNIQUE;
+        entry++; 
+    }
+    return ;
+}
+
+/**
+ * @brief query the outside deduplication index 
+ * 
+ * @param outClient the out-enclave client ptr
+ */
+void Ocall_QueryOutIndex(void* outClient) {
+    ClientVar* outClientPtr = (ClientVar*)outClient;
+    QueryOutIndex(outClientPtr, outClientPtr->_outQuery.queryNum);
+    return ;
+}
+
+/**
+ * @brief query the outside deduplication index on the helper thread of the
+ * client, the enclave processes the next batch in the meantime
+ * 
+ * @param outClient the out-enclave client ptr
+ * @param queryNum the number of queries in the query buffer
+ */
+void Ocall_QueryOutIndexAsync(void* outClient, uint32_t queryNum) {
+    ClientVar* outClientPtr = (ClientVar*)outClient;
+    if (outClientPtr->_outQueryWorker == NULL) {
+        outClientPtr->_outQueryWorker = new OutQueryWorker();
+    }
+    outClientPtr->_outQueryWorker->Submit(boost::bind(&QueryOutIndex,
+        outClientPtr, queryNum));
+    return ;
+}
+
+/**
+ * @brief wait for the query of the outside deduplication index
+ * 
+ * @param outClient the out-enclave client ptr
+ */
+void Ocall_WaitOutIndex(void* outClient) {
+    ClientVar* outClientPtr = (ClientVar*)outClient;
+    if (outClientPtr->_outQueryWorker != NULL) {
+        outClientPtr->_outQueryWorker->Wait();
+    }
     return ;
 }
 
@@ -346,24 +455,34 @@ void Ocall_QueryOutIndex(void* outClient) {
  * @param outClient the out-enclave client ptr
  */
 void Ocall_UpdateOutIndex(void* outClient) {
-#if (MULTI_CLIENT == 1) 
-    pthread_rwlock_wrlock(&outIdxLck_);
-#endif
     ClientVar* outClientPtr = (ClientVar*)outClient;
     OutQuery_t* outQuery = &outClientPtr->_outQuery;
     OutQueryEntry_t* entry = outQuery->outQueryBase;
+    bool* insertList = outClientPtr->_outQueryFlagList;
     for (size_t i = 0; i < outQuery->queryNum; i++) {
-        // update the outside index
-        if (entry->dedupFlag == UNIQUE) {
-            // this is unique for the outside index, update the outside index
-            indexStoreObj_->InsertBothBuffer((char*)entry->chunkHash, CHUNK_HASH_SIZE,
-                (char*)&entry->chunkAddr, sizeof(RecipeEntry_t));
-        } 
-        entry++;
+        // only the unique chunks of the outside index are inserted
+        insertList[i] = (entry[i].dedupFlag == UNIQUE);
     }
+    if (!indexStoreObj_->WriteBatchBuffer((char*)entry->chunkHash, CHUNK_HASH_SIZE,
+        (char*)&entry->chunkAddr, sizeof(RecipeEntry_t), sizeof(OutQueryEntry_t),
+        outQuery->queryNum, insertList)) {
+        tool::Logging(myName_.c_str(), "cannot write the batch to the outside index.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (outIndexFilter_ != NULL) {
+        // keep the filter in sync with the index, only the written keys
 #if (MULTI_CLIENT == 1)
-    pthread_rwlock_unlock(&outIdxLck_);
+        pthread_rwlock_wrlock(&outFilterLck_);
 #endif
+        for (size_t i = 0; i < outQuery->queryNum; i++) {
+            if (insertList[i]) {
+                outIndexFilter_->Insert((char*)entry[i].chunkHash);
+            }
+        }
+#if (MULTI_CLIENT == 1)
+        pthread_rwlock_unlock(&outFilterLck_);
+#endif
+    }
     return ;
 }
 
@@ -35,6 +35,10 @@ DataReceiver::~DataReceiver() {
     fprintf(stderr, "========DataReceiver Info========\n");
     fprintf(stderr, "total receive batch num: %lu\n", batchNum_);
     fprintf(stderr, "total receive recipe end num: %lu\n", recipeEndNum_);
+    fprintf(stderr, "total receive new file num: %lu\n", newFileNum_);
+    fprintf(stderr, "total receive compressed batch num: %lu\n", compressedBatchNum_);
+    fprintf(stderr, "total receive stream sync num: %lu\n", streamSyncNum_);
+    fprintf(stderr, "total send batch feedback num: %lu\n", feedbackNum_);
     fprintf(stderr, "=================================\n");
 }
 
@@ -55,6 +59,13 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
     struct timeval sProcTime;
     struct timeval eProcTime;
     double totalProcessTime = 0;
+    double batchProcessTime = 0;
+
+    // the feedback of the current batch window
+    uint32_t batchChunkNum = 0;
+    BatchFeedback_t feedback;
+    memset(&feedback, 0, sizeof(BatchFeedback_t));
+    bool sessionAborted = false;
 
     tool::Logging(myName_.c_str(), "the main thread is running.\n");
     while (true) {
@@ -67,14 +78,34 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
             break;
         } else {
             gettimeofday(&sProcTime, NULL);
+            batchChunkNum = 0;
             switch (recvChunkBuf->header->messageType) {
                 case CLIENT_UPLOAD_CHUNK: {
+                    batchChunkNum = recvChunkBuf->header->currentItemNum;
                     absIndexObj_->ProcessOneBatch(recvChunkBuf, upOutSGX); 
                     batchNum_++;
                     break;
                 }
+                case CLIENT_UPLOAD_COMPRESSED_CHUNK: {
+                    // the enclave decompresses the batch after the decryption
+                    batchChunkNum = recvChunkBuf->header->currentItemNum;
+                    absIndexObj_->ProcessOneBatch(recvChunkBuf, upOutSGX);
+                    batchNum_++;
+                    compressedBatchNum_++;
+                    break;
+                }
                 case CLIENT_UPLOAD_RECIPE_END: {
                     // this is the end of one upload 
+                    if (outClient->_uploadSession != NULL &&
+                        !outClient->_uploadSession->WaitStreamSync()) {
+                        // a stream of the session is rejected, drop the file
+                        tool::Logging(myName_.c_str(), "the upload session is "
+                            "aborted, close the connection.\n");
+                        sessionAborted = true;
+                        break;
+                    }
+                    // the other streams merge their batches of this file into
+                    // the recipe before the tail
                     absIndexObj_->ProcessTailBatch(upOutSGX);
                     // finalize the file recipe
                     storageCoreObj_->FinalizeRecipe((FileRecipeHead_t*)recvChunkBuf->dataBuffer,
@@ -83,7 +114,32 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
 
                     // update the upload data size
                     FileRecipeHead_t* tmpRecipeHead = (FileRecipeHead_t*)recvChunkBuf->dataBuffer;
-                    outClient->_uploadDataSize = tmpRecipeHead->fileSize;
+                    outClient->_uploadDataSize += tmpRecipeHead->fileSize;
+                    break;
+                }
+                case CLIENT_UPLOAD_NEW_FILE: {
+                    // the next file in this session, the recipe of the previous
+                    // file has been finalized by its recipe end
+                    string recipePath = storageCoreObj_->GetRecipePath(
+                        recvChunkBuf->dataBuffer);
+                    outClient->OpenRecipe(recipePath);
+                    if (outClient->_uploadSession != NULL) {
+                        outClient->_uploadSession->NextFile();
+                    }
+                    newFileNum_++;
+                    break;
+                }
+                case CLIENT_UPLOAD_STREAM_SYNC: {
+                    // a secondary stream has sent all its batches of the file,
+                    // flush its tail segment to the recipe merger
+                    if (outClient->_uploadSession == NULL) {
+                        tool::Logging(myName_.c_str(), "recv the stream sync "
+                            "without parallel streams.\n");
+                        exit(EXIT_FAILURE);
+                    }
+                    absIndexObj_->ProcessTailBatch(upOutSGX);
+                    streamSyncNum_++;
+                    outClient->_uploadSession->SyncStream();
                     break;
                 }
                 default: {
@@ -92,8 +148,25 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
                     exit(EXIT_FAILURE);
                 }
             }
+            if (sessionAborted) {
+                dataSecureChannel_->GetClientIp(clientIP, clientSSL);
+                dataSecureChannel_->ClearAcceptedClientSd(clientSSL);
+                break;
+            }
             gettimeofday(&eProcTime, NULL);
-            totalProcessTime += tool::GetTimeDiff(sProcTime, eProcTime);
+            batchProcessTime = tool::GetTimeDiff(sProcTime, eProcTime);
+            totalProcessTime += batchProcessTime;
+
+            if (outClient->_batchTuneWindow != 0 && batchChunkNum != 0) {
+                // report the enclave time per window of chunk batches
+                feedback.batchNum++;
+                feedback.chunkNum += batchChunkNum;
+                feedback.enclaveTime += batchProcessTime;
+                if (feedback.batchNum == outClient->_batchTuneWindow) {
+                    this->SendBatchFeedback(clientSSL, feedback);
+                    memset(&feedback, 0, sizeof(BatchFeedback_t));
+                }
+            }
         }
     }
 
@@ -101,11 +174,35 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
     if (curContainer->currentSize != 0) {
         Ocall_WriteContainer(outClient);
     }
-    outClient->_inputMQ->done_ = true;
+    outClient->_inputMQ->SetDone();
     tool::Logging(myName_.c_str(), "thread exit for %s, ID: %u, enclave total process time: %lf\n", 
         clientIP.c_str(), outClient->_clientID, totalProcessTime);
 
     enclaveInfo->enclaveProcessTime = totalProcessTime;
     Ecall_GetEnclaveInfo(eidSGX_, enclaveInfo);
     return ;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief send the enclave time of a batch window to the client, which
+ * tunes the batch size by the feedback
+ * 
+ * @param clientSSL the client connection
+ * @param feedback the feedback of the window
+ */
+void DataReceiver::SendBatchFeedback(SSL* clientSSL, BatchFeedback_t& feedback) {
+    uint8_t sendBuffer[sizeof(NetworkHead_t) + sizeof(BatchFeedback_t)];
+    NetworkHead_t* header = (NetworkHead_t*)sendBuffer;
+    header->messageType = SERVER_BATCH_FEEDBACK;
+    header->clientID = 0;
+    header->currentItemNum = 0;
+    header->dataSize = sizeof(BatchFeedback_t);
+    memcpy(sendBuffer + sizeof(NetworkHead_t), &feedback, sizeof(BatchFeedback_t));
+    if (!dataSecureChannel_->SendData(clientSSL, sendBuffer,
+        sizeof(NetworkHead_t) + sizeof(BatchFeedback_t))) {
+        tool::Logging(myName_.c_str(), "send the batch feedback error.\n");
+        exit(EXIT_FAILURE);
+    }
+    feedbackNum_++;
+    return ;
+}
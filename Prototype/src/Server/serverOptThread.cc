@@ -170,6 +170,13 @@ void ServerOptThread::Run(SSL* clientSSL) {
         tool::Logging(myName_.c_str(), "recv the session key request error.\n");
         exit(EXIT_FAILURE);
     }
+    if (recvBuf.header->messageType == CLIENT_LOGIN_UPLOAD_STREAM) {
+        // a secondary stream of an upload session, it uses the session key of
+        // the primary stream
+        this->RunStream(clientSSL, recvBuf);
+        free(recvBuf.sendBuffer);
+        return ;
+    }
     if (recvBuf.header->messageType != SESSION_KEY_INIT) { 
         tool::Logging(myName_.c_str(), "recv the wrong session key init type.\n");
         exit(EXIT_FAILURE);
@@ -230,16 +237,37 @@ void ServerOptThread::Run(SSL* clientSSL) {
         }
     }
 
-    // check the file status
-    // convert the file name hash to the file path
-    char fileHashBuf[CHUNK_HASH_SIZE * 2 + 1];
-    for (uint32_t i = 0; i < CHUNK_HASH_SIZE; i++) {
-        sprintf(fileHashBuf + i * 2, "%02x", recvBuf.dataBuffer[i]);
+    // accept the transfer mode requested by the client
+    uint32_t transferMode = PLAIN_TRANSFER;
+    if (recvBuf.header->currentItemNum == COMPRESSED_TRANSFER) {
+        transferMode = COMPRESSED_TRANSFER;
+    }
+
+    // accept the upload options requested by the client
+    UploadLoginOpt_t loginOpt;
+    loginOpt.streamNum = 1;
+    loginOpt.batchTuneWindow = 0;
+    loginOpt.maxChunkBatchSize = config.GetMaxChunkBatchSize();
+    if (optType == UPLOAD_OPT && recvBuf.header->dataSize ==
+        CHUNK_HASH_SIZE * 2 + sizeof(UploadLoginOpt_t)) {
+        UploadLoginOpt_t requestOpt;
+        memcpy(&requestOpt, recvBuf.dataBuffer + CHUNK_HASH_SIZE * 2,
+            sizeof(UploadLoginOpt_t));
+#if (MULTI_CLIENT == 1)
+        // the streams process their batches in the enclave concurrently,
+        // which needs multiple TCSs
+        loginOpt.streamNum = std::max(std::min(requestOpt.streamNum,
+            MAX_UPLOAD_STREAM_NUM), 1U);
+#endif
+        // the client tunes the batch size up to the capacity of the upload
+        // buffers of this server
+        loginOpt.batchTuneWindow = requestOpt.batchTuneWindow;
     }
-    string fileName;
-    fileName.assign(fileHashBuf, CHUNK_HASH_SIZE * 2);
-    string recipePath = config.GetRecipeRootPath() +
-        fileName + config.GetRecipeSuffix();
+    uint32_t streamNum = loginOpt.streamNum;
+    UploadSession* uploadSession = NULL;
+
+    // check the file status
+    string recipePath = storageCoreObj_->GetRecipePath(recvBuf.dataBuffer);
     if (!this->CheckFileStatus(recipePath, optType)) {
         recvBuf.header->messageType = SERVER_FILE_NON_EXIST;
         if (!dataSecureChannel_->SendData(clientSSL, recvBuf.sendBuffer,
@@ -276,9 +304,31 @@ void ServerOptThread::Run(SSL* clientSSL) {
             tool::Logging(myName_.c_str(), "recv the upload request from client: %u\n",
                 clientID);
             outClient = new ClientVar(clientID, clientSSL, UPLOAD_OPT, recipePath);
+            outClient->_batchTuneWindow = loginOpt.batchTuneWindow;
             Ecall_Init_Client(eidSGX_, clientID, indexType_, UPLOAD_OPT, 
                 recvBuf.dataBuffer + CHUNK_HASH_SIZE, 
                 &outClient->_upOutSGX.sgxClient);
+            if (streamNum > 1) {
+                // the secondary streams join the session by the client ID
+                uploadSession = new UploadSession(outClient, streamNum);
+                outClient->_uploadSession = uploadSession;
+                bool joinRet = false;
+                Ecall_Join_Stream(eidSGX_, &joinRet, outClient->_upOutSGX.sgxClient,
+                    &outClient->_upOutSGX, 0, streamNum);
+                if (!joinRet) {
+                    tool::Logging(myName_.c_str(), "the enclave rejects the upload "
+                        "session of client %u, close the connection.\n", clientID);
+                    Ecall_Destroy_Client(eidSGX_, outClient->_upOutSGX.sgxClient);
+                    delete uploadSession;
+                    delete outClient;
+                    dataSecureChannel_->ClearAcceptedClientSd(clientSSL);
+                    free(recvBuf.sendBuffer);
+                    tmpLock->unlock();
+                    return ;
+                }
+                lock_guard<mutex> lock(clientLockSetLock_);
+                uploadSessionIndex_[clientID] = uploadSession;
+            }
 
             thTmp = new boost::thread(attrs, boost::bind(&DataReceiver::Run, dataReceiverObj_,
                 outClient, &enclaveInfo));
@@ -288,10 +338,13 @@ void ServerOptThread::Run(SSL* clientSSL) {
                 outClient->_inputMQ));
             thList.push_back(thTmp);
 #endif
-            // send the upload-response to the client
+            // send the upload-response to the client (include the accepted options)
             recvBuf.header->messageType = SERVER_LOGIN_RESPONSE;
+            recvBuf.header->currentItemNum = transferMode;
+            recvBuf.header->dataSize = sizeof(UploadLoginOpt_t);
+            memcpy(recvBuf.dataBuffer, &loginOpt, sizeof(UploadLoginOpt_t));
             if (!dataSecureChannel_->SendData(clientSSL, recvBuf.sendBuffer, 
-                sizeof(NetworkHead_t))) {
+                sizeof(NetworkHead_t) + sizeof(UploadLoginOpt_t))) {
                 tool::Logging(myName_.c_str(), "send the upload-login response error.\n");
                 exit(EXIT_FAILURE);
             }
@@ -303,6 +356,7 @@ void ServerOptThread::Run(SSL* clientSSL) {
             tool::Logging(myName_.c_str(), "recv the restore request from client: %u\n",
                 clientID);
             outClient = new ClientVar(clientID, clientSSL, DOWNLOAD_OPT, recipePath);
+            outClient->_resOutSGX.transferMode = transferMode;
             Ecall_Init_Client(eidSGX_, clientID, indexType_, DOWNLOAD_OPT, 
                 recvBuf.dataBuffer + CHUNK_HASH_SIZE,
                 &outClient->_resOutSGX.sgxClient);
@@ -313,6 +367,7 @@ void ServerOptThread::Run(SSL* clientSSL) {
 
             // send the restore-response to the client (include the file recipe header)
             recvBuf.header->messageType = SERVER_LOGIN_RESPONSE;
+            recvBuf.header->currentItemNum = transferMode;
             outClient->_recipeReadHandler.read((char*)recvBuf.dataBuffer,
                 sizeof(FileRecipeHead_t));
             if (!dataSecureChannel_->SendData(clientSSL, recvBuf.sendBuffer, 
@@ -346,6 +401,15 @@ void ServerOptThread::Run(SSL* clientSSL) {
     // clean up client variables 
     switch (optType) {
         case UPLOAD_OPT: {
+            if (uploadSession != NULL) {
+                // the secondary streams refer to the recipe merger of this client
+                uploadSession->Close();
+                {
+                    lock_guard<mutex> lock(clientLockSetLock_);
+                    uploadSessionIndex_.erase(clientID);
+                }
+                delete uploadSession;
+            }
             Ecall_Destroy_Client(eidSGX_, outClient->_upOutSGX.sgxClient);
             break;
         }
@@ -402,6 +466,91 @@ void ServerOptThread::Run(SSL* clientSSL) {
     return ;
 }
 
+/**
+ * @brief the process of a secondary stream of an upload session
+ * 
+ * @param clientSSL the client ssl
+ * @param recvBuf the buffer of the stream login
+ */
+void ServerOptThread::RunStream(SSL* clientSSL, SendMsgBuffer_t& recvBuf) {
+    boost::thread_attributes attrs;
+    attrs.set_stack_size(THREAD_STACK_SIZE);
+    vector<boost::thread*> thList;
+    EnclaveInfo_t enclaveInfo;
+    uint32_t clientID = recvBuf.header->clientID;
+    uint32_t streamID = recvBuf.header->currentItemNum;
+
+    // join the session of the primary stream
+    UploadSession* uploadSession = NULL;
+    {
+        lock_guard<mutex> lock(clientLockSetLock_);
+        auto findResult = uploadSessionIndex_.find(clientID);
+        if (findResult != uploadSessionIndex_.end() &&
+            findResult->second->JoinStream(streamID)) {
+            uploadSession = findResult->second;
+        }
+    }
+    if (uploadSession == NULL) {
+        tool::Logging(myName_.c_str(), "no upload session for stream %u of "
+            "client %u, close the connection.\n", streamID, clientID);
+        dataSecureChannel_->ClearAcceptedClientSd(clientSSL);
+        return ;
+    }
+
+    // the stream writes its own containers, and its recipe entries are merged
+    // into the recipe of the primary stream inside the enclave
+    string emptyRecipePath;
+    ClientVar* outClient = new ClientVar(clientID, clientSSL, UPLOAD_OPT,
+        emptyRecipePath);
+    outClient->_uploadSession = uploadSession;
+    outClient->_streamID = streamID;
+    Ecall_Init_Client(eidSGX_, clientID, indexType_, UPLOAD_OPT,
+        recvBuf.dataBuffer, &outClient->_upOutSGX.sgxClient);
+    bool joinRet = false;
+    Ecall_Join_Stream(eidSGX_, &joinRet, outClient->_upOutSGX.sgxClient,
+        &uploadSession->GetPrimaryClient()->_upOutSGX, streamID,
+        uploadSession->GetStreamNum());
+    if (!joinRet) {
+        // the primary stream cannot complete the file without this stream
+        tool::Logging(myName_.c_str(), "the enclave rejects stream %u of client "
+            "%u, abort the session.\n", streamID, clientID);
+        Ecall_Destroy_Client(eidSGX_, outClient->_upOutSGX.sgxClient);
+        delete outClient;
+        uploadSession->Abort();
+        uploadSession->ExitStream();
+        dataSecureChannel_->ClearAcceptedClientSd(clientSSL);
+        return ;
+    }
+
+    thList.push_back(new boost::thread(attrs, boost::bind(&DataReceiver::Run,
+        dataReceiverObj_, outClient, &enclaveInfo)));
+#if (MULTI_CLIENT == 0)
+    thList.push_back(new boost::thread(attrs, boost::bind(&DataWriter::Run,
+        dataWriterObj_, outClient->_inputMQ)));
+#endif
+
+    // send the stream-response to the client
+    recvBuf.header->messageType = SERVER_LOGIN_RESPONSE;
+    recvBuf.header->dataSize = 0;
+    if (!dataSecureChannel_->SendData(clientSSL, recvBuf.sendBuffer,
+        sizeof(NetworkHead_t))) {
+        tool::Logging(myName_.c_str(), "send the stream-login response error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (auto it : thList) {
+        it->join();
+        delete it;
+    }
+
+    Ecall_Destroy_Client(eidSGX_, outClient->_upOutSGX.sgxClient);
+    delete outClient;
+    uploadSession->ExitStream();
+    tool::Logging(myName_.c_str(), "stream %u of client %u exits.\n", streamID,
+        clientID);
+    return ;
+}
+
 /**
  * @brief check the file status
  * 
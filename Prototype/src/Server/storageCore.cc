@@ -65,4 +65,21 @@ void StorageCore::UpdateRecipeToFile(const uint8_t* recipeBuffer, size_t recipeE
     size_t recipeBufferSize = recipeEntryNum * sizeof(RecipeEntry_t);
     fileRecipeHandler.write((char*)recipeBuffer, recipeBufferSize);
     return ;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Get the recipe path of a file
+ * 
+ * @param fileNameHash the hash of the file name
+ * @return string the recipe path
+ */
+string StorageCore::GetRecipePath(const uint8_t* fileNameHash) {
+    // convert the file name hash to the file path
+    char fileHashBuf[CHUNK_HASH_SIZE * 2 + 1];
+    for (uint32_t i = 0; i < CHUNK_HASH_SIZE; i++) {
+        sprintf(fileHashBuf + i * 2, "%02x", fileNameHash[i]);
+    }
+    string fileName;
+    fileName.assign(fileHashBuf, CHUNK_HASH_SIZE * 2);
+    return recipeNamePrefix_ + fileName + recipeNameTail_;
+}
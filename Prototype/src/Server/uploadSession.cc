@@ -0,0 +1,149 @@
+/**
+ * @file uploadSession.cc
+ * @brief implement the interface of the upload session with parallel streams
+ * @version 0.1
+ *
+ */
+
+#include "../../include/uploadSession.h"
+
+/**
+ * @brief Construct a new UploadSession object
+ *
+ * @param primaryClient the out-enclave client of the primary stream
+ * @param streamNum the number of streams in the session
+ */
+UploadSession::UploadSession(ClientVar* primaryClient, uint32_t streamNum) {
+    primaryClient_ = primaryClient;
+    streamNum_ = streamNum;
+    myName_ = myName_ + "-" + to_string(primaryClient_->_clientID);
+    tool::Logging(myName_.c_str(), "init the UploadSession, stream num: %u\n",
+        streamNum_);
+}
+
+/**
+ * @brief Destroy the UploadSession object
+ *
+ */
+UploadSession::~UploadSession() {
+    fprintf(stderr, "========UploadSession Info========\n");
+    fprintf(stderr, "stream num: %u\n", streamNum_);
+    fprintf(stderr, "joined stream num: %u\n", joinStreamNum_);
+    fprintf(stderr, "file num: %lu\n", fileEpoch_ + 1);
+    fprintf(stderr, "==================================\n");
+}
+
+/**
+ * @brief join a secondary stream to the session
+ *
+ * @param streamID the stream ID
+ * @return true success
+ * @return false the stream ID is wrong or the session is closed
+ */
+bool UploadSession::JoinStream(uint32_t streamID) {
+    boost::unique_lock<boost::mutex> lck(sessionLck_);
+    if (closed_ || streamID == 0 || streamID >= streamNum_ ||
+        joinStreamNum_ == streamNum_ - 1) {
+        return false;
+    }
+    joinStreamNum_++;
+    return true;
+}
+
+/**
+ * @brief a secondary stream has processed all its batches of the
+ * current file, wait until the primary stream starts the next file
+ *
+ */
+void UploadSession::SyncStream() {
+    boost::unique_lock<boost::mutex> lck(sessionLck_);
+    uint64_t curEpoch = fileEpoch_;
+    syncStreamNum_++;
+    sessionCond_.notify_all();
+
+    // the batches of the next file cannot be merged into the current recipe
+    while (fileEpoch_ == curEpoch && !closed_) {
+        sessionCond_.wait(lck);
+    }
+    return ;
+}
+
+/**
+ * @brief wait until all secondary streams process their batches of the
+ * current file, called by the primary stream at the recipe end
+ *
+ * @return true success
+ * @return false the session is aborted, or a secondary stream does
+ * not join in time
+ */
+bool UploadSession::WaitStreamSync() {
+    boost::unique_lock<boost::mutex> lck(sessionLck_);
+    while (syncStreamNum_ != streamNum_ - 1 && !aborted_) {
+        if (sessionCond_.wait_for(lck, boost::chrono::seconds(STREAM_JOIN_TIMEOUT)) ==
+            boost::cv_status::timeout && joinStreamNum_ != streamNum_ - 1) {
+            // the batches of the missing streams never arrive
+            tool::Logging(myName_.c_str(), "only %u of %u secondary streams "
+                "joined, abort the session.\n", joinStreamNum_, streamNum_ - 1);
+            aborted_ = true;
+            closed_ = true;
+            sessionCond_.notify_all();
+        }
+    }
+    if (aborted_) {
+        return false;
+    }
+    syncStreamNum_ = 0;
+    return true;
+}
+
+/**
+ * @brief the primary stream starts the next file, release the
+ * secondary streams
+ *
+ */
+void UploadSession::NextFile() {
+    boost::unique_lock<boost::mutex> lck(sessionLck_);
+    fileEpoch_++;
+    sessionCond_.notify_all();
+    return ;
+}
+
+/**
+ * @brief exit a secondary stream
+ *
+ */
+void UploadSession::ExitStream() {
+    boost::unique_lock<boost::mutex> lck(sessionLck_);
+    exitStreamNum_++;
+    sessionCond_.notify_all();
+    return ;
+}
+
+/**
+ * @brief abort the session after a secondary stream is rejected, the
+ * primary stream stops waiting for the streams
+ *
+ */
+void UploadSession::Abort() {
+    boost::unique_lock<boost::mutex> lck(sessionLck_);
+    aborted_ = true;
+    closed_ = true;
+    sessionCond_.notify_all();
+    return ;
+}
+
+/**
+ * @brief close the session, wait until all secondary streams exit
+ *
+ */
+void UploadSession::Close() {
+    boost::unique_lock<boost::mutex> lck(sessionLck_);
+    closed_ = true;
+    sessionCond_.notify_all();
+
+    // the secondary streams refer to the recipe merger of the primary stream
+    while (exitStreamNum_ != joinStreamNum_) {
+        sessionCond_.wait(lck);
+    }
+    return ;
+}
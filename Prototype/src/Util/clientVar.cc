@@ -10,6 +10,7 @@
  */
 
 #include "../../include/clientVar.h"
+#include "../../include/outQueryWorker.h"
 
 /**
  * @brief Construct a new ClientVar object
@@ -17,7 +18,8 @@
  * @param clientID the client ID
  * @param clientSSL the client SSL
  * @param optType the operation type (upload / download)
- * @param recipePath the file recipe path
+ * @param recipePath the file recipe path (empty for a secondary upload
+ * stream, which writes to the recipe of the primary stream)
  */
 ClientVar::ClientVar(uint32_t clientID, SSL* clientSSL, 
     int optType, string& recipePath) {
@@ -30,6 +32,7 @@ ClientVar::ClientVar(uint32_t clientID, SSL* clientSSL,
 
     // config
     sendChunkBatchSize_ = config.GetSendChunkBatchSize();
+    maxChunkBatchSize_ = config.GetMaxChunkBatchSize();
     sendRecipeBatchSize_ = config.GetSendRecipeBatchSize();
 
     switch (optType_) {
@@ -76,12 +79,14 @@ void ClientVar::InitUploadBuffer() {
 
     // for querying outside index 
     _outQuery.outQueryBase = (OutQueryEntry_t*) malloc(sizeof(OutQueryEntry_t) * 
-        sendChunkBatchSize_);
+        maxChunkBatchSize_);
     _outQuery.queryNum = 0;
+    _outQueryFlagList = (bool*) malloc(sizeof(bool) * maxChunkBatchSize_);
+    _outQueryProbeList = (bool*) malloc(sizeof(bool) * maxChunkBatchSize_);
 
     // init the recv buffer
     _recvChunkBuf.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) + 
-        sendChunkBatchSize_ * sizeof(Chunk_t));
+        maxChunkBatchSize_ * sizeof(Chunk_t));
     _recvChunkBuf.header = (NetworkHead_t*) _recvChunkBuf.sendBuffer;
     _recvChunkBuf.header->clientID = _clientID;
     _recvChunkBuf.header->dataSize = 0;
@@ -105,6 +110,25 @@ void ClientVar::InitUploadBuffer() {
     _upOutSGX.outClient = this;
 
     // init the file recipe
+    if (recipePath_.size() != 0) {
+        this->OpenRecipe(recipePath_);
+    }
+
+    return ;
+}
+
+/**
+ * @brief open the recipe of the next uploaded file in this session
+ * 
+ * @param recipePath the file recipe path
+ */
+void ClientVar::OpenRecipe(string& recipePath) {
+    if (_recipeWriteHandler.is_open()) {
+        tool::Logging(myName_.c_str(), "recipe file: %s is not finalized.\n",
+            recipePath_.c_str());
+        exit(EXIT_FAILURE);
+    }
+    recipePath_ = recipePath;
     _recipeWriteHandler.open(recipePath_, ios_base::trunc | ios_base::binary);
     if (!_recipeWriteHandler.is_open()) {
         tool::Logging(myName_.c_str(), "cannot init recipe file: %s\n",
@@ -113,7 +137,6 @@ void ClientVar::InitUploadBuffer() {
     }
     FileRecipeHead_t virtualRecipeEnd;
     _recipeWriteHandler.write((char*)&virtualRecipeEnd, sizeof(FileRecipeHead_t));
-
     return ;
 }
 
@@ -122,11 +145,17 @@ void ClientVar::InitUploadBuffer() {
  * 
  */
 void ClientVar::DestroyUploadBuffer() {
+    if (_outQueryWorker != NULL) {
+        // the query in flight still writes to the query buffer
+        delete _outQueryWorker;
+    }
     if (_recipeWriteHandler.is_open()) {
         _recipeWriteHandler.close();
     }
     free(_outRecipe.entryList);
     free(_outQuery.outQueryBase);
+    free(_outQueryFlagList);
+    free(_outQueryProbeList);
     free(_recvChunkBuf.sendBuffer);
     delete _inputMQ;
     return ;
@@ -164,6 +193,7 @@ void ClientVar::InitRestoreBuffer() {
     _resOutSGX.reqContainer = &_reqContainer;
     _resOutSGX.sendChunkBuf = &_sendChunkBuf;
     _resOutSGX.outClient = this;
+    _resOutSGX.transferMode = PLAIN_TRANSFER;
 
     // init the recipe handler
     _recipeReadHandler.open(recipePath_, ios_base::in | ios_base::binary);
@@ -43,12 +43,23 @@ void Configure::ReadConf(std::string path) {
     avgChunkSize_ = root.get<uint64_t>("ChunkerConfig.avgChunkSize_");
     slidingWinSize_ = root.get<uint64_t>("ChunkerConfig.slidingWinSize_");
     readSize_ = root.get<uint64_t>("ChunkerConfig.readSize_");
+    chunkingThreadNum_ = root.get<uint64_t>("ChunkerConfig.chunkingThreadNum_");
+    fileWorkerNum_ = root.get<uint64_t>("ChunkerConfig.fileWorkerNum_");
 
     // StorageCore configure
     recipeRootPath_ = root.get<std::string>("StorageCore.recipeRootPath_");
     containerRootPath_ = root.get<std::string>("StorageCore.containerRootPath_");
     fp2ChunkDBName_ = root.get<std::string>("StorageCore.fp2ChunkDBName_");
+    fp2ChunkDBType_ = root.get<uint64_t>("StorageCore.fp2ChunkDBType_");
     topKParam_ = root.get<uint64_t>("StorageCore.topKParam_");
+    topKEPCBudget_ = root.get<uint64_t>("StorageCore.topKEPCBudget_");
+    sketchWidth_ = root.get<uint64_t>("StorageCore.sketchWidth_");
+    sketchDepth_ = root.get<uint64_t>("StorageCore.sketchDepth_");
+    freqPolicy_ = root.get<uint64_t>("StorageCore.freqPolicy_");
+    enclaveWorkerNum_ = root.get<uint64_t>("StorageCore.enclaveWorkerNum_");
+    outQueryPipeline_ = root.get<uint64_t>("StorageCore.outQueryPipeline_");
+    outIndexFilterSize_ = root.get<uint64_t>("StorageCore.outIndexFilterSize_");
+    outIndexShardNum_ = root.get<uint64_t>("StorageCore.outIndexShardNum_");
 
     // restore writer
     readCacheSize_ = root.get<uint64_t>("RestoreWriter.readCacheSize_");
@@ -60,7 +71,16 @@ void Configure::ReadConf(std::string path) {
     // for client id
     clientID_ = root.get<uint32_t>("DataSender.clientID_");
     sendChunkBatchSize_ = root.get<uint64_t>("DataSender.sendChunkBatchSize_");
+    minChunkBatchSize_ = root.get<uint64_t>("DataSender.minChunkBatchSize_");
+    maxChunkBatchSize_ = root.get<uint64_t>("DataSender.maxChunkBatchSize_");
+    batchTuneWindow_ = root.get<uint32_t>("DataSender.batchTuneWindow_");
+    // the initial batch size is always in the bounds
+    minChunkBatchSize_ = std::min(std::max(minChunkBatchSize_, (uint64_t)1),
+        sendChunkBatchSize_);
+    maxChunkBatchSize_ = std::max(maxChunkBatchSize_, sendChunkBatchSize_);
     sendRecipeBatchSize_ = root.get<uint64_t>("DataSender.sendRecipeBatchSize_");
+    transferMode_ = root.get<uint32_t>("DataSender.transferMode_");
+    uploadStreamNum_ = root.get<uint32_t>("DataSender.uploadStreamNum_");
     spid_ = root.get<std::string>("DataSender.spid_");
     quoteType_ = root.get<uint16_t>("DataSender.quoteType_");
     iasServerType_ = root.get<uint32_t>("DataSender.iasServerType_");
@@ -0,0 +1,307 @@
+/**
+ * @file cuckooFilter.cc
+ * @brief implement the cuckoo filter in front of the out-enclave index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/cuckooFilter.h"
+
+// the header of the filter file
+typedef struct {
+    uint64_t bucketNum;
+    uint64_t itemNum;
+    uint64_t hasVictim;
+    uint64_t victimIdx;
+    uint64_t victimTag;
+} CuckooFilterHead_t;
+
+/**
+ * @brief Construct a new Cuckoo Filter object
+ * 
+ * @param capacity the max number of keys
+ */
+CuckooFilter::CuckooFilter(uint64_t capacity) {
+    uint64_t minBucketNum = (uint64_t)(capacity / MAX_LOAD_FACTOR) / SLOT_PER_BUCKET + 1;
+    bucketNum_ = 1;
+    while (bucketNum_ < minBucketNum) {
+        bucketNum_ <<= 1;
+    }
+    table_ = (uint16_t*) calloc(bucketNum_ * SLOT_PER_BUCKET, sizeof(uint16_t));
+    if (table_ == NULL) {
+        tool::Logging(myName_.c_str(), "cannot allocate the table of %lu buckets.\n",
+            bucketNum_);
+        exit(EXIT_FAILURE);
+    }
+    hitNum_ = 0;
+    missNum_ = 0;
+    falsePositiveNum_ = 0;
+    tool::Logging(myName_.c_str(), "init the filter, bucket num: %lu, size: %lu MiB\n",
+        bucketNum_, bucketNum_ * SLOT_PER_BUCKET * sizeof(uint16_t) / MiB_2_B);
+}
+
+/**
+ * @brief Destroy the Cuckoo Filter object
+ * 
+ */
+CuckooFilter::~CuckooFilter() {
+    free(table_);
+    fprintf(stderr, "========CuckooFilter Info========\n");
+    fprintf(stderr, "item num: %lu\n", itemNum_);
+    fprintf(stderr, "overflow: %d\n", overflow_);
+    fprintf(stderr, "hit num (maybe in the index): %lu\n", hitNum_.load());
+    fprintf(stderr, "miss num (definitely unique): %lu\n", missNum_.load());
+    fprintf(stderr, "false positive num: %lu\n", falsePositiveNum_.load());
+    fprintf(stderr, "=================================\n");
+}
+
+/**
+ * @brief put a tag into an empty slot of the bucket
+ * 
+ * @param idx the bucket index
+ * @param tag the tag
+ * @return true success
+ * @return false the bucket is full
+ */
+bool CuckooFilter::InsertTagToBucket(uint64_t idx, uint16_t tag) {
+    uint16_t* bucket = table_ + idx * SLOT_PER_BUCKET;
+    for (size_t i = 0; i < SLOT_PER_BUCKET; i++) {
+        if (bucket[i] == 0) {
+            bucket[i] = tag;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief check whether the bucket has the tag
+ * 
+ * @param idx the bucket index
+ * @param tag the tag
+ * @return true it has the tag
+ * @return false it does not have the tag
+ */
+bool CuckooFilter::FindTagInBucket(uint64_t idx, uint16_t tag) {
+    uint16_t* bucket = table_ + idx * SLOT_PER_BUCKET;
+    return (bucket[0] == tag) | (bucket[1] == tag) | (bucket[2] == tag) |
+        (bucket[3] == tag);
+}
+
+/**
+ * @brief remove one copy of a tag from the bucket
+ * 
+ * @param idx the bucket index
+ * @param tag the tag
+ * @return true success
+ * @return false the bucket does not have the tag
+ */
+bool CuckooFilter::DeleteTagFromBucket(uint64_t idx, uint16_t tag) {
+    uint16_t* bucket = table_ + idx * SLOT_PER_BUCKET;
+    for (size_t i = 0; i < SLOT_PER_BUCKET; i++) {
+        if (bucket[i] == tag) {
+            bucket[i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief put a tag into one of its buckets, relocate the tags if both are full
+ * 
+ * @param idx the bucket index
+ * @param tag the tag
+ */
+void CuckooFilter::InsertTag(uint64_t idx, uint16_t tag) {
+    if (this->InsertTagToBucket(idx, tag)) {
+        return ;
+    }
+    idx = this->GetAltIndex(idx, tag);
+    if (this->InsertTagToBucket(idx, tag)) {
+        return ;
+    }
+
+    // relocate a random tag of the bucket to its other bucket
+    for (size_t kick = 0; kick < MAX_KICK_NUM; kick++) {
+        kickSeed_ ^= kickSeed_ << 13;
+        kickSeed_ ^= kickSeed_ >> 7;
+        kickSeed_ ^= kickSeed_ << 17;
+        uint16_t* slot = table_ + idx * SLOT_PER_BUCKET + (kickSeed_ % SLOT_PER_BUCKET);
+        uint16_t oldTag = *slot;
+        *slot = tag;
+        tag = oldTag;
+        idx = this->GetAltIndex(idx, tag);
+        if (this->InsertTagToBucket(idx, tag)) {
+            return ;
+        }
+    }
+
+    // keep the last tag aside, the filter still answers it
+    hasVictim_ = true;
+    victimIdx_ = idx;
+    victimTag_ = tag;
+    return ;
+}
+
+/**
+ * @brief insert a key
+ * 
+ * @param key the key (at least 10 bytes)
+ * @return true success
+ * @return false the filter is full, it answers "maybe" afterwards
+ */
+bool CuckooFilter::Insert(const char* key) {
+    if (overflow_) {
+        return false;
+    }
+    if (hasVictim_) {
+        // the table cannot hold more tags
+        tool::Logging(myName_.c_str(), "the filter is full with %lu keys, "
+            "increase outIndexFilterSize_.\n", itemNum_);
+        overflow_ = true;
+        return false;
+    }
+
+    uint64_t idx;
+    uint16_t tag;
+    this->GetIndexTag(key, &idx, &tag);
+    this->InsertTag(idx, tag);
+    itemNum_++;
+    return true;
+}
+
+/**
+ * @brief check whether a key may be in the index
+ * 
+ * @param key the key (at least 10 bytes)
+ * @return true it may be in the index
+ * @return false it is definitely not in the index
+ */
+bool CuckooFilter::Contain(const char* key) {
+    if (overflow_) {
+        hitNum_.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    uint64_t idx;
+    uint16_t tag;
+    this->GetIndexTag(key, &idx, &tag);
+    uint64_t altIdx = this->GetAltIndex(idx, tag);
+    bool findRes = this->FindTagInBucket(idx, tag) || this->FindTagInBucket(altIdx, tag) ||
+        (hasVictim_ && victimTag_ == tag && (victimIdx_ == idx || victimIdx_ == altIdx));
+    if (findRes) {
+        hitNum_.fetch_add(1, memory_order_relaxed);
+    } else {
+        missNum_.fetch_add(1, memory_order_relaxed);
+    }
+    return findRes;
+}
+
+/**
+ * @brief delete a key inserted before, for the garbage collection
+ * 
+ * @param key the key (at least 10 bytes)
+ * @return true success
+ * @return false the filter does not have the key
+ */
+bool CuckooFilter::Delete(const char* key) {
+    uint64_t idx;
+    uint16_t tag;
+    this->GetIndexTag(key, &idx, &tag);
+    uint64_t altIdx = this->GetAltIndex(idx, tag);
+    if (this->DeleteTagFromBucket(idx, tag) || this->DeleteTagFromBucket(altIdx, tag)) {
+        itemNum_--;
+        if (hasVictim_) {
+            // a slot is free, put the victim back
+            hasVictim_ = false;
+            this->InsertTag(victimIdx_, victimTag_);
+        }
+        return true;
+    }
+    if (hasVictim_ && victimTag_ == tag && (victimIdx_ == idx || victimIdx_ == altIdx)) {
+        hasVictim_ = false;
+        itemNum_--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief persist the filter to a file
+ * 
+ * @param filePath the file path
+ * @return true success
+ * @return false fail, the file is not written
+ */
+bool CuckooFilter::Persist(string filePath) {
+    // write a temp file and rename it, a failed write leaves no filter file
+    string tmpFilePath = filePath + ".tmp";
+    ofstream filterFile;
+    filterFile.open(tmpFilePath, ios_base::trunc | ios_base::binary);
+    if (!filterFile.is_open()) {
+        tool::Logging(myName_.c_str(), "cannot open the filter file: %s\n",
+            tmpFilePath.c_str());
+        return false;
+    }
+    CuckooFilterHead_t filterHead;
+    filterHead.bucketNum = bucketNum_;
+    filterHead.itemNum = itemNum_;
+    filterHead.hasVictim = hasVictim_;
+    filterHead.victimIdx = victimIdx_;
+    filterHead.victimTag = victimTag_;
+    filterFile.write((char*)&filterHead, sizeof(CuckooFilterHead_t));
+    filterFile.write((char*)table_, bucketNum_ * SLOT_PER_BUCKET * sizeof(uint16_t));
+    filterFile.close();
+    if (filterFile.fail()) {
+        tool::Logging(myName_.c_str(), "cannot write the filter file: %s\n",
+            tmpFilePath.c_str());
+        remove(tmpFilePath.c_str());
+        return false;
+    }
+    if (rename(tmpFilePath.c_str(), filePath.c_str()) != 0) {
+        tool::Logging(myName_.c_str(), "cannot rename the filter file to %s, "
+            "errno: %d\n", filePath.c_str(), errno);
+        remove(tmpFilePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief load the filter from a file
+ * 
+ * @param filePath the file path
+ * @return true success
+ * @return false fail, the filter is unchanged
+ */
+bool CuckooFilter::Load(string filePath) {
+    ifstream filterFile;
+    filterFile.open(filePath, ios_base::in | ios_base::binary);
+    if (!filterFile.is_open()) {
+        return false;
+    }
+    CuckooFilterHead_t filterHead;
+    filterFile.read((char*)&filterHead, sizeof(CuckooFilterHead_t));
+    if (filterFile.gcount() != sizeof(CuckooFilterHead_t) ||
+        filterHead.bucketNum != bucketNum_) {
+        // the capacity is changed, the tags cannot be moved to the new table
+        tool::Logging(myName_.c_str(), "the filter file does not match the capacity.\n");
+        filterFile.close();
+        return false;
+    }
+    filterFile.read((char*)table_, bucketNum_ * SLOT_PER_BUCKET * sizeof(uint16_t));
+    if ((size_t)filterFile.gcount() != bucketNum_ * SLOT_PER_BUCKET * sizeof(uint16_t)) {
+        tool::Logging(myName_.c_str(), "the filter file is truncated.\n");
+        memset(table_, 0, bucketNum_ * SLOT_PER_BUCKET * sizeof(uint16_t));
+        filterFile.close();
+        return false;
+    }
+    itemNum_ = filterHead.itemNum;
+    hasVictim_ = filterHead.hasVictim;
+    victimIdx_ = filterHead.victimIdx;
+    victimTag_ = filterHead.victimTag;
+    filterFile.close();
+    tool::Logging(myName_.c_str(), "loaded filter item num: %lu\n", itemNum_);
+    return true;
+}
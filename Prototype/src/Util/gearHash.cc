@@ -0,0 +1,372 @@
+/**
+ * @file gearHash.cc
+ * @brief implement the interface defined in gearHash.h
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/gearHash.h"
+#include <immintrin.h>
+
+// The vector kernels split a round into one block per lane and run the gear
+// hash of all blocks in parallel. Lane 0 starts from the real fingerprint, and
+// lane i warms up on the last GEAR_WARMUP_SIZE bytes of block i - 1, which in
+// practice converges to the sequential state. The lanes are then checked in
+// order and an out-of-sync lane is rescanned by the scalar kernel, so the cut
+// points are always identical to the scalar ones.
+
+/**
+ * @brief Construct a new GearHash object
+ * 
+ * @param kernelType the kernel type
+ */
+GearHash::GearHash(int kernelType) {
+    if (!IsSupported(kernelType)) {
+        tool::Logging(myName_.c_str(), "%s is not supported, use the scalar kernel.\n",
+            GetKernelName(kernelType));
+        kernelType = GEAR_SCALAR;
+    }
+    kernelType_ = kernelType;
+}
+
+/**
+ * @brief Destroy the GearHash object
+ * 
+ */
+GearHash::~GearHash() {
+}
+
+/**
+ * @brief detect the fastest kernel supported by this CPU
+ * 
+ * @return int the kernel type
+ */
+int GearHash::DetectKernelType() {
+    // AVX2 has no in-register table lookup, so its kernel fills the gear rows
+    // with scalar loads and does not beat the scalar kernel (see gearBench);
+    // it is only used when requested explicitly
+    if (IsSupported(GEAR_AVX512)) {
+        return GEAR_AVX512;
+    }
+    return GEAR_SCALAR;
+}
+
+/**
+ * @brief check whether the CPU supports the kernel
+ * 
+ * @param kernelType the kernel type
+ * @return true supported
+ * @return false not supported
+ */
+bool GearHash::IsSupported(int kernelType) {
+    switch (kernelType) {
+        case GEAR_SCALAR:
+            return true;
+        case GEAR_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case GEAR_AVX512:
+            return __builtin_cpu_supports("avx512f");
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Get the name of the kernel
+ * 
+ * @param kernelType the kernel type
+ * @return const char* the kernel name
+ */
+const char* GearHash::GetKernelName(int kernelType) {
+    switch (kernelType) {
+        case GEAR_SCALAR:
+            return "scalar";
+        case GEAR_AVX2:
+            return "AVX2";
+        case GEAR_AVX512:
+            return "AVX-512";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * @brief find the first byte in [start, end) whose fingerprint matches the mask
+ * 
+ * @param src the input buffer
+ * @param start the start offset
+ * @param end the end offset
+ * @param mask the cut mask
+ * @param fp the running fingerprint (updated if no cut is found)
+ * @return uint32_t the offset of the cut byte, end if no cut
+ */
+uint32_t GearHash::Scan(const uint8_t* src, uint32_t start, uint32_t end,
+    uint32_t mask, uint32_t& fp) {
+    switch (kernelType_) {
+        case GEAR_AVX2:
+            return ScanAVX2(src, start, end, mask, fp);
+        case GEAR_AVX512:
+            return ScanAVX512(src, start, end, mask, fp);
+        default:
+            return ScanScalar(src, start, end, mask, fp);
+    }
+}
+
+/**
+ * @brief scan the buffer byte by byte
+ * 
+ * @param src the input buffer
+ * @param start the start offset
+ * @param end the end offset
+ * @param mask the cut mask
+ * @param fp the running fingerprint
+ * @return uint32_t the offset of the cut byte, end if no cut
+ */
+uint32_t GearHash::ScanScalar(const uint8_t* src, uint32_t start, uint32_t end,
+    uint32_t mask, uint32_t& fp) {
+    for (uint32_t i = start; i < end; i++) {
+        fp = (fp >> 1) + GEAR[src[i]];
+        if (!(fp & mask)) {
+            return i;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief check the speculative result of each lane in order
+ * 
+ * @param src the input buffer
+ * @param start the start offset of this round
+ * @param laneNum the number of lanes
+ * @param laneState the fingerprint of each lane before its block
+ * @param laneHit the first cut offset of each lane in its block
+ * @param laneEnd the fingerprint of each lane after its block
+ * @param mask the cut mask
+ * @param fp the running fingerprint
+ * @param cut the offset of the cut byte
+ * @return true a cut is found in this round
+ * @return false no cut in this round
+ */
+bool GearHash::VerifyLanes(const uint8_t* src, uint32_t start, uint32_t laneNum,
+    const uint32_t* laneState, const uint32_t* laneHit, const uint32_t* laneEnd,
+    uint32_t mask, uint32_t& fp, uint32_t& cut) {
+    for (uint32_t i = 0; i < laneNum; i++) {
+        uint32_t blockStart = start + i * GEAR_BLOCK_SIZE;
+        uint32_t blockEnd = blockStart + GEAR_BLOCK_SIZE;
+        if (laneState[i] == fp) {
+            // the lane is in sync, its result is exact
+            if (laneHit[i] != UINT32_MAX) {
+                cut = blockStart + laneHit[i];
+                return true;
+            }
+            fp = laneEnd[i];
+        } else {
+            // the lane is out of sync, rescan its block
+            cut = ScanScalar(src, blockStart, blockEnd, mask, fp);
+            if (cut != blockEnd) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief scan the buffer with the AVX2 kernel
+ * 
+ * @param src the input buffer
+ * @param start the start offset
+ * @param end the end offset
+ * @param mask the cut mask
+ * @param fp the running fingerprint
+ * @return uint32_t the offset of the cut byte, end if no cut
+ */
+__attribute__((target("avx2")))
+uint32_t GearHash::ScanAVX2(const uint8_t* src, uint32_t start, uint32_t end,
+    uint32_t mask, uint32_t& fp) {
+    const uint32_t laneNum = GEAR_AVX2_LANE_NUM;
+    const uint32_t roundSize = laneNum * GEAR_BLOCK_SIZE;
+    alignas(32) uint32_t gearRow[GEAR_BLOCK_SIZE * laneNum];
+    alignas(32) uint32_t laneState[laneNum];
+    alignas(32) uint32_t laneHit[laneNum];
+    alignas(32) uint32_t laneEnd[laneNum];
+
+    const __m256i zeroVec = _mm256_setzero_si256();
+    const __m256i maskVec = _mm256_set1_epi32(mask);
+    // move lane i to lane i + 1
+    const __m256i shiftIdx = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+
+    uint32_t cut;
+    while (end - start >= roundSize) {
+        // gearRow[step][lane]: the gear value of each byte
+        const uint8_t* blockBase = src + start;
+        for (uint32_t lane = 0; lane < laneNum; lane++) {
+            const uint8_t* block = blockBase + lane * GEAR_BLOCK_SIZE;
+            for (uint32_t step = 0; step < GEAR_BLOCK_SIZE; step++) {
+                gearRow[step * laneNum + lane] = GEAR[block[step]];
+            }
+        }
+
+        // warm up lane i with the tail of block i - 1
+        __m256i fpVec = zeroVec;
+        for (uint32_t step = GEAR_BLOCK_SIZE - GEAR_WARMUP_SIZE; step < GEAR_BLOCK_SIZE;
+            step++) {
+            __m256i gearVec = _mm256_permutevar8x32_epi32(
+                _mm256_load_si256((const __m256i*)(gearRow + step * laneNum)), shiftIdx);
+            fpVec = _mm256_add_epi32(_mm256_srli_epi32(fpVec, 1), gearVec);
+        }
+        fpVec = _mm256_blend_epi32(fpVec, _mm256_set1_epi32(fp), 1);
+        _mm256_store_si256((__m256i*)laneState, fpVec);
+
+        __m256i foundVec = zeroVec;
+        __m256i hitVec = _mm256_set1_epi32(-1);
+        for (uint32_t step = 0; step < GEAR_BLOCK_SIZE; step++) {
+            __m256i gearVec = _mm256_load_si256((const __m256i*)(gearRow + step * laneNum));
+            fpVec = _mm256_add_epi32(_mm256_srli_epi32(fpVec, 1), gearVec);
+            __m256i matchVec = _mm256_andnot_si256(foundVec,
+                _mm256_cmpeq_epi32(_mm256_and_si256(fpVec, maskVec), zeroVec));
+            hitVec = _mm256_blendv_epi8(hitVec, _mm256_set1_epi32(step), matchVec);
+            foundVec = _mm256_or_si256(foundVec, matchVec);
+        }
+        _mm256_store_si256((__m256i*)laneHit, hitVec);
+        _mm256_store_si256((__m256i*)laneEnd, fpVec);
+
+        if (VerifyLanes(src, start, laneNum, laneState, laneHit, laneEnd, mask,
+            fp, cut)) {
+            return cut;
+        }
+        start += roundSize;
+    }
+    return ScanScalar(src, start, end, mask, fp);
+}
+
+/**
+ * @brief transpose a 16x16 matrix of 32-bit integers
+ * 
+ * @param row the rows of the matrix
+ */
+__attribute__((target("avx512f")))
+static inline void Transpose16x16(__m512i* row) {
+    __m512i tmp[16];
+    for (int i = 0; i < 16; i += 2) {
+        tmp[i] = _mm512_unpacklo_epi32(row[i], row[i + 1]);
+        tmp[i + 1] = _mm512_unpackhi_epi32(row[i], row[i + 1]);
+    }
+    for (int i = 0; i < 16; i += 4) {
+        row[i] = _mm512_unpacklo_epi64(tmp[i], tmp[i + 2]);
+        row[i + 1] = _mm512_unpackhi_epi64(tmp[i], tmp[i + 2]);
+        row[i + 2] = _mm512_unpacklo_epi64(tmp[i + 1], tmp[i + 3]);
+        row[i + 3] = _mm512_unpackhi_epi64(tmp[i + 1], tmp[i + 3]);
+    }
+    for (int i = 0; i < 4; i++) {
+        tmp[i] = _mm512_shuffle_i32x4(row[i], row[i + 4], 0x88);
+        tmp[i + 4] = _mm512_shuffle_i32x4(row[i], row[i + 4], 0xdd);
+        tmp[i + 8] = _mm512_shuffle_i32x4(row[i + 8], row[i + 12], 0x88);
+        tmp[i + 12] = _mm512_shuffle_i32x4(row[i + 8], row[i + 12], 0xdd);
+    }
+    for (int i = 0; i < 4; i++) {
+        row[i] = _mm512_shuffle_i32x4(tmp[i], tmp[i + 8], 0x88);
+        row[i + 8] = _mm512_shuffle_i32x4(tmp[i], tmp[i + 8], 0xdd);
+        row[i + 4] = _mm512_shuffle_i32x4(tmp[i + 4], tmp[i + 12], 0x88);
+        row[i + 12] = _mm512_shuffle_i32x4(tmp[i + 4], tmp[i + 12], 0xdd);
+    }
+    return ;
+}
+
+/**
+ * @brief scan the buffer with the AVX-512 kernel
+ * 
+ * @param src the input buffer
+ * @param start the start offset
+ * @param end the end offset
+ * @param mask the cut mask
+ * @param fp the running fingerprint
+ * @return uint32_t the offset of the cut byte, end if no cut
+ */
+__attribute__((target("avx512f")))
+uint32_t GearHash::ScanAVX512(const uint8_t* src, uint32_t start, uint32_t end,
+    uint32_t mask, uint32_t& fp) {
+    const uint32_t laneNum = GEAR_AVX512_LANE_NUM;
+    const uint32_t roundSize = laneNum * GEAR_BLOCK_SIZE;
+    alignas(64) uint32_t gearRow[GEAR_BLOCK_SIZE * laneNum];
+    alignas(64) uint32_t laneState[laneNum];
+    alignas(64) uint32_t laneHit[laneNum];
+    alignas(64) uint32_t laneEnd[laneNum];
+
+    // keep the whole gear table in registers, 32 entries per pair
+    __m512i gearTable[16];
+    for (int i = 0; i < 16; i++) {
+        gearTable[i] = _mm512_loadu_si512((const void*)(GEAR + i * 16));
+    }
+    const __m512i zeroVec = _mm512_setzero_si512();
+    const __m512i maskVec = _mm512_set1_epi32(mask);
+    const __m512i bit5Vec = _mm512_set1_epi32(1 << 5);
+    const __m512i bit6Vec = _mm512_set1_epi32(1 << 6);
+    const __m512i bit7Vec = _mm512_set1_epi32(1 << 7);
+
+    uint32_t cut;
+    while (end - start >= roundSize) {
+        // look up 16 bytes of each lane, then transpose to gearRow[step][lane]
+        const uint8_t* blockBase = src + start;
+        for (uint32_t step = 0; step < GEAR_BLOCK_SIZE; step += 16) {
+            __m512i row[16];
+            for (uint32_t lane = 0; lane < laneNum; lane++) {
+                __m512i idx = _mm512_cvtepu8_epi32(_mm_loadu_si128(
+                    (const __m128i*)(blockBase + lane * GEAR_BLOCK_SIZE + step)));
+                __mmask16 bit5 = _mm512_test_epi32_mask(idx, bit5Vec);
+                __mmask16 bit6 = _mm512_test_epi32_mask(idx, bit6Vec);
+                __mmask16 bit7 = _mm512_test_epi32_mask(idx, bit7Vec);
+                __m512i entry0 = _mm512_mask_blend_epi32(bit5,
+                    _mm512_permutex2var_epi32(gearTable[0], idx, gearTable[1]),
+                    _mm512_permutex2var_epi32(gearTable[2], idx, gearTable[3]));
+                __m512i entry1 = _mm512_mask_blend_epi32(bit5,
+                    _mm512_permutex2var_epi32(gearTable[4], idx, gearTable[5]),
+                    _mm512_permutex2var_epi32(gearTable[6], idx, gearTable[7]));
+                __m512i entry2 = _mm512_mask_blend_epi32(bit5,
+                    _mm512_permutex2var_epi32(gearTable[8], idx, gearTable[9]),
+                    _mm512_permutex2var_epi32(gearTable[10], idx, gearTable[11]));
+                __m512i entry3 = _mm512_mask_blend_epi32(bit5,
+                    _mm512_permutex2var_epi32(gearTable[12], idx, gearTable[13]),
+                    _mm512_permutex2var_epi32(gearTable[14], idx, gearTable[15]));
+                entry0 = _mm512_mask_blend_epi32(bit6, entry0, entry1);
+                entry2 = _mm512_mask_blend_epi32(bit6, entry2, entry3);
+                row[lane] = _mm512_mask_blend_epi32(bit7, entry0, entry2);
+            }
+            Transpose16x16(row);
+            for (uint32_t i = 0; i < 16; i++) {
+                _mm512_store_si512((void*)(gearRow + (step + i) * laneNum), row[i]);
+            }
+        }
+
+        // warm up lane i with the tail of block i - 1
+        __m512i fpVec = zeroVec;
+        for (uint32_t step = GEAR_BLOCK_SIZE - GEAR_WARMUP_SIZE; step < GEAR_BLOCK_SIZE;
+            step++) {
+            __m512i gearVec = _mm512_alignr_epi32(
+                _mm512_load_si512((const void*)(gearRow + step * laneNum)), zeroVec, 15);
+            fpVec = _mm512_add_epi32(_mm512_srli_epi32(fpVec, 1), gearVec);
+        }
+        fpVec = _mm512_mask_mov_epi32(fpVec, 1, _mm512_set1_epi32(fp));
+        _mm512_store_si512((void*)laneState, fpVec);
+
+        __mmask16 found = 0;
+        __m512i hitVec = _mm512_set1_epi32(-1);
+        for (uint32_t step = 0; step < GEAR_BLOCK_SIZE; step++) {
+            __m512i gearVec = _mm512_load_si512((const void*)(gearRow + step * laneNum));
+            fpVec = _mm512_add_epi32(_mm512_srli_epi32(fpVec, 1), gearVec);
+            __mmask16 match = _mm512_testn_epi32_mask(fpVec, maskVec) & ~found;
+            hitVec = _mm512_mask_mov_epi32(hitVec, match, _mm512_set1_epi32(step));
+            found |= match;
+        }
+        _mm512_store_si512((void*)laneHit, hitVec);
+        _mm512_store_si512((void*)laneEnd, fpVec);
+
+        if (VerifyLanes(src, start, laneNum, laneState, laneHit, laneEnd, mask,
+            fp, cut)) {
+            return cut;
+        }
+        start += roundSize;
+    }
+    return ScanScalar(src, start, end, mask, fp);
+}
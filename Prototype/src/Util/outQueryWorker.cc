@@ -0,0 +1,81 @@
+/**
+ * @file outQueryWorker.cc
+ * @brief implement the helper thread of the out-enclave index query
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/outQueryWorker.h"
+
+/**
+ * @brief Construct a new OutQueryWorker object
+ * 
+ */
+OutQueryWorker::OutQueryWorker() {
+    workerTh_ = new boost::thread(boost::bind(&OutQueryWorker::Run, this));
+}
+
+/**
+ * @brief Destroy the OutQueryWorker object, wait for the task in flight
+ * 
+ */
+OutQueryWorker::~OutQueryWorker() {
+    {
+        boost::mutex::scoped_lock lock(workerLck_);
+        exitFlag_ = true;
+    }
+    workerCond_.notify_all();
+    workerTh_->join();
+    delete workerTh_;
+}
+
+/**
+ * @brief the main loop of the helper thread
+ * 
+ */
+void OutQueryWorker::Run() {
+    boost::mutex::scoped_lock lock(workerLck_);
+    while (true) {
+        while (!busyFlag_ && !exitFlag_) {
+            workerCond_.wait(lock);
+        }
+        if (!busyFlag_) {
+            // exit after the task in flight
+            break;
+        }
+        lock.unlock();
+        task_();
+        lock.lock();
+        busyFlag_ = false;
+        workerCond_.notify_all();
+    }
+    return ;
+}
+
+/**
+ * @brief submit a task, wait for the previous one if it is in flight
+ * 
+ * @param task the task
+ */
+void OutQueryWorker::Submit(boost::function<void()> task) {
+    boost::mutex::scoped_lock lock(workerLck_);
+    while (busyFlag_) {
+        workerCond_.wait(lock);
+    }
+    task_ = task;
+    busyFlag_ = true;
+    workerCond_.notify_all();
+    return ;
+}
+
+/**
+ * @brief wait until the submitted task finishes
+ * 
+ */
+void OutQueryWorker::Wait() {
+    boost::mutex::scoped_lock lock(workerLck_);
+    while (busyFlag_) {
+        workerCond_.wait(lock);
+    }
+    return ;
+}
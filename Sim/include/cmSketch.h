@@ -80,6 +80,10 @@ class CountMinSketch {
         ///
         void ClearUp();
 
+        /// \brief halve all buckets in the sketch (aging)
+        ///
+        void Halve();
+
         /// \brief Get the First Row of the sketch
         ///
         /// \return uint32_t* - the pointer points to the first row of sketch
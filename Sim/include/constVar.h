@@ -65,6 +65,16 @@ static const uint32_t SPARSE_MANIFIEST_CAP_NUM = 10;
 enum INDEX_TYPE_SET {OUT_ENCLAVE = 0, IN_ENCLAVE, EXTREME_BIN, SPARSE_INDEX, 
     FREQ_INDEX};
 
+// the policies of the frequency index (the bits of freqPolicy): FREQ_AGING halves
+// the sketch and the top-k freqs every FREQ_AGING_FACTOR * k chunks, FREQ_DOORKEEPER
+// keeps the first occurrence of a chunk in a doorkeeper (cleared every period) and
+// only admits a chunk above the top-k min (TinyLFU), FREQ_BYTE_WEIGHT counts a
+// chunk by its size in FREQ_WEIGHT_UNIT
+enum FREQ_POLICY {FREQ_AGING = 0x1, FREQ_DOORKEEPER = 0x2, FREQ_BYTE_WEIGHT = 0x4};
+static const uint32_t FREQ_AGING_FACTOR = 10;
+static const uint32_t DOORKEEPER_BITS_PER_CHUNK = 8;
+static const uint32_t FREQ_WEIGHT_UNIT = MIN_CHUNK_SIZE;
+
 enum SSL_CONNECTION_TYPE {IN_SERVERSIDE = 0, IN_CLIENTSIDE};
 
 // for SSL connection 
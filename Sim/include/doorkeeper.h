@@ -0,0 +1,52 @@
+/**
+ * @file doorkeeper.h
+ * @brief define the doorkeeper of the freq index: a bloom filter that keeps
+ * the chunks seen once in the current period (TinyLFU)
+ * @version 0.1
+ * 
+ */
+
+#ifndef DOORKEEPER_H
+#define DOORKEEPER_H
+
+#include "define.h"
+#include "murmurHash3.h"
+
+using namespace std;
+
+class Doorkeeper {
+    private:
+        // the bits set per key
+        static const uint32_t HASH_NUM = 4;
+        // the seed after the ones of the sketch
+        static const uint32_t HASH_SEED = 16;
+
+        uint64_t bitNum_;
+        vector<uint64_t> wordList_;
+
+    public:
+        /**
+         * @brief Construct a new Doorkeeper object
+         * 
+         * @param bitNum the number of bits
+         */
+        Doorkeeper(uint64_t bitNum);
+
+        /**
+         * @brief check whether a chunk is in the doorkeeper, and insert it
+         * 
+         * @param chunkHash the chunk hash
+         * @param chunkHashLen the length of the chunk hash
+         * @return true the chunk was in the doorkeeper
+         * @return false the chunk is inserted for the first time
+         */
+        bool TestAndSet(uint8_t* const chunkHash, size_t chunkHashLen);
+
+        /**
+         * @brief clear all bits at the end of a period
+         * 
+         */
+        void Clear();
+};
+
+#endif
@@ -117,6 +117,13 @@ class EcallEntryHeap {
          */
         void Update(const string&key, uint32_t freq);
 
+        /**
+         * @brief halve the frequency of all elements (aging), the halving
+         * keeps the heap order
+         * 
+         */
+        void Age();
+
         /**
          * @brief check if the heap contains an element
          * 
@@ -17,6 +17,7 @@
 #include "cmSketch.h"
 #include "absDatabase.h"
 #include "ecallEntryHeap.h"
+#include "doorkeeper.h"
 
 using namespace std;
 
@@ -44,6 +45,15 @@ class FreqIndex: public AbsIndex {
         // the deduplication index
         EcallEntryHeap* newMinHeap_;
 
+        // the freq policy (the bits of FREQ_POLICY)
+        uint32_t freqPolicy_;
+        // the chunks seen in the current period (NULL: no FREQ_DOORKEEPER)
+        Doorkeeper* doorkeeper_ = NULL;
+        // the chunks of a period, and the chunks of the current period
+        uint64_t agingPeriod_;
+        uint64_t periodChunkNum_ = 0;
+        uint64_t agingNum_ = 0;
+
         // statistics
         uint64_t insideDedupChunkNum_ = 0;
         uint64_t insideDedupDataSize_ = 0;
@@ -67,6 +77,43 @@ class FreqIndex: public AbsIndex {
          */
         void ProcessBatchFp(vector<ChunkInfo>& fpBatchBuffer);
 
+        /**
+         * @brief get the weight of a chunk in the sketch
+         * 
+         * @param chunkSize the chunk size
+         * @return uint32_t the weight
+         */
+        inline uint32_t GetFreqWeight(uint32_t chunkSize) const {
+            if (freqPolicy_ & FREQ_BYTE_WEIGHT) {
+                return (chunkSize + FREQ_WEIGHT_UNIT - 1) / FREQ_WEIGHT_UNIT;
+            }
+            return 1;
+        }
+
+        /**
+         * @brief check whether admit a new chunk to the full heap, with the
+         * doorkeeper the chunk must beat the min freq (TinyLFU)
+         * 
+         * @param currentFreq the chunk freq
+         * @param heapMinFreq the min freq of the heap
+         * @return true admit the chunk
+         * @return false reject the chunk
+         */
+        inline bool CheckIfAdmit(uint32_t currentFreq, uint32_t heapMinFreq) const {
+            if (doorkeeper_ != NULL) {
+                return currentFreq > heapMinFreq;
+            }
+            return currentFreq >= heapMinFreq;
+        }
+
+        /**
+         * @brief count the chunks of a batch, and halve the frequencies and
+         * clear the doorkeeper at the end of a period
+         * 
+         * @param chunkNum the number of chunks in the batch
+         */
+        void AgeFreq(uint64_t chunkNum);
+
     public:
         /**
          * @brief Construct a new Top K Two Index object
@@ -74,8 +121,9 @@ class FreqIndex: public AbsIndex {
          * @param inputFile the trace file
          * @param type FSL or MS 
          * @param k 
+         * @param freqPolicy the bits of FREQ_POLICY
          */
-        FreqIndex(string inputFile, int type, uint32_t k);
+        FreqIndex(string inputFile, int type, uint32_t k, uint32_t freqPolicy = 0);
 
         /**
          * @brief process the trace file
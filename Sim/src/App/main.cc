@@ -16,22 +16,28 @@
 enum METHOD_TYPE {DEBE = 0, TED};
 
 void Usage() {
-    fprintf(stderr, "./KLDMain -i [input file] -m [method] -k [top-k threshold (K)] -t [trace type]\n");
+    fprintf(stderr, "./KLDMain -i [input file] -m [method] -k [top-k threshold (K)] -t [trace type] "
+        "-p [freq policy (optional)]\n");
     fprintf(stderr, "-m: method:\n");
     fprintf(stderr, "\t0: DEBE\n");
     fprintf(stderr, "\t1: TED\n");
     fprintf(stderr, "-t: trace type:\n");
     fprintf(stderr, "\t0: DOCKER, LINUX, VM, and FSL\n");
     fprintf(stderr, "\t1: MS\n");
+    fprintf(stderr, "-p: freq policy of DEBE (the sum of the bits, default 0):\n");
+    fprintf(stderr, "\t1: aging\n");
+    fprintf(stderr, "\t2: doorkeeper (TinyLFU admission)\n");
+    fprintf(stderr, "\t4: byte weight\n");
 }
 
 string myName = "Sim";
 
 int main(int argc, char* argv[]) {
-    const char optString[] = "i:m:k:t:";
+    const char optString[] = "i:m:k:t:p:";
     int option;
 
-    if (argc < sizeof(optString)) {
+    // -p is optional
+    if (argc < sizeof(optString) - 2) {
         tool::Logging(myName.c_str(), "wrong argc: %d\n", argc);
         Usage();
         exit(EXIT_FAILURE);
@@ -41,6 +47,7 @@ int main(int argc, char* argv[]) {
     int method;
     string inputFilePath;
     int traceType = FSL;
+    uint32_t freqPolicy = 0;
     while ((option = getopt(argc, argv, optString)) != -1) {
         switch (option) {
             case 'i': {
@@ -87,6 +94,15 @@ int main(int argc, char* argv[]) {
                 }
                 break;
             }
+            case 'p': {
+                freqPolicy = atoi(optarg);
+                if (freqPolicy > (FREQ_AGING | FREQ_DOORKEEPER | FREQ_BYTE_WEIGHT)) {
+                    tool::Logging(myName.c_str(), "wrong freq policy.\n");
+                    Usage();
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
             case '?': {
                 tool::Logging(myName.c_str(), "error optopt: %c\n", optopt);
                 tool::Logging(myName.c_str(), "error opterr: %d\n", opterr);
@@ -98,6 +114,7 @@ int main(int argc, char* argv[]) {
     tool::Logging(myName.c_str(), "--------config--------\n");
     tool::Logging(myName.c_str(), "input file path: %s\n", inputFilePath.c_str());
     tool::Logging(myName.c_str(), "threshold: %u K\n", k);
+    tool::Logging(myName.c_str(), "freq policy: %u\n", freqPolicy);
     tool::Logging(myName.c_str(), "----------------------\n");   
 
 
@@ -105,7 +122,7 @@ int main(int argc, char* argv[]) {
     switch (method) {
         case DEBE: {
             k *= 1024; 
-            index = new FreqIndex(inputFilePath, traceType, k);
+            index = new FreqIndex(inputFilePath, traceType, k, freqPolicy);
             break;
         }
         case TED: {
@@ -17,11 +17,17 @@
  * @param inputFile the trace file
  * @param type FSL or MS 
  * @param k 
+ * @param freqPolicy the bits of FREQ_POLICY
  */
-FreqIndex::FreqIndex(string inputFile, int type, uint32_t k) : 
+FreqIndex::FreqIndex(string inputFile, int type, uint32_t k, uint32_t freqPolicy) : 
     AbsIndex(inputFile, type) {
     k_ = k;
     cmSketch_ = new CountMinSketch(width_, depth_);
+    freqPolicy_ = freqPolicy;
+    agingPeriod_ = (uint64_t)FREQ_AGING_FACTOR * k_;
+    if (freqPolicy_ & FREQ_DOORKEEPER) {
+        doorkeeper_ = new Doorkeeper(DOORKEEPER_BITS_PER_CHUNK * agingPeriod_);
+    }
     newMinHeap_ = new EcallEntryHeap();
     newMinHeap_->SetHeapSize(k_);
     logicalChunkDB_ = dbFactory_.CreateDatabase(LEVEL_DB, "plaintext-db");
@@ -41,9 +47,15 @@ FreqIndex::~FreqIndex() {
     delete cipherChunkDB_;
     delete cmSketch_;
     delete newMinHeap_;
+    if (doorkeeper_ != NULL) {
+        delete doorkeeper_;
+    }
     fprintf(stderr, "========FreqIndex Info========\n");
     fprintf(stderr, "Original KLD (CE): %lf\n", originalKLD_);
     fprintf(stderr, "Cipher KLD (DEBE): %lf\n", newKLD_);
+    fprintf(stderr, "Freq policy: %u, aging num: %lu\n", freqPolicy_, agingNum_);
+    fprintf(stderr, "Top-k dedup ratio (chunk): %lf\n", (logicalChunkNum_ == 0) ? 0 :
+        static_cast<double>(insideDedupChunkNum_) / logicalChunkNum_);
     fprintf(stderr, "==============================\n");
 }
 
@@ -139,9 +151,16 @@ void FreqIndex::ProcessBatchFp(vector<ChunkInfo>& fpBatchBuffer) {
         uint32_t currentFreq;
         // update the sketch
         string chunkFp = fpBatchBuffer[i].fpStr;
-        cmSketch_->Update((uint8_t*)&chunkFp[0], chunkHashLen, 1);
+        uint32_t weight = this->GetFreqWeight(fpBatchBuffer[i].chunkSize);
+        if (doorkeeper_ == NULL || doorkeeper_->TestAndSet((uint8_t*)&chunkFp[0], chunkHashLen)) {
+            cmSketch_->Update((uint8_t*)&chunkFp[0], chunkHashLen, weight);
+        }
         // estimate the current frequency
         currentFreq = cmSketch_->Estimate((uint8_t*)&chunkFp[0], chunkHashLen);
+        if (doorkeeper_ != NULL) {
+            // the doorkeeper holds one occurrence of each chunk in the period
+            currentFreq += weight;
+        }
 
         // for batching merge them together in a batch index
         auto localFindResult = tmpIndex.find(chunkFp);
@@ -236,7 +255,7 @@ void FreqIndex::ProcessBatchFp(vector<ChunkInfo>& fpBatchBuffer) {
                     if (newMinHeap_->Size() == k_) {
                         // remove the root node
                         uint32_t heapMinFreq = newMinHeap_->TopEntry();
-                        if (currentFreq >= heapMinFreq) {
+                        if (this->CheckIfAdmit(currentFreq, heapMinFreq)) {
                             // add this chunk to the heap
                             newMinHeap_->Pop();
                             
@@ -272,7 +291,7 @@ void FreqIndex::ProcessBatchFp(vector<ChunkInfo>& fpBatchBuffer) {
                     if (newMinHeap_->Size() == k_) {
                         // remove the root node
                         uint32_t heapMinFreq = newMinHeap_->TopEntry();
-                        if (currentFreq >= heapMinFreq) {
+                        if (this->CheckIfAdmit(currentFreq, heapMinFreq)) {
                             // add this chunk to the heap
                             newMinHeap_->Pop();
                             
@@ -298,5 +317,36 @@ void FreqIndex::ProcessBatchFp(vector<ChunkInfo>& fpBatchBuffer) {
             }
         }
     }
+
+    // age the frequencies at the end of a period
+    this->AgeFreq(fpBatchBuffer.size());
+    return ;
+}
+
+/**
+ * @brief count the chunks of a batch, and halve the frequencies and
+ * clear the doorkeeper at the end of a period
+ * 
+ * @param chunkNum the number of chunks in the batch
+ */
+void FreqIndex::AgeFreq(uint64_t chunkNum) {
+    if ((freqPolicy_ & (FREQ_AGING | FREQ_DOORKEEPER)) == 0) {
+        return ;
+    }
+    periodChunkNum_ += chunkNum;
+    if (periodChunkNum_ < agingPeriod_) {
+        return ;
+    }
+
+    if (freqPolicy_ & FREQ_AGING) {
+        cmSketch_->Halve();
+        // the halving keeps the order of the heap
+        newMinHeap_->Age();
+        agingNum_++;
+    }
+    if (doorkeeper_ != NULL) {
+        doorkeeper_->Clear();
+    }
+    periodChunkNum_ = 0;
     return ;
 }
\ No newline at end of file
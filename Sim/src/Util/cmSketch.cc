@@ -115,6 +115,19 @@ void CountMinSketch::ClearUp() {
     }
 }
 
+/// \brief halve all buckets in the sketch (aging)
+///
+void CountMinSketch::Halve() {
+    size_t indexWidth;
+    size_t indexDepth;
+    for (indexDepth = 0; indexDepth < depth_; indexDepth++) {
+        for (indexWidth = 0; indexWidth < width_; indexWidth++) {
+            counterArray_[indexDepth][indexWidth] >>= 1;
+        }
+    }
+    total_ >>= 1;
+}
+
 /// \brief return the pos of first row
 ///
 /// \param chunkHash 
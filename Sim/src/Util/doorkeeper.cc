@@ -0,0 +1,51 @@
+/**
+ * @file doorkeeper.cc
+ * @brief implement the doorkeeper of the freq index
+ * @version 0.1
+ * 
+ */
+
+#include "../../include/doorkeeper.h"
+
+/**
+ * @brief Construct a new Doorkeeper object
+ * 
+ * @param bitNum the number of bits
+ */
+Doorkeeper::Doorkeeper(uint64_t bitNum) {
+    bitNum_ = (bitNum == 0) ? 64 : bitNum;
+    wordList_.resize((bitNum_ + 63) / 64, 0);
+}
+
+/**
+ * @brief check whether a chunk is in the doorkeeper, and insert it
+ * 
+ * @param chunkHash the chunk hash
+ * @param chunkHashLen the length of the chunk hash
+ * @return true the chunk was in the doorkeeper
+ * @return false the chunk is inserted for the first time
+ */
+bool Doorkeeper::TestAndSet(uint8_t* const chunkHash, size_t chunkHashLen) {
+    // the trace fp is short, derive the bits by double hashing
+    uint64_t hashVal[2];
+    MurmurHash3_x64_128(chunkHash, chunkHashLen, HASH_SEED, hashVal);
+    bool existFlag = true;
+    for (uint32_t i = 0; i < HASH_NUM; i++) {
+        uint64_t bitPos = (hashVal[0] + i * hashVal[1]) % bitNum_;
+        uint64_t mask = 1ULL << (bitPos % 64);
+        if ((wordList_[bitPos / 64] & mask) == 0) {
+            wordList_[bitPos / 64] |= mask;
+            existFlag = false;
+        }
+    }
+    return existFlag;
+}
+
+/**
+ * @brief clear all bits at the end of a period
+ * 
+ */
+void Doorkeeper::Clear() {
+    fill(wordList_.begin(), wordList_.end(), 0);
+    return ;
+}
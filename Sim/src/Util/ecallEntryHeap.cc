@@ -132,6 +132,18 @@ void EcallEntryHeap::Update(const string&key, uint32_t freq) {
     return ;
 }
 
+/**
+ * @brief halve the frequency of all elements (aging), the halving
+ * keeps the heap order
+ * 
+ */
+void EcallEntryHeap::Age() {
+    for (auto& item : _index) {
+        item.second.chunkFreq >>= 1;
+    }
+    return ;
+}
+
 /**
  * @brief check if the heap contains an element
  * 